@@ -0,0 +1,188 @@
+#include "core/adc.h"
+#include "core/executioncontext.h"
+#include "core/scheduler.h"
+#include "core/waveform.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace avr {
+    namespace {
+        constexpr uint64_t CONVERSION_CLOCKS = 13u;
+        constexpr uint64_t FIRST_CONVERSION_CLOCKS = 25u;
+    }
+
+    Adc::Adc(const AdcLayout& layout, std::shared_ptr<Waveform> waveform)
+        : _layout(layout),
+          _waveform(std::move(waveform)),
+          _adcsra(0u),
+          _adcsrb(0u),
+          _admux(0u),
+          _result(0u),
+          _locked(false),
+          _first(true),
+          _converting(false),
+          _channel(0u),
+          _sampleAt(0u),
+          _doneAt(0u),
+          _scheduled(false),
+          _event(0u)
+    {}
+
+    std::shared_ptr<Adc> Adc::Attach(ExecutionContext& ctx, const AdcLayout& layout, std::shared_ptr<Waveform> waveform)
+    {
+        auto adc = std::make_shared<Adc>(layout, std::move(waveform));
+        auto read = [adc] (ExecutionContext& ctx, uint16_t address) {
+            return adc->Read(ctx, address);
+        };
+        auto write = [adc] (ExecutionContext& ctx, uint16_t address, uint8_t value) {
+            adc->Write(ctx, address, value);
+        };
+
+        for (auto address : { layout.adcl, layout.adch, layout.adcsra, layout.adcsrb, layout.admux })
+            ctx.io.Map(address, read, write);
+        return adc;
+    }
+
+    uint64_t Adc::Prescale() const
+    {
+        auto select = _adcsra & 0x07u;
+        return select == 0u ? 2u : uint64_t(1u) << select;
+    }
+
+    bool Adc::FreeRunning() const
+    {
+        return (_adcsra & ADATE) && (_adcsrb & 0x07u) == 0u;
+    }
+
+    // Sample and hold comes 1.5 ADC clocks in, after the 12 clocks the
+    // first conversion spends starting up the analog circuitry
+    void Adc::Start(uint64_t cycle)
+    {
+        auto prescale = Prescale();
+        auto clocks = _first ? FIRST_CONVERSION_CLOCKS : CONVERSION_CLOCKS;
+        _converting = true;
+        _channel = _admux & MUX;
+        _sampleAt = cycle + (clocks - CONVERSION_CLOCKS) * prescale + prescale * 3u / 2u;
+        _doneAt = cycle + clocks * prescale;
+        _first = false;
+    }
+
+    // ADIF stays set until Acknowledge sees its interrupt vectored or the
+    // firmware writes a one to it, so it can be polled too. A result
+    // finished while ADCL is locked is lost.
+    void Adc::Complete(ExecutionContext& ctx)
+    {
+        auto sample = std::min<uint16_t>(_waveform->Sample(_channel, _sampleAt), 0x3FFu);
+        if (!_locked)
+            _result = sample;
+
+        _adcsra |= ADIF;
+        if (_adcsra & ADIE)
+            ctx.RaiseInterrupt(_layout.interrupt);
+    }
+
+    // A set ADIF whose interrupt is enabled but no longer pending has been
+    // vectored, which clears it on the hardware
+    void Adc::Acknowledge(ExecutionContext& ctx)
+    {
+        auto pending = (ctx.pendingInterrupts & (uint64_t(1u) << _layout.interrupt)) != 0u;
+        if ((_adcsra & ADIF) && (_adcsra & ADIE) && !pending)
+            _adcsra &= static_cast<uint8_t>(~ADIF);
+    }
+
+    void Adc::Advance(ExecutionContext& ctx)
+    {
+        Acknowledge(ctx);
+        if (!_converting || ctx.cycles < _doneAt)
+            return;
+
+        if (!FreeRunning())
+        {
+            _converting = false;
+            Complete(ctx);
+            return;
+        }
+
+        // Back to back conversions: only the last one finished matters
+        auto period = CONVERSION_CLOCKS * Prescale();
+        auto skipped = (ctx.cycles - _doneAt) / period;
+        if (skipped > 0u)
+            Start(_doneAt + (skipped - 1u) * period);
+        Complete(ctx);
+        Start(_doneAt);
+    }
+
+    void Adc::Reschedule(ExecutionContext& ctx)
+    {
+        if (_scheduled)
+        {
+            ctx.scheduler.Cancel(_event);
+            _scheduled = false;
+        }
+        if (!_converting || !(_adcsra & ADIE))
+            return;
+
+        _event = ctx.scheduler.Schedule(_doneAt, [self = shared_from_this()] (ExecutionContext& ctx) {
+            self->_scheduled = false;
+            self->Advance(ctx);
+            self->Reschedule(ctx);
+        });
+        _scheduled = true;
+    }
+
+    uint8_t Adc::Read(ExecutionContext& ctx, uint16_t address)
+    {
+        Advance(ctx);
+        Reschedule(ctx);
+        auto adjusted = (_admux & ADLAR) ? static_cast<uint16_t>(_result << 6) : _result;
+        if (address == _layout.adcl)
+        {
+            _locked = true;
+            return static_cast<uint8_t>(adjusted);
+        }
+        if (address == _layout.adch)
+        {
+            _locked = false;
+            return static_cast<uint8_t>(adjusted >> 8);
+        }
+        if (address == _layout.adcsra)
+            return static_cast<uint8_t>(_adcsra | (_converting ? ADSC : 0u));
+        if (address == _layout.adcsrb)
+            return _adcsrb;
+        return _admux;
+    }
+
+    void Adc::Write(ExecutionContext& ctx, uint16_t address, uint8_t value)
+    {
+        Advance(ctx);
+        if (address == _layout.adcsra)
+        {
+            // Writing a one clears ADIF, and the interrupt if it was already
+            // raised. Clearing ADIE only takes the interrupt away.
+            auto flags = static_cast<uint8_t>(_adcsra & ADIF & ~value);
+            if ((value & ADIF) || !(value & ADIE))
+                ctx.ClearInterrupt(_layout.interrupt);
+            else if (flags && !(_adcsra & ADIE))
+                ctx.RaiseInterrupt(_layout.interrupt);
+            _adcsra = static_cast<uint8_t>((value & ~(ADSC | ADIF)) | flags);
+
+            if (!(_adcsra & ADEN))
+            {
+                // Switching the ADC off aborts any conversion
+                _converting = false;
+                _first = true;
+            }
+            else if ((value & ADSC) && !_converting)
+                Start(ctx.cycles);
+        }
+        else if (address == _layout.adcsrb)
+            _adcsrb = value;
+        else if (address == _layout.admux)
+            _admux = value;
+
+        Reschedule(ctx);
+    }
+}
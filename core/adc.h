@@ -0,0 +1,93 @@
+#pragma once
+
+#include "core/executioncontext.h"
+#include "core/scheduler.h"
+#include "core/waveform.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace avr {
+    // Where the ADC's registers sit in data space and the interrupt it
+    // raises, numbered as the ATmega328P numbers its vectors
+    struct AdcLayout {
+        uint16_t adcl;
+        uint16_t adch;
+        uint16_t adcsra;
+        uint16_t adcsrb;
+        uint16_t admux;
+        uint8_t interrupt;
+    };
+
+    constexpr AdcLayout ADC_LAYOUT = { 0x78u, 0x79u, 0x7Au, 0x7Bu, 0x7Cu, 21u };
+
+    // The 10-bit ADC on the I/O bus, converting samples from a Waveform.
+    // MUX picks the waveform channel and each sample is taken at the cycle
+    // the hardware would sample and hold it, 1.5 ADC clocks into a
+    // conversion, or 13.5 into the first one after ADEN, which takes 25
+    // clocks rather than 13. Samples are ADC codes, clamped to 0x3FF.
+    //
+    // Like TimerCounter, conversions are worked out when a register is
+    // read, so free running skips straight to the last one finished, and
+    // one is only scheduled when ADIE wants an interrupt from it.
+    //
+    // Of the auto trigger sources only free running is modelled, and the
+    // reference selection, digital input disable and the analog
+    // comparator's use of the multiplexer are ignored.
+    class Adc : public std::enable_shared_from_this<Adc> {
+        private:
+            enum Control : uint8_t {
+                ADIE = 0x08u,
+                ADIF = 0x10u,
+                ADATE = 0x20u,
+                ADSC = 0x40u,
+                ADEN = 0x80u
+            };
+
+            enum Multiplexer : uint8_t {
+                MUX = 0x0Fu,
+                ADLAR = 0x20u
+            };
+
+            AdcLayout _layout;
+            std::shared_ptr<Waveform> _waveform;
+            uint8_t _adcsra;
+            uint8_t _adcsrb;
+            uint8_t _admux;
+            uint16_t _result;
+            bool _locked;           // ADCL was read, so ADCH still holds its pair
+            bool _first;            // the next conversion is the first since ADEN
+
+            bool _converting;
+            unsigned _channel;
+            uint64_t _sampleAt;
+            uint64_t _doneAt;
+            bool _scheduled;
+            Scheduler::EventId _event;
+
+            uint64_t Prescale() const;
+            bool FreeRunning() const;
+            void Start(uint64_t cycle);
+            void Complete(ExecutionContext& ctx);
+            void Acknowledge(ExecutionContext& ctx);
+            void Advance(ExecutionContext& ctx);
+            void Reschedule(ExecutionContext& ctx);
+
+            uint8_t Read(ExecutionContext& ctx, uint16_t address);
+            void Write(ExecutionContext& ctx, uint16_t address, uint8_t value);
+
+        public:
+            Adc(const AdcLayout& layout, std::shared_ptr<Waveform> waveform);
+
+            // Maps the ADC's registers on ctx.io. The bus and any event
+            // scheduled keep the ADC alive.
+            static std::shared_ptr<Adc> Attach(ExecutionContext& ctx, const AdcLayout& layout, std::shared_ptr<Waveform> waveform);
+
+            // Conversions that repeated a stale sample because the waveform
+            // is NonBlocking and its page was not in memory yet
+            uint64_t misses() const
+            {
+                return _waveform->misses();
+            }
+    };
+}
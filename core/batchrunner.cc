@@ -0,0 +1,187 @@
+#include "core/batchrunner.h"
+#include "core/cpu.h"
+#include "core/executioncontext.h"
+#include "core/flashimage.h"
+#include "core/iexecutor.h"
+#include "core/loader.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace avr {
+    namespace {
+        // Job indices waiting for a worker. The owner takes from the back
+        // and thieves from the front, so they only meet on the last job.
+        class WorkQueue {
+            private:
+                std::mutex _mutex;
+                std::deque<std::size_t> _jobs;
+
+            public:
+                WorkQueue()
+                    : _mutex(),
+                      _jobs()
+                {}
+
+                void Push(std::size_t job)
+                {
+                    auto lock = std::lock_guard<std::mutex>(_mutex);
+                    _jobs.push_back(job);
+                }
+
+                bool Pop(std::size_t& job)
+                {
+                    auto lock = std::lock_guard<std::mutex>(_mutex);
+                    if (_jobs.empty())
+                        return false;
+                    job = _jobs.back();
+                    _jobs.pop_back();
+                    return true;
+                }
+
+                bool Steal(std::size_t& job)
+                {
+                    auto lock = std::lock_guard<std::mutex>(_mutex);
+                    if (_jobs.empty())
+                        return false;
+                    job = _jobs.front();
+                    _jobs.pop_front();
+                    return true;
+                }
+        };
+
+        bool IsHalted(const ExecutionContext& ctx)
+        {
+            if (!ctx.scheduler.Empty())
+                return false;
+            if (ctx.cpu.is_sleeping)
+                return true;
+
+            // rjmp .-2
+            auto pc = ctx.cpu.PC;
+            return ctx.progMem[pc] == 0xFEu && ctx.progMem[static_cast<uint16_t>(pc + 1u)] == 0xCFu;
+        }
+    }
+
+    BatchRunner::BatchRunner(
+        const IExecutor& executor,
+        uint64_t cycleLimit,
+        const std::vector<MemoryRange>& ranges,
+        unsigned threads)
+        : _executor(executor),
+          _cycleLimit(cycleLimit),
+          _ranges(ranges),
+          _threads(threads != 0u ? threads : std::max(std::thread::hardware_concurrency(), 1u))
+    {}
+
+    RunResult BatchRunner::RunJob(const BatchJob& job, const FlashImage& image) const
+    {
+        auto result = RunResult();
+        result.reason = ExitReason::CycleLimit;
+
+        auto ctx = Loader().LoadImage(image);
+        for (const auto& [address, bytes] : job.inputs)
+            for (auto i = 0u; i < bytes.size(); i++)
+                ctx.Store(static_cast<uint16_t>(address + i), static_cast<uint8_t>(bytes[i]));
+
+        try
+        {
+            while (true)
+            {
+                if (IsHalted(ctx))
+                {
+                    result.reason = ExitReason::Halted;
+                    break;
+                }
+                if (ctx.cycles >= _cycleLimit)
+                    break;
+                auto slice = std::min<uint64_t>(SLICE, _cycleLimit - ctx.cycles);
+                _executor.Execute(ctx, static_cast<uint32_t>(slice));
+            }
+        }
+        catch (const std::string& error)
+        {
+            result.reason = ExitReason::Error;
+            result.error = error;
+        }
+        catch (const std::exception& error)
+        {
+            result.reason = ExitReason::Error;
+            result.error = error.what();
+        }
+        catch (...)
+        {
+            result.reason = ExitReason::Error;
+            result.error = "Unknown error";
+        }
+
+        result.cycles = ctx.cycles;
+        result.pc = ctx.cpu.PC;
+        result.sp = ctx.cpu.SP;
+        result.sreg = PackSREG(ctx.cpu);
+        std::copy(ctx.cpu.R, ctx.cpu.R + result.registers.size(), result.registers.begin());
+        for (const auto& range : _ranges)
+        {
+            auto bytes = std::string(range.length, '\0');
+            for (auto i = 0u; i < range.length; i++)
+                bytes[i] = static_cast<char>(std::as_const(ctx.ram)[static_cast<uint16_t>(range.begin + i)]);
+            result.ram.push_back(std::move(bytes));
+        }
+        return result;
+    }
+
+    std::vector<RunResult> BatchRunner::Run(const std::vector<BatchJob>& jobs) const
+    {
+        auto loader = Loader();
+        auto images = std::vector<std::shared_ptr<const FlashImage>>(jobs.size());
+        auto built = std::map<std::string, std::shared_ptr<const FlashImage>>();
+        for (auto job = std::size_t(0u); job < jobs.size(); job++)
+        {
+            auto& image = built[jobs[job].program];
+            if (image == nullptr)
+                image = loader.BuildImage(jobs[job].program);
+            images[job] = image;
+        }
+
+        auto results = std::vector<RunResult>(jobs.size());
+        auto workers = std::min<std::size_t>(_threads, std::max<std::size_t>(jobs.size(), 1u));
+        auto queues = std::vector<std::unique_ptr<WorkQueue>>();
+        for (auto i = 0u; i < workers; i++)
+            queues.push_back(std::make_unique<WorkQueue>());
+        for (auto job = std::size_t(0u); job < jobs.size(); job++)
+            queues[job * workers / jobs.size()]->Push(job);
+
+        auto work = [&] (std::size_t self) {
+            auto job = std::size_t(0u);
+            while (true)
+            {
+                auto found = queues[self]->Pop(job);
+                for (auto i = std::size_t(1u); !found && i < workers; i++)
+                    found = queues[(self + i) % workers]->Steal(job);
+                // Nothing is queued once running, so empty queues stay empty
+                if (!found)
+                    return;
+                results[job] = RunJob(jobs[job], *images[job]);
+            }
+        };
+
+        auto threads = std::vector<std::thread>();
+        for (auto i = std::size_t(1u); i < workers; i++)
+            threads.emplace_back(work, i);
+        work(0u);
+        for (auto& thread : threads)
+            thread.join();
+
+        return results;
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "core/flashimage.h"
+#include "core/iexecutor.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace avr {
+    // A firmware image and the input to run it against
+    struct BatchJob {
+        std::string program;
+        // Bytes written to the data space at each address before running
+        std::vector<std::pair<uint16_t, std::string>> inputs;
+    };
+
+    struct MemoryRange {
+        uint16_t begin;
+        uint16_t length;
+    };
+
+    enum class ExitReason {
+        CycleLimit,
+        // Asleep or spinning on a jump to itself with nothing scheduled
+        // which could ever change that
+        Halted,
+        Error
+    };
+
+    struct RunResult {
+        ExitReason reason;
+        std::string error;  // what the executor threw, for Error
+        uint64_t cycles;
+        uint16_t pc;
+        uint16_t sp;
+        uint8_t sreg;
+        std::array<uint8_t, 32> registers;
+        std::vector<std::string> ram;   // one per requested MemoryRange
+    };
+
+    // Runs every job in a context of its own on a pool of worker threads.
+    // Jobs with the same program share one FlashImage, so only the pages a
+    // run writes are its own.
+    // Each worker starts with an even share of the jobs and, once out,
+    // steals from the front of the others' queues, so a few long runs do
+    // not leave the rest of the pool idle. All workers share one executor,
+    // which must be safe to use from several threads at once: Executor,
+    // ThreadedExecutor and BlockExecutor without a compiler are, given a
+    // NoopClock.
+    class BatchRunner {
+        public:
+            // Cycles run between checks for a halted context, so a halted
+            // run overshoots by at most this many
+            constexpr static uint32_t SLICE = 0x1000u;
+
+        private:
+            const IExecutor& _executor;
+            uint64_t _cycleLimit;
+            std::vector<MemoryRange> _ranges;
+            unsigned _threads;
+
+            RunResult RunJob(const BatchJob& job, const FlashImage& image) const;
+
+        public:
+            // threads of 0 uses one per hardware thread
+            BatchRunner(
+                const IExecutor& executor,
+                uint64_t cycleLimit,
+                const std::vector<MemoryRange>& ranges,
+                unsigned threads = 0u);
+
+            unsigned Threads() const
+            {
+                return _threads;
+            }
+
+            // Results are in the same order as jobs
+            std::vector<RunResult> Run(const std::vector<BatchJob>& jobs) const;
+    };
+}
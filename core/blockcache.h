@@ -0,0 +1,144 @@
+#pragma once
+
+#include "core/decodecache.h"
+#include "core/memory.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace avr {
+    struct TranslatedBlock;
+
+    // A successor this block has already been seen to leave for. Exits are
+    // linked on first use so hot loops hop from block to block without a
+    // lookup.
+    struct BlockExit {
+        uint16_t address;
+        TranslatedBlock* block; // nullptr while unlinked
+    };
+
+    // Host code generated for a block by JitCompiler
+    struct NativeBlock {
+        using Function = uint32_t (*)(uint8_t* r, uint8_t* sreg, uint16_t* pc);
+
+        Function function;      // nullptr until compiled
+        uint64_t arena;         // JitArena::Id the code was committed to
+        uint32_t leadCycles;    // cycles spent before the last instruction starts
+        bool rejected;          // the block uses instructions the compiler lacks
+    };
+
+    // A straight-line run of predecoded instructions starting at start. The
+    // run ends after the first instruction which may branch or skip.
+    struct TranslatedBlock {
+        uint16_t start;
+        uint32_t end;       // one past the last byte the translation read
+        std::vector<DecodedInstruction> ops;
+        std::array<BlockExit, 2> exits;
+        uint32_t hits;
+        NativeBlock native;
+    };
+
+    class BlockCache {
+        private:
+            std::size_t _size;
+            std::size_t _mask;
+            std::vector<std::unique_ptr<TranslatedBlock>> _blocks;
+            std::vector<std::unique_ptr<TranslatedBlock>> _retired;
+            uint32_t _generation;
+
+            std::size_t GetIndex(uint16_t address) const
+            {
+                return address & _mask;
+            }
+
+            void Unlink()
+            {
+                for (auto& block : _blocks)
+                    if (block != nullptr)
+                        block->exits = {};
+            }
+
+        public:
+            BlockCache(std::size_t size)
+                : _size(RoundUpToPowerOfTwo(size)),
+                  _mask(_size - 1u),
+                  _blocks(),
+                  _retired(),
+                  _generation(0u)
+            {}
+
+            // Bumped whenever a block is thrown away. Engines must stop
+            // following links into blocks they fetched under an older
+            // generation.
+            uint32_t Generation() const
+            {
+                return _generation;
+            }
+
+            TranslatedBlock* Find(uint16_t address) const
+            {
+                if (_blocks.empty())
+                    return nullptr;
+                return _blocks[GetIndex(address)].get();
+            }
+
+            TranslatedBlock& Insert(std::unique_ptr<TranslatedBlock>&& block)
+            {
+                if (_blocks.empty())
+                    _blocks.resize(_size);
+
+                auto& slot = _blocks[GetIndex(block->start)];
+                if (slot != nullptr)
+                    _retired.push_back(std::move(slot));
+                slot = std::move(block);
+                return *slot;
+            }
+
+            // Drops every block whose translation read the byte at address.
+            // The block currently executing may be among them, so dropped
+            // blocks stay alive until ReleaseRetired is called from outside
+            // any block.
+            void Invalidate(uint16_t address)
+            {
+                Invalidate(address, 1u);
+            }
+
+            // Drops every block whose translation read any of length bytes
+            // from address
+            void Invalidate(uint16_t address, std::size_t length)
+            {
+                auto end = address + length;
+                auto invalidated = false;
+                for (auto& block : _blocks)
+                {
+                    if (block == nullptr || end <= block->start || address >= block->end)
+                        continue;
+
+                    _retired.push_back(std::move(block));
+                    invalidated = true;
+                }
+
+                if (!invalidated)
+                    return;
+
+                Unlink();
+                _generation++;
+            }
+
+            void ReleaseRetired()
+            {
+                _retired.clear();
+            }
+
+            void Clear()
+            {
+                for (auto& block : _blocks)
+                    if (block != nullptr)
+                        _retired.push_back(std::move(block));
+                _blocks.clear();
+                _generation++;
+            }
+    };
+}
@@ -0,0 +1,179 @@
+#include "core/blockcache.h"
+#include "core/blockexecutor.h"
+#include "core/decodecache.h"
+#include "core/dispatchtable.h"
+#include "core/jitcompiler.h"
+#include "core/threadedengine.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace avr {
+    namespace {
+        bool EndsBlock(Operation op)
+        {
+            switch (op)
+            {
+                case Operation::BRBC:
+                case Operation::CALL:
+                case Operation::CPSE:
+                case Operation::JMP:
+                case Operation::RJMP:
+                case Operation::SBIC:
+                case Operation::SBIS:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        bool IsSkip(Operation op)
+        {
+            return op == Operation::CPSE || op == Operation::SBIC || op == Operation::SBIS;
+        }
+
+        // Feeds the engine from translated blocks. While PC keeps landing on
+        // the next instruction of the current block no lookup is made; any
+        // other PC leaves the block, following a linked exit where one
+        // matches. Generic instructions with control flow of their own (RET,
+        // ICALL, SBRC, ...) are caught the same way. With a compiler, a hot
+        // block is entered through a single instruction running its native
+        // code, provided every instruction in it would have started before
+        // the budget ran out or the next event fell due.
+        class BlockStream {
+            private:
+                const DispatchTable& _dispatchTable;
+                JitCompiler* _compiler;
+                DecodedInstruction _native;
+                TranslatedBlock* _block;
+                std::size_t _index;
+                uint16_t _expected;
+                uint32_t _generation;
+
+                std::unique_ptr<TranslatedBlock> Translate(
+                    const ProgramMemory& progMem,
+                    uint16_t start,
+                    const void* const* handlers) const
+                {
+                    auto block = std::make_unique<TranslatedBlock>();
+                    block->start = start;
+                    block->exits = {};
+
+                    uint32_t address = start;
+                    while (block->ops.size() < BlockExecutor::MAX_BLOCK_LENGTH)
+                    {
+                        auto pc = static_cast<uint16_t>(address);
+                        // Leave undecodable words to be reported if they are
+                        // ever actually reached
+                        if (!block->ops.empty() && !_dispatchTable.CanDecode(progMem, pc))
+                            break;
+
+                        auto insn = _dispatchTable.Decode(progMem, pc);
+                        insn.handler = handlers[static_cast<uint8_t>(insn.op)];
+                        block->ops.push_back(insn);
+
+                        address += insn.size * 2u;
+                        block->end = IsSkip(insn.op) ? address + 2u : address;
+                        if (EndsBlock(insn.op))
+                            break;
+                    }
+
+                    return block;
+                }
+
+                TranslatedBlock& Lookup(ExecutionContext& ctx, uint16_t address, const void* const* handlers) const
+                {
+                    auto block = ctx.blockCache.Find(address);
+                    if (block != nullptr)
+                        return *block;
+                    return ctx.blockCache.Insert(Translate(ctx.progMem, address, handlers));
+                }
+
+                TranslatedBlock* Follow(uint16_t address) const
+                {
+                    for (auto& exit : _block->exits)
+                        if (exit.block != nullptr && exit.address == address)
+                            return exit.block;
+                    return nullptr;
+                }
+
+                void Link(uint16_t address, TranslatedBlock& successor)
+                {
+                    auto& exits = _block->exits;
+                    auto& exit = (exits[0].block == nullptr) ? exits[0] : exits[1];
+                    exit.address = address;
+                    exit.block = &successor;
+                }
+
+                void Enter(TranslatedBlock& block, uint16_t address, uint32_t generation)
+                {
+                    _block = &block;
+                    _index = 0u;
+                    _expected = address;
+                    _generation = generation;
+                }
+
+            public:
+                BlockStream(const DispatchTable& dispatchTable, JitCompiler* compiler)
+                    : _dispatchTable(dispatchTable),
+                      _compiler(compiler),
+                      _native(),
+                      _block(nullptr),
+                      _index(0u),
+                      _expected(0u),
+                      _generation(0u)
+                {
+                    if (_compiler != nullptr)
+                        _native.executor = &_compiler->GetInstruction();
+                    _native.size = 1u;
+                }
+
+                const DecodedInstruction& Next(ExecutionContext& ctx, const void* const* handlers, uint32_t cyclesLeft)
+                {
+                    auto& cache = ctx.blockCache;
+                    auto pc = ctx.cpu.PC;
+                    auto linkable = _block != nullptr && _generation == cache.Generation();
+
+                    if (!linkable || pc != _expected || _index == _block->ops.size())
+                    {
+                        auto successor = linkable ? Follow(pc) : nullptr;
+                        if (successor == nullptr)
+                        {
+                            // Nothing still points into blocks retired by SPM
+                            if (!linkable)
+                                cache.ReleaseRetired();
+
+                            successor = &Lookup(ctx, pc, handlers);
+                            if (linkable)
+                                Link(pc, *successor);
+                        }
+                        Enter(*successor, pc, cache.Generation());
+
+                        if (_compiler != nullptr &&
+                            _compiler->Prepare(*_block) &&
+                            cyclesLeft > _block->native.leadCycles)
+                        {
+                            _index = _block->ops.size();
+                            _native.handler = handlers[static_cast<uint8_t>(Operation::Generic)];
+                            return _native;
+                        }
+                    }
+
+                    auto& insn = _block->ops[_index++];
+                    _expected = static_cast<uint16_t>(pc + insn.size * 2u);
+                    return insn;
+                }
+        };
+    }
+
+    void BlockExecutor::Execute(ExecutionContext& ctx, uint32_t cyclesRequested) const
+    {
+        auto stream = BlockStream(*_dispatchTable, _compiler.get());
+        threaded::Run(_clock, ctx, cyclesRequested, stream);
+    }
+
+    void BlockExecutor::Interrupt(ExecutionContext& ctx, uint8_t interrupt) const
+    {
+        ctx.RaiseInterrupt(interrupt);
+    }
+}
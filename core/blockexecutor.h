@@ -0,0 +1,67 @@
+#pragma once
+
+#include "core/dispatchtable.h"
+#include "core/iclock.h"
+#include "core/iexecutor.h"
+#include "core/jitcompiler.h"
+#include "instructions/instructionexecutor.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace avr {
+    // Translates straight-line runs of flash into blocks held in
+    // ExecutionContext::blockCache and runs them on the threaded engine.
+    // A block's exits are linked to the blocks they lead to the first time
+    // they are taken, so a hot loop runs without a cache lookup.
+    class BlockExecutor : public IExecutor {
+        public:
+            constexpr static std::size_t MAX_BLOCK_LENGTH = 64u;
+
+        private:
+            IClock& _clock;
+            std::shared_ptr<const DispatchTable> _dispatchTable;
+            std::shared_ptr<JitCompiler> _compiler;
+
+        public:
+            BlockExecutor(
+                IClock& clock,
+                std::vector<std::unique_ptr<InstructionExecutor>>&& executors)
+                : _clock(clock),
+                  _dispatchTable(std::make_shared<const DispatchTable>(std::move(executors))),
+                  _compiler()
+            {}
+
+            BlockExecutor(
+                IClock& clock,
+                const std::shared_ptr<const DispatchTable>& dispatchTable)
+                : _clock(clock),
+                  _dispatchTable(dispatchTable),
+                  _compiler()
+            {}
+
+            // Hot blocks the compiler accepts run as native code
+            BlockExecutor(
+                IClock& clock,
+                const std::shared_ptr<const DispatchTable>& dispatchTable,
+                const std::shared_ptr<JitCompiler>& compiler)
+                : _clock(clock),
+                  _dispatchTable(dispatchTable),
+                  _compiler(compiler)
+            {}
+
+            const std::shared_ptr<const DispatchTable>& GetDispatchTable() const
+            {
+                return _dispatchTable;
+            }
+
+            const std::shared_ptr<JitCompiler>& GetCompiler() const
+            {
+                return _compiler;
+            }
+
+            void Execute(ExecutionContext& ctx, uint32_t cyclesRequested) const override;
+            void Interrupt(ExecutionContext& ctx, uint8_t interrupt) const override;
+    };
+}
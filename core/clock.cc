@@ -1,17 +1,68 @@
 #include "core/clock.h"
 
-#include <mutex>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <thread>
 
 namespace avr
 {
+    Clock::Clock(uint32_t frequency, Duration quantum)
+        : _frequency(std::max(frequency, 1u)),
+          _quantum(1u),
+          _rebase(true),
+          _origin(),
+          _originCycles(0u),
+          _lag(0)
+    {
+        auto cycles = static_cast<uint64_t>(_frequency) * static_cast<uint64_t>(quantum.count()) /
+            static_cast<uint64_t>(Duration::period::den);
+        _quantum = static_cast<uint32_t>(std::clamp<uint64_t>(cycles, 1u, std::numeric_limits<uint32_t>::max()));
+    }
+
+    // Split to keep cycles * 10^9 from overflowing on long runs
+    Clock::Duration Clock::ToHostTime(uint64_t cycles) const
+    {
+        const auto perSecond = static_cast<uint64_t>(Duration::period::den);
+        auto seconds = cycles / _frequency;
+        auto remainder = cycles % _frequency;
+        return Duration(static_cast<Duration::rep>(seconds * perSecond + remainder * perSecond / _frequency));
+    }
+
+    void Clock::Rebase(HostClock::time_point now, uint64_t cycles)
+    {
+        _origin = now;
+        _originCycles = cycles;
+    }
+
     void Clock::Pulse()
     {
-        _cv.notify_one();
+        _rebase.store(true, std::memory_order_relaxed);
+    }
+
+    void Clock::Synchronize(uint64_t cycles)
+    {
+        auto now = HostClock::now();
+        if (_rebase.exchange(false, std::memory_order_relaxed) || cycles < _originCycles)
+        {
+            Rebase(now, cycles);
+            _lag.store(0, std::memory_order_relaxed);
+            return;
+        }
+
+        auto deadline = _origin + ToHostTime(cycles - _originCycles);
+        auto lag = std::chrono::duration_cast<Duration>(now - deadline);
+        _lag.store(lag.count(), std::memory_order_relaxed);
+
+        if (lag > MAX_LAG)
+            Rebase(now, cycles);
+        else if (lag < Duration::zero())
+            std::this_thread::sleep_until(deadline);
     }
 
-    void Clock::ConsumeCycle()
+    uint32_t Clock::Quantum() const
     {
-        std::unique_lock<std::mutex> lock(_m);
-        _cv.wait(lock);
+        return _quantum;
     }
 }
@@ -2,17 +2,63 @@
 
 #include "core/iclock.h"
 
-#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#ifndef AVR_EMU_F_CPU
+#define AVR_EMU_F_CPU 16000000u   // 16 MHz
+#endif
 
 namespace avr {
+    // Paces the CPU against the host's steady clock. Every quantum the
+    // executor has run is matched to the host deadline for that many cycles
+    // at the clock frequency, and the executor sleeps until it. Deadlines
+    // are measured from a fixed origin rather than from the last wake-up,
+    // so oversleeping one quantum shortens the next instead of adding up.
     class Clock : public IClock
     {
+        public:
+            using Duration = std::chrono::nanoseconds;
+
+            constexpr static Duration DEFAULT_QUANTUM = std::chrono::milliseconds(1);
+
+            // A CPU further behind than this no longer tries to catch up and
+            // carries on from wherever real time is now
+            constexpr static Duration MAX_LAG = std::chrono::milliseconds(100);
+
         private:
-            std::mutex _m;
-            std::condition_variable _cv;
+            using HostClock = std::chrono::steady_clock;
+
+            uint32_t _frequency;
+            uint32_t _quantum;
+            std::atomic<bool> _rebase;
+            HostClock::time_point _origin;
+            uint64_t _originCycles;
+            std::atomic<int64_t> _lag;
+
+            Duration ToHostTime(uint64_t cycles) const;
+            void Rebase(HostClock::time_point now, uint64_t cycles);
 
         public:
+            Clock(uint32_t frequency = AVR_EMU_F_CPU, Duration quantum = DEFAULT_QUANTUM);
+
+            // Restarts pacing from the next synchronization, e.g. after
+            // the emulator has been paused
             void Pulse() override;
-            void ConsumeCycle() override;
+            void Synchronize(uint64_t cycles) override;
+            uint32_t Quantum() const override;
+
+            uint32_t Frequency() const
+            {
+                return _frequency;
+            }
+
+            // How far the CPU trailed real time at the last synchronization,
+            // negative while it was ahead
+            Duration Lag() const
+            {
+                return Duration(_lag.load(std::memory_order_relaxed));
+            }
     };
 }
@@ -0,0 +1,47 @@
+#include "core/contextarena.h"
+#include "core/executioncontext.h"
+#include "core/memory.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace avr {
+    ContextArena::ContextArena(std::size_t capacity, std::size_t memorySize)
+        : _capacity(capacity),
+          _memorySize(std::max(RoundUpToPowerOfTwo(memorySize), ALIGNMENT)),
+          _storage(std::make_shared<Storage>()),
+          _contexts()
+    {
+        auto space = _capacity * _memorySize + ALIGNMENT;
+        _storage->buffer = std::make_unique<uint8_t[]>(space);
+
+        void* slab = _storage->buffer.get();
+        _storage->slab = static_cast<uint8_t*>(std::align(ALIGNMENT, _capacity * _memorySize, slab, space));
+        _storage->memories.reserve(_capacity);
+        _contexts.reserve(_capacity);
+    }
+
+    ExecutionContext& ContextArena::Allocate()
+    {
+        using namespace std::string_literals;
+        if (_contexts.size() == _capacity)
+            throw "Context arena is full ("s + std::to_string(_capacity) + " contexts)"s;
+
+        auto& memories = _storage->memories;
+        memories.emplace_back(_storage->slab + memories.size() * _memorySize, _memorySize);
+        auto memory = std::shared_ptr<Memory>(_storage, &memories.back());
+
+        _contexts.push_back(ExecutionContext(memory, memory));
+        return _contexts.back();
+    }
+
+    ExecutionContext& ContextArena::Allocate(const ContextSnapshot& image)
+    {
+        auto& ctx = Allocate();
+        ctx.Restore(image);
+        ctx.SaveResetImage();
+        return ctx;
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "core/executioncontext.h"
+#include "core/memory.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace avr {
+    // Holds up to a fixed number of contexts for running many instances side
+    // by side. The contexts sit in one array and their memories, each flash
+    // and RAM in one, in one cache line aligned slab, so the register file at
+    // the start of every memory is aligned too.
+    //
+    // Each context takes its share of the slab, flash and RAM together
+    // rounded up to a power of two (32 K by default), and about 7 K in the
+    // array, most of it the Scheduler's 385 list heads and the IOBus's
+    // 256-byte table. Its Memory also allocates a page pointer per 256
+    // bytes and a dirty bitmap for snapshots, 2 K more by default. The
+    // decode and block caches and the event queue stay empty until used.
+    class ContextArena {
+        public:
+            constexpr static std::size_t ALIGNMENT = 64u;
+
+        private:
+            // Shared with every context through aliasing shared_ptrs, so it
+            // outlives the arena while any context moved out of it remains
+            struct Storage {
+                std::unique_ptr<uint8_t[]> buffer;
+                uint8_t* slab;
+                std::vector<Memory> memories;
+            };
+
+            std::size_t _capacity;
+            std::size_t _memorySize;
+            std::shared_ptr<Storage> _storage;
+            std::vector<ExecutionContext> _contexts;
+
+        public:
+            ContextArena(std::size_t capacity, std::size_t memorySize = AVR_EMU_FLASH_SIZE + AVR_EMU_RAM_SIZE);
+
+            // Throws once capacity contexts have been allocated
+            ExecutionContext& Allocate();
+
+            // Starts the new context from image, typically a snapshot of a
+            // context with the firmware loaded, which also becomes its reset
+            // image. Memory pages stay shared with image until written.
+            ExecutionContext& Allocate(const ContextSnapshot& image);
+
+            ExecutionContext& operator[](std::size_t index)
+            {
+                return _contexts[index];
+            }
+
+            const ExecutionContext& operator[](std::size_t index) const
+            {
+                return _contexts[index];
+            }
+
+            std::size_t size() const
+            {
+                return _contexts.size();
+            }
+
+            std::size_t capacity() const
+            {
+                return _capacity;
+            }
+
+            std::vector<ExecutionContext>::iterator begin()
+            {
+                return _contexts.begin();
+            }
+
+            std::vector<ExecutionContext>::iterator end()
+            {
+                return _contexts.end();
+            }
+    };
+}
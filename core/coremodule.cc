@@ -1,11 +1,16 @@
 #include "cdif/cdif.h"
+#include "core/blockexecutor.h"
 #include "core/clock.h"
 #include "core/coremodule.h"
 #include "core/cpu.h"
 #include "core/executor.h"
+#include "core/iexecutor.h"
+#include "core/jitexecutor.h"
+#include "core/lockstepexecutor.h"
 #include "core/iclock.h"
 #include "core/memory.h"
 #include "core/noopclock.h"
+#include "core/threadedexecutor.h"
 #include "instructions/instructionexecutor.h"
 
 #include <memory>
@@ -15,7 +20,11 @@ namespace avr
 {
     void CoreModule::load(cdif::Container& ctx)
     {
+#if defined(AVR_EMU_REALTIME_CLOCK)
+        ctx.bind<Clock>().as<IClock>().in<cdif::Scope::Singleton>().build();
+#else
         ctx.bind<NoopClock>().as<IClock>().in<cdif::Scope::Singleton>().build();
+#endif
         ctx.bind<ExecutionContext>().build();
 
         ctx
@@ -23,5 +32,63 @@ namespace avr
                 IClock&,
                 std::vector<std::unique_ptr<InstructionExecutor>>>()
             .build();
+
+        ctx
+            .bind<ThreadedExecutor,
+                IClock&,
+                std::vector<std::unique_ptr<InstructionExecutor>>>()
+            .build();
+
+        ctx
+            .bind<BlockExecutor,
+                IClock&,
+                std::vector<std::unique_ptr<InstructionExecutor>>>()
+            .build();
+
+        ctx
+            .bind<JitExecutor,
+                IClock&,
+                std::vector<std::unique_ptr<InstructionExecutor>>>()
+            .build();
+
+        ctx
+            .bind<LockstepExecutor,
+                IClock&,
+                std::vector<std::unique_ptr<InstructionExecutor>>>()
+            .build();
+
+#if defined(AVR_EMU_JIT_EXECUTOR)
+        ctx
+            .bind<JitExecutor,
+                IClock&,
+                std::vector<std::unique_ptr<InstructionExecutor>>>()
+            .as<IExecutor>()
+            .in<cdif::Scope::Singleton>()
+            .build();
+#elif defined(AVR_EMU_BLOCK_EXECUTOR)
+        ctx
+            .bind<BlockExecutor,
+                IClock&,
+                std::vector<std::unique_ptr<InstructionExecutor>>>()
+            .as<IExecutor>()
+            .in<cdif::Scope::Singleton>()
+            .build();
+#elif defined(AVR_EMU_THREADED_EXECUTOR)
+        ctx
+            .bind<ThreadedExecutor,
+                IClock&,
+                std::vector<std::unique_ptr<InstructionExecutor>>>()
+            .as<IExecutor>()
+            .in<cdif::Scope::Singleton>()
+            .build();
+#else
+        ctx
+            .bind<Executor,
+                IClock&,
+                std::vector<std::unique_ptr<InstructionExecutor>>>()
+            .as<IExecutor>()
+            .in<cdif::Scope::Singleton>()
+            .build();
+#endif
     }
 }
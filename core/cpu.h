@@ -8,13 +8,23 @@
 namespace avr {
     struct IndirectRegister {
     private:
-        uint8_t* const _base;
+        uint8_t* _base;
 
     public:
         IndirectRegister(uint8_t* base)
             : _base(base)
         {}
 
+        IndirectRegister(const IndirectRegister&) = default;
+
+        // Assigning writes the value, never the location
+        IndirectRegister& operator=(const IndirectRegister&) = delete;
+
+        void Rebind(uint8_t* base)
+        {
+            _base = base;
+        }
+
         uint16_t operator*() const
         {
             uint16_t out = 0u;
@@ -69,7 +79,9 @@ namespace avr {
         }
     };
 
-    struct CPU {
+    // Kept to a cache line of its own so that the state touched on every
+    // instruction shares no line with neighbouring contexts in an arena
+    struct alignas(64) CPU {
         constexpr static uint16_t R_END = 0x1Fu;
         constexpr static uint16_t GPIO_END = 0x5Fu;
         constexpr static uint16_t EGPIO_END = 0xFFu;
@@ -120,5 +132,57 @@ namespace avr {
         {
             SREG.C = SREG.Z = SREG.N = SREG.V = SREG.S = SREG.H = SREG.T = SREG.I = false;
         }
+
+        // The register file lives in memory, so a copy would alias another
+        // context's registers; there is no copy construction, and snapshots
+        // keep the state held here in a ContextSnapshot instead. Assigning
+        // copies only that state, and this CPU keeps viewing its own memory.
+        CPU(const CPU&) = delete;
+
+        CPU& operator=(const CPU& other)
+        {
+            PC = other.PC;
+            SP = other.SP;
+            SREG = other.SREG;
+            RAMPX = other.RAMPX;
+            RAMPY = other.RAMPY;
+            RAMPZ = other.RAMPZ;
+            RAMPD = other.RAMPD;
+            EIND = other.EIND;
+            is_sleeping = other.is_sleeping;
+            return *this;
+        }
+
+        // Points the register file and I/O views at mem, for when the
+        // memory they were built over has moved
+        void Bind(SRAM& mem)
+        {
+            R = std::addressof(mem[0x00]);
+            GPIO = std::addressof(mem[R_END + 1u]);
+            X.Rebind(std::addressof(R[26]));
+            Y.Rebind(std::addressof(R[28]));
+            Z.Rebind(std::addressof(R[30]));
+        }
     };
+
+    // SREG as the byte the hardware keeps at I/O address 0x3F, C in bit 0
+    // through I in bit 7
+    inline uint8_t PackSREG(const CPU& cpu)
+    {
+        return static_cast<uint8_t>(
+            cpu.SREG.C | (cpu.SREG.Z << 1u) | (cpu.SREG.N << 2u) | (cpu.SREG.V << 3u) |
+            (cpu.SREG.S << 4u) | (cpu.SREG.H << 5u) | (cpu.SREG.T << 6u) | (cpu.SREG.I << 7u));
+    }
+
+    inline void UnpackSREG(CPU& cpu, uint8_t sreg)
+    {
+        cpu.SREG.C = ((sreg >> 0u) & 0x1u) != 0u;
+        cpu.SREG.Z = ((sreg >> 1u) & 0x1u) != 0u;
+        cpu.SREG.N = ((sreg >> 2u) & 0x1u) != 0u;
+        cpu.SREG.V = ((sreg >> 3u) & 0x1u) != 0u;
+        cpu.SREG.S = ((sreg >> 4u) & 0x1u) != 0u;
+        cpu.SREG.H = ((sreg >> 5u) & 0x1u) != 0u;
+        cpu.SREG.T = ((sreg >> 6u) & 0x1u) != 0u;
+        cpu.SREG.I = ((sreg >> 7u) & 0x1u) != 0u;
+    }
 }
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "core/executioncontext.h"
+#include "core/iclock.h"
+#include "core/interrupts.h"
+#include "core/scheduler.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace avr {
+    // Adds the cycles an instruction took to the context's counter. The
+    // fast path is a single compare against ctx.syncAt, which is the earliest
+    // of the next scheduled event, the next clock sync and an interrupt
+    // coming off hold, so execution runs uninterrupted up to whichever comes
+    // first. The clock only hears about it once a quantum has built up,
+    // instead of once per cycle.
+    //
+    // Events posted from other threads are drained at the same point, which
+    // comes at least every EventQueue::DRAIN_CYCLES once the context has a
+    // queue, even under a clock whose quantum never runs out.
+    // Raising an interrupt or setting SREG.I requests a sync, so a pending
+    // interrupt is entered here, at the next instruction boundary, without
+    // the fast path testing for one. Returns cycles plus any spent entering
+    // an interrupt.
+    inline uint32_t RetireCycles(IClock& clock, ExecutionContext& ctx, uint32_t cycles)
+    {
+        ctx.cycles += cycles;
+        if (ctx.cycles < ctx.syncAt)
+            return cycles;
+
+        ctx.DrainEvents();
+        if (ctx.cycles >= ctx.scheduler.NextDue())
+            ctx.scheduler.RunDue(ctx);
+        if (IsInterruptDue(ctx))
+        {
+            auto entry = EnterInterrupt(ctx);
+            cycles += entry;
+            ctx.cycles += entry;
+            if (ctx.cycles >= ctx.scheduler.NextDue())
+                ctx.scheduler.RunDue(ctx);
+        }
+
+        if (ctx.cycles >= ctx.clockAt)
+        {
+            clock.Synchronize(ctx.cycles);
+            ctx.clockAt = ctx.cycles + clock.Quantum();
+        }
+        ctx.syncAt = std::min({ ctx.clockAt, ctx.scheduler.NextDue(), ctx.NextDrain() });
+        // Held back by SEI or RETI, so look again once the hold is over
+        if (ctx.pendingInterrupts != 0u && ctx.cpu.SREG.I)
+            ctx.syncAt = std::min(ctx.syncAt, ctx.interruptsHeldUntil);
+        return cycles;
+    }
+
+    // Cycles which can run before RetireCycles next leaves its fast path, up
+    // to cyclesLeft. Code run as one unit, such as a compiled block, must fit
+    // in them for events to land between the right instructions.
+    inline uint32_t CyclesBeforeSync(const ExecutionContext& ctx, uint32_t cyclesLeft)
+    {
+        if (ctx.syncAt <= ctx.cycles)
+            return 0u;
+        return static_cast<uint32_t>(std::min<uint64_t>(cyclesLeft, ctx.syncAt - ctx.cycles));
+    }
+
+    // Takes in what arrived while the core was not running: events posted
+    // from other threads or scheduled directly and interrupts raised, which
+    // no instruction has retired since to see. Executors call it on entry.
+    // Returns the cycles spent entering an interrupt.
+    inline uint32_t CatchUp(IClock& clock, ExecutionContext& ctx)
+    {
+        ctx.DrainEvents();
+        // Anything scheduled from outside since, or a queue created since,
+        // has to cut the fast path short too
+        ctx.syncAt = std::min({ ctx.syncAt, ctx.scheduler.NextDue(), ctx.NextDrain() });
+        if (!IsInterruptDue(ctx))
+            return 0u;
+
+        ctx.RequestSync();
+        return RetireCycles(clock, ctx, 0u);
+    }
+
+    // Lets time pass while the core sleeps, jumping straight from one
+    // scheduled event to the next until one of them wakes the core by
+    // clearing CPU::is_sleeping, an interrupt is entered or cyclesLeft run
+    // out. Returns the cycles slept, including entering the interrupt.
+    inline uint32_t SleepUntilWoken(IClock& clock, ExecutionContext& ctx, uint32_t cyclesLeft)
+    {
+        auto slept = 0u;
+        while (ctx.cpu.is_sleeping && slept < cyclesLeft)
+        {
+            if (IsInterruptDue(ctx))
+            {
+                slept += CatchUp(clock, ctx);
+                continue;
+            }
+
+            auto cycles = static_cast<uint64_t>(cyclesLeft - slept);
+            auto due = ctx.scheduler.NextDue();
+            if (due != Scheduler::NEVER)
+                cycles = due > ctx.cycles ? std::min(cycles, due - ctx.cycles) : 0u;
+            // A quantum, or EventQueue::DRAIN_CYCLES, at a time, so events
+            // posted meanwhile from other threads are seen as promptly as
+            // while running
+            if (ctx.syncAt > ctx.cycles)
+                cycles = std::min(cycles, ctx.syncAt - ctx.cycles);
+
+            slept += RetireCycles(clock, ctx, static_cast<uint32_t>(cycles));
+        }
+        return slept;
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "core/memory.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace avr {
+    class InstructionExecutor;
+
+    // Operations an execution engine may implement inline; anything left as
+    // Generic is run through its InstructionExecutor
+    enum class Operation : uint8_t {
+        Generic = 0,
+        ADC,
+        ADD,
+        AND,
+        ANDI,
+        BRBC,
+        CALL,
+        CP,
+        CPC,
+        CPI,
+        CPSE,
+        DEC,
+        EOR,
+        INC,
+        JMP,
+        LDI,
+        LDS,
+        MOV,
+        OR,
+        ORI,
+        RJMP,
+        SBIC,
+        SBIS,
+        STS,
+        SUB,
+        SUBI,
+        Count
+    };
+
+    struct DecodedInstruction {
+        const InstructionExecutor* executor; // nullptr marks an empty cache slot
+        const void* handler;                 // engine specific dispatch target
+        Operation op;
+        uint16_t opcode;
+        uint16_t operand;   // word following the opcode (second word of two-word instructions)
+        uint16_t k;         // immediate, address or offset extracted by the executor
+        uint8_t rd;
+        uint8_t rr;
+        uint8_t size;       // length in words
+        uint8_t skip;       // words a skip instruction jumps over
+        uint8_t cycles;     // static cycle cost, 0 if the executor does not predecode
+        bool idleLoop;      // backward branch closing a loop FastForward can skip
+    };
+
+    class DecodeCache {
+        private:
+            std::size_t _size;
+            std::size_t _mask;
+            std::vector<DecodedInstruction> _entries;
+
+            std::size_t GetIndex(uint16_t address) const
+            {
+                return (address & _mask) >> 1u;
+            }
+
+        public:
+            DecodeCache(std::size_t size)
+                : _size(RoundUpToPowerOfTwo(size)),
+                  _mask(_size - 1u),
+                  _entries()
+            {}
+
+            static bool IsCacheable(uint16_t address)
+            {
+                return (address & 0x1u) == 0u;
+            }
+
+            // Slots are allocated on first use so contexts which never execute
+            // (e.g. single instruction tests) pay nothing for the cache
+            DecodedInstruction& operator[](uint16_t address)
+            {
+                if (_entries.empty())
+                    _entries.resize((_size + 1u) >> 1u, DecodedInstruction());
+                return _entries[GetIndex(address)];
+            }
+
+            // A write to the byte at address changes the instruction starting at
+            // that word and the operand/skip target of the word before it
+            void Invalidate(uint16_t address)
+            {
+                if (_entries.empty())
+                    return;
+
+                auto index = GetIndex(address);
+                auto previous = (index == 0u) ? _entries.size() - 1u : index - 1u;
+                _entries[index].executor = nullptr;
+                _entries[previous].executor = nullptr;
+            }
+
+            void Invalidate(uint16_t address, std::size_t length)
+            {
+                if (_entries.empty())
+                    return;
+
+                for (auto offset = std::size_t(0u); offset < length; offset += 2u)
+                    Invalidate(static_cast<uint16_t>(address + offset));
+            }
+
+            void Clear()
+            {
+                _entries.clear();
+            }
+    };
+}
@@ -0,0 +1,67 @@
+#include "core/decodecache.h"
+#include "core/dispatchtable.h"
+#include "core/idleloop.h"
+#include "core/memory.h"
+#include "instructions/instructionexecutor.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace avr {
+    DispatchTable::DispatchTable(std::vector<std::unique_ptr<InstructionExecutor>>&& executors)
+        : _executors(std::move(executors)),
+          _table(std::make_unique<Table>())
+    {
+        Build();
+    }
+
+    void DispatchTable::Build()
+    {
+        for (auto i = 0u; i < OPCODE_COUNT; i++)
+        {
+            auto opcode = static_cast<uint16_t>(i);
+            auto it = std::find_if(
+                std::begin(_executors),
+                std::end(_executors),
+                [opcode] (const auto& executor) { return executor->Matches(opcode); });
+            (*_table)[i] = (it == std::end(_executors)) ? nullptr : it->get();
+        }
+    }
+
+    uint16_t DispatchTable::ReadWord(const ProgramMemory& memory, const uint16_t address) const
+    {
+        uint16_t value = 0u;
+        value = memory[address];
+        value |= static_cast<uint16_t>((memory[address+1] << 8) & 0xFF00u);
+        return value;
+    }
+
+    const InstructionExecutor& DispatchTable::GetExecutor(const uint16_t opcode) const
+    {
+        using namespace std::string_literals;
+        auto executor = (*_table)[opcode];
+        if (executor == nullptr)
+            throw "No executor for opcode ("s + std::to_string(opcode) + ")"s;
+        return *executor;
+    }
+
+    bool DispatchTable::CanDecode(const ProgramMemory& progMem, const uint16_t address) const
+    {
+        return (*_table)[ReadWord(progMem, address)] != nullptr;
+    }
+
+    DecodedInstruction DispatchTable::Decode(const ProgramMemory& progMem, const uint16_t address) const
+    {
+        auto insn = DecodedInstruction();
+        insn.opcode = ReadWord(progMem, address);
+        insn.operand = ReadWord(progMem, static_cast<uint16_t>(address + sizeof(insn.opcode)));
+        insn.size = 1u;
+        insn.executor = &GetExecutor(insn.opcode);
+        insn.executor->Decode(insn);
+        insn.idleLoop = IdleLoop::Find(progMem, address, insn).kind != IdleLoop::Kind::None;
+        return insn;
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "core/decodecache.h"
+#include "core/memory.h"
+#include "instructions/instructionexecutor.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace avr {
+    class DispatchTable {
+        public:
+            constexpr static std::size_t OPCODE_COUNT = 0x10000u;
+
+        private:
+            using Table = std::array<const InstructionExecutor*, OPCODE_COUNT>;
+
+            std::vector<std::unique_ptr<InstructionExecutor>> _executors;
+            std::unique_ptr<Table> _table;
+
+            void Build();
+            uint16_t ReadWord(const ProgramMemory& progMem, const uint16_t address) const;
+
+        public:
+            DispatchTable(std::vector<std::unique_ptr<InstructionExecutor>>&& executors);
+
+            const InstructionExecutor* operator[](uint16_t opcode) const
+            {
+                return (*_table)[opcode];
+            }
+
+            const InstructionExecutor& GetExecutor(const uint16_t opcode) const;
+            bool CanDecode(const ProgramMemory& progMem, const uint16_t address) const;
+            DecodedInstruction Decode(const ProgramMemory& progMem, const uint16_t address) const;
+    };
+}
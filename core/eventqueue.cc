@@ -0,0 +1,96 @@
+#include "core/eventqueue.h"
+#include "core/executioncontext.h"
+#include "core/memory.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace avr {
+    namespace {
+        void Apply(ExecutionContext& ctx, const ExternalEvent& event)
+        {
+            switch (event.kind)
+            {
+                case ExternalEvent::Kind::Interrupt:
+                    ctx.RaiseInterrupt(event.value);
+                    break;
+                case ExternalEvent::Kind::Pins:
+                {
+                    // Pins are inputs, so the register changes without the
+                    // write a peripheral mapped there would act on
+                    auto& reg = ctx.ram[event.address];
+                    reg = static_cast<uint8_t>((reg & ~event.mask) | (event.value & event.mask));
+                    break;
+                }
+            }
+        }
+    }
+
+    EventQueue::EventQueue(std::size_t capacity)
+        : _slots(std::make_unique<Slot[]>(RoundUpToPowerOfTwo(capacity))),
+          _mask(RoundUpToPowerOfTwo(capacity) - 1u),
+          _enqueue(0u),
+          _dequeue(0u),
+          _now(0u)
+    {
+        for (auto i = uint64_t(0u); i <= _mask; i++)
+            _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    bool EventQueue::Post(const ExternalEvent& event)
+    {
+        // Caught here, RaiseInterrupt would only throw later on the thread
+        // running the context
+        using namespace std::string_literals;
+        if (event.kind == ExternalEvent::Kind::Interrupt && event.value >= 64u)
+            throw "Interrupt out of range: "s + std::to_string(event.value);
+
+        auto position = _enqueue.load(std::memory_order_relaxed);
+        while (true)
+        {
+            auto& slot = _slots[position & _mask];
+            auto sequence = slot.sequence.load(std::memory_order_acquire);
+            auto turn = static_cast<int64_t>(sequence - position);
+            if (turn < 0)
+                return false;
+
+            if (turn > 0)
+                position = _enqueue.load(std::memory_order_relaxed);
+            else if (_enqueue.compare_exchange_weak(position, position + 1u, std::memory_order_relaxed))
+            {
+                slot.event = event;
+                slot.sequence.store(position + 1u, std::memory_order_release);
+                return true;
+            }
+        }
+    }
+
+    bool EventQueue::Take(ExternalEvent& event)
+    {
+        auto& slot = _slots[_dequeue & _mask];
+        if (slot.sequence.load(std::memory_order_acquire) != _dequeue + 1u)
+            return false;
+
+        event = slot.event;
+        slot.sequence.store(_dequeue + _mask + 1u, std::memory_order_release);
+        _dequeue++;
+        return true;
+    }
+
+    void EventQueue::Drain(ExecutionContext& ctx)
+    {
+        _now.store(ctx.cycles, std::memory_order_relaxed);
+
+        auto event = ExternalEvent();
+        while (Take(event))
+        {
+            if (event.cycle <= ctx.cycles)
+                Apply(ctx, event);
+            else
+                ctx.scheduler.Schedule(event.cycle, [event] (ExecutionContext& context) { Apply(context, event); });
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace avr {
+    struct ExecutionContext;
+
+    // Something another thread wants to happen to a running context
+    struct ExternalEvent {
+        enum class Kind : uint8_t {
+            Interrupt,  // raise interrupt value
+            Pins        // set the bits in mask of the register at address to value
+        };
+
+        uint64_t cycle;     // ExecutionContext::cycles it takes effect at; earlier means on arrival
+        Kind kind;
+        uint8_t value;
+        uint8_t mask;
+        uint16_t address;   // data space address, for Pins
+
+        static ExternalEvent Interrupt(uint64_t cycle, uint8_t interrupt)
+        {
+            return ExternalEvent{cycle, Kind::Interrupt, interrupt, 0u, 0u};
+        }
+
+        static ExternalEvent Pins(uint64_t cycle, uint16_t address, uint8_t mask, uint8_t value)
+        {
+            return ExternalEvent{cycle, Kind::Pins, value, mask, address};
+        }
+    };
+
+    // Carries events from any number of producer threads to the thread
+    // running one context. A fixed ring of slots, each with a sequence
+    // number saying whose turn it is, so producers only race each other on a
+    // compare-and-swap and never wait on the consumer or take a lock. A full
+    // queue turns posts away rather than blocking.
+    //
+    // The context drains it whenever its executor leaves the fast path,
+    // which it does at least every DRAIN_CYCLES once the queue exists
+    // however long the clock's quantum, and whenever an executor starts,
+    // scheduling each event for the cycle it is stamped with. Only the slow
+    // path reads the queue, so the instruction fast path is untouched.
+    class EventQueue {
+        public:
+            constexpr static std::size_t DEFAULT_CAPACITY = 0x400u;
+            constexpr static uint64_t DRAIN_CYCLES = 0x10000u;
+
+        private:
+            struct Slot {
+                std::atomic<uint64_t> sequence;
+                ExternalEvent event;
+            };
+
+            std::unique_ptr<Slot[]> _slots;
+            uint64_t _mask;
+            alignas(64) std::atomic<uint64_t> _enqueue;
+            alignas(64) uint64_t _dequeue;      // consumer only
+            alignas(64) std::atomic<uint64_t> _now;
+
+        public:
+            // capacity is rounded up to a power of two
+            explicit EventQueue(std::size_t capacity = DEFAULT_CAPACITY);
+
+            EventQueue(const EventQueue&) = delete;
+            EventQueue& operator=(const EventQueue&) = delete;
+
+            // Safe from any thread. Returns false when the queue is full and
+            // throws, on the posting thread, for an interrupt out of range.
+            bool Post(const ExternalEvent& event);
+
+            // The context's cycle count when it last drained the queue, for
+            // producers stamping events relative to simulated time
+            uint64_t Now() const
+            {
+                return _now.load(std::memory_order_relaxed);
+            }
+
+            // Consumer only. Returns false when nothing is waiting.
+            bool Take(ExternalEvent& event);
+
+            // Consumer only. Applies every event which has arrived and is
+            // due, and schedules the rest on ctx.scheduler.
+            void Drain(ExecutionContext& ctx);
+    };
+}
@@ -1,26 +1,86 @@
 #pragma once
 
+#include "core/blockcache.h"
 #include "core/cpu.h"
+#include "core/decodecache.h"
+#include "core/eventqueue.h"
+#include "core/iobus.h"
 #include "core/memory.h"
+#include "core/scheduler.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
 
 namespace avr {
+    // Everything ExecutionContext::Restore needs to put a context back the
+    // way it was. Memory pages are shared with the context and any other
+    // snapshot until one of them writes to the page.
+    struct ContextSnapshot {
+        Memory::Snapshot ram;
+        Memory::Snapshot progMem;   // empty when flash and RAM are one Memory
+        uint16_t pc;
+        uint16_t sp;
+        decltype(CPU::SREG) sreg;
+        uint8_t rampx;
+        uint8_t rampy;
+        uint8_t rampz;
+        uint8_t rampd;
+        uint8_t eind;
+        bool sleeping;
+        uint64_t pendingInterrupts;
+        Scheduler scheduler;
+        uint64_t cycles;
+    };
+
     struct ExecutionContext {
         private:
             std::shared_ptr<Memory> _ram;
             std::shared_ptr<Memory> _progMem;
+            ContextSnapshot _resetImage;    // no pages until SaveResetImage
+            std::shared_ptr<EventQueue> _events;    // null until Events is called
+
+            void RequireNoPeripherals() const
+            {
+                if (!io.Empty())
+                    throw std::string("Snapshots do not cover peripherals; unmap them from the I/O bus first");
+            }
 
         public:
-            Memory& ram;
-            Memory& progMem;
+            MemoryView ram;
+            MemoryView progMem;
             CPU cpu;
+            DecodeCache decodeCache;
+            BlockCache blockCache;
+            Scheduler scheduler;
+            IOBus io;
+            uint64_t pendingInterrupts; // bit n set while interrupt n waits for SREG.I
+            uint64_t interruptsHeldUntil;   // cycles before which none are entered
+            uint64_t cycles;    // run on this context since it was created
+            uint64_t syncAt;    // cycles at which executors next leave their fast path
+            uint64_t clockAt;   // cycles at which executors next call IClock::Synchronize
 
         ExecutionContext()
             : 
             _ram(std::make_shared<Memory>(AVR_EMU_RAM_SIZE)),
             _progMem(std::make_shared<Memory>(AVR_EMU_FLASH_SIZE)),
+            _resetImage(),
+            _events(),
             ram(*_ram),
             progMem(*_progMem),
-            cpu(ram)
+            cpu(*_ram),
+            decodeCache(progMem.size()),
+            blockCache(progMem.size()),
+            scheduler(),
+            io(),
+            pendingInterrupts(0u),
+            interruptsHeldUntil(0u),
+            cycles(0u),
+            syncAt(0u),
+            clockAt(0u)
         {}
 
         ExecutionContext(
@@ -29,9 +89,250 @@ namespace avr {
         ) :
             _ram(ram_memory),
             _progMem(prog_memory),
+            _resetImage(),
+            _events(),
             ram(*_ram),
             progMem(*_progMem),
-            cpu(ram)
+            cpu(*_ram),
+            decodeCache(progMem.size()),
+            blockCache(progMem.size()),
+            scheduler(),
+            io(),
+            pendingInterrupts(0u),
+            interruptsHeldUntil(0u),
+            cycles(0u),
+            syncAt(0u),
+            clockAt(0u)
         {}
+
+        // Copies would share memory with the original; fork a context with
+        // Snapshot and Restore instead
+        ExecutionContext(const ExecutionContext&) = delete;
+        ExecutionContext& operator=(const ExecutionContext&) = delete;
+
+        // Every view is rebound to the memory moved in, so contexts can be
+        // kept by value in containers and reassigned. The moved-from
+        // context may only be assigned to or destroyed.
+        ExecutionContext(ExecutionContext&& other) noexcept
+            : _ram(std::move(other._ram)),
+              _progMem(std::move(other._progMem)),
+              _resetImage(std::move(other._resetImage)),
+              _events(std::move(other._events)),
+              ram(*_ram),
+              progMem(*_progMem),
+              cpu(*_ram),
+              decodeCache(std::move(other.decodeCache)),
+              blockCache(std::move(other.blockCache)),
+              scheduler(std::move(other.scheduler)),
+              io(std::move(other.io)),
+              pendingInterrupts(other.pendingInterrupts),
+              interruptsHeldUntil(other.interruptsHeldUntil),
+              cycles(other.cycles),
+              syncAt(other.syncAt),
+              clockAt(other.clockAt)
+        {
+            cpu = other.cpu;
+        }
+
+        ExecutionContext& operator=(ExecutionContext&& other) noexcept
+        {
+            _ram = std::move(other._ram);
+            _progMem = std::move(other._progMem);
+            _resetImage = std::move(other._resetImage);
+            _events = std::move(other._events);
+            ram.Bind(*_ram);
+            progMem.Bind(*_progMem);
+            cpu.Bind(*_ram);
+            cpu = other.cpu;
+            decodeCache = std::move(other.decodeCache);
+            blockCache = std::move(other.blockCache);
+            scheduler = std::move(other.scheduler);
+            io = std::move(other.io);
+            pendingInterrupts = other.pendingInterrupts;
+            interruptsHeldUntil = other.interruptsHeldUntil;
+            cycles = other.cycles;
+            syncAt = other.syncAt;
+            clockAt = other.clockAt;
+            return *this;
+        }
+
+        // Data space accesses which peripherals mapped on the I/O bus may
+        // need to see. Everything else goes straight to RAM.
+        uint8_t Load(uint16_t address)
+        {
+            if (io.IsMapped(address))
+                return io.Read(*this, address);
+            return std::as_const(ram)[address];
+        }
+
+        void Store(uint16_t address, uint8_t value)
+        {
+            if (io.IsMapped(address))
+                io.Write(*this, address, value);
+            else
+                ram[address] = value;
+        }
+
+        // Sets or clears one bit of address, for SBI and CBI
+        void StoreBit(uint16_t address, uint8_t bit, bool set)
+        {
+            if (io.IsMapped(address))
+            {
+                io.WriteBit(*this, address, bit, set);
+                return;
+            }
+
+            auto mask = static_cast<uint8_t>(0x1u << bit);
+            auto value = std::as_const(ram)[address];
+            ram[address] = set ? static_cast<uint8_t>(value | mask) : static_cast<uint8_t>(value & ~mask);
+        }
+
+        // Costs a pointer copy per page plus a copy of each page written
+        // since the last snapshot or restore. Peripheral state is not
+        // captured, so this throws while any are mapped on io.
+        ContextSnapshot Snapshot()
+        {
+            RequireNoPeripherals();
+
+            // CPU::R and CPU::GPIO write the first page behind Memory's back
+            _ram->MarkDirty(0x0u);
+
+            auto snapshot = ContextSnapshot();
+            snapshot.ram = _ram->TakeSnapshot();
+            if (_progMem != _ram)
+                snapshot.progMem = _progMem->TakeSnapshot();
+            snapshot.pc = cpu.PC;
+            snapshot.sp = cpu.SP;
+            snapshot.sreg = cpu.SREG;
+            snapshot.rampx = cpu.RAMPX;
+            snapshot.rampy = cpu.RAMPY;
+            snapshot.rampz = cpu.RAMPZ;
+            snapshot.rampd = cpu.RAMPD;
+            snapshot.eind = cpu.EIND;
+            snapshot.sleeping = cpu.is_sleeping;
+            snapshot.pendingInterrupts = pendingInterrupts;
+            snapshot.scheduler = scheduler;
+            snapshot.cycles = cycles;
+            return snapshot;
+        }
+
+        // Copies back only the pages which differ from snapshot, so it can
+        // also restore a snapshot taken of another context with the same
+        // memory layout. Predecoded code in restored pages is dropped. A
+        // real-time clock should be pulsed afterwards as cycles may go
+        // backwards. Throws while peripherals are mapped on io, as they
+        // would keep their state and events from after the snapshot.
+        void Restore(const ContextSnapshot& snapshot)
+        {
+            RequireNoPeripherals();
+            _ram->MarkDirty(0x0u);
+
+            auto invalidate = [this] (uint16_t address, std::size_t length) {
+                decodeCache.Invalidate(address, length);
+                blockCache.Invalidate(address, length);
+            };
+            if (_progMem != _ram)
+            {
+                _ram->Restore(snapshot.ram, [] (uint16_t, std::size_t) {});
+                _progMem->Restore(snapshot.progMem, invalidate);
+            }
+            else
+                _ram->Restore(snapshot.ram, invalidate);
+
+            cpu.PC = snapshot.pc;
+            cpu.SP = snapshot.sp;
+            cpu.SREG = snapshot.sreg;
+            cpu.RAMPX = snapshot.rampx;
+            cpu.RAMPY = snapshot.rampy;
+            cpu.RAMPZ = snapshot.rampz;
+            cpu.RAMPD = snapshot.rampd;
+            cpu.EIND = snapshot.eind;
+            cpu.is_sleeping = snapshot.sleeping;
+            pendingInterrupts = snapshot.pendingInterrupts;
+            interruptsHeldUntil = 0u;
+            scheduler = snapshot.scheduler;
+            cycles = snapshot.cycles;
+            RequestSync();
+        }
+
+        // Makes the current state the one Reset returns to, e.g. a freshly
+        // loaded program
+        void SaveResetImage()
+        {
+            _resetImage = Snapshot();
+        }
+
+        // Returns to the reset image without allocating, copying back only
+        // the pages written since the image was saved or last reset to.
+        // Like Restore, throws while peripherals are mapped on io.
+        void Reset()
+        {
+            if (_resetImage.ram.empty())
+                throw std::string("No reset image has been saved");
+            Restore(_resetImage);
+        }
+
+        // Has the executor synchronize the clock as soon as the current
+        // instruction retires, for I/O which must line up with host time.
+        // Pending interrupts are looked at then too.
+        void RequestSync()
+        {
+            syncAt = cycles;
+            clockAt = cycles;
+        }
+
+        // Keeps pending interrupts waiting until after cycles more have run,
+        // as SEI and RETI let the instruction following them run first
+        void HoldInterrupts(uint64_t after)
+        {
+            interruptsHeldUntil = cycles + after;
+            syncAt = std::min(syncAt, interruptsHeldUntil);
+        }
+
+        // Marks interrupt (0 - 63) pending. It is entered at the next
+        // instruction boundary at which SREG.I is set, waking the core if it
+        // sleeps, and stays pending until then.
+        void RaiseInterrupt(uint8_t interrupt)
+        {
+            using namespace std::string_literals;
+            if (interrupt >= 64u)
+                throw "Interrupt out of range: "s + std::to_string(interrupt);
+
+            pendingInterrupts |= uint64_t(1u) << interrupt;
+            RequestSync();
+        }
+
+        void ClearInterrupt(uint8_t interrupt)
+        {
+            if (interrupt < 64u)
+                pendingInterrupts &= ~(uint64_t(1u) << interrupt);
+        }
+
+        // The queue other threads post events to this context through,
+        // created on first use. Call it on the thread running the context
+        // and hand the pointer to the producers; it stays valid if the
+        // context moves.
+        const std::shared_ptr<EventQueue>& Events()
+        {
+            if (_events == nullptr)
+                _events = std::make_shared<EventQueue>();
+            return _events;
+        }
+
+        void DrainEvents()
+        {
+            if (_events != nullptr)
+                _events->Drain(*this);
+        }
+
+        // Cycle by which the event queue has to be drained again, so events
+        // posted from other threads are seen however rarely anything else
+        // leaves the fast path. NEVER without a queue.
+        uint64_t NextDrain() const
+        {
+            if (_events == nullptr)
+                return Scheduler::NEVER;
+            return _events->Now() + EventQueue::DRAIN_CYCLES;
+        }
     };
 }
@@ -1,56 +1,56 @@
 #include "core/cpu.h"
+#include "core/cycles.h"
+#include "core/decodecache.h"
+#include "core/dispatchtable.h"
 #include "core/executor.h"
+#include "core/idleloop.h"
 #include "core/memory.h"
 #include "instructions/instructionexecutor.h"
 
-#include <algorithm>
 #include <cstdint>
 #include <memory>
-#include <string>
 #include <vector>
 
 namespace avr {
-    uint16_t Executor::FetchWord(const ProgramMemory& memory, const uint16_t address) const
+    DecodedInstruction Executor::FetchInstruction(ExecutionContext& ctx) const
     {
-        uint16_t value = 0u;
-        value = memory[address];
-        value |= static_cast<uint16_t>((memory[address+1] << 8) & 0xFF00u);
-        _clock.ConsumeCycle();
-        return value;
-    }
+        auto address = ctx.cpu.PC;
+        if (!DecodeCache::IsCacheable(address))
+            return _dispatchTable->Decode(ctx.progMem, address);
 
-    const std::unique_ptr<InstructionExecutor>& Executor::GetExecutor(const uint16_t opcode) const
-    {
-        auto it = std::find_if(
-            std::begin(_executors),
-            std::end(_executors),
-            [opcode] (const auto& executor) { return executor->Matches(opcode); });
-        return *it;
+        auto& slot = ctx.decodeCache[address];
+        if (slot.executor == nullptr)
+            slot = _dispatchTable->Decode(ctx.progMem, address);
+        return slot;
     }
 
     void Executor::Execute(ExecutionContext& ctx, uint32_t cyclesRequested) const {
-        using namespace std::string_literals;
-        auto cyclesConsumed = 0u;
+        auto cyclesConsumed = CatchUp(_clock, ctx);
 
-        while (cyclesConsumed < cyclesRequested && !ctx.cpu.is_sleeping)
+        while (cyclesConsumed < cyclesRequested)
         {
-            auto opcode = FetchWord(ctx.progMem, ctx.cpu.PC);
+            if (ctx.cpu.is_sleeping)
+            {
+                cyclesConsumed += SleepUntilWoken(_clock, ctx, cyclesRequested - cyclesConsumed);
+                continue;
+            }
+
+            auto address = ctx.cpu.PC;
+            auto insn = FetchInstruction(ctx);
             ctx.cpu.PC += sizeof(ctx.cpu.PC);
-            const auto& instruction_executor = GetExecutor(opcode);
-            cyclesConsumed += instruction_executor->Execute(opcode, ctx);
+            auto cycles = insn.executor->ExecuteDecoded(insn, ctx);
+            cyclesConsumed += RetireCycles(_clock, ctx, cycles);
+
+            if (insn.idleLoop && cyclesConsumed < cyclesRequested)
+            {
+                auto skipped = FastForward(ctx, address, insn, cyclesRequested - cyclesConsumed);
+                cyclesConsumed += RetireCycles(_clock, ctx, skipped);
+            }
         }
     }
 
     void Executor::Interrupt(ExecutionContext& ctx, uint8_t interrupt) const
     {
-        ctx.cpu.R[24] = interrupt;
-        auto old_pc = ctx.cpu.PC;
-        // push PC
-        ctx.ram[ctx.cpu.SP--] = (ctx.cpu.PC & 0xff);
-        ctx.ram[ctx.cpu.SP--] = ((ctx.cpu.PC >> 8) & 0xff);
-        ctx.cpu.PC = 0x912;
-
-        while (ctx.cpu.PC != old_pc)
-            Execute(ctx, 1);
+        ctx.RaiseInterrupt(interrupt);
     }
 }
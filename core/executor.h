@@ -1,7 +1,10 @@
 #pragma once
 
 #include "core/cpu.h"
+#include "core/decodecache.h"
+#include "core/dispatchtable.h"
 #include "core/iclock.h"
+#include "core/iexecutor.h"
 #include "core/memory.h"
 #include "instructions/instructionexecutor.h"
 
@@ -10,23 +13,34 @@
 #include <vector>
 
 namespace avr {
-    class Executor {
+    class Executor : public IExecutor {
         private:
             IClock& _clock;
-            std::vector<std::unique_ptr<InstructionExecutor>> _executors;
+            std::shared_ptr<const DispatchTable> _dispatchTable;
 
-            uint16_t FetchWord(const ProgramMemory& progMem, const uint16_t address) const;
-            const std::unique_ptr<InstructionExecutor>& GetExecutor(const uint16_t opcode) const;
+            DecodedInstruction FetchInstruction(ExecutionContext& ctx) const;
 
         public:
             Executor(
                 IClock& clock,
                 std::vector<std::unique_ptr<InstructionExecutor>>&& executors)
                 : _clock(clock),
-                  _executors(std::move(executors))
+                  _dispatchTable(std::make_shared<const DispatchTable>(std::move(executors)))
             {}
 
-            void Execute(ExecutionContext& ctx, uint32_t cyclesRequested) const;
-            void Interrupt(ExecutionContext& ctx, uint8_t interrupt) const;
+            Executor(
+                IClock& clock,
+                const std::shared_ptr<const DispatchTable>& dispatchTable)
+                : _clock(clock),
+                  _dispatchTable(dispatchTable)
+            {}
+
+            const std::shared_ptr<const DispatchTable>& GetDispatchTable() const
+            {
+                return _dispatchTable;
+            }
+
+            void Execute(ExecutionContext& ctx, uint32_t cyclesRequested) const override;
+            void Interrupt(ExecutionContext& ctx, uint8_t interrupt) const override;
     };
 }
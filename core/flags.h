@@ -0,0 +1,101 @@
+#pragma once
+
+#include "core/cpu.h"
+
+#include <cstdint>
+
+namespace avr {
+    // SREG bits as PackSREG lays them out
+    constexpr uint8_t SREG_C = 0x01u;
+    constexpr uint8_t SREG_Z = 0x02u;
+    constexpr uint8_t SREG_N = 0x04u;
+    constexpr uint8_t SREG_V = 0x08u;
+    constexpr uint8_t SREG_S = 0x10u;
+    constexpr uint8_t SREG_H = 0x20u;
+    constexpr uint8_t SREG_T = 0x40u;
+    constexpr uint8_t SREG_I = 0x80u;
+
+    // The flags add, subtract and compare set, and those logic operations
+    // and INC and DEC set
+    constexpr uint8_t ARITHMETIC_FLAGS = SREG_C | SREG_Z | SREG_N | SREG_V | SREG_S | SREG_H;
+    constexpr uint8_t LOGIC_FLAGS = SREG_Z | SREG_N | SREG_V | SREG_S;
+
+    // How the register ALU instructions set SREG, shared by every engine so
+    // they cannot drift apart. The JIT takes the flags from the host's ALU
+    // instead, keeping only the bits above, and its differential mode checks
+    // it against these.
+    //
+    // Add and subtract flags come from the carry or borrow out of each bit
+    // and the signed overflow into each bit, of which H wants bit 3 and C
+    // and V bit 7. A carry into the operation is already in result.
+
+    inline uint8_t AddCarries(uint8_t rd, uint8_t rr, uint8_t result)
+    {
+        return static_cast<uint8_t>((rd & rr) | ((rd | rr) & ~result));
+    }
+
+    inline uint8_t AddOverflow(uint8_t rd, uint8_t rr, uint8_t result)
+    {
+        return static_cast<uint8_t>(~(rd ^ rr) & (rd ^ result));
+    }
+
+    inline uint8_t SubtractBorrows(uint8_t rd, uint8_t rr, uint8_t result)
+    {
+        return static_cast<uint8_t>((~rd & rr) | (~(rd ^ rr) & result));
+    }
+
+    inline uint8_t SubtractOverflow(uint8_t rd, uint8_t rr, uint8_t result)
+    {
+        return static_cast<uint8_t>((rd ^ rr) & (rd ^ result));
+    }
+
+    // On SREG packed into a byte, for loops over many lanes at once
+    inline uint8_t ArithmeticFlags(uint8_t sreg, uint8_t result, uint8_t carries, uint8_t overflow)
+    {
+        uint8_t n = result >> 7u;
+        uint8_t v = overflow >> 7u;
+        uint8_t z = result == 0u;
+        return static_cast<uint8_t>(
+            (sreg & ~ARITHMETIC_FLAGS) | (carries >> 7u) | (z << 1u) | (n << 2u) |
+            (v << 3u) | ((n ^ v) << 4u) | (((carries >> 3u) & 0x1u) << 5u));
+    }
+
+    inline uint8_t LogicFlags(uint8_t sreg, uint8_t result, uint8_t v)
+    {
+        uint8_t n = result >> 7u;
+        uint8_t z = result == 0u;
+        return static_cast<uint8_t>(
+            (sreg & ~LOGIC_FLAGS) | (z << 1u) | (n << 2u) | (v << 3u) | ((n ^ v) << 4u));
+    }
+
+    inline void SetArithmeticFlags(CPU& cpu, uint8_t result, uint8_t carries, uint8_t overflow)
+    {
+        cpu.SREG.H = (carries & 0x08u) != 0u;
+        cpu.SREG.V = (overflow & 0x80u) != 0u;
+        cpu.SREG.N = (result & 0x80u) != 0u;
+        cpu.SREG.S = cpu.SREG.N ^ cpu.SREG.V;
+        cpu.SREG.Z = result == 0u;
+        cpu.SREG.C = (carries & 0x80u) != 0u;
+    }
+
+    // ADD and ADC
+    inline void SetAddFlags(CPU& cpu, uint8_t rd, uint8_t rr, uint8_t result)
+    {
+        SetArithmeticFlags(cpu, result, AddCarries(rd, rr, result), AddOverflow(rd, rr, result));
+    }
+
+    // SUB, SUBI and the compares, which only differ in not storing result
+    inline void SetSubtractFlags(CPU& cpu, uint8_t rd, uint8_t rr, uint8_t result)
+    {
+        SetArithmeticFlags(cpu, result, SubtractBorrows(rd, rr, result), SubtractOverflow(rd, rr, result));
+    }
+
+    // AND, OR and EOR clear V; INC and DEC set it when they overflow
+    inline void SetLogicFlags(CPU& cpu, uint8_t result, bool overflow = false)
+    {
+        cpu.SREG.V = overflow;
+        cpu.SREG.N = (result & 0x80u) != 0u;
+        cpu.SREG.S = cpu.SREG.N ^ cpu.SREG.V;
+        cpu.SREG.Z = result == 0u;
+    }
+}
@@ -0,0 +1,54 @@
+#include "core/flashimage.h"
+#include "core/memory.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace avr {
+    FlashImage::FlashImage(Memory& contents)
+        : _fd(-1),
+          _size(contents.size()),
+          _pages(contents.TakeSnapshot())
+    {
+        using namespace std::string_literals;
+        _fd = memfd_create("avr-emu-flash", MFD_CLOEXEC);
+        if (_fd < 0)
+            throw "Unable to create a "s + std::to_string(_size) + " byte flash image"s;
+
+        for (auto page = std::size_t(0u); page < _pages.size(); page++)
+        {
+            auto offset = page * Memory::PAGE_SIZE;
+            auto length = std::min(Memory::PAGE_SIZE, _size - offset);
+            if (pwrite(_fd, _pages[page]->data(), length, static_cast<off_t>(offset)) != static_cast<ssize_t>(length))
+            {
+                close(_fd);
+                throw "Unable to write the "s + std::to_string(_size) + " byte flash image"s;
+            }
+        }
+    }
+
+    FlashImage::~FlashImage()
+    {
+        close(_fd);
+    }
+
+    std::shared_ptr<Memory> FlashImage::Map() const
+    {
+        using namespace std::string_literals;
+        auto memory = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE, _fd, 0);
+        if (memory == MAP_FAILED)
+            throw "Unable to map the "s + std::to_string(_size) + " byte flash image"s;
+
+        auto size = _size;
+        auto mapping = std::shared_ptr<uint8_t>(
+            static_cast<uint8_t*>(memory),
+            [size] (uint8_t* base) { munmap(base, size); });
+        return std::make_shared<Memory>(mapping, _size, _pages);
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "core/memory.h"
+
+#include <cstddef>
+#include <memory>
+
+namespace avr {
+    // An immutable copy of memory, typically freshly loaded firmware, which
+    // any number of contexts can run from at once. Every Memory from Map
+    // reads the image's pages in place; the host hands a context a private
+    // copy of a page only when it writes to it, as SPM does to flash or any
+    // store does to RAM sharing a page with it. The image's pages also seed
+    // each Memory's snapshot pages, so saving a reset image copies nothing
+    // the context has not written.
+    class FlashImage {
+        private:
+            int _fd;
+            std::size_t _size;
+            Memory::Snapshot _pages;
+
+        public:
+            // Captures contents as they are now
+            explicit FlashImage(Memory& contents);
+            ~FlashImage();
+
+            FlashImage(const FlashImage&) = delete;
+            FlashImage& operator=(const FlashImage&) = delete;
+
+            std::size_t size() const
+            {
+                return _size;
+            }
+
+            // A new memory sharing the image's pages until written. Safe to
+            // call from several threads at once, and the memory may outlive
+            // the image.
+            std::shared_ptr<Memory> Map() const;
+    };
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 namespace avr
 {
     class IClock
@@ -7,6 +9,11 @@ namespace avr
         public:
             virtual ~IClock() {}
             virtual void Pulse() = 0;
-            virtual void ConsumeCycle() = 0;
+
+            // Called by executors once a context has run Quantum() cycles
+            // past the last synchronization. cycles is the total the context
+            // has executed; the call returns once the clock has caught up.
+            virtual void Synchronize(uint64_t cycles) = 0;
+            virtual uint32_t Quantum() const = 0;
     };
 }
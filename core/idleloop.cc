@@ -0,0 +1,230 @@
+#include "core/decodecache.h"
+#include "core/executioncontext.h"
+#include "core/idleloop.h"
+#include "core/iobus.h"
+#include "core/memory.h"
+#include "core/scheduler.h"
+#include "instructions/opcodes.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace avr {
+    namespace {
+        // Words between the head of a loop and its closing branch
+        constexpr uint16_t MAX_BODY_LENGTH = 2u;
+
+        constexpr uint8_t Z_FLAG = 1u;
+
+        uint16_t ReadWord(const ProgramMemory& progMem, uint16_t address)
+        {
+            return static_cast<uint16_t>(
+                progMem[address] |
+                (progMem[static_cast<uint16_t>(address + 1u)] << 8u));
+        }
+
+        bool Is(uint16_t opcode, OpCode op, OpCodeMask mask)
+        {
+            return (opcode & static_cast<uint16_t>(mask)) == static_cast<uint16_t>(op);
+        }
+
+        uint8_t GetRegister(uint16_t opcode)
+        {
+            return static_cast<uint8_t>((opcode >> 4u) & 0x1Fu);
+        }
+
+        uint8_t GetUpperRegister(uint16_t opcode)
+        {
+            return static_cast<uint8_t>(((opcode >> 4u) & 0x0Fu) | 0x10u);
+        }
+
+        uint8_t GetImmediate(uint16_t opcode)
+        {
+            return static_cast<uint8_t>(((opcode >> 4u) & 0xF0u) | (opcode & 0x0Fu));
+        }
+
+        // brne, the only branch a countdown may close with
+        bool IsBranchIfNotZero(const DecodedInstruction& branch)
+        {
+            return (branch.opcode & 0x0400u) != 0u && branch.rr == Z_FLAG;
+        }
+
+        bool FindPoll(IdleLoop& loop, const uint16_t* body, uint16_t length)
+        {
+            if (length == 1u)
+            {
+                auto sbis = Is(body[0], OpCode::SBIS, OpCodeMask::SBIS);
+                if (!sbis && !Is(body[0], OpCode::SBIC, OpCodeMask::SBIC))
+                    return false;
+
+                loop.io = static_cast<uint8_t>((body[0] & 0x00F8u) >> 3u);
+                loop.bit = static_cast<uint8_t>(body[0] & 0x07u);
+                loop.exitWhenSet = sbis;
+                loop.period = 1u + 2u;
+                return true;
+            }
+
+            if (!Is(body[0], OpCode::IN, OpCodeMask::IN))
+                return false;
+
+            auto sbrs = Is(body[1], OpCode::SBRS, OpCodeMask::SBRS);
+            if (!sbrs && !Is(body[1], OpCode::SBRC, OpCodeMask::SBRC))
+                return false;
+            if (GetRegister(body[1]) != GetRegister(body[0]))
+                return false;
+
+            loop.io = static_cast<uint8_t>((body[0] & 0x000Fu) | ((body[0] >> 5u) & 0x0030u));
+            loop.bit = static_cast<uint8_t>(body[1] & 0x07u);
+            loop.exitWhenSet = sbrs;
+            loop.loads = true;
+            loop.rd = GetRegister(body[0]);
+            loop.period = 1u + 1u + 2u;
+            return true;
+        }
+
+        bool FindCountdown(IdleLoop& loop, const uint16_t* body, uint16_t length)
+        {
+            if (length == 1u && Is(body[0], OpCode::DEC, OpCodeMask::DEC))
+            {
+                loop.rd = GetRegister(body[0]);
+                loop.period = 1u + 2u;
+                return true;
+            }
+
+            if (length == 1u && Is(body[0], OpCode::SBIW, OpCodeMask::SBIW))
+            {
+                auto k = ((body[0] & 0x00C0u) >> 2u) | (body[0] & 0x000Fu);
+                if (k != 1u)
+                    return false;
+
+                loop.wide = true;
+                loop.rd = static_cast<uint8_t>(((body[0] >> 4u) & 0x03u) * 2u + 24u);
+                loop.rdHigh = static_cast<uint8_t>(loop.rd + 1u);
+                loop.period = 2u + 2u;
+                return true;
+            }
+
+            if (length == 2u &&
+                Is(body[0], OpCode::SUBI, OpCodeMask::SUBI) &&
+                Is(body[1], OpCode::SBCI, OpCodeMask::SBCI))
+            {
+                if (GetImmediate(body[0]) != 1u || GetImmediate(body[1]) != 0u)
+                    return false;
+                if (GetUpperRegister(body[0]) == GetUpperRegister(body[1]))
+                    return false;
+
+                loop.wide = true;
+                loop.rd = GetUpperRegister(body[0]);
+                loop.rdHigh = GetUpperRegister(body[1]);
+                loop.period = 1u + 1u + 2u;
+                return true;
+            }
+
+            return false;
+        }
+
+        // Iterations the counter allows before the one which falls through
+        uint64_t GetCountdownIterations(const IdleLoop& loop, const CPU& cpu)
+        {
+            auto value = static_cast<uint32_t>(cpu.R[loop.rd]);
+            if (loop.wide)
+                value |= static_cast<uint32_t>(cpu.R[loop.rdHigh]) << 8u;
+            if (value == 0u)
+                value = loop.wide ? 0x10000u : 0x100u;
+            return value - 1u;
+        }
+
+        void CountDown(const IdleLoop& loop, CPU& cpu, uint64_t iterations)
+        {
+            auto value = static_cast<uint32_t>(cpu.R[loop.rd]);
+            if (loop.wide)
+                value |= static_cast<uint32_t>(cpu.R[loop.rdHigh]) << 8u;
+            value -= static_cast<uint32_t>(iterations);
+
+            cpu.R[loop.rd] = static_cast<uint8_t>(value & 0xFFu);
+            if (loop.wide)
+                cpu.R[loop.rdHigh] = static_cast<uint8_t>((value >> 8u) & 0xFFu);
+        }
+    }
+
+    IdleLoop IdleLoop::Find(const ProgramMemory& progMem, uint16_t address, const DecodedInstruction& branch)
+    {
+        auto loop = IdleLoop();
+        if (branch.op != Operation::RJMP && branch.op != Operation::BRBC)
+            return loop;
+
+        // Offsets count bytes from the word after the branch
+        auto offset = static_cast<int16_t>(branch.k);
+        if (offset > -2 || (offset & 1) != 0)
+            return loop;
+
+        auto length = static_cast<uint16_t>((-offset - 2) / 2);
+        if (length > MAX_BODY_LENGTH)
+            return loop;
+
+        loop.head = static_cast<uint16_t>(address + 2 + offset);
+        if (length == 0u)
+        {
+            loop.kind = Kind::Spin;
+            loop.period = 2u;
+            return loop;
+        }
+
+        uint16_t body[MAX_BODY_LENGTH];
+        for (auto i = 0u; i < length; i++)
+            body[i] = ReadWord(progMem, static_cast<uint16_t>(loop.head + i * 2u));
+
+        if (branch.op == Operation::RJMP && FindPoll(loop, body, length))
+            loop.kind = Kind::Poll;
+        else if (branch.op == Operation::BRBC && IsBranchIfNotZero(branch) && FindCountdown(loop, body, length))
+            loop.kind = Kind::Countdown;
+        else
+            loop = IdleLoop();
+
+        return loop;
+    }
+
+    uint32_t FastForward(ExecutionContext& ctx, uint16_t address, const DecodedInstruction& branch, uint32_t cyclesLeft)
+    {
+        // The body may have been rewritten since the branch was decoded
+        auto loop = IdleLoop::Find(ctx.progMem, address, branch);
+        if (loop.kind == IdleLoop::Kind::None || ctx.cpu.PC != loop.head)
+            return 0u;
+
+        // Stopping on the event itself lets it run after the same
+        // instruction it would have run after. Events from other threads
+        // can only arrive once the queue is drained, so stop for that too.
+        auto horizon = static_cast<uint64_t>(cyclesLeft);
+        auto due = std::min(ctx.scheduler.NextDue(), ctx.NextDrain());
+        if (due != Scheduler::NEVER)
+            horizon = due > ctx.cycles ? std::min(horizon, due - ctx.cycles) : 0u;
+
+        auto iterations = horizon / loop.period;
+        auto& cpu = ctx.cpu;
+        switch (loop.kind)
+        {
+            case IdleLoop::Kind::Poll:
+            {
+                // A peripheral behind the register may answer differently
+                // on every read, so each one has to really happen
+                if (ctx.io.IsMapped(static_cast<uint16_t>(IOBus::BEGIN + loop.io)))
+                    return 0u;
+
+                auto set = (cpu.GPIO[loop.io] & (0x1u << loop.bit)) != 0u;
+                if (set == loop.exitWhenSet)
+                    return 0u;
+                if (loop.loads && iterations != 0u)
+                    cpu.R[loop.rd] = cpu.GPIO[loop.io];
+                break;
+            }
+            case IdleLoop::Kind::Countdown:
+                iterations = std::min(iterations, GetCountdownIterations(loop, cpu));
+                CountDown(loop, cpu, iterations);
+                break;
+            default:
+                break;
+        }
+
+        return static_cast<uint32_t>(iterations * loop.period);
+    }
+}
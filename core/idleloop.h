@@ -0,0 +1,48 @@
+#pragma once
+
+#include "core/decodecache.h"
+#include "core/executioncontext.h"
+#include "core/memory.h"
+
+#include <cstdint>
+
+namespace avr {
+    // A loop which only the passing of time or a change in I/O gets the CPU
+    // out of:
+    //   Spin       rjmp .-2, or a branch taken back to itself
+    //   Poll       sbis/sbic io, bit followed by rjmp back to it, or
+    //              in rd, io; sbrs/sbrc rd, bit; rjmp back
+    //   Countdown  dec rd, sbiw rd, 1, or subi rl, 1; sbci rh, 0, followed
+    //              by brne back, as _delay_loop style code compiles to
+    struct IdleLoop {
+        enum class Kind : uint8_t {
+            None,
+            Spin,
+            Poll,
+            Countdown
+        };
+
+        Kind kind;
+        uint16_t head;      // address the closing branch jumps back to
+        uint8_t period;     // cycles of an iteration which goes round again
+        uint8_t io;         // Poll: I/O register waited on
+        uint8_t bit;        // Poll: bit of io waited on
+        bool exitWhenSet;   // Poll: the loop ends once the bit is set
+        bool loads;         // Poll: the loop reads io into rd each time round
+        bool wide;          // Countdown: the counter is rdHigh:rd
+        uint8_t rd;
+        uint8_t rdHigh;
+
+        // Recognizes the loop closed by branch, decoded from address
+        static IdleLoop Find(const ProgramMemory& progMem, uint16_t address, const DecodedInstruction& branch);
+    };
+
+    // Called once branch, decoded from address, has jumped back to the head
+    // of an idle loop. Runs whole iterations of the loop without
+    // interpreting them, for no more than cyclesLeft and never past the next
+    // scheduled event or the next drain of the event queue, leaving the state
+    // interpreting them would have. The last iteration of a countdown is
+    // always left to the interpreter.
+    // Returns the cycles the iterations took.
+    uint32_t FastForward(ExecutionContext& ctx, uint16_t address, const DecodedInstruction& branch, uint32_t cyclesLeft);
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "core/executioncontext.h"
+
+#include <cstdint>
+
+namespace avr
+{
+    class IExecutor
+    {
+        public:
+            virtual ~IExecutor() {}
+            virtual void Execute(ExecutionContext& ctx, uint32_t cyclesRequested) const = 0;
+
+            // Marks interrupt pending and returns. It is entered at an
+            // instruction boundary of a later Execute once SREG.I allows.
+            virtual void Interrupt(ExecutionContext& ctx, uint8_t interrupt) const = 0;
+    };
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "core/cpu.h"
+#include "core/executioncontext.h"
+
+#include <array>
+#include <cstdint>
+#include <utility>
+
+namespace avr {
+    // Cycles between accepting an interrupt and the first instruction of its
+    // handler, spent pushing PC and jumping to the vector
+    constexpr uint32_t INTERRUPT_RESPONSE_CYCLES = 4u;
+
+    // Added to the response when the interrupt wakes the core from sleep
+    constexpr uint32_t INTERRUPT_WAKE_CYCLES = 4u;
+
+    // Spent saving the call-used registers and SREG and clearing r1, as the
+    // prologue avr-gcc gives an ISR calling a plain function would
+    constexpr uint32_t INTERRUPT_SAVE_CYCLES = 32u;
+
+    // Handler pointers attach_interrupt fills in, one word per interrupt.
+    // Loader starts the stack below them.
+    constexpr uint16_t INTERRUPT_TABLE = 0x7F0u;
+
+    // interrupt_return, which Loader places in the last 64 bytes of program
+    // memory. It pops what EnterInterrupt saved before its reti.
+    constexpr uint16_t INTERRUPT_RETURN = static_cast<uint16_t>(
+        CPU::SRAM_BEG + AVR_EMU_RAM_SIZE + AVR_EMU_FLASH_SIZE - 0x40u);
+
+    // Saved below PC in this order, r1 first, with SREG after r0
+    constexpr std::array<uint8_t, 14> INTERRUPT_SAVED_REGISTERS = {
+        1u, 0u, 18u, 19u, 20u, 21u, 22u, 23u, 24u, 25u, 26u, 27u, 30u, 31u
+    };
+
+    inline bool IsInterruptDue(const ExecutionContext& ctx)
+    {
+        return ctx.pendingInterrupts != 0u && ctx.cpu.SREG.I && ctx.cycles >= ctx.interruptsHeldUntil;
+    }
+
+    // Vectors the lowest numbered pending interrupt, which the hardware gives
+    // priority, and returns the cycles taken. Like the hardware it clears
+    // SREG.I, so handlers do not nest unless they set it again. Handlers are
+    // plain functions from the table attach_interrupt fills in, so the
+    // registers avr-gcc lets a function clobber are saved for them with
+    // SREG, r1 is cleared as their code expects, and INTERRUPT_RETURN is
+    // left for their ret to come back to.
+    inline uint32_t EnterInterrupt(ExecutionContext& ctx)
+    {
+        auto interrupt = static_cast<uint16_t>(__builtin_ctzll(ctx.pendingInterrupts));
+        ctx.pendingInterrupts &= ctx.pendingInterrupts - 1u;
+
+        auto cycles = INTERRUPT_RESPONSE_CYCLES + INTERRUPT_SAVE_CYCLES;
+        if (ctx.cpu.is_sleeping)
+        {
+            ctx.cpu.is_sleeping = false;
+            cycles += INTERRUPT_WAKE_CYCLES;
+        }
+
+        // SREG is saved with I already clear, leaving RETI to set it
+        ctx.cpu.SREG.I = false;
+        auto push = [&ctx] (uint8_t value) { ctx.ram[ctx.cpu.SP--] = value; };
+        push(static_cast<uint8_t>(ctx.cpu.PC & 0xff));
+        push(static_cast<uint8_t>((ctx.cpu.PC >> 8) & 0xff));
+        for (auto reg : INTERRUPT_SAVED_REGISTERS)
+        {
+            push(ctx.cpu.R[reg]);
+            if (reg == 0u)
+                push(PackSREG(ctx.cpu));
+        }
+        ctx.cpu.R[1] = 0u;
+        push(static_cast<uint8_t>(INTERRUPT_RETURN & 0xff));
+        push(static_cast<uint8_t>((INTERRUPT_RETURN >> 8) & 0xff));
+
+        const auto& ram = std::as_const(ctx.ram);
+        auto entry = static_cast<uint16_t>(INTERRUPT_TABLE + 2u * interrupt);
+        ctx.cpu.PC = static_cast<uint16_t>(ram[entry] | (ram[static_cast<uint16_t>(entry + 1u)] << 8));
+        return cycles;
+    }
+}
@@ -0,0 +1,110 @@
+#include "core/cpu.h"
+#include "core/executioncontext.h"
+#include "core/iobus.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace avr {
+    IOBus::IOBus()
+        : _table(),
+          _handlers(),
+          _free()
+    {
+        _table[SREG] = IN_CPU;
+    }
+
+    void IOBus::Map(uint16_t address, ReadHandler read, WriteHandler write, uint8_t clearedByOne)
+    {
+        using namespace std::string_literals;
+        if (address < BEGIN || address >= END)
+            throw "Address ("s + std::to_string(address) + ") is outside the I/O range"s;
+
+        if (_table[address] == 0u || _table[address] == IN_CPU)
+        {
+            if (_free.empty())
+            {
+                _handlers.push_back(Handlers());
+                _table[address] = static_cast<uint8_t>(_handlers.size());
+            }
+            else
+            {
+                _table[address] = _free.back();
+                _free.pop_back();
+            }
+        }
+
+        auto& handlers = _handlers[_table[address] - 1u];
+        handlers.read = std::move(read);
+        handlers.write = std::move(write);
+        handlers.clearedByOne = clearedByOne;
+    }
+
+    void IOBus::Unmap(uint16_t address)
+    {
+        if (!IsMapped(address))
+            return;
+        if (_table[address] == IN_CPU)
+        {
+            _table[address] = 0u;
+            return;
+        }
+
+        auto& handlers = _handlers[_table[address] - 1u];
+        handlers.read = nullptr;
+        handlers.write = nullptr;
+        handlers.clearedByOne = 0u;
+        _free.push_back(_table[address]);
+        _table[address] = 0u;
+    }
+
+    // Peripherals behind the bus get to see the access at the right host
+    // time, so the clock is synchronized once the instruction retires.
+    // SREG, which every ISR prologue and critical section goes through, is
+    // left out.
+    uint8_t IOBus::Read(ExecutionContext& ctx, uint16_t address) const
+    {
+        if (_table[address] == IN_CPU)
+            return PackSREG(ctx.cpu);
+
+        ctx.RequestSync();
+        auto& handlers = _handlers[_table[address] - 1u];
+        if (!handlers.read)
+            return std::as_const(ctx.ram)[address];
+        return handlers.read(ctx, address);
+    }
+
+    void IOBus::Write(ExecutionContext& ctx, uint16_t address, uint8_t value) const
+    {
+        if (_table[address] == IN_CPU)
+        {
+            UnpackSREG(ctx.cpu, value);
+            // Only the fast path is left, for pending interrupts to be
+            // entered once the instruction retires
+            if (ctx.cpu.SREG.I && ctx.pendingInterrupts != 0u)
+                ctx.syncAt = ctx.cycles;
+            return;
+        }
+
+        ctx.RequestSync();
+        auto& handlers = _handlers[_table[address] - 1u];
+        if (!handlers.write)
+        {
+            ctx.ram[address] = value;
+            return;
+        }
+        handlers.write(ctx, address, value);
+    }
+
+    // As SBI and CBI do on the hardware: the register is read and written
+    // back with only bit changed, and flags which a one clears written as
+    // zero so that the others stay set
+    void IOBus::WriteBit(ExecutionContext& ctx, uint16_t address, uint8_t bit, bool set) const
+    {
+        auto mask = static_cast<uint8_t>(0x1u << bit);
+        auto flags = _table[address] == IN_CPU ? uint8_t(0u) : _handlers[_table[address] - 1u].clearedByOne;
+        auto value = static_cast<uint8_t>(Read(ctx, address) & ~flags & ~mask);
+        Write(ctx, address, set ? static_cast<uint8_t>(value | mask) : value);
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace avr {
+    struct ExecutionContext;
+
+    // Lets peripherals see loads and stores to addresses in the I/O range of
+    // the data space, 0x20 to 0xFF. Whether an address is mapped is a single
+    // table lookup, and addresses outside the range fail the bounds check
+    // before even that, so ordinary SRAM stays on the fast path. Unmapped
+    // I/O addresses behave as plain RAM. SREG is mapped from the start, as
+    // it is kept in CPU rather than behind its address, but unlike
+    // peripheral registers needs no clock sync.
+    class IOBus {
+        public:
+            constexpr static uint16_t BEGIN = 0x20u;
+            constexpr static uint16_t END = 0x100u;
+            constexpr static uint16_t SREG = 0x5Fu;
+
+            using ReadHandler = std::function<uint8_t(ExecutionContext& ctx, uint16_t address)>;
+            using WriteHandler = std::function<void(ExecutionContext& ctx, uint16_t address, uint8_t value)>;
+
+        private:
+            struct Handlers {
+                ReadHandler read;
+                WriteHandler write;
+                uint8_t clearedByOne;
+            };
+
+            // Marks SREG in _table while it reads and writes CPU::SREG
+            constexpr static uint8_t IN_CPU = 0xFFu;
+
+            // One past the index of an address' handlers, 0 while unmapped.
+            // Slots are reused once unmapped, so no more than END - BEGIN
+            // are ever taken.
+            std::array<uint8_t, END> _table;
+            std::vector<Handlers> _handlers;
+            std::vector<uint8_t> _free;
+
+        public:
+            IOBus();
+
+            bool IsMapped(uint16_t address) const
+            {
+                return address < END && _table[address] != 0u;
+            }
+
+            // No peripheral registers are mapped, only SREG
+            bool Empty() const
+            {
+                return _handlers.size() == _free.size();
+            }
+
+            // Routes accesses to address through the handlers. Either may be
+            // empty to leave that direction reading or writing the RAM
+            // behind the register. clearedByOne are the flag bits which a
+            // one written to clears, such as TIFR's, which WriteBit leaves
+            // alone unless it names them.
+            void Map(uint16_t address, ReadHandler read, WriteHandler write, uint8_t clearedByOne = 0u);
+            void Unmap(uint16_t address);
+
+            // Only for mapped addresses; see ExecutionContext::Load, Store
+            // and StoreBit
+            uint8_t Read(ExecutionContext& ctx, uint16_t address) const;
+            void Write(ExecutionContext& ctx, uint16_t address, uint8_t value) const;
+            void WriteBit(ExecutionContext& ctx, uint16_t address, uint8_t bit, bool set) const;
+    };
+}
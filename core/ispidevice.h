@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace avr
+{
+    // Device side of an SPI bus. Buffers belong to the caller and are only
+    // borrowed for the length of the call.
+    class ISpiDevice
+    {
+        public:
+            virtual ~ISpiDevice() {}
+
+            // Chip select was driven low, starting a transaction
+            virtual void Select() = 0;
+
+            // Chip select was released, ending it
+            virtual void Deselect() = 0;
+
+            // Shifts length bytes each way: mosi holds what the controller
+            // sends and miso receives the device's answer. MISO floats high,
+            // so miso arrives filled with 0xFF.
+            virtual void Transfer(const uint8_t* mosi, uint8_t* miso, std::size_t length) = 0;
+    };
+}
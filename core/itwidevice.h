@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace avr
+{
+    // Device side of a TWI (I2C) bus. Buffers belong to the caller and are
+    // only borrowed for the length of the call.
+    class ITwiDevice
+    {
+        public:
+            virtual ~ITwiDevice() {}
+
+            // A START or repeated START was followed by the device's address.
+            // Returns false to NACK it.
+            virtual bool Address(bool read) = 0;
+
+            // The controller sent length bytes. Returns false to NACK the
+            // last of them.
+            virtual bool Write(const uint8_t* data, std::size_t length) = 0;
+
+            // The controller clocks in length bytes
+            virtual void Read(uint8_t* data, std::size_t length) = 0;
+
+            virtual void Stop() = 0;
+    };
+}
@@ -0,0 +1,56 @@
+#include "core/jitarena.h"
+
+#include <sys/mman.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace avr {
+    namespace {
+        std::atomic<uint64_t> nextArenaId(1u);
+    }
+
+    JitArena::JitArena(std::size_t capacity)
+        : _base(nullptr),
+          _capacity(capacity),
+          _used(0u),
+          _id(nextArenaId++)
+    {
+        using namespace std::string_literals;
+        auto memory = mmap(nullptr, _capacity, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED)
+            throw "Unable to map "s + std::to_string(_capacity) + " bytes for generated code"s;
+        _base = static_cast<uint8_t*>(memory);
+    }
+
+    JitArena::~JitArena()
+    {
+        munmap(_base, _capacity);
+    }
+
+    const void* JitArena::Commit(const std::vector<uint8_t>& code)
+    {
+        using namespace std::string_literals;
+        if (code.size() > _capacity - _used)
+            return nullptr;
+
+        if (mprotect(_base, _capacity, PROT_READ | PROT_WRITE) != 0)
+            throw "Unable to make generated code writable"s;
+
+        auto start = _base + _used;
+        std::memcpy(start, code.data(), code.size());
+        // Keep entry points 16 byte aligned
+        _used += (code.size() + 0xFu) & ~static_cast<std::size_t>(0xFu);
+        if (_used > _capacity)
+            _used = _capacity;
+
+        if (mprotect(_base, _capacity, PROT_READ | PROT_EXEC) != 0)
+            throw "Unable to make generated code executable"s;
+
+        __builtin___clear_cache(reinterpret_cast<char*>(start), reinterpret_cast<char*>(start + code.size()));
+        return start;
+    }
+}
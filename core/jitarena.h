@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace avr {
+    // Append-only region of executable memory. Code is copied in while the
+    // region is writable and the region is flipped back to read/execute
+    // before anything is run from it, so it is never writable and executable
+    // at once.
+    class JitArena {
+        public:
+            constexpr static std::size_t DEFAULT_CAPACITY = 0x100000u; // 1 M
+
+        private:
+            uint8_t* _base;
+            std::size_t _capacity;
+            std::size_t _used;
+            uint64_t _id;
+
+        public:
+            JitArena(std::size_t capacity = DEFAULT_CAPACITY);
+            ~JitArena();
+
+            JitArena(const JitArena&) = delete;
+            JitArena& operator=(const JitArena&) = delete;
+
+            // Unique for the lifetime of the process, unlike the arena's
+            // address, so stale code pointers can be told apart from live
+            // ones
+            uint64_t Id() const
+            {
+                return _id;
+            }
+
+            std::size_t Used() const
+            {
+                return _used;
+            }
+
+            // Returns nullptr once the arena is full
+            const void* Commit(const std::vector<uint8_t>& code);
+    };
+}
@@ -0,0 +1,380 @@
+#include "core/blockcache.h"
+#include "core/cpu.h"
+#include "core/decodecache.h"
+#include "core/flags.h"
+#include "core/jitcompiler.h"
+#include "core/memory.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace avr {
+    namespace {
+        // SREG bits map to the hardware layout (C in bit 0 through I in bit
+        // 7), which the generated code relies on
+        bool HasHardwareSREGLayout()
+        {
+            auto memory = Memory(0x100u);
+            auto cpu = CPU(memory);
+            uint8_t value = 0u;
+
+            cpu.SREG.C = 1u;
+            cpu.SREG.H = 1u;
+            cpu.SREG.I = 1u;
+            std::memcpy(&value, &cpu.SREG, sizeof(value));
+            return sizeof(cpu.SREG) == sizeof(value) && value == (SREG_C | SREG_H | SREG_I);
+        }
+
+        bool IsCompilable(const DecodedInstruction& insn, bool last)
+        {
+            switch (insn.op)
+            {
+                case Operation::ADC:
+                case Operation::ADD:
+                case Operation::AND:
+                case Operation::ANDI:
+                case Operation::CP:
+                case Operation::CPC:
+                case Operation::CPI:
+                case Operation::DEC:
+                case Operation::EOR:
+                case Operation::INC:
+                case Operation::LDI:
+                case Operation::MOV:
+                case Operation::OR:
+                case Operation::ORI:
+                case Operation::SUBI:
+                    return true;
+                case Operation::SUB:
+                    // SUBInstruction computes flags from the register it has
+                    // just cleared when both operands are the same register
+                    return insn.rd != insn.rr;
+                case Operation::BRBC:
+                case Operation::RJMP:
+                    return last;
+                default:
+                    return false;
+            }
+        }
+
+        // Register use inside generated code (System V, all caller saved):
+        //   rdi   CPU::R          rsi  &CPU::SREG       rdx  &CPU::PC
+        //   r8d   working SREG    ecx  Rd               r11d Rr
+        //   eax, r9d, r10d        scratch for flag extraction
+        class Assembler {
+            private:
+                std::vector<uint8_t> _code;
+
+            public:
+                Assembler()
+                    : _code()
+                {}
+
+                const std::vector<uint8_t>& Code() const
+                {
+                    return _code;
+                }
+
+                void Emit(std::initializer_list<uint8_t> bytes)
+                {
+                    _code.insert(_code.end(), bytes);
+                }
+
+                void Emit16(uint16_t value)
+                {
+                    Emit({ static_cast<uint8_t>(value & 0xFFu), static_cast<uint8_t>(value >> 8u) });
+                }
+
+                void Emit32(uint32_t value)
+                {
+                    for (auto i = 0u; i < sizeof(value); i++)
+                        _code.push_back(static_cast<uint8_t>((value >> (i * 8u)) & 0xFFu));
+                }
+
+                void LoadSREG()                     { Emit({ 0x44, 0x0F, 0xB6, 0x06 }); }        // movzx r8d, byte [rsi]
+                void StoreSREG()                    { Emit({ 0x44, 0x88, 0x06 }); }              // mov byte [rsi], r8b
+                void LoadRd(uint8_t r)              { Emit({ 0x0F, 0xB6, 0x4F, r }); }           // movzx ecx, byte [rdi + r]
+                void LoadRr(uint8_t r)              { Emit({ 0x44, 0x0F, 0xB6, 0x5F, r }); }     // movzx r11d, byte [rdi + r]
+                void StoreRd(uint8_t r)             { Emit({ 0x88, 0x4F, r }); }                 // mov byte [rdi + r], cl
+                void StoreImmediate(uint8_t r, uint8_t k) { Emit({ 0xC6, 0x47, r, k }); }        // mov byte [rdi + r], k
+                void CarryIn()                      { Emit({ 0x41, 0x0F, 0xBA, 0xE0, 0x00 }); }  // bt r8d, 0
+                void TestFlag(uint8_t bit)          { Emit({ 0x41, 0x0F, 0xBA, 0xE0, bit }); }   // bt r8d, bit
+                void Increment()                    { Emit({ 0xFE, 0xC1 }); }                    // inc cl
+                void Decrement()                    { Emit({ 0xFE, 0xC9 }); }                    // dec cl
+                void Return()                       { Emit({ 0xC3 }); }                          // ret
+
+                // <op> cl, r11b
+                void AluRegister(uint8_t opcode)
+                {
+                    Emit({ 0x44, opcode, 0xD9 });
+                }
+
+                // <op> cl, k
+                void AluImmediate(uint8_t extension, uint8_t k)
+                {
+                    Emit({ 0x80, static_cast<uint8_t>(0xC1u | (extension << 3u)), k });
+                }
+
+                // mov eax, cycles
+                void ReturnCycles(uint32_t cycles)
+                {
+                    Emit({ 0xB8 });
+                    Emit32(cycles);
+                }
+
+                // mov word [rdx], address
+                void SetPC(uint16_t address)
+                {
+                    Emit({ 0x66, 0xC7, 0x02 });
+                    Emit16(address);
+                }
+
+                // jc/jnc forward, returning the offset to pass to Land once the
+                // code to skip has been emitted
+                std::size_t SkipIfCarry(bool carry)
+                {
+                    Emit({ static_cast<uint8_t>(carry ? 0x72u : 0x73u), 0x00 });
+                    return _code.size();
+                }
+
+                void Land(std::size_t skip)
+                {
+                    _code[skip - 1u] = static_cast<uint8_t>(_code.size() - skip);
+                }
+
+                // Moves the host flags of the last ALU instruction into the
+                // bits of r8d selected by mask
+                void CaptureFlags(uint8_t mask)
+                {
+                    Emit({ 0x9F });                         // lahf
+                    Emit({ 0x0F, 0x92, 0xC1 });             // setc  cl
+                    Emit({ 0x41, 0x0F, 0x94, 0xC1 });       // setz  r9b
+                    Emit({ 0x41, 0x0F, 0x98, 0xC2 });       // sets  r10b
+                    Emit({ 0x41, 0x0F, 0x90, 0xC3 });       // seto  r11b
+                    Emit({ 0xC1, 0xE8, 0x0C });             // shr   eax, 12     ; AF
+                    Emit({ 0x83, 0xE0, 0x01 });             // and   eax, 1
+                    Emit({ 0xC1, 0xE0, 0x05 });             // shl   eax, 5      ; H
+                    Emit({ 0x0F, 0xB6, 0xC9 });             // movzx ecx, cl     ; C
+                    Emit({ 0x09, 0xC8 });                   // or    eax, ecx
+                    Emit({ 0x45, 0x0F, 0xB6, 0xC9 });       // movzx r9d, r9b
+                    Emit({ 0x41, 0xD1, 0xE1 });             // shl   r9d, 1      ; Z
+                    Emit({ 0x44, 0x09, 0xC8 });             // or    eax, r9d
+                    Emit({ 0x45, 0x0F, 0xB6, 0xD2 });       // movzx r10d, r10b
+                    Emit({ 0x45, 0x0F, 0xB6, 0xDB });       // movzx r11d, r11b
+                    Emit({ 0x44, 0x89, 0xD1 });             // mov   ecx, r10d
+                    Emit({ 0x44, 0x31, 0xD9 });             // xor   ecx, r11d
+                    Emit({ 0xC1, 0xE1, 0x04 });             // shl   ecx, 4      ; S
+                    Emit({ 0x09, 0xC8 });                   // or    eax, ecx
+                    Emit({ 0x41, 0xC1, 0xE2, 0x02 });       // shl   r10d, 2     ; N
+                    Emit({ 0x44, 0x09, 0xD0 });             // or    eax, r10d
+                    Emit({ 0x41, 0xC1, 0xE3, 0x03 });       // shl   r11d, 3     ; V
+                    Emit({ 0x44, 0x09, 0xD8 });             // or    eax, r11d
+                    Emit({ 0x25 });                         // and   eax, mask
+                    Emit32(mask);
+                    Emit({ 0x41, 0x81, 0xE0 });             // and   r8d, ~mask
+                    Emit32(~static_cast<uint32_t>(mask));
+                    Emit({ 0x41, 0x09, 0xC0 });             // or    r8d, eax
+                }
+
+                void Binary(const DecodedInstruction& insn, uint8_t opcode, bool carryIn, bool store, uint8_t flags)
+                {
+                    LoadRd(insn.rd);
+                    LoadRr(insn.rr);
+                    if (carryIn)
+                        CarryIn();
+                    AluRegister(opcode);
+                    if (store)
+                        StoreRd(insn.rd);
+                    CaptureFlags(flags);
+                }
+
+                void Immediate(const DecodedInstruction& insn, uint8_t extension, bool store, uint8_t flags)
+                {
+                    LoadRd(insn.rd);
+                    AluImmediate(extension, static_cast<uint8_t>(insn.k));
+                    if (store)
+                        StoreRd(insn.rd);
+                    CaptureFlags(flags);
+                }
+        };
+    }
+
+    uint32_t NativeBlockInstruction::Execute(uint16_t, ExecutionContext& ctx) const
+    {
+        auto block = ctx.blockCache.Find(static_cast<uint16_t>(ctx.cpu.PC - sizeof(ctx.cpu.PC)));
+        return _compiler.Run(ctx, *block);
+    }
+
+    bool NativeBlockInstruction::Matches(uint16_t) const
+    {
+        return false;
+    }
+
+    JitCompiler::JitCompiler(JitMode mode)
+        : _mode(mode),
+          _arena(),
+          _instruction(*this),
+#if defined(__x86_64__)
+          _supported(HasHardwareSREGLayout())
+#else
+          _supported(false)
+#endif
+    {}
+
+    bool JitCompiler::Prepare(TranslatedBlock& block)
+    {
+        auto& native = block.native;
+        if (native.function != nullptr && native.arena == _arena.Id())
+            return true;
+        if (native.rejected || !_supported)
+            return false;
+
+        if (++block.hits < HOT_BLOCK_THRESHOLD)
+            return false;
+
+        native.rejected = !Compile(block);
+        return !native.rejected;
+    }
+
+    bool JitCompiler::Compile(TranslatedBlock& block)
+    {
+        auto count = block.ops.size();
+        for (auto i = 0u; i < count; i++)
+            if (!IsCompilable(block.ops[i], i + 1u == count))
+                return false;
+
+        auto assembler = Assembler();
+        auto pc = block.start;
+        auto cycles = 0u;
+        auto terminated = false;
+
+        assembler.LoadSREG();
+        for (const auto& insn : block.ops)
+        {
+            pc = static_cast<uint16_t>(pc + sizeof(pc));
+            switch (insn.op)
+            {
+                case Operation::ADD:  assembler.Binary(insn, 0x00u, false, true, ARITHMETIC_FLAGS); break;
+                case Operation::ADC:  assembler.Binary(insn, 0x10u, true, true, ARITHMETIC_FLAGS); break;
+                case Operation::SUB:  assembler.Binary(insn, 0x28u, false, true, ARITHMETIC_FLAGS); break;
+                case Operation::CP:   assembler.Binary(insn, 0x38u, false, false, ARITHMETIC_FLAGS); break;
+                case Operation::CPC:  assembler.Binary(insn, 0x18u, true, false, ARITHMETIC_FLAGS); break;
+                case Operation::AND:  assembler.Binary(insn, 0x20u, false, true, LOGIC_FLAGS); break;
+                case Operation::OR:   assembler.Binary(insn, 0x08u, false, true, LOGIC_FLAGS); break;
+                case Operation::EOR:  assembler.Binary(insn, 0x30u, false, true, LOGIC_FLAGS); break;
+                case Operation::SUBI: assembler.Immediate(insn, 5u, true, ARITHMETIC_FLAGS); break;
+                case Operation::CPI:  assembler.Immediate(insn, 7u, false, ARITHMETIC_FLAGS); break;
+                case Operation::ANDI: assembler.Immediate(insn, 4u, true, LOGIC_FLAGS); break;
+                case Operation::ORI:  assembler.Immediate(insn, 1u, true, LOGIC_FLAGS); break;
+
+                case Operation::LDI:
+                    assembler.StoreImmediate(insn.rd, static_cast<uint8_t>(insn.k));
+                    break;
+
+                case Operation::MOV:
+                    assembler.LoadRd(insn.rr);
+                    assembler.StoreRd(insn.rd);
+                    break;
+
+                case Operation::INC:
+                case Operation::DEC:
+                    assembler.LoadRd(insn.rd);
+                    if (insn.op == Operation::INC)
+                        assembler.Increment();
+                    else
+                        assembler.Decrement();
+                    assembler.StoreRd(insn.rd);
+                    assembler.CaptureFlags(LOGIC_FLAGS);
+                    break;
+
+                case Operation::RJMP:
+                    assembler.StoreSREG();
+                    assembler.ReturnCycles(cycles + 2u);
+                    assembler.SetPC(static_cast<uint16_t>(pc + insn.k));
+                    assembler.Return();
+                    terminated = true;
+                    break;
+
+                case Operation::BRBC:
+                {
+                    auto branchIfSet = (insn.opcode & 0x0400u) == 0u;
+                    assembler.StoreSREG();
+                    assembler.ReturnCycles(cycles + 1u);
+                    assembler.SetPC(pc);
+                    assembler.TestFlag(insn.rr);
+                    auto notTaken = assembler.SkipIfCarry(!branchIfSet);
+                    assembler.ReturnCycles(cycles + 2u);
+                    assembler.SetPC(static_cast<uint16_t>(pc + insn.k));
+                    assembler.Land(notTaken);
+                    assembler.Return();
+                    terminated = true;
+                    break;
+                }
+
+                default:
+                    return false;
+            }
+
+            if (!terminated)
+                cycles++;
+        }
+
+        if (!terminated)
+        {
+            assembler.StoreSREG();
+            assembler.ReturnCycles(cycles);
+            assembler.SetPC(pc);
+            assembler.Return();
+        }
+
+        auto code = _arena.Commit(assembler.Code());
+        if (code == nullptr)
+            return false;
+
+        block.native.function = reinterpret_cast<NativeBlock::Function>(const_cast<void*>(code));
+        block.native.arena = _arena.Id();
+        block.native.leadCycles = static_cast<uint32_t>(count - 1u);
+        return true;
+    }
+
+    uint32_t JitCompiler::Run(ExecutionContext& ctx, const TranslatedBlock& block) const
+    {
+        if (_mode == JitMode::Differential)
+            return Verify(ctx, block);
+
+        auto sreg = reinterpret_cast<uint8_t*>(&ctx.cpu.SREG);
+        return block.native.function(ctx.cpu.R, sreg, &ctx.cpu.PC);
+    }
+
+    uint32_t JitCompiler::Verify(ExecutionContext& ctx, const TranslatedBlock& block) const
+    {
+        using namespace std::string_literals;
+        auto& cpu = ctx.cpu;
+
+        uint8_t r[CPU::R_END + 1u];
+        uint8_t sreg = 0u;
+        uint16_t pc = block.start;
+        std::memcpy(r, cpu.R, sizeof(r));
+        std::memcpy(&sreg, &cpu.SREG, sizeof(sreg));
+        auto nativeCycles = block.native.function(r, &sreg, &pc);
+
+        auto cycles = 0u;
+        cpu.PC = block.start;
+        for (auto i = 0u; i < block.ops.size(); i++)
+        {
+            cpu.PC += sizeof(cpu.PC);
+            cycles += block.ops[i].executor->ExecuteDecoded(block.ops[i], ctx);
+        }
+
+        uint8_t expectedSreg = 0u;
+        std::memcpy(&expectedSreg, &cpu.SREG, sizeof(expectedSreg));
+        if (std::memcmp(r, cpu.R, sizeof(r)) != 0 || sreg != expectedSreg || pc != cpu.PC || nativeCycles != cycles)
+            throw "Compiled block at "s + std::to_string(block.start) + " diverged from the interpreter"s;
+
+        return cycles;
+    }
+}
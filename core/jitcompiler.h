@@ -0,0 +1,83 @@
+#pragma once
+
+#include "core/blockcache.h"
+#include "core/executioncontext.h"
+#include "core/jitarena.h"
+#include "instructions/instructionexecutor.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace avr {
+    enum class JitMode {
+        Native,
+        // Runs each compiled block on scratch copies of the registers, then
+        // through the interpreter, and throws if the two disagree
+        Differential
+    };
+
+    class JitCompiler;
+
+    // Stands in for a whole compiled block so the threaded engine can run
+    // it like any other generic instruction. PC already points one word past
+    // the block start when it runs.
+    class NativeBlockInstruction : public InstructionExecutor {
+        private:
+            const JitCompiler& _compiler;
+
+        public:
+            NativeBlockInstruction(const JitCompiler& compiler)
+                : _compiler(compiler)
+            {}
+
+            uint32_t Execute(uint16_t opcode, ExecutionContext& ctx) const override;
+            bool Matches(uint16_t opcode) const override;
+    };
+
+    // Compiles hot translated blocks to x86-64. The general purpose registers
+    // stay in CPU::R and are addressed off a base register, since the host
+    // has too few registers to hold all 32. SREG is kept in a host register
+    // for the whole block and written back once on exit. Blocks containing
+    // anything outside the integer subset stay interpreted.
+    class JitCompiler {
+        public:
+            constexpr static uint32_t HOT_BLOCK_THRESHOLD = 16u;
+
+        private:
+            JitMode _mode;
+            JitArena _arena;
+            NativeBlockInstruction _instruction;
+            bool _supported;
+
+            bool Compile(TranslatedBlock& block);
+            uint32_t Verify(ExecutionContext& ctx, const TranslatedBlock& block) const;
+
+        public:
+            JitCompiler(JitMode mode = JitMode::Native);
+
+            // False when the host is not x86-64 or CPU::SREG is laid out
+            // differently from the hardware register
+            bool IsSupported() const
+            {
+                return _supported;
+            }
+
+            JitMode GetMode() const
+            {
+                return _mode;
+            }
+
+            const InstructionExecutor& GetInstruction() const
+            {
+                return _instruction;
+            }
+
+            // Counts an entry into block, compiling it once it turns hot.
+            // Returns true when block has native code from this compiler.
+            bool Prepare(TranslatedBlock& block);
+
+            // Runs the compiled block starting at PC - 2 and returns the
+            // cycles it took
+            uint32_t Run(ExecutionContext& ctx, const TranslatedBlock& block) const;
+    };
+}
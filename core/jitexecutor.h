@@ -0,0 +1,34 @@
+#pragma once
+
+#include "core/blockexecutor.h"
+#include "core/dispatchtable.h"
+#include "core/iclock.h"
+#include "core/jitcompiler.h"
+#include "instructions/instructionexecutor.h"
+
+#include <memory>
+#include <vector>
+
+namespace avr {
+    // BlockExecutor with a JitCompiler tier. Blocks start out interpreted
+    // and are compiled to host code once hot; blocks the compiler rejects,
+    // and any block SPM rewrites until it turns hot again, stay interpreted.
+    class JitExecutor : public BlockExecutor {
+        public:
+            JitExecutor(
+                IClock& clock,
+                std::vector<std::unique_ptr<InstructionExecutor>>&& executors)
+                : BlockExecutor(
+                    clock,
+                    std::make_shared<const DispatchTable>(std::move(executors)),
+                    std::make_shared<JitCompiler>())
+            {}
+
+            JitExecutor(
+                IClock& clock,
+                const std::shared_ptr<const DispatchTable>& dispatchTable,
+                JitMode mode = JitMode::Native)
+                : BlockExecutor(clock, dispatchTable, std::make_shared<JitCompiler>(mode))
+            {}
+    };
+}
@@ -1,6 +1,8 @@
 #include "core/loader.h"
 #include "core/cpu.h"
 #include "core/executioncontext.h"
+#include "core/flashimage.h"
+#include "core/interrupts.h"
 #include "core/memory.h"
 
 #include <memory>
@@ -12,16 +14,41 @@ namespace avr
     {
         auto memory = std::make_shared<Memory>(AVR_EMU_FLASH_SIZE + AVR_EMU_RAM_SIZE);
         auto ctx = ExecutionContext(memory, memory);
+        LoadProgram(ctx, program);
+        return ctx;
+    }
 
+    void Loader::LoadProgram(ExecutionContext& ctx, const std::string& program) const
+    {
         LoadInterruptHandlers(ctx);
         LoadToMemory(ctx, program, 0x940);
+        Start(ctx);
+    }
 
-        ctx.cpu.PC = 0x940;
-        ctx.cpu.SP = 0x8EF;
+    std::shared_ptr<const FlashImage> Loader::BuildImage(const std::string& program) const
+    {
+        auto memory = std::make_shared<Memory>(AVR_EMU_FLASH_SIZE + AVR_EMU_RAM_SIZE);
+        auto ctx = ExecutionContext(memory, memory);
+        LoadInterruptHandlers(ctx);
+        LoadToMemory(ctx, program, 0x940);
+        return std::make_shared<const FlashImage>(*memory);
+    }
 
+    ExecutionContext Loader::LoadImage(const FlashImage& image) const
+    {
+        auto memory = image.Map();
+        auto ctx = ExecutionContext(memory, memory);
+        Start(ctx);
         return ctx;
     }
 
+    void Loader::Start(ExecutionContext& ctx) const
+    {
+        ctx.cpu.PC = 0x940;
+        ctx.cpu.SP = 0x7EF;    // below INTERRUPT_TABLE
+        ctx.SaveResetImage();
+    }
+
     void Loader::LoadInterruptHandlers(ExecutionContext& ctx) const
     {
         //auto interrupts = std::string(
@@ -80,13 +107,42 @@ namespace avr
             "\x08\x95" // ret
         );
 
+        auto interruptReturn = std::string(
+            // interrupt_return:
+            "\xff\x91" // pop     r31
+            "\xef\x91" // pop     r30
+            "\xbf\x91" // pop     r27
+            "\xaf\x91" // pop     r26
+            "\x9f\x91" // pop     r25
+            "\x8f\x91" // pop     r24
+            "\x7f\x91" // pop     r23
+            "\x6f\x91" // pop     r22
+            "\x5f\x91" // pop     r21
+            "\x4f\x91" // pop     r20
+            "\x3f\x91" // pop     r19
+            "\x2f\x91" // pop     r18
+            "\x0f\x90" // pop     r0
+            "\x0f\xbe" // out     0x3f, r0
+            "\x0f\x90" // pop     r0
+            "\x1f\x90" // pop     r1
+            "\x18\x95" // reti
+        );
+
         auto progMemStart = ctx.cpu.SRAM_BEG + AVR_EMU_RAM_SIZE; // 0x900
         LoadToMemory(ctx, interrupts, progMemStart);
+        LoadToMemory(ctx, interruptReturn, INTERRUPT_RETURN);
     }
 
     void Loader::LoadToMemory(ExecutionContext& ctx, const std::string& program, uint16_t address) const
     {
-        for (auto i = 0; i < program.size(); i++)
-            ctx.progMem[address + i] = program[i];
+        if (address + program.size() <= ctx.progMem.size())
+        {
+            for (auto i = 0u; i < program.size(); i++)
+                ctx.progMem.Unchecked(static_cast<uint16_t>(address + i)) = static_cast<uint8_t>(program[i]);
+            return;
+        }
+
+        for (auto i = 0u; i < program.size(); i++)
+            ctx.progMem[static_cast<uint16_t>(address + i)] = static_cast<uint8_t>(program[i]);
     }
 }
@@ -1,4 +1,8 @@
 #include "core/executioncontext.h"
+#include "core/flashimage.h"
+
+#include <memory>
+#include <string>
 
 namespace avr
 {
@@ -7,8 +11,21 @@ namespace avr
         private:
             void LoadInterruptHandlers(ExecutionContext& ctx) const;
             void LoadToMemory(ExecutionContext& ctx, const std::string& program, uint16_t address) const;
+            void Start(ExecutionContext& ctx) const;
 
         public:
             ExecutionContext LoadProgram(const std::string& program) const;
+
+            // Into a context whose flash and RAM are one Memory of at least
+            // AVR_EMU_FLASH_SIZE + AVR_EMU_RAM_SIZE bytes, e.g. from a
+            // ContextArena
+            void LoadProgram(ExecutionContext& ctx, const std::string& program) const;
+
+            // The memory LoadProgram would set up, frozen so that any number
+            // of contexts can share it through LoadImage
+            std::shared_ptr<const FlashImage> BuildImage(const std::string& program) const;
+
+            // A context starting from image, sharing its pages until written
+            ExecutionContext LoadImage(const FlashImage& image) const;
     };
 }
@@ -0,0 +1,472 @@
+#include "core/contextarena.h"
+#include "core/cpu.h"
+#include "core/cycles.h"
+#include "core/decodecache.h"
+#include "core/dispatchtable.h"
+#include "core/flags.h"
+#include "core/idleloop.h"
+#include "core/lockstepexecutor.h"
+#include "instructions/instructionexecutor.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Kernels are cloned for AVX2 and picked when the program loads, so the
+// loops over lanes vectorize 32 at a time on hosts which have it
+#if defined(__x86_64__) && defined(__linux__) && defined(__GNUC__)
+#define AVR_EMU_LANE_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+#define AVR_EMU_LANE_KERNEL
+#endif
+
+namespace avr {
+    namespace {
+        constexpr uint32_t NO_PC = 0x10000u;
+
+        // The registers and SREG of a group of lanes laid out a row per
+        // register with a byte per lane, kept across instructions while
+        // the group runs ALU instructions together. Rows are read in from
+        // the lanes on first use and written back by Flush, only those
+        // written, before anything which looks at the lanes' CPU.
+        class LaneRows {
+            public:
+                constexpr static unsigned SREG_ROW = 32u;
+                constexpr static unsigned IMMEDIATE_ROW = 33u;
+                constexpr static unsigned SCRATCH_ROW = 34u;
+                constexpr static unsigned ROWS = 35u;
+
+            private:
+                const std::vector<ExecutionContext*>& _lanes;
+                const std::vector<std::size_t>& _group;
+                std::vector<uint8_t> _rows;
+                std::size_t _count;
+                uint64_t _loaded;   // a bit per row holding the lanes' values
+                uint64_t _dirty;    // a bit per row the lanes have yet to see
+
+                uint8_t* Row(unsigned row)
+                {
+                    return _rows.data() + row * _count;
+                }
+
+            public:
+                LaneRows(const std::vector<ExecutionContext*>& lanes, const std::vector<std::size_t>& group)
+                    : _lanes(lanes),
+                      _group(group),
+                      _rows(),
+                      _count(0u),
+                      _loaded(0u),
+                      _dirty(0u)
+                {}
+
+                std::size_t count() const
+                {
+                    return _count;
+                }
+
+                // Only once flushed, as the group's lanes are being replaced
+                void Reset()
+                {
+                    _count = _group.size();
+                    _rows.resize(ROWS * _count);
+                    _loaded = 0u;
+                    _dirty = 0u;
+                }
+
+                const uint8_t* Read(unsigned row)
+                {
+                    auto values = Row(row);
+                    if (_loaded & (uint64_t(1u) << row))
+                        return values;
+
+                    for (auto j = std::size_t(0u); j < _count; j++)
+                    {
+                        auto& cpu = _lanes[_group[j]]->cpu;
+                        values[j] = row == SREG_ROW ? PackSREG(cpu) : cpu.R[row];
+                    }
+                    _loaded |= uint64_t(1u) << row;
+                    return values;
+                }
+
+                // The whole row must be written, as it is not read in first
+                uint8_t* Write(unsigned row)
+                {
+                    _loaded |= uint64_t(1u) << row;
+                    _dirty |= uint64_t(1u) << row;
+                    return Row(row);
+                }
+
+                uint8_t* Update(unsigned row)
+                {
+                    Read(row);
+                    return Write(row);
+                }
+
+                const uint8_t* Immediate(uint8_t value)
+                {
+                    auto values = Row(IMMEDIATE_ROW);
+                    std::fill(values, values + _count, value);
+                    return values;
+                }
+
+                uint8_t* Scratch()
+                {
+                    return Row(SCRATCH_ROW);
+                }
+
+                void Flush()
+                {
+                    for (auto row = 0u; row <= SREG_ROW; row++)
+                    {
+                        if (!(_dirty & (uint64_t(1u) << row)))
+                            continue;
+
+                        auto values = Row(row);
+                        for (auto j = std::size_t(0u); j < _count; j++)
+                        {
+                            auto& cpu = _lanes[_group[j]]->cpu;
+                            if (row == SREG_ROW)
+                                UnpackSREG(cpu, values[j]);
+                            else
+                                cpu.R[row] = values[j];
+                        }
+                    }
+                    _loaded = 0u;
+                    _dirty = 0u;
+                }
+        };
+
+        AVR_EMU_LANE_KERNEL
+        void Add(const uint8_t* rd, const uint8_t* rr, uint8_t* sreg, uint8_t* out, std::size_t count, uint8_t carryMask)
+        {
+            for (auto i = std::size_t(0u); i < count; i++)
+            {
+                uint8_t d = rd[i];
+                uint8_t r = rr[i];
+                auto result = static_cast<uint8_t>(d + r + (sreg[i] & carryMask));
+                sreg[i] = ArithmeticFlags(sreg[i], result, AddCarries(d, r, result), AddOverflow(d, r, result));
+                out[i] = result;
+            }
+        }
+
+        AVR_EMU_LANE_KERNEL
+        void Subtract(const uint8_t* rd, const uint8_t* rr, uint8_t* sreg, uint8_t* out, std::size_t count, uint8_t carryMask)
+        {
+            for (auto i = std::size_t(0u); i < count; i++)
+            {
+                uint8_t d = rd[i];
+                uint8_t r = rr[i];
+                auto result = static_cast<uint8_t>(d - r - (sreg[i] & carryMask));
+                sreg[i] = ArithmeticFlags(sreg[i], result, SubtractBorrows(d, r, result), SubtractOverflow(d, r, result));
+                out[i] = result;
+            }
+        }
+
+        AVR_EMU_LANE_KERNEL
+        void And(const uint8_t* rd, const uint8_t* rr, uint8_t* sreg, uint8_t* out, std::size_t count)
+        {
+            for (auto i = std::size_t(0u); i < count; i++)
+            {
+                auto result = static_cast<uint8_t>(rd[i] & rr[i]);
+                sreg[i] = LogicFlags(sreg[i], result, 0u);
+                out[i] = result;
+            }
+        }
+
+        AVR_EMU_LANE_KERNEL
+        void Or(const uint8_t* rd, const uint8_t* rr, uint8_t* sreg, uint8_t* out, std::size_t count)
+        {
+            for (auto i = std::size_t(0u); i < count; i++)
+            {
+                auto result = static_cast<uint8_t>(rd[i] | rr[i]);
+                sreg[i] = LogicFlags(sreg[i], result, 0u);
+                out[i] = result;
+            }
+        }
+
+        AVR_EMU_LANE_KERNEL
+        void Eor(const uint8_t* rd, const uint8_t* rr, uint8_t* sreg, uint8_t* out, std::size_t count)
+        {
+            for (auto i = std::size_t(0u); i < count; i++)
+            {
+                auto result = static_cast<uint8_t>(rd[i] ^ rr[i]);
+                sreg[i] = LogicFlags(sreg[i], result, 0u);
+                out[i] = result;
+            }
+        }
+
+        AVR_EMU_LANE_KERNEL
+        void Increment(const uint8_t* rd, uint8_t* sreg, uint8_t* out, std::size_t count)
+        {
+            for (auto i = std::size_t(0u); i < count; i++)
+            {
+                auto result = static_cast<uint8_t>(rd[i] + 1u);
+                sreg[i] = LogicFlags(sreg[i], result, result == 0x80u);
+                out[i] = result;
+            }
+        }
+
+        AVR_EMU_LANE_KERNEL
+        void Decrement(const uint8_t* rd, uint8_t* sreg, uint8_t* out, std::size_t count)
+        {
+            for (auto i = std::size_t(0u); i < count; i++)
+            {
+                auto result = static_cast<uint8_t>(rd[i] - 1u);
+                sreg[i] = LogicFlags(sreg[i], result, result == 0x7Fu);
+                out[i] = result;
+            }
+        }
+
+        bool IsVectorizable(const DecodedInstruction& insn)
+        {
+            switch (insn.op)
+            {
+                case Operation::ADC:
+                case Operation::ADD:
+                case Operation::AND:
+                case Operation::ANDI:
+                case Operation::CP:
+                case Operation::CPC:
+                case Operation::CPI:
+                case Operation::DEC:
+                case Operation::EOR:
+                case Operation::INC:
+                case Operation::LDI:
+                case Operation::MOV:
+                case Operation::OR:
+                case Operation::ORI:
+                case Operation::SUBI:
+                    return insn.cycles != 0u;
+                case Operation::SUB:
+                    // SUBInstruction computes flags from the register it has
+                    // just cleared when both operands are the same register
+                    return insn.cycles != 0u && insn.rd != insn.rr;
+                default:
+                    return false;
+            }
+        }
+
+        bool HasImmediate(Operation op)
+        {
+            return op == Operation::ANDI || op == Operation::CPI || op == Operation::LDI ||
+                op == Operation::ORI || op == Operation::SUBI;
+        }
+
+        bool StoresResult(Operation op)
+        {
+            return op != Operation::CP && op != Operation::CPC && op != Operation::CPI;
+        }
+
+        uint16_t ReadWord(const ExecutionContext& ctx, uint16_t address)
+        {
+            return static_cast<uint16_t>(
+                ctx.progMem[address] | (ctx.progMem[static_cast<uint16_t>(address + 1u)] << 8u));
+        }
+
+        void RunKernel(const DecodedInstruction& insn, LaneRows& rows)
+        {
+            auto count = rows.count();
+            auto rr = static_cast<const uint8_t*>(nullptr);
+            if (HasImmediate(insn.op))
+                rr = rows.Immediate(static_cast<uint8_t>(insn.k));
+            else if (insn.op != Operation::INC && insn.op != Operation::DEC)
+                rr = rows.Read(insn.rr);
+            if (insn.op == Operation::MOV || insn.op == Operation::LDI)
+            {
+                // Only move their source
+                auto out = rows.Write(insn.rd);
+                if (out != rr)
+                    std::copy(rr, rr + count, out);
+                return;
+            }
+
+            auto rd = rows.Read(insn.rd);
+            auto sreg = rows.Update(LaneRows::SREG_ROW);
+            auto out = StoresResult(insn.op) ? rows.Update(insn.rd) : rows.Scratch();
+            switch (insn.op)
+            {
+                case Operation::ADD:  Add(rd, rr, sreg, out, count, 0u); break;
+                case Operation::ADC:  Add(rd, rr, sreg, out, count, SREG_C); break;
+                case Operation::SUB:
+                case Operation::SUBI:
+                case Operation::CP:
+                case Operation::CPI:  Subtract(rd, rr, sreg, out, count, 0u); break;
+                case Operation::CPC:  Subtract(rd, rr, sreg, out, count, SREG_C); break;
+                case Operation::AND:
+                case Operation::ANDI: And(rd, rr, sreg, out, count); break;
+                case Operation::OR:
+                case Operation::ORI:  Or(rd, rr, sreg, out, count); break;
+                case Operation::EOR:  Eor(rd, rr, sreg, out, count); break;
+                case Operation::INC:  Increment(rd, sreg, out, count); break;
+                case Operation::DEC:  Decrement(rd, sreg, out, count); break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    DecodedInstruction LockstepExecutor::FetchInstruction(ExecutionContext& ctx) const
+    {
+        auto address = ctx.cpu.PC;
+        if (!DecodeCache::IsCacheable(address))
+            return _dispatchTable->Decode(ctx.progMem, address);
+
+        auto& slot = ctx.decodeCache[address];
+        if (slot.executor == nullptr)
+            slot = _dispatchTable->Decode(ctx.progMem, address);
+        return slot;
+    }
+
+    // One instruction, or one stretch of sleep or idle loop, on a lane of
+    // its own
+    uint32_t LockstepExecutor::Step(ExecutionContext& ctx, uint32_t cyclesLeft) const
+    {
+        if (ctx.cpu.is_sleeping)
+            return SleepUntilWoken(_clock, ctx, cyclesLeft);
+
+        auto address = ctx.cpu.PC;
+        auto insn = FetchInstruction(ctx);
+        ctx.cpu.PC += sizeof(ctx.cpu.PC);
+        auto consumed = RetireCycles(_clock, ctx, insn.executor->ExecuteDecoded(insn, ctx));
+
+        if (insn.idleLoop && consumed < cyclesLeft)
+        {
+            auto skipped = FastForward(ctx, address, insn, cyclesLeft - consumed);
+            consumed += RetireCycles(_clock, ctx, skipped);
+        }
+        return consumed;
+    }
+
+    void LockstepExecutor::Execute(const std::vector<ExecutionContext*>& lanes, uint32_t cyclesRequested) const
+    {
+        auto consumed = std::vector<uint32_t>(lanes.size(), 0u);
+        for (auto i = std::size_t(0u); i < lanes.size(); i++)
+            consumed[i] = CatchUp(_clock, *lanes[i]);
+        auto group = std::vector<std::size_t>();
+        auto rows = LaneRows(lanes, group);
+        auto waitingAt = NO_PC;     // lowest PC of the running lanes outside the group
+        group.reserve(lanes.size());
+
+        // The group keeps running as one until its lanes part or reach a
+        // lane left waiting, and only then are all the lanes looked at again
+        auto together = [&] () {
+            auto pc = lanes[group.front()]->cpu.PC;
+            if (pc >= waitingAt)
+                return false;
+            for (auto lane : group)
+            {
+                auto& ctx = *lanes[lane];
+                if (consumed[lane] >= cyclesRequested || ctx.cpu.is_sleeping || ctx.cpu.PC != pc)
+                    return false;
+            }
+            return true;
+        };
+
+        auto regroup = true;
+        while (true)
+        {
+            if (regroup)
+            {
+                // Lowest PC first, so lanes which took a forward branch wait
+                // for the rest to catch up
+                auto found = false;
+                auto pc = uint16_t(0u);
+                for (auto i = std::size_t(0u); i < lanes.size(); i++)
+                {
+                    auto& ctx = *lanes[i];
+                    if (consumed[i] < cyclesRequested && ctx.cpu.is_sleeping)
+                        consumed[i] += SleepUntilWoken(_clock, ctx, cyclesRequested - consumed[i]);
+                    if (consumed[i] >= cyclesRequested)
+                        continue;
+                    if (!found || ctx.cpu.PC < pc)
+                        pc = ctx.cpu.PC;
+                    found = true;
+                }
+                if (!found)
+                    return;
+
+                group.clear();
+                waitingAt = NO_PC;
+                for (auto i = std::size_t(0u); i < lanes.size(); i++)
+                {
+                    if (consumed[i] >= cyclesRequested)
+                        continue;
+                    if (lanes[i]->cpu.PC == pc)
+                        group.push_back(i);
+                    else
+                        waitingAt = std::min<uint32_t>(waitingAt, lanes[i]->cpu.PC);
+                }
+                rows.Reset();
+                regroup = false;
+            }
+
+            auto pc = lanes[group.front()]->cpu.PC;
+            auto insn = FetchInstruction(*lanes[group.front()]);
+            if (group.size() == 1u || !IsVectorizable(insn))
+            {
+                rows.Flush();
+                for (auto lane : group)
+                    consumed[lane] += Step(*lanes[lane], cyclesRequested - consumed[lane]);
+                regroup = !together();
+                continue;
+            }
+
+            // Lanes whose code has been rewritten join a later group
+            auto rewritten = std::any_of(group.begin(), group.end(),
+                [&] (auto lane) { return ReadWord(*lanes[lane], pc) != insn.opcode; });
+            if (rewritten)
+            {
+                rows.Flush();
+                group.erase(
+                    std::remove_if(group.begin(), group.end(),
+                        [&] (auto lane) { return ReadWord(*lanes[lane], pc) != insn.opcode; }),
+                    group.end());
+                rows.Reset();
+                waitingAt = pc;
+            }
+
+            RunKernel(insn, rows);
+
+            // Events and interrupts look at the CPU, so lanes must have
+            // their registers back before any leaves the fast path
+            auto syncing = std::any_of(group.begin(), group.end(),
+                [&] (auto lane) { return lanes[lane]->cycles + insn.cycles >= lanes[lane]->syncAt; });
+            if (syncing)
+                rows.Flush();
+
+            auto finished = false;
+            for (auto lane : group)
+            {
+                auto& ctx = *lanes[lane];
+                ctx.cpu.PC = static_cast<uint16_t>(pc + sizeof(pc));
+                consumed[lane] += RetireCycles(_clock, ctx, insn.cycles);
+                finished |= consumed[lane] >= cyclesRequested;
+            }
+            regroup = (syncing || finished) ? !together() : pc + sizeof(pc) >= waitingAt;
+            if (regroup)
+                rows.Flush();
+        }
+    }
+
+    void LockstepExecutor::Execute(ContextArena& arena, uint32_t cyclesRequested) const
+    {
+        auto lanes = std::vector<ExecutionContext*>();
+        lanes.reserve(arena.size());
+        for (auto& ctx : arena)
+            lanes.push_back(&ctx);
+        Execute(lanes, cyclesRequested);
+    }
+
+    void LockstepExecutor::Execute(ExecutionContext& ctx, uint32_t cyclesRequested) const
+    {
+        Execute(std::vector<ExecutionContext*>{ &ctx }, cyclesRequested);
+    }
+
+    void LockstepExecutor::Interrupt(ExecutionContext& ctx, uint8_t interrupt) const
+    {
+        ctx.RaiseInterrupt(interrupt);
+    }
+}
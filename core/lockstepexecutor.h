@@ -0,0 +1,65 @@
+#pragma once
+
+#include "core/contextarena.h"
+#include "core/decodecache.h"
+#include "core/dispatchtable.h"
+#include "core/iclock.h"
+#include "core/iexecutor.h"
+#include "instructions/instructionexecutor.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace avr {
+    // Runs many contexts, typically the same firmware fed different inputs,
+    // side by side. Each step picks the lowest PC among the lanes still
+    // running and executes that instruction on every lane sitting at it,
+    // so lanes which branched apart are left waiting and regroup where
+    // their paths meet again. A group stays together without the lanes
+    // being looked at again until it parts or reaches a waiting lane.
+    // Register ALU instructions run as one loop over the group, built for
+    // AVX2 as well where the host supports it, on registers and SREG held
+    // a row per register across instructions, so a run of them gathers and
+    // scatters each register once. Everything else runs lane by lane as in
+    // Executor.
+    //
+    // Lanes must not share memory. Each runs exactly as it would have on
+    // its own; the clock is synchronized per lane, so pace batches with a
+    // NoopClock.
+    class LockstepExecutor : public IExecutor {
+        private:
+            IClock& _clock;
+            std::shared_ptr<const DispatchTable> _dispatchTable;
+
+            DecodedInstruction FetchInstruction(ExecutionContext& ctx) const;
+            uint32_t Step(ExecutionContext& ctx, uint32_t cyclesLeft) const;
+
+        public:
+            LockstepExecutor(
+                IClock& clock,
+                std::vector<std::unique_ptr<InstructionExecutor>>&& executors)
+                : _clock(clock),
+                  _dispatchTable(std::make_shared<const DispatchTable>(std::move(executors)))
+            {}
+
+            LockstepExecutor(
+                IClock& clock,
+                const std::shared_ptr<const DispatchTable>& dispatchTable)
+                : _clock(clock),
+                  _dispatchTable(dispatchTable)
+            {}
+
+            const std::shared_ptr<const DispatchTable>& GetDispatchTable() const
+            {
+                return _dispatchTable;
+            }
+
+            // Gives every lane cyclesRequested cycles, as Execute would
+            void Execute(const std::vector<ExecutionContext*>& lanes, uint32_t cyclesRequested) const;
+            void Execute(ContextArena& arena, uint32_t cyclesRequested) const;
+
+            void Execute(ExecutionContext& ctx, uint32_t cyclesRequested) const override;
+            void Interrupt(ExecutionContext& ctx, uint8_t interrupt) const override;
+    };
+}
@@ -1,6 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
 #ifndef AVR_EMU_RAM_SIZE
 #define AVR_EMU_RAM_SIZE 0x800u    // 2 K
 #endif
@@ -12,35 +19,225 @@
 #include <cstdint>
 
 namespace avr {
+    constexpr std::size_t RoundUpToPowerOfTwo(std::size_t value)
+    {
+        auto result = std::size_t(1u);
+        while (result < value)
+            result <<= 1u;
+        return result;
+    }
+
+    // Sizes are rounded up to a power of two so that addresses wrap with a
+    // mask rather than a divide.
+    //
+    // Snapshots are taken a page at a time. Pages already captured are
+    // immutable and shared, by reference count, between every snapshot and
+    // memory still holding the same contents; a page is only copied again
+    // once a write has dirtied it. Any non-const access counts as a write,
+    // so read through a const reference where that matters. Writes through
+    // pointers held elsewhere (CPU::R, CPU::GPIO) are not seen at all, and
+    // their owners must MarkDirty the page themselves.
     class Memory {
+        public:
+            constexpr static std::size_t PAGE_SIZE = 0x100u;
+
+            using Page = std::array<uint8_t, PAGE_SIZE>;
+            using Snapshot = std::vector<std::shared_ptr<const Page>>;
+
         private:
-            std::unique_ptr<uint8_t[]> _data;
+            std::unique_ptr<uint8_t[]> _owned;  // empty over external storage
+            std::shared_ptr<uint8_t> _mapping;  // set over a FlashImage mapping
+            uint8_t* _data;
             std::size_t _size;
+            std::size_t _mask;
+            Snapshot _pages;                // last captured contents of each page
+            std::vector<uint64_t> _dirty;   // pages written since captured
+
+            static std::size_t GetPageCount(std::size_t size)
+            {
+                return (size + PAGE_SIZE - 1u) / PAGE_SIZE;
+            }
+
+            std::size_t GetPageLength(std::size_t page) const
+            {
+                return std::min(PAGE_SIZE, _size - page * PAGE_SIZE);
+            }
+
+            bool IsDirty(std::size_t page) const
+            {
+                return (_dirty[page >> 6u] & (uint64_t(1u) << (page & 63u))) != 0u;
+            }
 
         public:
             Memory(std::size_t size)
-                : _data(std::make_unique<uint8_t[]>(size)),
-                  _size(size)
+                : _owned(std::make_unique<uint8_t[]>(RoundUpToPowerOfTwo(size))),
+                  _mapping(),
+                  _data(_owned.get()),
+                  _size(RoundUpToPowerOfTwo(size)),
+                  _mask(_size - 1u),
+                  _pages(GetPageCount(_size)),
+                  _dirty((GetPageCount(_size) + 63u) / 64u, ~uint64_t(0u))
             {}
 
+            // Over storage owned elsewhere, such as a ContextArena slab,
+            // which must outlive this memory. size must be a power of two.
+            Memory(uint8_t* storage, std::size_t size)
+                : _owned(),
+                  _mapping(),
+                  _data(storage),
+                  _size(size),
+                  _mask(_size - 1u),
+                  _pages(GetPageCount(_size)),
+                  _dirty((GetPageCount(_size) + 63u) / 64u, ~uint64_t(0u))
+            {
+                if (size != RoundUpToPowerOfTwo(size))
+                    throw std::string("External memory size must be a power of two");
+            }
+
+            // Over a mapping already holding the contents captured in pages,
+            // so nothing is dirty or copied until it is written. Used by
+            // FlashImage.
+            Memory(const std::shared_ptr<uint8_t>& mapping, std::size_t size, const Snapshot& pages)
+                : _owned(),
+                  _mapping(mapping),
+                  _data(_mapping.get()),
+                  _size(size),
+                  _mask(_size - 1u),
+                  _pages(pages),
+                  _dirty((pages.size() + 63u) / 64u, uint64_t(0u))
+            {
+                if (size != RoundUpToPowerOfTwo(size) || pages.size() != GetPageCount(size))
+                    throw std::string("Mapped memory must be a power of two in size and fully captured");
+            }
+
             Memory() = delete;
 
             uint8_t& operator[](uint16_t address)
             {
-                return _data[address % _size];
+                MarkDirty(address);
+                return _data[address & _mask];
             }
 
             const uint8_t& operator[](uint16_t address) const
             {
-                return _data[address % _size];
+                return _data[address & _mask];
+            }
+
+            // For callers which have already checked that address < size()
+            uint8_t& Unchecked(uint16_t address)
+            {
+                MarkDirty(address);
+                return _data[address];
+            }
+
+            const uint8_t& Unchecked(uint16_t address) const
+            {
+                return _data[address];
             }
 
             constexpr std::size_t size() const
             {
                 return _size;
             }
+
+            void MarkDirty(uint16_t address)
+            {
+                auto page = static_cast<std::size_t>(address & _mask) / PAGE_SIZE;
+                _dirty[page >> 6u] |= uint64_t(1u) << (page & 63u);
+            }
+
+            // Copies only the pages written since they were last captured
+            Snapshot TakeSnapshot()
+            {
+                for (auto page = 0u; page < _pages.size(); page++)
+                {
+                    if (!IsDirty(page))
+                        continue;
+
+                    auto copy = std::make_shared<Page>();
+                    std::memcpy(copy->data(), &_data[page * PAGE_SIZE], GetPageLength(page));
+                    _pages[page] = std::move(copy);
+                }
+                std::fill(_dirty.begin(), _dirty.end(), uint64_t(0u));
+                return _pages;
+            }
+
+            // Copies back only the pages which were written or differ from
+            // snapshot, calling restored(address, length) for each. The
+            // snapshot must have come from memory of the same size.
+            template <typename Callback>
+            void Restore(const Snapshot& snapshot, Callback&& restored)
+            {
+                if (snapshot.size() != _pages.size())
+                    throw std::string("Snapshot was taken of memory with a different size");
+
+                for (auto page = 0u; page < _pages.size(); page++)
+                {
+                    if (!IsDirty(page) && _pages[page] == snapshot[page])
+                        continue;
+
+                    auto length = GetPageLength(page);
+                    std::memcpy(&_data[page * PAGE_SIZE], snapshot[page]->data(), length);
+                    _pages[page] = snapshot[page];
+                    restored(static_cast<uint16_t>(page * PAGE_SIZE), length);
+                }
+                std::fill(_dirty.begin(), _dirty.end(), uint64_t(0u));
+            }
     };
 
     using SRAM = Memory;
     using ProgramMemory = Memory;
+
+    // Stands in for a Memory& which can be rebound, so that whatever holds
+    // one stays assignable. Converts to Memory& for code taking memory by
+    // reference.
+    class MemoryView {
+        private:
+            Memory* _memory;
+
+        public:
+            explicit MemoryView(Memory& memory)
+                : _memory(&memory)
+            {}
+
+            void Bind(Memory& memory)
+            {
+                _memory = &memory;
+            }
+
+            uint8_t& operator[](uint16_t address)
+            {
+                return (*_memory)[address];
+            }
+
+            const uint8_t& operator[](uint16_t address) const
+            {
+                return std::as_const(*_memory)[address];
+            }
+
+            uint8_t& Unchecked(uint16_t address)
+            {
+                return _memory->Unchecked(address);
+            }
+
+            const uint8_t& Unchecked(uint16_t address) const
+            {
+                return std::as_const(*_memory).Unchecked(address);
+            }
+
+            std::size_t size() const
+            {
+                return _memory->size();
+            }
+
+            operator Memory&()
+            {
+                return *_memory;
+            }
+
+            operator const Memory&() const
+            {
+                return *_memory;
+            }
+    };
 }
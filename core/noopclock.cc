@@ -1,12 +1,21 @@
 #include "core/noopclock.h"
 
+#include <cstdint>
+#include <limits>
+
 namespace avr
 {
     void NoopClock::Pulse()
     {
     }
 
-    void NoopClock::ConsumeCycle()
+    void NoopClock::Synchronize(uint64_t)
+    {
+    }
+
+    // Nothing to wait for, so executors need hardly ever call in
+    uint32_t NoopClock::Quantum() const
     {
+        return std::numeric_limits<uint32_t>::max();
     }
 }
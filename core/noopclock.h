@@ -2,11 +2,14 @@
 
 #include "core/iclock.h"
 
+#include <cstdint>
+
 namespace avr {
     class NoopClock : public IClock
     {
         public:
             void Pulse() override;
-            void ConsumeCycle() override;
+            void Synchronize(uint64_t cycles) override;
+            uint32_t Quantum() const override;
     };
 }
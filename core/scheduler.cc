@@ -0,0 +1,196 @@
+#include "core/executioncontext.h"
+#include "core/scheduler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+namespace avr {
+    Scheduler::Scheduler()
+        : _events(),
+          _free(),
+          _lists(),
+          _occupied(),
+          _cursor(0u),
+          _serial(0u),
+          _count(0u),
+          _nextDue(NEVER),
+          _nextDueKnown(true)
+    {
+        _lists.fill(List{NONE, NONE});
+    }
+
+    // The level is the highest group of bits in which due differs from the
+    // cursor, so every event on a level sorts after the cursor's own slot on
+    // it. Anything already due shares the cursor's slot on level 0.
+    uint32_t Scheduler::ListFor(uint64_t due) const
+    {
+        auto key = std::max(due, _cursor);
+        auto differs = key ^ _cursor;
+        if ((differs >> (LEVELS * SLOT_BITS)) != 0u)
+            return FAR_FUTURE;
+
+        auto level = differs == 0u ? 0u : static_cast<uint32_t>(63 - __builtin_clzll(differs)) / SLOT_BITS;
+        auto slot = static_cast<uint32_t>(key >> (level * SLOT_BITS)) & (SLOTS - 1u);
+        return level * SLOTS + slot;
+    }
+
+    // Level 0 lists are kept in the order their events run, which is
+    // nearly always the order they arrive in
+    void Scheduler::Link(uint32_t index)
+    {
+        auto& event = _events[index];
+        event.list = ListFor(event.due);
+        auto& list = _lists[event.list];
+
+        auto prev = list.tail;
+        if (event.list < SLOTS)
+            while (prev != NONE && (_events[prev].due > event.due ||
+                   (_events[prev].due == event.due && _events[prev].id > event.id)))
+                prev = _events[prev].prev;
+
+        auto next = prev == NONE ? list.head : _events[prev].next;
+        event.prev = prev;
+        event.next = next;
+        (prev == NONE ? list.head : _events[prev].next) = index;
+        (next == NONE ? list.tail : _events[next].prev) = index;
+
+        if (event.list != FAR_FUTURE)
+            _occupied[event.list / SLOTS] |= uint64_t(1u) << (event.list % SLOTS);
+    }
+
+    void Scheduler::Unlink(uint32_t index)
+    {
+        auto& event = _events[index];
+        auto& list = _lists[event.list];
+        (event.prev == NONE ? list.head : _events[event.prev].next) = event.next;
+        (event.next == NONE ? list.tail : _events[event.next].prev) = event.prev;
+
+        if (list.head == NONE && event.list != FAR_FUTURE)
+            _occupied[event.list / SLOTS] &= ~(uint64_t(1u) << (event.list % SLOTS));
+        event.list = NONE;
+    }
+
+    void Scheduler::Release(uint32_t index)
+    {
+        _events[index].action = nullptr;
+        _free.push_back(index);
+        _count--;
+    }
+
+    // cursor must be the earliest due cycle on the wheels. Only the list it
+    // falls in can hold events which now belong on a lower level; everything
+    // else is either above it or further out on the same level.
+    void Scheduler::MoveCursor(uint64_t cursor)
+    {
+        if (cursor <= _cursor)
+            return;
+
+        auto list = ListFor(cursor);
+        _cursor = cursor;
+        if (list < SLOTS)
+            return;
+
+        auto index = _lists[list].head;
+        _lists[list] = List{NONE, NONE};
+        if (list != FAR_FUTURE)
+            _occupied[list / SLOTS] &= ~(uint64_t(1u) << (list % SLOTS));
+
+        while (index != NONE)
+        {
+            auto next = _events[index].next;
+            Link(index);
+            index = next;
+        }
+    }
+
+    // The first occupied slot on the lowest occupied level holds the
+    // earliest events. Level 0 slots are a single cycle wide and sorted;
+    // wider slots are searched.
+    uint64_t Scheduler::FindNextDue() const
+    {
+        if (_count == 0u)
+            return NEVER;
+
+        auto list = FAR_FUTURE;
+        for (auto level = 0u; level < LEVELS; level++)
+        {
+            if (_occupied[level] == 0u)
+                continue;
+
+            list = level * SLOTS + static_cast<uint32_t>(__builtin_ctzll(_occupied[level]));
+            if (level == 0u)
+                return _events[_lists[list].head].due;
+            break;
+        }
+
+        auto due = NEVER;
+        for (auto index = _lists[list].head; index != NONE; index = _events[index].next)
+            due = std::min(due, _events[index].due);
+        return due;
+    }
+
+    Scheduler::EventId Scheduler::Schedule(uint64_t due, Action action)
+    {
+        auto index = static_cast<uint32_t>(_events.size());
+        if (!_free.empty())
+        {
+            index = _free.back();
+            _free.pop_back();
+        }
+        else
+            _events.emplace_back();
+
+        auto id = (_serial++ << INDEX_BITS) | index;
+        auto& event = _events[index];
+        event.due = due;
+        event.id = id;
+        event.action = std::move(action);
+        Link(index);
+        _count++;
+
+        if (_nextDueKnown)
+            _nextDue = std::min(_nextDue, due);
+        return id;
+    }
+
+    bool Scheduler::Cancel(EventId id)
+    {
+        auto index = static_cast<uint32_t>(id & ((uint64_t(1u) << INDEX_BITS) - 1u));
+        if (index >= _events.size() || _events[index].list == NONE || _events[index].id != id)
+            return false;
+
+        if (_nextDueKnown && _events[index].due <= _nextDue)
+            _nextDueKnown = false;
+        Unlink(index);
+        Release(index);
+        return true;
+    }
+
+    void Scheduler::RunDue(ExecutionContext& ctx)
+    {
+        while (NextDue() <= ctx.cycles)
+        {
+            MoveCursor(NextDue());
+            auto index = _lists[_cursor & (SLOTS - 1u)].head;
+
+            auto action = std::move(_events[index].action);
+            Unlink(index);
+            Release(index);
+            _nextDueKnown = false;
+
+            action(ctx);
+        }
+    }
+
+    void Scheduler::Clear()
+    {
+        _events.clear();
+        _free.clear();
+        _lists.fill(List{NONE, NONE});
+        _occupied.fill(0u);
+        _count = 0u;
+        _nextDue = NEVER;
+        _nextDueKnown = true;
+    }
+}
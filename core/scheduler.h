@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace avr {
+    struct ExecutionContext;
+
+    // Actions due at a given ExecutionContext::cycles count, such as a
+    // peripheral reaching its next state change. Executors run every event
+    // that has fallen due as soon as the instruction in flight retires.
+    //
+    // Events hang off a hierarchical timing wheel: LEVELS wheels of SLOTS
+    // lists each, level n holding events whose due cycle first differs from
+    // the wheel's cursor in the nth group of SLOT_BITS bits. Scheduling and
+    // cancelling only link or unlink a list node. Running events moves the
+    // cursor straight to the earliest one, spilling the single list it lands
+    // in down a level, rather than turning the wheels a slot at a time.
+    // Events further out than the wheels reach wait on one overflow list.
+    class Scheduler {
+        public:
+            using Action = std::function<void(ExecutionContext&)>;
+            using EventId = uint64_t;
+
+            constexpr static uint64_t NEVER = std::numeric_limits<uint64_t>::max();
+
+            constexpr static uint32_t SLOT_BITS = 6u;
+            constexpr static uint32_t SLOTS = 1u << SLOT_BITS;
+            constexpr static uint32_t LEVELS = 6u;
+
+        private:
+            constexpr static uint32_t NONE = std::numeric_limits<uint32_t>::max();
+            constexpr static uint32_t FAR_FUTURE = LEVELS * SLOTS;
+            constexpr static uint32_t INDEX_BITS = 24u;
+
+            // Pool entry, linked into one list while scheduled. The id has a
+            // serial number above the entry's index, so ids order events by
+            // when they were scheduled.
+            struct Event {
+                uint64_t due;
+                EventId id;
+                Action action;
+                uint32_t list;  // NONE while free
+                uint32_t prev;
+                uint32_t next;
+            };
+
+            struct List {
+                uint32_t head;
+                uint32_t tail;
+            };
+
+            std::vector<Event> _events;
+            std::vector<uint32_t> _free;
+            std::array<List, FAR_FUTURE + 1u> _lists;
+            std::array<uint64_t, LEVELS> _occupied;     // a bit per non-empty slot
+            uint64_t _cursor;   // no event is placed before it
+            uint64_t _serial;
+            std::size_t _count;
+            mutable uint64_t _nextDue;
+            mutable bool _nextDueKnown;
+
+            uint32_t ListFor(uint64_t due) const;
+            void Link(uint32_t index);
+            void Unlink(uint32_t index);
+            void Release(uint32_t index);
+            void MoveCursor(uint64_t cursor);
+            uint64_t FindNextDue() const;
+
+        public:
+            Scheduler();
+
+            // NEVER while nothing is scheduled. Cached, so only the first
+            // call after the earliest event runs or is cancelled looks at
+            // the wheels.
+            uint64_t NextDue() const
+            {
+                if (!_nextDueKnown)
+                {
+                    _nextDue = FindNextDue();
+                    _nextDueKnown = true;
+                }
+                return _nextDue;
+            }
+
+            bool Empty() const
+            {
+                return _count == 0u;
+            }
+
+            // Events due at the same cycle run in the order scheduled
+            EventId Schedule(uint64_t due, Action action);
+
+            // Returns false when the event has already run or been cancelled
+            bool Cancel(EventId id);
+
+            // Runs, in order, every event due at or before ctx.cycles,
+            // including any the actions themselves schedule in that window
+            void RunDue(ExecutionContext& ctx);
+
+            void Clear();
+    };
+}
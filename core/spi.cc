@@ -0,0 +1,200 @@
+#include "core/executioncontext.h"
+#include "core/scheduler.h"
+#include "core/spi.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace avr {
+    Spi::Spi(const SpiLayout& layout)
+        : _layout(layout),
+          _devices(),
+          _spcr(0u),
+          _spsr(0u),
+          _spdr(0u),
+          _received(0u),
+          _flagsRead(false),
+          _busy(false),
+          _doneAt(0u),
+          _scheduled(false),
+          _event(0u)
+    {}
+
+    std::shared_ptr<Spi> Spi::Attach(ExecutionContext& ctx, const SpiLayout& layout)
+    {
+        auto spi = std::make_shared<Spi>(layout);
+        auto read = [spi] (ExecutionContext& ctx, uint16_t address) {
+            return spi->Read(ctx, address);
+        };
+        auto write = [spi] (ExecutionContext& ctx, uint16_t address, uint8_t value) {
+            spi->Write(ctx, address, value);
+        };
+
+        for (auto address : { layout.spcr, layout.spsr, layout.spdr, layout.port })
+            ctx.io.Map(address, read, write);
+        return spi;
+    }
+
+    void Spi::Connect(uint8_t pin, std::shared_ptr<ISpiDevice> device)
+    {
+        using namespace std::string_literals;
+        if (pin >= 8u)
+            throw "Chip select pin out of range: "s + std::to_string(pin);
+        _devices.emplace_back(pin, std::move(device));
+    }
+
+    uint64_t Spi::TransferCycles() const
+    {
+        constexpr uint64_t dividers[] = { 4u, 16u, 64u, 128u };
+        auto divider = dividers[_spcr & 0x03u];
+        if (_spsr & SPI2X)
+            divider /= 2u;
+        return 8u * divider;
+    }
+
+    void Spi::SetFlag(ExecutionContext& ctx)
+    {
+        _spsr |= SPIF;
+        if (_spcr & SPIE)
+            ctx.RaiseInterrupt(_layout.interrupt);
+    }
+
+    void Spi::ClearFlags(ExecutionContext& ctx)
+    {
+        _spsr &= static_cast<uint8_t>(~(SPIF | WCOL));
+        _flagsRead = false;
+        ctx.ClearInterrupt(_layout.interrupt);
+    }
+
+    // A set SPIF whose interrupt is enabled but no longer pending has been
+    // vectored, which clears it on the hardware
+    void Spi::Acknowledge(ExecutionContext& ctx)
+    {
+        auto pending = (ctx.pendingInterrupts & (uint64_t(1u) << _layout.interrupt)) != 0u;
+        if ((_spsr & SPIF) && (_spcr & SPIE) && !pending)
+        {
+            _spsr &= static_cast<uint8_t>(~SPIF);
+            _flagsRead = false;
+        }
+    }
+
+    // The answer only shows in SPDR once the last bit is clocked in. SPIF
+    // stays set until Acknowledge sees its interrupt vectored or the
+    // firmware reads SPSR and then SPDR, so it can be polled too.
+    void Spi::Advance(ExecutionContext& ctx)
+    {
+        Acknowledge(ctx);
+        if (!_busy || ctx.cycles < _doneAt)
+            return;
+
+        _busy = false;
+        _spdr = _received;
+        SetFlag(ctx);
+    }
+
+    void Spi::Reschedule(ExecutionContext& ctx)
+    {
+        if (_scheduled)
+        {
+            ctx.scheduler.Cancel(_event);
+            _scheduled = false;
+        }
+        if (!_busy || !(_spcr & SPIE))
+            return;
+
+        _event = ctx.scheduler.Schedule(_doneAt, [self = shared_from_this()] (ExecutionContext& ctx) {
+            self->_scheduled = false;
+            self->Advance(ctx);
+        });
+        _scheduled = true;
+    }
+
+    // Devices answer as the byte is written. With several selected, any of
+    // them driving a bit low wins.
+    void Spi::Start(ExecutionContext& ctx, uint8_t value)
+    {
+        _received = 0xFFu;
+        auto port = std::as_const(ctx.ram)[_layout.port];
+        for (auto& device : _devices)
+        {
+            if (port & (0x1u << device.first))
+                continue;
+
+            auto miso = uint8_t(0xFFu);
+            device.second->Transfer(&value, &miso, 1u);
+            _received &= miso;
+        }
+
+        _busy = true;
+        _doneAt = ctx.cycles + TransferCycles();
+    }
+
+    // Every device sees its own chip select pin change, selected devices
+    // last so nothing answers on a bus shared with one just released
+    void Spi::WritePort(ExecutionContext& ctx, uint8_t value)
+    {
+        auto previous = std::as_const(ctx.ram)[_layout.port];
+        ctx.ram[_layout.port] = value;
+
+        auto released = static_cast<uint8_t>(value & ~previous);
+        auto selected = static_cast<uint8_t>(previous & ~value);
+        for (auto& device : _devices)
+            if (released & (0x1u << device.first))
+                device.second->Deselect();
+        for (auto& device : _devices)
+            if (selected & (0x1u << device.first))
+                device.second->Select();
+    }
+
+    uint8_t Spi::Read(ExecutionContext& ctx, uint16_t address)
+    {
+        Advance(ctx);
+        if (address == _layout.port)
+            return std::as_const(ctx.ram)[address];
+        if (address == _layout.spcr)
+            return _spcr;
+        if (address == _layout.spsr)
+        {
+            _flagsRead = (_spsr & SPIF) != 0u;
+            return _spsr;
+        }
+
+        if (_flagsRead)
+            ClearFlags(ctx);
+        return _spdr;
+    }
+
+    void Spi::Write(ExecutionContext& ctx, uint16_t address, uint8_t value)
+    {
+        Advance(ctx);
+        if (address == _layout.port)
+            WritePort(ctx, value);
+        else if (address == _layout.spcr)
+        {
+            // Only the interrupt goes with SPIE; SPIF stays for polling
+            if (!(value & SPIE))
+                ctx.ClearInterrupt(_layout.interrupt);
+            else if (!(_spcr & SPIE) && (_spsr & SPIF))
+                ctx.RaiseInterrupt(_layout.interrupt);
+            _spcr = value;
+        }
+        else if (address == _layout.spsr)
+            _spsr = static_cast<uint8_t>((_spsr & ~SPI2X) | (value & SPI2X));
+        else
+        {
+            if (_flagsRead)
+                ClearFlags(ctx);
+
+            if (_busy)
+                _spsr |= WCOL;
+            else if ((_spcr & SPE) && (_spcr & MSTR))
+                Start(ctx, value);
+            else
+                _spdr = value;
+        }
+
+        Reschedule(ctx);
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "core/executioncontext.h"
+#include "core/ispidevice.h"
+#include "core/scheduler.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace avr {
+    // Where the SPI's registers sit in data space, the port its chip select
+    // pins are on and the interrupt it raises, numbered as the ATmega328P
+    // numbers its vectors
+    struct SpiLayout {
+        uint16_t spcr;
+        uint16_t spsr;
+        uint16_t spdr;
+        uint16_t port;
+        uint8_t interrupt;
+    };
+
+    constexpr SpiLayout SPI_LAYOUT = { 0x4Cu, 0x4Du, 0x4Eu, 0x25u, 17u };
+
+    // The SPI controller in master mode on the I/O bus. Each byte written
+    // to SPDR goes to every device whose chip select pin is low, and their
+    // answer lands in SPDR once the eight SCK periods SPR and SPI2X give are
+    // over. Like TimerCounter, SPIF is worked out when SPSR is read and the
+    // transfer is only scheduled when SPIE wants an interrupt from it.
+    //
+    // The port holding the chip select pins is mapped too, so changes to
+    // the pins reach the devices; everything written to it is still kept
+    // in RAM. Slave mode, data order and clock polarity and phase are not
+    // modelled.
+    class Spi : public std::enable_shared_from_this<Spi> {
+        private:
+            enum Flag : uint8_t {
+                SPI2X = 0x01u,
+                WCOL = 0x40u,
+                SPIF = 0x80u
+            };
+
+            enum Control : uint8_t {
+                MSTR = 0x10u,
+                SPE = 0x40u,
+                SPIE = 0x80u
+            };
+
+            SpiLayout _layout;
+            std::vector<std::pair<uint8_t, std::shared_ptr<ISpiDevice>>> _devices;
+            uint8_t _spcr;
+            uint8_t _spsr;
+            uint8_t _spdr;
+            uint8_t _received;
+            bool _flagsRead;        // SPIF was seen set, so an SPDR access clears it
+            bool _busy;
+            uint64_t _doneAt;
+            bool _scheduled;
+            Scheduler::EventId _event;
+
+            uint64_t TransferCycles() const;
+            void SetFlag(ExecutionContext& ctx);
+            void ClearFlags(ExecutionContext& ctx);
+            void Acknowledge(ExecutionContext& ctx);
+            void Advance(ExecutionContext& ctx);
+            void Reschedule(ExecutionContext& ctx);
+            void Start(ExecutionContext& ctx, uint8_t value);
+            void WritePort(ExecutionContext& ctx, uint8_t value);
+
+            uint8_t Read(ExecutionContext& ctx, uint16_t address);
+            void Write(ExecutionContext& ctx, uint16_t address, uint8_t value);
+
+        public:
+            explicit Spi(const SpiLayout& layout);
+
+            // Maps the SPI's registers and chip select port on ctx.io. The
+            // bus and any event scheduled keep the SPI alive.
+            static std::shared_ptr<Spi> Attach(ExecutionContext& ctx, const SpiLayout& layout);
+
+            // Puts device on the bus, selected while bit pin of the port is
+            // low
+            void Connect(uint8_t pin, std::shared_ptr<ISpiDevice> device);
+    };
+}
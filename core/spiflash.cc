@@ -0,0 +1,209 @@
+#include "core/spiflash.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace avr {
+    namespace {
+        enum Command : uint8_t {
+            PAGE_PROGRAM = 0x02u,
+            READ = 0x03u,
+            WRITE_DISABLE = 0x04u,
+            READ_STATUS = 0x05u,
+            WRITE_ENABLE = 0x06u,
+            FAST_READ = 0x0Bu,
+            SECTOR_ERASE = 0x20u,
+            CHIP_ERASE_ALT = 0x60u,
+            JEDEC_ID = 0x9Fu,
+            CHIP_ERASE = 0xC7u,
+            BLOCK_ERASE = 0xD8u,
+            NONE = 0xFFu
+        };
+
+        constexpr std::size_t ADDRESS_END = 4u;     // command and three address bytes
+        constexpr uint32_t PAGE_SIZE = 0x100u;
+    }
+
+    SpiFlash::SpiFlash(const std::string& path, bool writeBack)
+        : _data(nullptr),
+          _size(0u),
+          _status(0u),
+          _command(NONE),
+          _received(0u),
+          _address(0u)
+    {
+        using namespace std::string_literals;
+        auto fd = open(path.c_str(), (writeBack ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+        if (fd < 0)
+            throw "Unable to open flash image "s + path + ": "s + std::strerror(errno);
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size <= 0)
+        {
+            close(fd);
+            throw "Flash image "s + path + " is empty"s;
+        }
+        _size = static_cast<std::size_t>(info.st_size);
+
+        auto memory = mmap(nullptr, _size, PROT_READ | PROT_WRITE, writeBack ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (memory == MAP_FAILED)
+            throw "Unable to map flash image "s + path + ": "s + std::strerror(errno);
+        _data = static_cast<uint8_t*>(memory);
+        madvise(_data, _size, MADV_SEQUENTIAL);
+    }
+
+    SpiFlash::~SpiFlash()
+    {
+        munmap(_data, _size);
+    }
+
+    uint32_t SpiFlash::Wrap(uint32_t address) const
+    {
+        return static_cast<uint32_t>(address % _size);
+    }
+
+    void SpiFlash::Erase(uint32_t address, std::size_t length)
+    {
+        auto start = Wrap(address) & ~static_cast<uint32_t>(length - 1u);
+        std::memset(_data + start, 0xFF, std::min(length, _size - start));
+    }
+
+    void SpiFlash::Select()
+    {
+        _command = NONE;
+        _received = 0u;
+        _address = 0u;
+    }
+
+    // Programs and erases are carried out as chip select goes high, and
+    // only when WEL was set and the command was complete
+    void SpiFlash::Deselect()
+    {
+        auto complete = _received == (_command == CHIP_ERASE || _command == CHIP_ERASE_ALT ? 1u : ADDRESS_END);
+        if (_status & WEL)
+        {
+            if (_command == SECTOR_ERASE && complete)
+                Erase(_address, 0x1000u);
+            else if (_command == BLOCK_ERASE && complete)
+                Erase(_address, 0x10000u);
+            else if ((_command == CHIP_ERASE || _command == CHIP_ERASE_ALT) && complete)
+                std::memset(_data, 0xFF, _size);
+        }
+
+        switch (_command)
+        {
+            case PAGE_PROGRAM:
+            case SECTOR_ERASE:
+            case BLOCK_ERASE:
+            case CHIP_ERASE:
+            case CHIP_ERASE_ALT:
+            case WRITE_DISABLE:
+                _status &= static_cast<uint8_t>(~WEL);
+                break;
+            case WRITE_ENABLE:
+                _status |= WEL;
+                break;
+            default:
+                break;
+        }
+        _command = NONE;
+        _received = 0u;
+    }
+
+    uint8_t SpiFlash::Shift(uint8_t value)
+    {
+        auto index = _received++;
+        if (index == 0u)
+        {
+            _command = value;
+            return 0xFFu;
+        }
+
+        switch (_command)
+        {
+            case READ_STATUS:
+                return _status;
+
+            case JEDEC_ID:
+            {
+                // Winbond, with the capacity given as a power of two
+                auto capacity = uint8_t(0u);
+                while ((std::size_t(1u) << capacity) < _size)
+                    capacity++;
+                const uint8_t id[] = { 0xEFu, 0x40u, capacity };
+                return index <= 3u ? id[index - 1u] : 0xFFu;
+            }
+
+            case READ:
+            case FAST_READ:
+            case PAGE_PROGRAM:
+            case SECTOR_ERASE:
+            case BLOCK_ERASE:
+                if (index < ADDRESS_END)
+                {
+                    _address = (_address << 8) | value;
+                    return 0xFFu;
+                }
+                break;
+
+            default:
+                return 0xFFu;
+        }
+
+        if (_command == PAGE_PROGRAM)
+        {
+            // Bytes past the end of the page wrap to its start
+            if (_status & WEL)
+            {
+                auto offset = static_cast<uint32_t>(index - ADDRESS_END);
+                auto address = Wrap((_address & ~(PAGE_SIZE - 1u)) | ((_address + offset) & (PAGE_SIZE - 1u)));
+                _data[address] &= value;
+            }
+            return 0xFFu;
+        }
+
+        auto offset = index - ADDRESS_END;
+        if (_command == FAST_READ)
+        {
+            if (offset == 0u)
+                return 0xFFu;   // dummy byte
+            offset--;
+        }
+        if (_command == READ || _command == FAST_READ)
+            return _data[Wrap(static_cast<uint32_t>(_address + offset))];
+        return 0xFFu;
+    }
+
+    // Reads past the address copy straight out of the image rather than a
+    // byte at a time
+    void SpiFlash::Transfer(const uint8_t* mosi, uint8_t* miso, std::size_t length)
+    {
+        auto dataStart = ADDRESS_END + (_command == FAST_READ ? 1u : 0u);
+        while (length > 0u && !((_command == READ || _command == FAST_READ) && _received >= dataStart))
+        {
+            *miso++ = Shift(*mosi++);
+            length--;
+            dataStart = ADDRESS_END + (_command == FAST_READ ? 1u : 0u);
+        }
+
+        while (length > 0u)
+        {
+            auto start = Wrap(static_cast<uint32_t>(_address + (_received - dataStart)));
+            auto count = std::min(length, _size - start);
+            std::memcpy(miso, _data + start, count);
+            miso += count;
+            _received += count;
+            length -= count;
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "core/ispidevice.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace avr {
+    // A 25-series serial NOR flash, such as a W25Q, whose contents are an
+    // image file mapped into memory, so reads and writes touch the image in
+    // place however large it is. With writeBack the mapping is shared and
+    // programs and erases reach the file; otherwise they stay private to
+    // this device.
+    //
+    // Understands READ (0x03), FAST READ (0x0B), READ STATUS (0x05), JEDEC
+    // ID (0x9F), WRITE ENABLE and DISABLE (0x06 and 0x04), PAGE PROGRAM
+    // (0x02), 4K and 64K block erase (0x20 and 0xD8) and chip erase (0xC7
+    // and 0x60). Programming only clears bits, and programs and erases
+    // finish at once, so the status register never reads busy. Addresses
+    // wrap at the end of the image.
+    class SpiFlash : public ISpiDevice {
+        private:
+            enum Status : uint8_t {
+                WEL = 0x02u
+            };
+
+            uint8_t* _data;
+            std::size_t _size;
+            uint8_t _status;
+
+            uint8_t _command;
+            std::size_t _received;  // bytes of the transaction so far
+            uint32_t _address;
+
+            uint32_t Wrap(uint32_t address) const;
+            void Erase(uint32_t address, std::size_t length);
+            uint8_t Shift(uint8_t value);
+
+        public:
+            SpiFlash(const std::string& path, bool writeBack = false);
+            ~SpiFlash();
+
+            SpiFlash(const SpiFlash&) = delete;
+            SpiFlash& operator=(const SpiFlash&) = delete;
+
+            std::size_t size() const
+            {
+                return _size;
+            }
+
+            const uint8_t* data() const
+            {
+                return _data;
+            }
+
+            void Select() override;
+            void Deselect() override;
+            void Transfer(const uint8_t* mosi, uint8_t* miso, std::size_t length) override;
+    };
+}
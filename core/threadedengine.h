@@ -0,0 +1,322 @@
+#pragma once
+
+#include "core/cpu.h"
+#include "core/cycles.h"
+#include "core/decodecache.h"
+#include "core/executioncontext.h"
+#include "core/flags.h"
+#include "core/idleloop.h"
+#include "core/iobus.h"
+#include "core/iclock.h"
+#include "instructions/instructionexecutor.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#if !defined(__GNUC__)
+#error "The threaded engine requires the labels as values extension (GCC or Clang)"
+#endif
+
+namespace avr {
+    namespace threaded {
+        inline bool GetFlag(const CPU& cpu, uint8_t index)
+        {
+            switch (index)
+            {
+                case 0u: return cpu.SREG.C;
+                case 1u: return cpu.SREG.Z;
+                case 2u: return cpu.SREG.N;
+                case 3u: return cpu.SREG.V;
+                case 4u: return cpu.SREG.S;
+                case 5u: return cpu.SREG.H;
+                case 6u: return cpu.SREG.T;
+                default: return cpu.SREG.I;
+            }
+        }
+
+        // Runs the handlers for instructions supplied by stream until the cycle
+        // budget is spent, letting time pass while the CPU sleeps.
+        // Stream::Next returns the instruction at the current PC with its
+        // handler resolved from the table it is passed, given the cycles
+        // which can run before the budget is spent or RetireCycles has to
+        // look at events, the clock or interrupts.
+        template <typename Stream>
+        void Run(IClock& clock, ExecutionContext& ctx, uint32_t cyclesRequested, Stream& stream)
+        {
+            // Must follow the order of the Operation enumeration
+            static const void* const handlers[] = {
+                &&Generic,
+                &&ADC, &&ADD, &&AND, &&ANDI, &&BRBC, &&CALL, &&CP, &&CPC, &&CPI,
+                &&CPSE, &&DEC, &&EOR, &&INC, &&JMP, &&LDI, &&LDS, &&MOV, &&OR,
+                &&ORI, &&RJMP, &&SBIC, &&SBIS, &&STS, &&SUB, &&SUBI,
+            };
+            static_assert(
+                sizeof(handlers) / sizeof(handlers[0]) == static_cast<std::size_t>(Operation::Count),
+                "Every Operation requires a handler");
+
+            auto& cpu = ctx.cpu;
+            auto cyclesConsumed = CatchUp(clock, ctx);
+            const DecodedInstruction* insn = nullptr;
+
+// Fetching advances PC past the opcode before the handler runs, exactly as
+// Executor::Execute does, so relative offsets keep their meaning
+#define AVR_EMU_DISPATCH() \
+            do { \
+                if (cpu.is_sleeping && cyclesConsumed < cyclesRequested) \
+                    cyclesConsumed += SleepUntilWoken(clock, ctx, cyclesRequested - cyclesConsumed); \
+                if (cyclesConsumed >= cyclesRequested) \
+                    return; \
+                insn = &stream.Next(ctx, handlers, CyclesBeforeSync(ctx, cyclesRequested - cyclesConsumed)); \
+                cpu.PC += sizeof(cpu.PC); \
+                goto *insn->handler; \
+            } while (false)
+
+#define AVR_EMU_RETIRE(cycles) \
+            do { \
+                cyclesConsumed += RetireCycles(clock, ctx, (cycles)); \
+                AVR_EMU_DISPATCH(); \
+            } while (false)
+
+// A branch taken back to the head of an idle loop lets the loop run on
+// without interpreting it, up to the budget or the next scheduled event
+#define AVR_EMU_RETIRE_BRANCH(address) \
+            do { \
+                cyclesConsumed += RetireCycles(clock, ctx, 2u); \
+                if (insn->idleLoop && cyclesConsumed < cyclesRequested) \
+                { \
+                    auto skipped = FastForward(ctx, (address), *insn, cyclesRequested - cyclesConsumed); \
+                    cyclesConsumed += RetireCycles(clock, ctx, skipped); \
+                } \
+                AVR_EMU_DISPATCH(); \
+            } while (false)
+
+// Skipping costs a cycle per skipped word on top of the compare, matching
+// CPSEInstruction, SBICInstruction and SBISInstruction
+#define AVR_EMU_SKIP() AVR_EMU_RETIRE(1u + insn->skip)
+
+            AVR_EMU_DISPATCH();
+
+        Generic:
+            {
+                auto cycles = insn->executor->ExecuteDecoded(*insn, ctx);
+                AVR_EMU_RETIRE(cycles);
+            }
+
+        ADC:
+            {
+                auto& rr = cpu.R[insn->rr];
+                auto& rd = cpu.R[insn->rd];
+                auto value = static_cast<uint8_t>(rr + rd + cpu.SREG.C);
+                SetAddFlags(cpu, rd, rr, value);
+                rd = value;
+                AVR_EMU_RETIRE(1u);
+            }
+
+        ADD:
+            {
+                auto& rr = cpu.R[insn->rr];
+                auto& rd = cpu.R[insn->rd];
+                auto value = static_cast<uint8_t>(rr + rd);
+                SetAddFlags(cpu, rd, rr, value);
+                rd = value;
+                AVR_EMU_RETIRE(1u);
+            }
+
+        AND:
+            {
+                auto& rd = cpu.R[insn->rd];
+                rd = static_cast<uint8_t>(cpu.R[insn->rr] & rd);
+                SetLogicFlags(cpu, rd);
+                AVR_EMU_RETIRE(1u);
+            }
+
+        ANDI:
+            {
+                auto& rd = cpu.R[insn->rd];
+                rd = static_cast<uint8_t>(rd & insn->k);
+                SetLogicFlags(cpu, rd);
+                AVR_EMU_RETIRE(1u);
+            }
+
+        BRBC:
+            {
+                auto branchIfSet = (insn->opcode & 0x0400u) == 0u;
+                if (GetFlag(cpu, insn->rr) != branchIfSet)
+                    AVR_EMU_RETIRE(1u);
+
+                auto address = static_cast<uint16_t>(cpu.PC - sizeof(cpu.PC));
+                cpu.PC = static_cast<uint16_t>(cpu.PC + insn->k);
+                AVR_EMU_RETIRE_BRANCH(address);
+            }
+
+        CALL:
+            {
+                auto returnAddress = static_cast<uint16_t>(cpu.PC + sizeof(cpu.PC));
+                ctx.ram[cpu.SP--] = static_cast<uint8_t>(returnAddress & 0xFFu);
+                ctx.ram[cpu.SP--] = static_cast<uint8_t>((returnAddress >> 8u) & 0xFFu);
+                cpu.PC = insn->k;
+                AVR_EMU_RETIRE(4u);
+            }
+
+        CP:
+            {
+                auto rd = cpu.R[insn->rd];
+                auto rr = cpu.R[insn->rr];
+                auto value = static_cast<int8_t>(static_cast<int8_t>(rd) - static_cast<int8_t>(rr));
+                SetSubtractFlags(cpu, rd, rr, static_cast<uint8_t>(value));
+                AVR_EMU_RETIRE(1u);
+            }
+
+        CPC:
+            {
+                auto rd = cpu.R[insn->rd];
+                auto rr = cpu.R[insn->rr];
+                auto value = static_cast<int8_t>(
+                    static_cast<int8_t>(rd) - static_cast<int8_t>(rr) - cpu.SREG.C);
+                SetSubtractFlags(cpu, rd, rr, static_cast<uint8_t>(value));
+                AVR_EMU_RETIRE(1u);
+            }
+
+        CPI:
+            {
+                auto rd = cpu.R[insn->rd];
+                auto k = static_cast<uint8_t>(insn->k);
+                auto value = static_cast<int8_t>(static_cast<int8_t>(rd) - static_cast<int8_t>(k));
+                SetSubtractFlags(cpu, rd, k, static_cast<uint8_t>(value));
+                AVR_EMU_RETIRE(1u);
+            }
+
+        CPSE:
+            {
+                if (cpu.R[insn->rr] != cpu.R[insn->rd])
+                    AVR_EMU_RETIRE(1u);
+
+                cpu.PC = static_cast<uint16_t>(cpu.PC + insn->skip * 2u);
+                AVR_EMU_SKIP();
+            }
+
+        DEC:
+            {
+                auto& rd = cpu.R[insn->rd];
+                auto value = static_cast<int8_t>(rd - 1u);
+                SetLogicFlags(cpu, static_cast<uint8_t>(value), rd == 0x80u);
+                rd = static_cast<uint8_t>(value);
+                AVR_EMU_RETIRE(1u);
+            }
+
+        EOR:
+            {
+                auto& rd = cpu.R[insn->rd];
+                rd ^= cpu.R[insn->rr];
+                SetLogicFlags(cpu, rd);
+                AVR_EMU_RETIRE(1u);
+            }
+
+        INC:
+            {
+                auto& rd = cpu.R[insn->rd];
+                rd = static_cast<uint8_t>(rd + 1u);
+                SetLogicFlags(cpu, rd, rd == 0x80u);
+                AVR_EMU_RETIRE(1u);
+            }
+
+        JMP:
+            {
+                cpu.PC = insn->k;
+                AVR_EMU_RETIRE(3u);
+            }
+
+        LDI:
+            {
+                cpu.R[insn->rd] = static_cast<uint8_t>(insn->k);
+                AVR_EMU_RETIRE(1u);
+            }
+
+        LDS:
+            {
+                cpu.PC += sizeof(insn->operand);
+                cpu.R[insn->rd] = ctx.Load(insn->k);
+                AVR_EMU_RETIRE(2u);
+            }
+
+        MOV:
+            {
+                cpu.R[insn->rd] = cpu.R[insn->rr];
+                AVR_EMU_RETIRE(1u);
+            }
+
+        OR:
+            {
+                auto& rd = cpu.R[insn->rd];
+                rd = static_cast<uint8_t>(cpu.R[insn->rr] | rd);
+                SetLogicFlags(cpu, rd);
+                AVR_EMU_RETIRE(1u);
+            }
+
+        ORI:
+            {
+                auto& rd = cpu.R[insn->rd];
+                rd = static_cast<uint8_t>(rd | insn->k);
+                SetLogicFlags(cpu, rd);
+                AVR_EMU_RETIRE(1u);
+            }
+
+        RJMP:
+            {
+                auto address = static_cast<uint16_t>(cpu.PC - sizeof(cpu.PC));
+                cpu.PC = static_cast<uint16_t>(cpu.PC + insn->k);
+                AVR_EMU_RETIRE_BRANCH(address);
+            }
+
+        SBIC:
+            {
+                if ((ctx.Load(static_cast<uint16_t>(IOBus::BEGIN + insn->rd)) & (0x1u << insn->k)) != 0u)
+                    AVR_EMU_RETIRE(1u);
+
+                cpu.PC = static_cast<uint16_t>(cpu.PC + insn->skip * 2u);
+                AVR_EMU_SKIP();
+            }
+
+        SBIS:
+            {
+                if ((ctx.Load(static_cast<uint16_t>(IOBus::BEGIN + insn->rd)) & (0x1u << insn->k)) == 0u)
+                    AVR_EMU_RETIRE(1u);
+
+                cpu.PC = static_cast<uint16_t>(cpu.PC + insn->skip * 2u);
+                AVR_EMU_SKIP();
+            }
+
+        STS:
+            {
+                ctx.Store(insn->k, cpu.R[insn->rr]);
+                cpu.PC += sizeof(insn->operand);
+                AVR_EMU_RETIRE(2u);
+            }
+
+        SUB:
+            {
+                auto& rr = cpu.R[insn->rr];
+                auto& rd = cpu.R[insn->rd];
+                auto originalValue = rd;
+                rd = static_cast<uint8_t>(rd - rr);
+                SetSubtractFlags(cpu, originalValue, rr, rd);
+                AVR_EMU_RETIRE(1u);
+            }
+
+        SUBI:
+            {
+                auto& rd = cpu.R[insn->rd];
+                auto k = static_cast<uint8_t>(insn->k);
+                auto originalValue = rd;
+                rd = static_cast<uint8_t>(rd - k);
+                SetSubtractFlags(cpu, originalValue, k, rd);
+                AVR_EMU_RETIRE(1u);
+            }
+
+#undef AVR_EMU_SKIP
+#undef AVR_EMU_RETIRE_BRANCH
+#undef AVR_EMU_RETIRE
+#undef AVR_EMU_DISPATCH
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#include "core/cpu.h"
+#include "core/decodecache.h"
+#include "core/dispatchtable.h"
+#include "core/threadedengine.h"
+#include "core/threadedexecutor.h"
+#include "instructions/instructionexecutor.h"
+
+#include <cstdint>
+
+namespace avr {
+    namespace {
+        // Feeds the engine one instruction at a time from the per word
+        // decode cache
+        class InstructionStream {
+            private:
+                const DispatchTable& _dispatchTable;
+                DecodedInstruction _scratch;
+
+            public:
+                InstructionStream(const DispatchTable& dispatchTable)
+                    : _dispatchTable(dispatchTable),
+                      _scratch()
+                {}
+
+                const DecodedInstruction& Next(ExecutionContext& ctx, const void* const* handlers, uint32_t)
+                {
+                    auto address = ctx.cpu.PC;
+                    if (!DecodeCache::IsCacheable(address))
+                    {
+                        _scratch = _dispatchTable.Decode(ctx.progMem, address);
+                        _scratch.handler = handlers[static_cast<uint8_t>(_scratch.op)];
+                        return _scratch;
+                    }
+
+                    auto& slot = ctx.decodeCache[address];
+                    if (slot.executor == nullptr)
+                        slot = _dispatchTable.Decode(ctx.progMem, address);
+                    if (slot.handler == nullptr)
+                        slot.handler = handlers[static_cast<uint8_t>(slot.op)];
+                    return slot;
+                }
+        };
+    }
+
+    void ThreadedExecutor::Execute(ExecutionContext& ctx, uint32_t cyclesRequested) const
+    {
+        auto stream = InstructionStream(*_dispatchTable);
+        threaded::Run(_clock, ctx, cyclesRequested, stream);
+    }
+
+    void ThreadedExecutor::Interrupt(ExecutionContext& ctx, uint8_t interrupt) const
+    {
+        ctx.RaiseInterrupt(interrupt);
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "core/decodecache.h"
+#include "core/dispatchtable.h"
+#include "core/iclock.h"
+#include "core/iexecutor.h"
+#include "instructions/instructionexecutor.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace avr {
+    // Direct threaded interpreter over the predecoded flash in
+    // ExecutionContext::decodeCache. Each slot stores the address of the
+    // handler implementing its Operation so consecutive instructions jump
+    // straight from one handler to the next. Operations without an inline
+    // handler are run through their InstructionExecutor.
+    class ThreadedExecutor : public IExecutor {
+        private:
+            IClock& _clock;
+            std::shared_ptr<const DispatchTable> _dispatchTable;
+
+        public:
+            ThreadedExecutor(
+                IClock& clock,
+                std::vector<std::unique_ptr<InstructionExecutor>>&& executors)
+                : _clock(clock),
+                  _dispatchTable(std::make_shared<const DispatchTable>(std::move(executors)))
+            {}
+
+            ThreadedExecutor(
+                IClock& clock,
+                const std::shared_ptr<const DispatchTable>& dispatchTable)
+                : _clock(clock),
+                  _dispatchTable(dispatchTable)
+            {}
+
+            const std::shared_ptr<const DispatchTable>& GetDispatchTable() const
+            {
+                return _dispatchTable;
+            }
+
+            void Execute(ExecutionContext& ctx, uint32_t cyclesRequested) const override;
+            void Interrupt(ExecutionContext& ctx, uint8_t interrupt) const override;
+    };
+}
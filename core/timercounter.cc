@@ -0,0 +1,397 @@
+#include "core/executioncontext.h"
+#include "core/scheduler.h"
+#include "core/timercounter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+
+namespace avr {
+    namespace {
+        constexpr uint32_t PRESCALERS[] = { 0u, 1u, 8u, 64u, 256u, 1024u, 0u, 0u };
+
+        struct Shape {
+            uint32_t top;
+            bool dual;
+            bool overflowAtTop;
+        };
+
+        // wgm as Timer1 numbers its waveform generation modes. Phase and
+        // frequency correct modes only differ in when OCR updates land.
+        Shape ShapeOf(uint8_t wgm, uint32_t max, uint32_t ocra, uint32_t icr)
+        {
+            switch (wgm)
+            {
+                case 1u: return { 0xFFu, true, false };
+                case 2u: return { 0x1FFu, true, false };
+                case 3u: return { 0x3FFu, true, false };
+                case 4u: return { ocra, false, false };
+                case 5u: return { 0xFFu, false, true };
+                case 6u: return { 0x1FFu, false, true };
+                case 7u: return { 0x3FFu, false, true };
+                case 8u: return { icr, true, false };
+                case 9u: return { ocra, true, false };
+                case 10u: return { icr, true, false };
+                case 11u: return { ocra, true, false };
+                case 12u: return { icr, false, false };
+                case 14u: return { icr, false, true };
+                case 15u: return { ocra, false, true };
+                default: return { max, false, true };
+            }
+        }
+
+        // Timer0's modes in Timer1's numbering; 4 and 6 are reserved
+        constexpr uint8_t NARROW_MODES[] = { 0u, 1u, 4u, 5u, 0u, 9u, 0u, 15u };
+    }
+
+    TimerCounter::TimerCounter(const TimerLayout& layout)
+        : _layout(layout),
+          _tccra(0u),
+          _tccrb(0u),
+          _timsk(0u),
+          _tifr(0u),
+          _temp(0u),
+          _ocra(0u),
+          _ocrb(0u),
+          _icr(0u),
+          _max(layout.wide ? 0xFFFFu : 0xFFu),
+          _top(_max),
+          _dual(false),
+          _overflowAtTop(true),
+          _overrun(false),
+          _prescale(0u),
+          _base(0u),
+          _phase(0u),
+          _scheduled(false),
+          _event(0u)
+    {}
+
+    std::shared_ptr<TimerCounter> TimerCounter::Attach(ExecutionContext& ctx, const TimerLayout& layout)
+    {
+        auto timer = std::make_shared<TimerCounter>(layout);
+        timer->_base = ctx.cycles;
+
+        auto read = [timer] (ExecutionContext& ctx, uint16_t address) {
+            return timer->Read(ctx, address);
+        };
+        auto write = [timer] (ExecutionContext& ctx, uint16_t address, uint8_t value) {
+            timer->Write(ctx, address, value);
+        };
+
+        for (auto address : { layout.tccra, layout.tccrb, layout.tcnt, layout.ocra, layout.ocrb, layout.timsk })
+            ctx.io.Map(address, read, write);
+        ctx.io.Map(layout.tifr, read, write, static_cast<uint8_t>(TOV | OCFA | OCFB));
+        if (layout.wide)
+            for (auto address : { layout.tcnt, layout.ocra, layout.ocrb })
+                ctx.io.Map(static_cast<uint16_t>(address + 1u), read, write);
+        if (layout.icr != 0u)
+        {
+            ctx.io.Map(layout.icr, read, write);
+            ctx.io.Map(static_cast<uint16_t>(layout.icr + 1u), read, write);
+        }
+
+        return timer;
+    }
+
+    uint16_t TimerCounter::Count(ExecutionContext& ctx)
+    {
+        Advance(ctx);
+        return static_cast<uint16_t>(CountAt(_phase));
+    }
+
+    // The counter walks through Period phases per cycle of its waveform. A
+    // single slope counter's phase is its count; a dual slope counter is
+    // counting back down in phases past TOP.
+    uint32_t TimerCounter::Period() const
+    {
+        if (_overrun)
+            return _max + 1u;
+        if (_dual)
+            return _top == 0u ? 1u : 2u * _top;
+        return _top + 1u;
+    }
+
+    uint32_t TimerCounter::CountAt(uint32_t phase) const
+    {
+        if (_overrun || !_dual || phase <= _top)
+            return phase;
+        return 2u * _top - phase;
+    }
+
+    // Ticks from _base until the one on which the counter moves off phase
+    uint64_t TimerCounter::TicksToLeave(uint32_t phase) const
+    {
+        auto period = Period();
+        return (phase % period + period - _phase) % period + 1u;
+    }
+
+    // Ticks from _base until flag is next set. Overflow is leaving TOP (or
+    // MAX in normal and CTC modes) for a single slope counter and arriving at
+    // BOTTOM for a dual slope one; compare matches are leaving OCR. Past TOP
+    // the counter runs up to MAX and wraps, so only what happens before the
+    // wrap is known.
+    uint64_t TimerCounter::TicksUntil(uint8_t flag) const
+    {
+        if (_prescale == 0u)
+            return Scheduler::NEVER;
+
+        auto compare = uint32_t(flag == OCFA ? _ocra : _ocrb);
+        if (_overrun)
+        {
+            if (flag == TOV)
+                return _max - _phase + 1u;
+            return compare >= _phase ? compare - _phase + 1u : Scheduler::NEVER;
+        }
+
+        if (flag == TOV)
+        {
+            if (_dual)
+                return _top == 0u ? Scheduler::NEVER : TicksToLeave(2u * _top - 1u);
+            return (_overflowAtTop || _top == _max) ? TicksToLeave(_top) : Scheduler::NEVER;
+        }
+
+        if (compare > _top || (_dual && _top == 0u))
+            return Scheduler::NEVER;
+        if (_dual)
+            return std::min(TicksToLeave(compare), TicksToLeave(2u * _top - compare));
+        return TicksToLeave(compare);
+    }
+
+    uint8_t TimerCounter::InterruptFor(uint8_t flag) const
+    {
+        if (flag == TOV)
+            return _layout.overflowInterrupt;
+        return flag == OCFA ? _layout.compareAInterrupt : _layout.compareBInterrupt;
+    }
+
+    // Picks up a change of mode, clock select or TOP, carrying the count
+    // over. A dual slope counter keeps its direction.
+    void TimerCounter::Reshape()
+    {
+        auto count = CountAt(_phase);
+        auto descending = _dual && !_overrun && _phase > _top;
+
+        auto wgm = static_cast<uint8_t>((_tccra & 0x03u) | ((_tccrb >> 1) & (_layout.wide ? 0x0Cu : 0x04u)));
+        auto shape = ShapeOf(_layout.wide ? wgm : NARROW_MODES[wgm], _max, _ocra, _icr);
+        _prescale = PRESCALERS[_tccrb & 0x07u];
+        _overflowAtTop = shape.overflowAtTop;
+        if (shape.top == _top && shape.dual == _dual)
+            return;
+
+        _top = shape.top;
+        _dual = shape.dual;
+        _overrun = false;
+        SetCount(count);
+        if (descending && _dual && _phase <= _top)
+            _phase = (2u * _top - _phase) % Period();
+    }
+
+    void TimerCounter::SetCount(uint32_t count)
+    {
+        _overrun = false;
+        if (count <= _top)
+            _phase = count;
+        else if (_dual)
+            _phase = _top;
+        else
+        {
+            _overrun = true;
+            _phase = count;
+        }
+    }
+
+    // Flags stay set in TIFR until the core vectors their interrupt, when
+    // it is enabled, or firmware writes a one to them
+    void TimerCounter::SetFlags(ExecutionContext& ctx, uint8_t flags)
+    {
+        _tifr |= flags;
+        for (auto flag : { TOV, OCFA, OCFB })
+            if (flags & _timsk & flag)
+                ctx.RaiseInterrupt(InterruptFor(flag));
+    }
+
+    // An enabled flag whose interrupt is no longer pending has been vectored,
+    // which clears it on the hardware
+    void TimerCounter::Acknowledge(ExecutionContext& ctx)
+    {
+        for (auto flag : { TOV, OCFA, OCFB })
+            if ((_tifr & _timsk & flag) && (ctx.pendingInterrupts & (uint64_t(1u) << InterruptFor(flag))) == 0u)
+                _tifr &= static_cast<uint8_t>(~flag);
+    }
+
+    // Counts every tick up to ctx.cycles, setting the flags of whatever
+    // happened in between. Only a wrap out of overrun needs more than one
+    // step.
+    void TimerCounter::Advance(ExecutionContext& ctx)
+    {
+        Acknowledge(ctx);
+        if (_prescale == 0u || ctx.cycles < _base)
+        {
+            _base = ctx.cycles;
+            return;
+        }
+
+        auto ticks = (ctx.cycles - _base) / _prescale;
+        while (ticks > 0u)
+        {
+            auto step = ticks;
+            auto wraps = false;
+            if (_overrun && _max - _phase + 1u <= step)
+            {
+                step = _max - _phase + 1u;
+                wraps = true;
+            }
+
+            auto flags = uint8_t(0u);
+            for (auto flag : { TOV, OCFA, OCFB })
+                if (TicksUntil(flag) <= step)
+                    flags |= flag;
+
+            if (wraps)
+            {
+                _overrun = false;
+                _phase = 0u;
+            }
+            else
+                _phase = static_cast<uint32_t>((_phase + step % Period()) % Period());
+
+            _base += step * _prescale;
+            ticks -= step;
+            SetFlags(ctx, flags);
+        }
+    }
+
+    // Leaves at most one event on the scheduler, for the earliest flag whose
+    // interrupt is enabled
+    void TimerCounter::Reschedule(ExecutionContext& ctx)
+    {
+        if (_scheduled)
+        {
+            ctx.scheduler.Cancel(_event);
+            _scheduled = false;
+        }
+
+        auto ticks = Scheduler::NEVER;
+        for (auto flag : { TOV, OCFA, OCFB })
+            if (_timsk & flag)
+                ticks = std::min(ticks, TicksUntil(flag));
+
+        // Compare matches beyond the wrap are only known once it happens
+        if (_overrun && _prescale != 0u && (_timsk & (TOV | OCFA | OCFB)) != 0u)
+            ticks = std::min(ticks, uint64_t(_max - _phase + 1u));
+
+        if (ticks == Scheduler::NEVER)
+            return;
+
+        _event = ctx.scheduler.Schedule(_base + ticks * _prescale, [self = shared_from_this()] (ExecutionContext& ctx) {
+            self->_scheduled = false;
+            self->Advance(ctx);
+            self->Reschedule(ctx);
+        });
+        _scheduled = true;
+    }
+
+    uint8_t TimerCounter::Read(ExecutionContext& ctx, uint16_t address)
+    {
+        auto wide = _layout.wide;
+        if (address == _layout.tcnt)
+        {
+            auto count = Count(ctx);
+            _temp = static_cast<uint8_t>(count >> 8);
+            return static_cast<uint8_t>(count);
+        }
+        if (address == _layout.icr)
+        {
+            _temp = static_cast<uint8_t>(_icr >> 8);
+            return static_cast<uint8_t>(_icr);
+        }
+        if (wide && (address == _layout.tcnt + 1u || address == _layout.icr + 1u))
+            return _temp;
+
+        if (address == _layout.ocra)
+            return static_cast<uint8_t>(_ocra);
+        if (address == _layout.ocrb)
+            return static_cast<uint8_t>(_ocrb);
+        if (wide && address == _layout.ocra + 1u)
+            return static_cast<uint8_t>(_ocra >> 8);
+        if (wide && address == _layout.ocrb + 1u)
+            return static_cast<uint8_t>(_ocrb >> 8);
+
+        if (address == _layout.tccra)
+            return _tccra;
+        if (address == _layout.tccrb)
+            return _tccrb;
+        if (address == _layout.timsk)
+            return _timsk;
+
+        Advance(ctx);
+        return _tifr;
+    }
+
+    // The high byte of a 16 bit register is written to TEMP first and lands
+    // together with the low byte
+    void TimerCounter::Write(ExecutionContext& ctx, uint16_t address, uint8_t value)
+    {
+        auto wide = _layout.wide;
+        if (wide && (address == _layout.tcnt + 1u ||
+                     address == _layout.ocra + 1u ||
+                     address == _layout.ocrb + 1u ||
+                     address == _layout.icr + 1u))
+        {
+            _temp = value;
+            return;
+        }
+
+        Advance(ctx);
+        auto word = static_cast<uint16_t>(wide ? (_temp << 8) | value : value);
+
+        if (address == _layout.tccra)
+        {
+            _tccra = value;
+            Reshape();
+        }
+        else if (address == _layout.tccrb)
+        {
+            auto prescale = _prescale;
+            _tccrb = value;
+            Reshape();
+            if (_prescale != prescale)
+                _base = ctx.cycles;
+        }
+        else if (address == _layout.tcnt)
+            SetCount(word);
+        else if (address == _layout.ocra)
+        {
+            _ocra = word;
+            Reshape();
+        }
+        else if (address == _layout.ocrb)
+            _ocrb = word;
+        else if (address == _layout.icr)
+        {
+            _icr = word;
+            Reshape();
+        }
+        else if (address == _layout.timsk)
+        {
+            // Flags already set interrupt as soon as they are enabled, and
+            // stop waiting on the core once they are disabled
+            for (auto flag : { TOV, OCFA, OCFB })
+                if ((_timsk & flag) && !(value & flag))
+                    ctx.ClearInterrupt(InterruptFor(flag));
+            _timsk = value;
+            SetFlags(ctx, _tifr);
+        }
+        else if (address == _layout.tifr)
+        {
+            // Writing a one clears the flag, and the interrupt if it was
+            // already raised
+            _tifr &= static_cast<uint8_t>(~value);
+            for (auto flag : { TOV, OCFA, OCFB })
+                if (value & flag)
+                    ctx.ClearInterrupt(InterruptFor(flag));
+        }
+
+        Reschedule(ctx);
+    }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "core/executioncontext.h"
+#include "core/scheduler.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace avr {
+    // Where a timer's registers sit in data space and which interrupts it
+    // raises. Interrupts are numbered as the ATmega328P numbers its vectors,
+    // so lower numbers keep the hardware's priority.
+    struct TimerLayout {
+        uint16_t tccra;
+        uint16_t tccrb;
+        uint16_t tcnt;      // low byte; 16 bit timers have the high byte above
+        uint16_t ocra;
+        uint16_t ocrb;
+        uint16_t icr;       // 0 on timers without input capture
+        uint16_t timsk;
+        uint16_t tifr;
+        bool wide;          // 16 bit, with high bytes going through TEMP
+        uint8_t overflowInterrupt;
+        uint8_t compareAInterrupt;
+        uint8_t compareBInterrupt;
+    };
+
+    constexpr TimerLayout TIMER0_LAYOUT = {
+        0x44u, 0x45u, 0x46u, 0x47u, 0x48u, 0x00u, 0x6Eu, 0x35u, false, 16u, 14u, 15u
+    };
+
+    constexpr TimerLayout TIMER1_LAYOUT = {
+        0x80u, 0x81u, 0x84u, 0x88u, 0x8Au, 0x86u, 0x6Fu, 0x36u, true, 13u, 11u, 12u
+    };
+
+    // Timer/Counter0 or Timer/Counter1 on the I/O bus. Nothing happens per
+    // cycle: the counter is a phase counted from the cycle the timer was
+    // last touched, TCNT is worked out from ctx.cycles when it is read and
+    // the flags when TIFR is read. Only the next event whose interrupt is
+    // enabled goes on ctx.scheduler, so a running timer with its interrupts
+    // masked costs nothing.
+    //
+    // Normal, CTC, fast PWM and phase correct modes are counted; phase and
+    // frequency correct modes count as phase correct. The prescaler starts
+    // afresh whenever the clock select changes, external clocks stop the
+    // timer, output compare pins and input capture are not modelled, and
+    // OCR writes take effect at once rather than at TOP or BOTTOM.
+    class TimerCounter : public std::enable_shared_from_this<TimerCounter> {
+        private:
+            enum Flag : uint8_t {
+                TOV = 0x01u,
+                OCFA = 0x02u,
+                OCFB = 0x04u
+            };
+
+            TimerLayout _layout;
+            uint8_t _tccra;
+            uint8_t _tccrb;
+            uint8_t _timsk;
+            uint8_t _tifr;
+            uint8_t _temp;
+            uint16_t _ocra;
+            uint16_t _ocrb;
+            uint16_t _icr;
+
+            uint32_t _max;
+            uint32_t _top;
+            bool _dual;             // counts up to TOP and back down
+            bool _overflowAtTop;    // otherwise only at MAX, as in CTC
+            bool _overrun;          // counting past TOP up to MAX
+            uint32_t _prescale;     // 0 while stopped
+            uint64_t _base;         // cycle _phase was counted at
+            uint32_t _phase;
+            bool _scheduled;
+            Scheduler::EventId _event;
+
+            uint32_t Period() const;
+            uint32_t CountAt(uint32_t phase) const;
+            uint64_t TicksToLeave(uint32_t phase) const;
+            uint64_t TicksUntil(uint8_t flag) const;
+            uint8_t InterruptFor(uint8_t flag) const;
+
+            void Reshape();
+            void SetCount(uint32_t count);
+            void SetFlags(ExecutionContext& ctx, uint8_t flags);
+            void Acknowledge(ExecutionContext& ctx);
+            void Advance(ExecutionContext& ctx);
+            void Reschedule(ExecutionContext& ctx);
+
+            uint8_t Read(ExecutionContext& ctx, uint16_t address);
+            void Write(ExecutionContext& ctx, uint16_t address, uint8_t value);
+
+        public:
+            explicit TimerCounter(const TimerLayout& layout);
+
+            // Maps the timer's registers on ctx.io. The bus and any event
+            // scheduled keep the timer alive.
+            static std::shared_ptr<TimerCounter> Attach(ExecutionContext& ctx, const TimerLayout& layout);
+
+            // TCNT as of ctx.cycles
+            uint16_t Count(ExecutionContext& ctx);
+    };
+}
@@ -0,0 +1,243 @@
+#include "core/executioncontext.h"
+#include "core/scheduler.h"
+#include "core/twi.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace avr {
+    Twi::Twi(const TwiLayout& layout)
+        : _layout(layout),
+          _devices(),
+          _twbr(0u),
+          _twsr(IDLE),
+          _twar(0xFEu),
+          _twdr(0xFFu),
+          _twcr(0u),
+          _owned(false),
+          _addressNext(false),
+          _reading(false),
+          _target(nullptr),
+          _busy(false),
+          _doneAt(0u),
+          _nextStatus(IDLE),
+          _nextData(0xFFu),
+          _scheduled(false),
+          _event(0u)
+    {}
+
+    std::shared_ptr<Twi> Twi::Attach(ExecutionContext& ctx, const TwiLayout& layout)
+    {
+        auto twi = std::make_shared<Twi>(layout);
+        auto read = [twi] (ExecutionContext& ctx, uint16_t address) {
+            return twi->Read(ctx, address);
+        };
+        auto write = [twi] (ExecutionContext& ctx, uint16_t address, uint8_t value) {
+            twi->Write(ctx, address, value);
+        };
+
+        for (auto address : { layout.twbr, layout.twsr, layout.twar, layout.twdr, layout.twcr })
+            ctx.io.Map(address, read, write);
+        return twi;
+    }
+
+    void Twi::Connect(uint8_t address, std::shared_ptr<ITwiDevice> device)
+    {
+        using namespace std::string_literals;
+        if (address > 0x7Fu)
+            throw "TWI address out of range: "s + std::to_string(address);
+        _devices.emplace_back(address, std::move(device));
+    }
+
+    // SCL runs at the CPU clock over 16 + 2 * TWBR * 4^TWPS
+    uint64_t Twi::BitCycles() const
+    {
+        return 16u + 2u * uint64_t(_twbr) * (uint64_t(1u) << (2u * (_twsr & 0x03u)));
+    }
+
+    ITwiDevice* Twi::Find(uint8_t address) const
+    {
+        for (auto& device : _devices)
+            if (device.first == address)
+                return device.second.get();
+        return nullptr;
+    }
+
+    void Twi::Release()
+    {
+        if (_target)
+            _target->Stop();
+        _target = nullptr;
+        _owned = false;
+        _addressNext = false;
+    }
+
+    // Carries out what TWCR asks for as TWINT is cleared. A STOP followed
+    // by a START in the same write sends both.
+    void Twi::Begin(ExecutionContext& ctx)
+    {
+        auto bit = BitCycles();
+        _nextData = _twdr;
+
+        if (_twcr & TWSTO)
+        {
+            Release();
+            if (!(_twcr & TWSTA))
+            {
+                _busy = true;
+                _doneAt = ctx.cycles + bit;
+                _nextStatus = IDLE;
+                return;
+            }
+        }
+
+        if (_twcr & TWSTA)
+        {
+            _nextStatus = _owned ? REPEATED_START : START;
+            _owned = true;
+            _addressNext = true;
+            _busy = true;
+            _doneAt = ctx.cycles + bit;
+            return;
+        }
+
+        if (!_owned)
+            return;
+
+        if (_addressNext)
+        {
+            _reading = (_twdr & 0x01u) != 0u;
+            auto device = Find(static_cast<uint8_t>(_twdr >> 1));
+            auto acked = device && device->Address(_reading);
+            _target = acked ? device : nullptr;
+            _addressNext = false;
+            if (_reading)
+                _nextStatus = acked ? SLA_R_ACK : SLA_R_NACK;
+            else
+                _nextStatus = acked ? SLA_W_ACK : SLA_W_NACK;
+        }
+        else if (_reading)
+        {
+            // An absent device leaves SDA to the pull-up
+            _nextData = 0xFFu;
+            if (_target)
+                _target->Read(&_nextData, 1u);
+            _nextStatus = (_twcr & TWEA) ? DATA_R_ACK : DATA_R_NACK;
+        }
+        else
+        {
+            auto acked = _target && _target->Write(&_twdr, 1u);
+            _nextStatus = acked ? DATA_W_ACK : DATA_W_NACK;
+        }
+
+        _busy = true;
+        _doneAt = ctx.cycles + 9u * bit;
+    }
+
+    // TWSTO clears itself once the STOP is out, without setting TWINT
+    void Twi::Advance(ExecutionContext& ctx)
+    {
+        if (!_busy || ctx.cycles < _doneAt)
+            return;
+
+        _busy = false;
+        _twsr = static_cast<uint8_t>((_nextStatus & 0xF8u) | (_twsr & 0x03u));
+        if (_nextStatus == IDLE)
+            _twcr &= static_cast<uint8_t>(~TWSTO);
+        else
+        {
+            _twdr = _nextData;
+            _twcr |= TWINT;
+        }
+    }
+
+    // Unlike the timers' flags, TWINT is not cleared by vectoring, so the
+    // interrupt is requested for as long as it is set
+    void Twi::UpdateInterrupt(ExecutionContext& ctx)
+    {
+        if ((_twcr & TWINT) && (_twcr & TWIE) && (_twcr & TWEN))
+            ctx.RaiseInterrupt(_layout.interrupt);
+        else
+            ctx.ClearInterrupt(_layout.interrupt);
+    }
+
+    void Twi::Reschedule(ExecutionContext& ctx)
+    {
+        if (_scheduled)
+        {
+            ctx.scheduler.Cancel(_event);
+            _scheduled = false;
+        }
+        if (!_busy || !(_twcr & TWIE))
+            return;
+
+        _event = ctx.scheduler.Schedule(_doneAt, [self = shared_from_this()] (ExecutionContext& ctx) {
+            self->_scheduled = false;
+            self->Advance(ctx);
+            self->UpdateInterrupt(ctx);
+        });
+        _scheduled = true;
+    }
+
+    uint8_t Twi::Read(ExecutionContext& ctx, uint16_t address)
+    {
+        Advance(ctx);
+        UpdateInterrupt(ctx);
+        if (address == _layout.twbr)
+            return _twbr;
+        if (address == _layout.twsr)
+            return _twsr;
+        if (address == _layout.twar)
+            return _twar;
+        if (address == _layout.twdr)
+            return _twdr;
+        return _twcr;
+    }
+
+    void Twi::Write(ExecutionContext& ctx, uint16_t address, uint8_t value)
+    {
+        Advance(ctx);
+        if (address == _layout.twbr)
+            _twbr = value;
+        else if (address == _layout.twsr)
+            _twsr = static_cast<uint8_t>((_twsr & 0xF8u) | (value & 0x03u));
+        else if (address == _layout.twar)
+            _twar = value;
+        else if (address == _layout.twdr)
+        {
+            // TWDR can only be written while TWINT is set
+            if (_twcr & TWINT)
+            {
+                _twdr = value;
+                _twcr &= static_cast<uint8_t>(~TWWC);
+            }
+            else
+                _twcr |= TWWC;
+        }
+        else
+        {
+            // Writing a one to TWINT clears it and starts the next action
+            auto start = (value & TWINT) != 0u && (value & TWEN) != 0u;
+            auto kept = static_cast<uint8_t>(_twcr & (TWINT | TWWC));
+            if (value & TWINT)
+                kept = static_cast<uint8_t>(kept & ~TWINT);
+            _twcr = static_cast<uint8_t>(kept | (value & (TWEA | TWSTA | TWSTO | TWEN | TWIE)));
+
+            if (!(_twcr & TWEN))
+            {
+                // Disabling the TWI lets go of the bus at once
+                Release();
+                _busy = false;
+                _twcr &= static_cast<uint8_t>(~(TWINT | TWSTO | TWWC));
+                _twsr = static_cast<uint8_t>(IDLE | (_twsr & 0x03u));
+            }
+            else if (start && !_busy)
+                Begin(ctx);
+        }
+
+        UpdateInterrupt(ctx);
+        Reschedule(ctx);
+    }
+}
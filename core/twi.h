@@ -0,0 +1,104 @@
+#pragma once
+
+#include "core/executioncontext.h"
+#include "core/itwidevice.h"
+#include "core/scheduler.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace avr {
+    // Where the TWI's registers sit in data space and the interrupt it
+    // raises, numbered as the ATmega328P numbers its vectors
+    struct TwiLayout {
+        uint16_t twbr;
+        uint16_t twsr;
+        uint16_t twar;
+        uint16_t twdr;
+        uint16_t twcr;
+        uint8_t interrupt;
+    };
+
+    constexpr TwiLayout TWI_LAYOUT = { 0xB8u, 0xB9u, 0xBAu, 0xBBu, 0xBCu, 24u };
+
+    // The TWI (I2C) controller as a bus master on the I/O bus. Clearing
+    // TWINT starts the action TWCR asks for, which the addressed device
+    // answers at once; TWINT, TWSR and TWDR only show the outcome once the
+    // bus would have carried it, nine SCL periods for an address or data
+    // byte and one for a START or STOP, with the period TWBR and the
+    // prescaler give. Like TimerCounter, the outcome is worked out when a
+    // register is read and is only scheduled when TWIE wants an interrupt
+    // from it.
+    //
+    // Slave modes, arbitration, general call and the TWAMR mask are not
+    // modelled; TWAR is only kept for the firmware to read back.
+    class Twi : public std::enable_shared_from_this<Twi> {
+        private:
+            enum Control : uint8_t {
+                TWIE = 0x01u,
+                TWEN = 0x04u,
+                TWWC = 0x08u,
+                TWSTO = 0x10u,
+                TWSTA = 0x20u,
+                TWEA = 0x40u,
+                TWINT = 0x80u
+            };
+
+            enum Status : uint8_t {
+                START = 0x08u,
+                REPEATED_START = 0x10u,
+                SLA_W_ACK = 0x18u,
+                SLA_W_NACK = 0x20u,
+                DATA_W_ACK = 0x28u,
+                DATA_W_NACK = 0x30u,
+                SLA_R_ACK = 0x40u,
+                SLA_R_NACK = 0x48u,
+                DATA_R_ACK = 0x50u,
+                DATA_R_NACK = 0x58u,
+                IDLE = 0xF8u
+            };
+
+            TwiLayout _layout;
+            std::vector<std::pair<uint8_t, std::shared_ptr<ITwiDevice>>> _devices;
+            uint8_t _twbr;
+            uint8_t _twsr;
+            uint8_t _twar;
+            uint8_t _twdr;
+            uint8_t _twcr;
+
+            bool _owned;            // a START has been sent and no STOP since
+            bool _addressNext;      // the next byte is SLA+R/W
+            bool _reading;
+            ITwiDevice* _target;    // device which ACKed its address
+
+            bool _busy;
+            uint64_t _doneAt;
+            uint8_t _nextStatus;
+            uint8_t _nextData;
+            bool _scheduled;
+            Scheduler::EventId _event;
+
+            uint64_t BitCycles() const;
+            ITwiDevice* Find(uint8_t address) const;
+            void Release();
+            void Begin(ExecutionContext& ctx);
+            void Advance(ExecutionContext& ctx);
+            void UpdateInterrupt(ExecutionContext& ctx);
+            void Reschedule(ExecutionContext& ctx);
+
+            uint8_t Read(ExecutionContext& ctx, uint16_t address);
+            void Write(ExecutionContext& ctx, uint16_t address, uint8_t value);
+
+        public:
+            explicit Twi(const TwiLayout& layout);
+
+            // Maps the TWI's registers on ctx.io. The bus and any event
+            // scheduled keep the TWI alive.
+            static std::shared_ptr<Twi> Attach(ExecutionContext& ctx, const TwiLayout& layout);
+
+            // Puts device on the bus at the 7-bit address
+            void Connect(uint8_t address, std::shared_ptr<ITwiDevice> device);
+    };
+}
@@ -0,0 +1,333 @@
+#include "core/executioncontext.h"
+#include "core/scheduler.h"
+#include "core/usart.h"
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace avr {
+    Usart::Usart(const UsartLayout& layout, int txFd, int rxFd)
+        : _layout(layout),
+          _txFd(txFd),
+          _rxFd(rxFd),
+          _ucsra(UDRE),
+          _ucsrb(0u),
+          _ucsrc(0x06u),
+          _ubrr(0u),
+          _transmitting(false),
+          _txPending(false),
+          _txData(0u),
+          _txDoneAt(0u),
+          _txScheduled(false),
+          _txEvent(0u),
+          _txBuffer(),
+          _flushScheduled(false),
+          _rxData(0u),
+          _rxScheduled(false),
+          _rxEvent(0u),
+          _rxClosed(rxFd < 0),
+          _rxBuffer(),
+          _rxHead(0u)
+    {
+        _txBuffer.reserve(BUFFER_SIZE);
+    }
+
+    // A byte still waiting in UDR would have gone out had the context kept
+    // running
+    Usart::~Usart()
+    {
+        if (_txPending)
+            _txBuffer.push_back(_txData);
+        try
+        {
+            Flush();
+        }
+        catch (const std::string&)
+        {
+        }
+    }
+
+    std::shared_ptr<Usart> Usart::Attach(ExecutionContext& ctx, const UsartLayout& layout, int txFd, int rxFd)
+    {
+        auto usart = std::make_shared<Usart>(layout, txFd, rxFd);
+        auto read = [usart] (ExecutionContext& ctx, uint16_t address) {
+            return usart->Read(ctx, address);
+        };
+        auto write = [usart] (ExecutionContext& ctx, uint16_t address, uint8_t value) {
+            usart->Write(ctx, address, value);
+        };
+
+        for (auto address : { layout.ucsra, layout.ucsrb, layout.ucsrc, layout.ubrrl, layout.ubrrh, layout.udr })
+            ctx.io.Map(address, read, write);
+        return usart;
+    }
+
+    void Usart::Flush()
+    {
+        using namespace std::string_literals;
+        auto written = std::size_t(0u);
+        while (_txFd >= 0 && written < _txBuffer.size())
+        {
+            auto count = write(_txFd, _txBuffer.data() + written, _txBuffer.size() - written);
+            if (count < 0 && errno == EINTR)
+                continue;
+            if (count < 0)
+            {
+                _txBuffer.clear();
+                throw "Unable to write USART output: "s + std::strerror(errno);
+            }
+            written += static_cast<std::size_t>(count);
+        }
+        _txBuffer.clear();
+    }
+
+    // Start bit, five to nine data bits, parity and one or two stop bits
+    uint64_t Usart::FrameCycles() const
+    {
+        auto size = ((_ucsrc >> 1) & 0x03u) | (_ucsrb & UCSZ2);
+        auto dataBits = size <= 3u ? 5u + size : (size == 7u ? 9u : 8u);
+        auto parityBits = (_ucsrc & 0x30u) != 0u ? 1u : 0u;
+        auto stopBits = (_ucsrc & 0x08u) != 0u ? 2u : 1u;
+        auto bitCycles = uint64_t((_ucsra & U2X) != 0u ? 8u : 16u) * (_ubrr + 1u);
+        return bitCycles * (1u + dataBits + parityBits + stopBits);
+    }
+
+    void Usart::Send(ExecutionContext& ctx, uint8_t value)
+    {
+        _txBuffer.push_back(value);
+        if (_txBuffer.size() >= BUFFER_SIZE)
+        {
+            Flush();
+            return;
+        }
+
+        if (_flushScheduled)
+            return;
+        _flushScheduled = true;
+        ctx.scheduler.Schedule(ctx.cycles + FLUSH_CYCLES, [self = shared_from_this()] (ExecutionContext&) {
+            self->_flushScheduled = false;
+            self->Flush();
+        });
+    }
+
+    // True when a received byte is waiting in the buffer, reading more in
+    // if the descriptor has any to give right now
+    bool Usart::Fill()
+    {
+        using namespace std::string_literals;
+        if (_rxHead < _rxBuffer.size())
+            return true;
+        if (_rxClosed)
+            return false;
+
+        auto ready = pollfd{_rxFd, POLLIN, 0};
+        if (poll(&ready, 1u, 0) <= 0 || (ready.revents & (POLLIN | POLLHUP)) == 0)
+            return false;
+
+        _rxBuffer.resize(BUFFER_SIZE);
+        auto count = read(_rxFd, _rxBuffer.data(), BUFFER_SIZE);
+        if (count < 0 && (errno == EINTR || errno == EAGAIN))
+            count = 0;
+        else if (count < 0)
+            throw "Unable to read USART input: "s + std::strerror(errno);
+        else if (count == 0)
+            _rxClosed = true;
+
+        _rxBuffer.resize(static_cast<std::size_t>(count));
+        _rxHead = 0u;
+        return count > 0;
+    }
+
+    // A set TXC whose interrupt is enabled but no longer pending has been
+    // vectored, which clears it on the hardware
+    void Usart::Acknowledge(ExecutionContext& ctx)
+    {
+        auto pending = (ctx.pendingInterrupts & (uint64_t(1u) << _layout.txInterrupt)) != 0u;
+        if ((_ucsra & TXC) && (_ucsrb & TXCIE) && !pending)
+            _ucsra &= static_cast<uint8_t>(~TXC);
+    }
+
+    // Moves the transmitter on to ctx.cycles: a byte waiting in UDR enters
+    // the shifter when the frame ahead of it ends, and TXC is set once the
+    // last frame is out
+    void Usart::Advance(ExecutionContext& ctx)
+    {
+        Acknowledge(ctx);
+        while (_transmitting && ctx.cycles >= _txDoneAt)
+        {
+            if (!_txPending)
+            {
+                _transmitting = false;
+                _ucsra |= TXC;
+                break;
+            }
+
+            _txPending = false;
+            _ucsra |= UDRE;
+            Send(ctx, _txData);
+            _txDoneAt += FrameCycles();
+        }
+    }
+
+    // Each interrupt is requested for as long as its flag is set and
+    // enabled. TXC stays set until Acknowledge sees its interrupt vectored
+    // or the firmware writes a one to it, so it can be polled too.
+    void Usart::UpdateInterrupts(ExecutionContext& ctx)
+    {
+        if ((_ucsrb & TXCIE) && (_ucsra & TXC))
+            ctx.RaiseInterrupt(_layout.txInterrupt);
+        else
+            ctx.ClearInterrupt(_layout.txInterrupt);
+
+        if ((_ucsrb & UDRIE) && (_ucsra & UDRE))
+            ctx.RaiseInterrupt(_layout.udreInterrupt);
+        else
+            ctx.ClearInterrupt(_layout.udreInterrupt);
+
+        if ((_ucsrb & RXCIE) && (_ucsra & RXC))
+            ctx.RaiseInterrupt(_layout.rxInterrupt);
+        else
+            ctx.ClearInterrupt(_layout.rxInterrupt);
+    }
+
+    // Only an interrupt waiting on the end of the current frame needs an
+    // event; anything else catches up on the next register access
+    void Usart::ScheduleTransmit(ExecutionContext& ctx)
+    {
+        if (_txScheduled)
+        {
+            ctx.scheduler.Cancel(_txEvent);
+            _txScheduled = false;
+        }
+
+        auto wanted = (_txPending && (_ucsrb & UDRIE)) || (_ucsrb & TXCIE);
+        if (!_transmitting || !wanted)
+            return;
+
+        _txEvent = ctx.scheduler.Schedule(_txDoneAt, [self = shared_from_this()] (ExecutionContext& ctx) {
+            self->_txScheduled = false;
+            self->Advance(ctx);
+            self->UpdateInterrupts(ctx);
+            self->ScheduleTransmit(ctx);
+        });
+        _txScheduled = true;
+    }
+
+    void Usart::ScheduleReceive(ExecutionContext& ctx)
+    {
+        if (_rxScheduled || !(_ucsrb & RXEN) || (_ucsra & RXC))
+            return;
+
+        auto delay = FrameCycles();
+        if (!Fill())
+        {
+            if (_rxClosed)
+                return;
+            delay *= RX_POLL_FRAMES;
+        }
+
+        _rxEvent = ctx.scheduler.Schedule(ctx.cycles + delay, [self = shared_from_this()] (ExecutionContext& ctx) {
+            self->_rxScheduled = false;
+            self->Receive(ctx);
+        });
+        _rxScheduled = true;
+    }
+
+    void Usart::Receive(ExecutionContext& ctx)
+    {
+        Advance(ctx);
+        if ((_ucsrb & RXEN) && !(_ucsra & RXC) && Fill())
+        {
+            _rxData = _rxBuffer[_rxHead++];
+            _ucsra |= RXC;
+            UpdateInterrupts(ctx);
+        }
+        ScheduleReceive(ctx);
+    }
+
+    uint8_t Usart::Read(ExecutionContext& ctx, uint16_t address)
+    {
+        Advance(ctx);
+        auto value = uint8_t(0u);
+        if (address == _layout.udr)
+        {
+            value = _rxData;
+            _ucsra &= static_cast<uint8_t>(~RXC);
+            UpdateInterrupts(ctx);
+            ScheduleReceive(ctx);
+        }
+        else if (address == _layout.ucsra)
+            value = _ucsra;
+        else if (address == _layout.ucsrb)
+            value = _ucsrb;
+        else if (address == _layout.ucsrc)
+            value = _ucsrc;
+        else if (address == _layout.ubrrl)
+            value = static_cast<uint8_t>(_ubrr);
+        else
+            value = static_cast<uint8_t>(_ubrr >> 8);
+        return value;
+    }
+
+    void Usart::Write(ExecutionContext& ctx, uint16_t address, uint8_t value)
+    {
+        Advance(ctx);
+        if (address == _layout.udr)
+        {
+            // Written while UDRE is clear, the byte is lost as on the
+            // hardware
+            if ((_ucsrb & TXEN) && !_transmitting)
+            {
+                _transmitting = true;
+                _txDoneAt = ctx.cycles + FrameCycles();
+                Send(ctx, value);
+            }
+            else if ((_ucsrb & TXEN) && !_txPending)
+            {
+                _txPending = true;
+                _txData = value;
+                _ucsra &= static_cast<uint8_t>(~UDRE);
+            }
+        }
+        else if (address == _layout.ucsra)
+        {
+            // Writing a one clears TXC; U2X and MPCM are the only other
+            // bits which can be written
+            if (value & TXC)
+            {
+                _ucsra &= static_cast<uint8_t>(~TXC);
+                ctx.ClearInterrupt(_layout.txInterrupt);
+            }
+            _ucsra = static_cast<uint8_t>((_ucsra & ~(U2X | MPCM)) | (value & (U2X | MPCM)));
+        }
+        else if (address == _layout.ucsrb)
+        {
+            _ucsrb = value;
+            // Disabling the receiver flushes it
+            if (!(_ucsrb & RXEN))
+            {
+                _ucsra &= static_cast<uint8_t>(~RXC);
+                if (_rxScheduled)
+                    ctx.scheduler.Cancel(_rxEvent);
+                _rxScheduled = false;
+            }
+        }
+        else if (address == _layout.ucsrc)
+            _ucsrc = value;
+        else if (address == _layout.ubrrl)
+            _ubrr = static_cast<uint16_t>((_ubrr & 0x0F00u) | value);
+        else
+            _ubrr = static_cast<uint16_t>((_ubrr & 0x00FFu) | ((value & 0x0Fu) << 8));
+
+        UpdateInterrupts(ctx);
+        ScheduleTransmit(ctx);
+        ScheduleReceive(ctx);
+    }
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "core/executioncontext.h"
+#include "core/scheduler.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace avr {
+    // Where a USART's registers sit in data space and which interrupts it
+    // raises, numbered as the ATmega328P numbers its vectors
+    struct UsartLayout {
+        uint16_t ucsra;
+        uint16_t ucsrb;
+        uint16_t ucsrc;
+        uint16_t ubrrl;
+        uint16_t ubrrh;
+        uint16_t udr;
+        uint8_t rxInterrupt;
+        uint8_t udreInterrupt;
+        uint8_t txInterrupt;
+    };
+
+    constexpr UsartLayout USART0_LAYOUT = {
+        0xC0u, 0xC1u, 0xC2u, 0xC4u, 0xC5u, 0xC6u, 18u, 19u, 20u
+    };
+
+    // An asynchronous USART on the I/O bus, bridged to host file
+    // descriptors. Frames take the time UBRR, U2X and the frame format give
+    // them in ExecutionContext::cycles, but nothing is scheduled per frame
+    // unless an interrupt depends on it: UDRE and TXC are worked out when
+    // UCSRA is read, like TimerCounter's flags.
+    //
+    // Transmitted bytes collect in a buffer written to txFd once
+    // BUFFER_SIZE bytes have built up, FLUSH_CYCLES after the first byte
+    // arrived in an empty buffer, on Flush and when the USART goes away.
+    // Received bytes are read from rxFd BUFFER_SIZE at a time, without
+    // blocking, and handed to the firmware a frame apart once it has read
+    // the previous one, so nothing is overrun. While rxFd has nothing to
+    // give it is polled every RX_POLL_FRAMES frame times. Either descriptor
+    // may be -1, and neither is closed.
+    //
+    // Synchronous and multiprocessor modes, parity and frame errors and the
+    // ninth data bit are not modelled, and the receiver has no FIFO.
+    class Usart : public std::enable_shared_from_this<Usart> {
+        public:
+            constexpr static std::size_t BUFFER_SIZE = 0x1000u;
+            constexpr static uint64_t FLUSH_CYCLES = 0x100000u;
+            constexpr static uint64_t RX_POLL_FRAMES = 0x100u;
+
+        private:
+            enum Flag : uint8_t {
+                MPCM = 0x01u,
+                U2X = 0x02u,
+                UDRE = 0x20u,
+                TXC = 0x40u,
+                RXC = 0x80u
+            };
+
+            enum Control : uint8_t {
+                UCSZ2 = 0x04u,
+                TXEN = 0x08u,
+                RXEN = 0x10u,
+                UDRIE = 0x20u,
+                TXCIE = 0x40u,
+                RXCIE = 0x80u
+            };
+
+            UsartLayout _layout;
+            int _txFd;
+            int _rxFd;
+            uint8_t _ucsra;
+            uint8_t _ucsrb;
+            uint8_t _ucsrc;
+            uint16_t _ubrr;
+
+            bool _transmitting;
+            bool _txPending;        // a byte waits in UDR for the shifter
+            uint8_t _txData;
+            uint64_t _txDoneAt;     // cycle the shifter finishes its frame
+            bool _txScheduled;
+            Scheduler::EventId _txEvent;
+            std::vector<uint8_t> _txBuffer;
+            bool _flushScheduled;
+
+            uint8_t _rxData;
+            bool _rxScheduled;
+            Scheduler::EventId _rxEvent;
+            bool _rxClosed;
+            std::vector<uint8_t> _rxBuffer;
+            std::size_t _rxHead;
+
+            uint64_t FrameCycles() const;
+            void Send(ExecutionContext& ctx, uint8_t value);
+            bool Fill();
+
+            void Acknowledge(ExecutionContext& ctx);
+            void Advance(ExecutionContext& ctx);
+            void UpdateInterrupts(ExecutionContext& ctx);
+            void ScheduleTransmit(ExecutionContext& ctx);
+            void ScheduleReceive(ExecutionContext& ctx);
+            void Receive(ExecutionContext& ctx);
+
+            uint8_t Read(ExecutionContext& ctx, uint16_t address);
+            void Write(ExecutionContext& ctx, uint16_t address, uint8_t value);
+
+        public:
+            Usart(const UsartLayout& layout, int txFd, int rxFd);
+            ~Usart();
+
+            Usart(const Usart&) = delete;
+            Usart& operator=(const Usart&) = delete;
+
+            // Maps the USART's registers on ctx.io. The bus and any event
+            // scheduled keep the USART alive.
+            static std::shared_ptr<Usart> Attach(ExecutionContext& ctx, const UsartLayout& layout, int txFd, int rxFd = -1);
+
+            // Writes out everything transmitted so far
+            void Flush();
+    };
+}
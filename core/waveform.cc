@@ -0,0 +1,147 @@
+#include "core/waveform.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace avr {
+    Waveform::Waveform(const std::string& path, unsigned channels, uint64_t cyclesPerFrame, Mode mode)
+        : _data(nullptr),
+          _size(0u),
+          _pageSize(static_cast<std::size_t>(sysconf(_SC_PAGESIZE))),
+          _channels(channels),
+          _cyclesPerFrame(cyclesPerFrame),
+          _frames(0u),
+          _mode(mode),
+          _requestedTo(0u),
+          _last(channels, 0u),
+          _misses(0u),
+          _mutex(),
+          _wake(),
+          _wanted(0u),
+          _stopping(false),
+          _reader()
+    {
+        using namespace std::string_literals;
+        if (channels == 0u || cyclesPerFrame == 0u)
+            throw "A waveform needs at least one channel and cycle per frame"s;
+
+        auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            throw "Unable to open waveform "s + path + ": "s + std::strerror(errno);
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < 2u * channels)
+        {
+            close(fd);
+            throw "Waveform "s + path + " holds no frames"s;
+        }
+        _size = static_cast<std::size_t>(info.st_size);
+        _frames = _size / (2u * channels);
+
+        auto memory = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (memory == MAP_FAILED)
+            throw "Unable to map waveform "s + path + ": "s + std::strerror(errno);
+        _data = static_cast<uint8_t*>(memory);
+
+        madvise(_data, _size, MADV_SEQUENTIAL);
+        _requestedTo = std::min(_size, PREFETCH_BYTES);
+        _reader = std::thread(&Waveform::ReadAhead, this);
+    }
+
+    Waveform::~Waveform()
+    {
+        {
+            auto lock = std::lock_guard(_mutex);
+            _stopping = true;
+        }
+        _wake.notify_one();
+        _reader.join();
+        munmap(_data, _size);
+    }
+
+    // Moves the reader's window on once half of the current one is used
+    // up, or at once when the sample jumped outside it
+    void Waveform::Prefetch(std::size_t offset)
+    {
+        auto inWindow = offset < _requestedTo && offset + PREFETCH_BYTES >= _requestedTo;
+        if (inWindow && (offset + PREFETCH_BYTES / 2u < _requestedTo || _requestedTo >= _size))
+            return;
+
+        {
+            auto lock = std::lock_guard(_mutex);
+            _wanted = offset;
+        }
+        _wake.notify_one();
+        _requestedTo = std::min(_size, offset + PREFETCH_BYTES);
+    }
+
+    // Touches each page of the window so it is faulted in on this thread
+    // rather than the CPU's. Pages already touched are only skipped while
+    // the window moves forward over them; a jump back reads it all again,
+    // as the kernel may have dropped pages left behind.
+    void Waveform::ReadAhead()
+    {
+        auto readTo = std::size_t(0u);
+        auto lock = std::unique_lock(_mutex);
+        while (!_stopping)
+        {
+            auto start = _wanted & ~(_pageSize - 1u);
+            auto end = std::min(_size, _wanted + PREFETCH_BYTES);
+            if (readTo < start || readTo > end)
+                readTo = start;
+            if (readTo >= end)
+            {
+                _wake.wait(lock);
+                continue;
+            }
+
+            lock.unlock();
+            auto sink = uint8_t(0u);
+            for (; readTo < end; readTo += _pageSize)
+                sink ^= *static_cast<volatile uint8_t*>(_data + readTo);
+            static_cast<void>(sink);
+            readTo = std::min(readTo, end);
+            lock.lock();
+        }
+    }
+
+    // mincore reports whether the file's page is in the page cache, so a
+    // resident page costs at most a minor fault to touch. It is asked
+    // every time, as the kernel can drop a page it said was there.
+    bool Waveform::Resident(std::size_t offset) const
+    {
+        auto page = offset & ~(_pageSize - 1u);
+        unsigned char resident = 0u;
+        return mincore(_data + page, 1u, &resident) == 0 && (resident & 0x1u);
+    }
+
+    uint16_t Waveform::Sample(unsigned channel, uint64_t cycle)
+    {
+        if (channel >= _channels)
+            return 0u;
+
+        auto frame = std::min(cycle / _cyclesPerFrame, _frames - 1u);
+        auto offset = static_cast<std::size_t>((frame * _channels + channel) * 2u);
+        Prefetch(offset);
+        if (_mode == Mode::NonBlocking && !Resident(offset))
+        {
+            _misses++;
+            return _last[channel];
+        }
+
+        _last[channel] = static_cast<uint16_t>(_data[offset] | (_data[offset + 1u] << 8));
+        return _last[channel];
+    }
+}
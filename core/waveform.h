@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace avr {
+    // Analog input recorded in a binary file and mapped into memory. The
+    // file holds frames of one little-endian 16-bit sample per channel,
+    // a frame every cyclesPerFrame CPU cycles from cycle 0; the last frame
+    // holds once the file runs out.
+    //
+    // A reader thread keeps PREFETCH_BYTES of the file ahead of the last
+    // sample taken faulted in, so the CPU thread normally finds its pages
+    // in memory whichever mode the waveform is in.
+    class Waveform {
+        public:
+            constexpr static std::size_t PREFETCH_BYTES = 0x100000u;
+
+            // What Sample does when the reader thread has fallen behind
+            enum class Mode {
+                // Takes the page fault, so a run always reads the same samples
+                Deterministic,
+                // Never waits on the disk: a sample on a page not in memory
+                // reads as the last value its channel gave, counted in
+                // misses()
+                NonBlocking
+            };
+
+        private:
+            uint8_t* _data;
+            std::size_t _size;
+            std::size_t _pageSize;
+            unsigned _channels;
+            uint64_t _cyclesPerFrame;
+            uint64_t _frames;
+            Mode _mode;
+
+            std::size_t _requestedTo;   // end of the window last handed to the reader
+            std::vector<uint16_t> _last;
+            uint64_t _misses;
+
+            std::mutex _mutex;
+            std::condition_variable _wake;
+            std::size_t _wanted;        // guarded by _mutex
+            bool _stopping;             // guarded by _mutex
+            std::thread _reader;
+
+            void Prefetch(std::size_t offset);
+            void ReadAhead();
+            bool Resident(std::size_t offset) const;
+
+        public:
+            Waveform(const std::string& path, unsigned channels, uint64_t cyclesPerFrame, Mode mode = Mode::Deterministic);
+            ~Waveform();
+
+            Waveform(const Waveform&) = delete;
+            Waveform& operator=(const Waveform&) = delete;
+
+            unsigned channels() const
+            {
+                return _channels;
+            }
+
+            uint64_t frames() const
+            {
+                return _frames;
+            }
+
+            Mode mode() const
+            {
+                return _mode;
+            }
+
+            // Samples NonBlocking mode repeated because their page was not
+            // in memory; always 0 in Deterministic mode
+            uint64_t misses() const
+            {
+                return _misses;
+            }
+
+            // The channel's sample at cycle, or 0 for a channel the file
+            // does not have
+            uint16_t Sample(unsigned channel, uint64_t cycle);
+    };
+}
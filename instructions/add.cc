@@ -1,48 +1,48 @@
+#include "core/flags.h"
 #include "instructions/add.h"
 #include "instructions/opcodes.h"
 
 #include <cstdint>
 
 namespace avr {
-    uint8_t& ADDInstruction::GetSourceRegister(CPU& cpu, uint16_t opcode) const
+    uint8_t ADDInstruction::GetSourceRegister(uint16_t opcode) const
     {
         auto mask = 0x020F;
         uint8_t value = static_cast<uint8_t>((opcode & (mask & 0xFF)) | ((opcode >> 5) & (mask >> 5)));
-        return cpu.R[value];
+        return value;
     }
 
-    uint8_t& ADDInstruction::GetDestinationRegister(CPU& cpu, uint16_t opcode) const
+    uint8_t ADDInstruction::GetDestinationRegister(uint16_t opcode) const
     {
         auto mask = 0x01F0;
         uint8_t value = static_cast<uint8_t>((opcode >> 4) & (mask >> 4));
-        return cpu.R[value];
+        return value;
     }
 
-    void ADDInstruction::SetRegisterFlags(CPU& cpu, uint8_t& rr, uint8_t& rd, uint8_t result) const
+    void ADDInstruction::Decode(DecodedInstruction& insn) const
     {
-        cpu.SREG.H = ((rd & 0x08) && (rr & 0x08)) ||
-            (((rr & 0x08) || (rd & 0x08)) && !(result & 0x08));
-        cpu.SREG.V = ((rd & 0x80) && (rr & 0x80) && !(result & 0x80)) ||
-            (!(rd & 0x80) && !(rr & 0x80) && (result & 0x80));
-        cpu.SREG.N = static_cast<bool>(result & 0x80);
-        cpu.SREG.S = cpu.SREG.N ^ cpu.SREG.V;
-        cpu.SREG.Z = result == 0;
-        cpu.SREG.C = ((rd & 0x80) && (rr & 0x80)) || 
-            (!(result & 0x80) && ((rd & 0x80) || (rr & 0x80)));
+        insn.op = IsADC(insn.opcode) ? Operation::ADC : Operation::ADD;
+        insn.rr = GetSourceRegister(insn.opcode);
+        insn.rd = GetDestinationRegister(insn.opcode);
+        insn.cycles = static_cast<uint8_t>(_cyclesConsumed);
     }
 
     uint32_t ADDInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
-        auto& rr = GetSourceRegister(ctx.cpu, opcode);
-        auto& rd = GetDestinationRegister(ctx.cpu, opcode);
+        return ExecuteDecoded(Predecode(opcode, ctx), ctx);
+    }
+
+    uint32_t ADDInstruction::ExecuteDecoded(const DecodedInstruction& insn, ExecutionContext& ctx) const
+    {
+        auto& rr = ctx.cpu.R[insn.rr];
+        auto& rd = ctx.cpu.R[insn.rd];
 
         auto value = static_cast<uint8_t>(rr + rd);
-        if (IsADC(opcode))
+        if (IsADC(insn.opcode))
             value += ctx.cpu.SREG.C;
 
-        SetRegisterFlags(ctx.cpu, rr, rd, value);
+        SetAddFlags(ctx.cpu, rd, rr, value);
         rd = value;
-        _clock.ConsumeCycle();
 
         return _cyclesConsumed;
     }
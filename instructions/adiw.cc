@@ -39,9 +39,7 @@ namespace avr {
         SetRegisterFlags(ctx.cpu, ctx.cpu.R[dstIndex+1], value);
 
         ctx.cpu.R[dstIndex] = static_cast<uint8_t>(0xFF & value);
-        _clock.ConsumeCycle();
         ctx.cpu.R[dstIndex+1] = static_cast<uint8_t>(0xFF & (value >> 8));
-        _clock.ConsumeCycle();
         
         return _cyclesConsumed;
     }
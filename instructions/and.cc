@@ -1,41 +1,46 @@
+#include "core/flags.h"
 #include "instructions/and.h"
 #include "instructions/opcodes.h"
 
 #include <cstdint>
 
 namespace avr {
-    uint8_t& ANDInstruction::GetSourceRegister(CPU& cpu, uint16_t opcode) const
+    uint8_t ANDInstruction::GetSourceRegister(uint16_t opcode) const
     {
         auto mask = 0x020F;
         uint8_t value = static_cast<uint8_t>((opcode & (mask & 0xFF)) | ((opcode >> 5) & (mask >> 5)));
-        return cpu.R[value];
+        return value;
     }
 
-    uint8_t& ANDInstruction::GetDestinationRegister(CPU& cpu, uint16_t opcode) const
+    uint8_t ANDInstruction::GetDestinationRegister(uint16_t opcode) const
     {
         auto mask = 0x01F0;
         uint8_t value = static_cast<uint8_t>((opcode >> 4) & (mask >> 4));
-        return cpu.R[value];
+        return value;
     }
 
-    void ANDInstruction::SetRegisterFlags(CPU& cpu, uint8_t result) const
+    void ANDInstruction::Decode(DecodedInstruction& insn) const
     {
-        cpu.SREG.V = 0;
-        cpu.SREG.N = (result & 0x80u) != 0u;
-        cpu.SREG.S = cpu.SREG.V ^ cpu.SREG.N;
-        cpu.SREG.Z = result == 0u;
+        insn.op = Operation::AND;
+        insn.rr = GetSourceRegister(insn.opcode);
+        insn.rd = GetDestinationRegister(insn.opcode);
+        insn.cycles = static_cast<uint8_t>(_cyclesConsumed);
     }
 
     uint32_t ANDInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
-        auto& rr = GetSourceRegister(ctx.cpu, opcode);
-        auto& rd = GetDestinationRegister(ctx.cpu, opcode);
+        return ExecuteDecoded(Predecode(opcode, ctx), ctx);
+    }
+
+    uint32_t ANDInstruction::ExecuteDecoded(const DecodedInstruction& insn, ExecutionContext& ctx) const
+    {
+        auto& rr = ctx.cpu.R[insn.rr];
+        auto& rd = ctx.cpu.R[insn.rd];
 
         auto value = static_cast<uint8_t>(rr & rd);
 
-        SetRegisterFlags(ctx.cpu, value);
+        SetLogicFlags(ctx.cpu, value);
         rd = value;
-        _clock.ConsumeCycle();
 
         return _cyclesConsumed;
     }
@@ -1,4 +1,5 @@
 #include "core/cpu.h"
+#include "core/flags.h"
 #include "core/memory.h"
 #include "instructions/andi.h"
 #include "instructions/opcodes.h"
@@ -13,28 +14,32 @@ namespace avr {
         return highNibble | lowNibble;
     }
 
-    uint8_t& ANDIInstruction::GetDestinationRegister(CPU& cpu, uint16_t opcode) const
+    uint8_t ANDIInstruction::GetDestinationRegister(uint16_t opcode) const
     {
         auto dstIndex = static_cast<uint8_t>(((opcode & 0x00f0) >> 4) + 16);
-        return cpu.R[dstIndex];
+        return dstIndex;
     }
 
-    void ANDIInstruction::SetRegisterFlags(CPU& cpu, uint16_t result) const
+    void ANDIInstruction::Decode(DecodedInstruction& insn) const
     {
-        cpu.SREG.V = 0;
-        cpu.SREG.N = (result & 0x80) != 0u;
-        cpu.SREG.S = cpu.SREG.N;
-        cpu.SREG.Z = result == 0;
+        insn.op = Operation::ANDI;
+        insn.rd = GetDestinationRegister(insn.opcode);
+        insn.k = GetSourceValue(insn.opcode);
+        insn.cycles = static_cast<uint8_t>(_cyclesConsumed);
     }
 
     uint32_t ANDIInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
-        auto src = GetSourceValue(opcode);
-        auto& dst = GetDestinationRegister(ctx.cpu, opcode);
+        return ExecuteDecoded(Predecode(opcode, ctx), ctx);
+    }
+
+    uint32_t ANDIInstruction::ExecuteDecoded(const DecodedInstruction& insn, ExecutionContext& ctx) const
+    {
+        auto src = static_cast<uint8_t>(insn.k);
+        auto& dst = ctx.cpu.R[insn.rd];
         
         dst = static_cast<uint16_t>(dst & src);
-        SetRegisterFlags(ctx.cpu, dst);
-        _clock.ConsumeCycle();
+        SetLogicFlags(ctx.cpu, dst);
 
         return _cyclesConsumed;
     }
@@ -1,7 +1,6 @@
 #pragma once
 
 #include "core/executioncontext.h"
-#include "core/iclock.h"
 #include "instructions/instructionexecutor.h"
 
 #include <cstdint>
@@ -9,19 +8,15 @@
 namespace avr {
     class ANDIInstruction: public InstructionExecutor {
         private:
-            IClock& _clock;
             const uint32_t _cyclesConsumed = 1u;
 
             uint8_t GetSourceValue(uint16_t opcode) const;
-            uint8_t& GetDestinationRegister(CPU& cpu, uint16_t opcode) const;
-            void SetRegisterFlags(CPU& cpu, uint16_t result) const;
+            uint8_t GetDestinationRegister(uint16_t opcode) const;
 
         public:
-            ANDIInstruction(IClock& clock)
-                : _clock(clock)
-            {}
-
             uint32_t Execute(uint16_t opcode, ExecutionContext& ctx) const override;
             bool Matches(uint16_t opcode) const override;
+            void Decode(DecodedInstruction& insn) const override;
+            uint32_t ExecuteDecoded(const DecodedInstruction& insn, ExecutionContext& ctx) const override;
     };
 }
@@ -28,7 +28,6 @@ namespace avr {
 
         SetRegisterFlags(ctx.cpu, rd, value);
         rd = value;
-        _clock.ConsumeCycle();
 
         return _cyclesConsumed;
     }
@@ -1,7 +1,6 @@
 #pragma once
 
 #include "core/executioncontext.h"
-#include "core/iclock.h"
 #include "instructions/instructionexecutor.h"
 
 #include <cstdint>
@@ -9,17 +8,12 @@
 namespace avr {
     class ASRInstruction: public InstructionExecutor {
         private:
-            IClock& _clock;
             const uint32_t _cyclesConsumed = 1u;
 
             uint8_t& GetDestinationRegister(CPU& cpu, uint16_t opcode) const;
             void SetRegisterFlags(CPU& cpu, uint8_t rd, uint8_t result) const;
 
         public:
-            ASRInstruction(IClock& clock)
-                : _clock(clock)
-            {}
-
             uint32_t Execute(uint16_t opcode, ExecutionContext& ctx) const override;
             bool Matches(uint16_t opcode) const override;
     };
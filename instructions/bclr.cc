@@ -30,9 +30,12 @@ namespace avr {
         else if (src == 6u)
             ctx.cpu.SREG.T = flagValue;
         else if (src == 7u)
+        {
             ctx.cpu.SREG.I = flagValue;
-
-        _clock.ConsumeCycle();
+            // The instruction after SEI always runs before any interrupt
+            if (flagValue)
+                ctx.HoldInterrupts(_cyclesConsumed + 1u);
+        }
 
         return _cyclesConsumed;
     }
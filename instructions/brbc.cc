@@ -38,19 +38,28 @@ namespace avr {
         return cpu.SREG.I == branchIfSet;
     }
 
+    void BRBCInstruction::Decode(DecodedInstruction& insn) const
+    {
+        insn.op = Operation::BRBC;
+        insn.rr = GetSourceValue(insn.opcode);
+        insn.k = static_cast<uint16_t>(GetDestinationOffset(insn.opcode));
+        insn.cycles = 1u;
+    }
+
     uint32_t BRBCInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
-        auto flagIndex = GetSourceValue(opcode);
+        return ExecuteDecoded(Predecode(opcode, ctx), ctx);
+    }
 
-        auto shouldBranch = ShouldBranch(opcode, ctx.cpu, flagIndex);
-        _clock.ConsumeCycle();
+    uint32_t BRBCInstruction::ExecuteDecoded(const DecodedInstruction& insn, ExecutionContext& ctx) const
+    {
+        auto flagIndex = insn.rr;
+
+        auto shouldBranch = ShouldBranch(insn.opcode, ctx.cpu, flagIndex);
         if (!shouldBranch)
             return 1;
 
-        auto offset = GetDestinationOffset(opcode);
-        ctx.cpu.PC += offset;
-
-        _clock.ConsumeCycle();
+        ctx.cpu.PC += insn.k;
 
         return 2;
     }
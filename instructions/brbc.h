@@ -1,7 +1,6 @@
 #pragma once
 
 #include "core/executioncontext.h"
-#include "core/iclock.h"
 #include "instructions/instructionexecutor.h"
 #include "instructions/opcodes.h"
 
@@ -10,7 +9,6 @@
 namespace avr {
     class BRBCInstruction: public InstructionExecutor {
         private:
-            IClock& _clock;
 
             uint8_t GetSourceValue(uint16_t opcode) const;
             int8_t GetDestinationOffset(uint16_t opcode) const;
@@ -18,11 +16,9 @@ namespace avr {
             bool Matches(uint16_t opcode, OpCode op, OpCodeMask mask) const;
 
         public:
-            BRBCInstruction(IClock& clock)
-                : _clock(clock)
-            {}
-
             uint32_t Execute(uint16_t opcode, ExecutionContext& ctx) const override;
             bool Matches(uint16_t opcode) const override;
+            void Decode(DecodedInstruction& insn) const override;
+            uint32_t ExecuteDecoded(const DecodedInstruction& insn, ExecutionContext& ctx) const override;
     };
 }
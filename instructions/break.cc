@@ -6,7 +6,6 @@
 namespace avr {
     uint32_t BREAKInstruction::Execute(uint16_t, ExecutionContext&) const
     {
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
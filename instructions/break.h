@@ -1,7 +1,6 @@
 #pragma once
 
 #include "core/executioncontext.h"
-#include "core/iclock.h"
 #include "instructions/instructionexecutor.h"
 #include "instructions/opcodes.h"
 
@@ -10,14 +9,9 @@
 namespace avr {
     class BREAKInstruction: public InstructionExecutor {
         private:
-            IClock& _clock;
             const uint16_t _cyclesConsumed = 1u;
 
         public:
-            BREAKInstruction(IClock& clock)
-                : _clock(clock)
-            {}
-
             uint32_t Execute(uint16_t opcode, ExecutionContext& ctx) const override;
             bool Matches(uint16_t opcode) const override;
     };
@@ -23,7 +23,6 @@ namespace avr {
         auto& rd = GetDestinationRegister(ctx.cpu, opcode);
 
         ctx.cpu.SREG.T = (rd >> bitShift) == 1u;
-        _clock.ConsumeCycle();
 
         return _cyclesConsumed;
     }
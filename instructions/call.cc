@@ -8,27 +8,32 @@ namespace avr {
     {
         uint16_t returnAddress = cpu.PC + static_cast<uint16_t>(sizeof(cpu.PC));
         for (uint16_t i = 0u; i < sizeof(cpu.PC); i++)
-        {
-            _clock.ConsumeCycle();
             mem[cpu.SP--] = static_cast<uint8_t>((returnAddress >> (i * 8u)) & 0xFFu);
-        }
     }
 
-    uint16_t CALLInstruction::GetDestinationAddress(CPU& cpu, ProgramMemory& mem) const
+    uint16_t CALLInstruction::GetDestinationAddress(uint16_t operand) const
     {
-        auto address = static_cast<uint16_t>(0u);
-        for (auto i = 0u; i < sizeof(address); i++)
-            address |= static_cast<uint16_t>(mem[cpu.PC++] << (i * 8u));
         // Actual avr assembly has this shifted right one bit to prevent odd addresses
-        _clock.ConsumeCycle();
-        return (address << 1u);
+        return static_cast<uint16_t>(operand << 1u);
     }
 
-    uint32_t CALLInstruction::Execute(uint16_t, ExecutionContext& ctx) const
+    void CALLInstruction::Decode(DecodedInstruction& insn) const
+    {
+        insn.op = Operation::CALL;
+        insn.k = GetDestinationAddress(insn.operand);
+        insn.size = 2u;
+        insn.cycles = static_cast<uint8_t>(_cyclesConsumed);
+    }
+
+    uint32_t CALLInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
+    {
+        return ExecuteDecoded(Predecode(opcode, ctx), ctx);
+    }
+
+    uint32_t CALLInstruction::ExecuteDecoded(const DecodedInstruction& insn, ExecutionContext& ctx) const
     {
         PushReturnAddress(ctx.cpu, ctx.ram);
-        ctx.cpu.PC = GetDestinationAddress(ctx.cpu, ctx.progMem);
-        _clock.ConsumeCycle();
+        ctx.cpu.PC = insn.k;
         return _cyclesConsumed;
     }
 
@@ -1,7 +1,6 @@
 #pragma once
 
 #include "core/executioncontext.h"
-#include "core/iclock.h"
 #include "instructions/instructionexecutor.h"
 
 #include <cstdint>
@@ -9,18 +8,15 @@
 namespace avr {
     class CALLInstruction: public InstructionExecutor {
         private:
-            IClock& _clock;
             const uint32_t _cyclesConsumed = 4u;
 
             void PushReturnAddress(CPU& cpu, SRAM& mem) const;
-            uint16_t GetDestinationAddress(CPU& cpu, ProgramMemory& mem) const;
+            uint16_t GetDestinationAddress(uint16_t operand) const;
 
         public:
-            CALLInstruction(IClock& clock)
-                : _clock(clock)
-            {}
-
             uint32_t Execute(uint16_t opcode, ExecutionContext& ctx) const override;
             bool Matches(uint16_t opcode) const override;
+            void Decode(DecodedInstruction& insn) const override;
+            uint32_t ExecuteDecoded(const DecodedInstruction& insn, ExecutionContext& ctx) const override;
     };
 }
@@ -4,11 +4,11 @@
 #include <cstdint>
 
 namespace avr {
-    uint8_t& CBIInstruction::GetDestinationRegister(CPU& cpu, uint16_t opcode) const
+    uint16_t CBIInstruction::GetDestinationAddress(uint16_t opcode) const
     {
         auto mask = 0x00F8u;
         auto index = static_cast<uint16_t>((opcode & mask) >> 3);
-        return cpu.GPIO[index];
+        return static_cast<uint16_t>(IOBus::BEGIN + index);
     }
 
     uint8_t CBIInstruction::GetSourceBit(uint16_t opcode) const
@@ -18,15 +18,10 @@ namespace avr {
 
     uint32_t CBIInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
-        auto& rd = GetDestinationRegister(ctx.cpu, opcode);
+        auto address = GetDestinationAddress(opcode);
         auto src = GetSourceBit(opcode);
-        auto mask = static_cast<uint8_t>(0xFFu ^ (0x1u << src));
 
-        uint8_t value = rd & mask;
-        _clock.ConsumeCycle();
-
-        rd = value;
-        _clock.ConsumeCycle();
+        ctx.StoreBit(address, src, false);
 
         return _cyclesConsumed;
     }
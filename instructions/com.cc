@@ -25,7 +25,6 @@ namespace avr {
         auto& rd = GetDestinationRegister(ctx.cpu, opcode);
         rd ^= 0xFFu;
         SetStatusRegisters(ctx.cpu, rd);
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
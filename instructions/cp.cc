@@ -1,50 +1,48 @@
+#include "core/flags.h"
 #include "instructions/cp.h"
 #include "instructions/opcodes.h"
 
 #include <cstdint>
 
 namespace avr {
-    uint8_t& CPInstruction::GetDestinationRegister(CPU& cpu, uint16_t opcode) const
+    uint8_t CPInstruction::GetDestinationRegister(uint16_t opcode) const
     {
         auto mask = 0x01F0u;
         auto index = static_cast<uint16_t>((opcode & mask) >> 4);
-        return cpu.R[index];
+        return static_cast<uint8_t>(index);
     }
 
-    uint8_t& CPInstruction::GetSourceRegister(CPU& cpu, uint16_t opcode) const
+    uint8_t CPInstruction::GetSourceRegister(uint16_t opcode) const
     {
         auto index = static_cast<uint16_t>(
                 ((opcode & 0x200u) >> 5u) |
                 (opcode & 0x0Fu));
-        return cpu.R[index];
+        return static_cast<uint8_t>(index);
     }
 
-    void CPInstruction::SetStatusRegisters(CPU& cpu, uint8_t rr, uint8_t rd, int8_t result) const
+    void CPInstruction::Decode(DecodedInstruction& insn) const
     {
-        cpu.SREG.Z = result == 0;
-        cpu.SREG.N = result < 0;
-        cpu.SREG.C = (!(rd & 0x80u) && (rr & 0x80u))
-            || ((rr & 0x80u) && (result & 0x80))
-            || ((result & 0x80) && !(rd & 0x80u));
-        cpu.SREG.V = ((rd & 0x80u) && !(rr & 0x80u) && !(result & 0x80))
-            || (!(rd & 0x80u) && (rr & 0x80u) && (result & 0x80));
-        cpu.SREG.S = cpu.SREG.V ^ cpu.SREG.N;
-        cpu.SREG.H = (!(rd & 0x08u) && (rr & 0x08u))
-            || ((rr & 0x08u) && (result & 0x08))
-            || ((result & 0x08) && !(rd & 0x08u));
+        insn.op = Matches(insn.opcode, OpCode::CPC, OpCodeMask::CPC) ? Operation::CPC : Operation::CP;
+        insn.rr = GetSourceRegister(insn.opcode);
+        insn.rd = GetDestinationRegister(insn.opcode);
+        insn.cycles = static_cast<uint8_t>(_cyclesConsumed);
     }
 
     uint32_t CPInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
-        auto& rd = GetDestinationRegister(ctx.cpu, opcode);
-        auto& rr = GetSourceRegister(ctx.cpu, opcode);
+        return ExecuteDecoded(Predecode(opcode, ctx), ctx);
+    }
+
+    uint32_t CPInstruction::ExecuteDecoded(const DecodedInstruction& insn, ExecutionContext& ctx) const
+    {
+        auto& rd = ctx.cpu.R[insn.rd];
+        auto& rr = ctx.cpu.R[insn.rr];
 
         int8_t value = static_cast<int8_t>(rd) - static_cast<int8_t>(rr);
-        if (Matches(opcode, OpCode::CPC, OpCodeMask::CPC))
+        if (Matches(insn.opcode, OpCode::CPC, OpCodeMask::CPC))
             value -= ctx.cpu.SREG.C;
 
-        SetStatusRegisters(ctx.cpu, rr, rd, value);
-        _clock.ConsumeCycle();
+        SetSubtractFlags(ctx.cpu, rd, rr, static_cast<uint8_t>(value));
         return _cyclesConsumed;
     }
 
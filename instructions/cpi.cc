@@ -1,14 +1,15 @@
+#include "core/flags.h"
 #include "instructions/cpi.h"
 #include "instructions/opcodes.h"
 
 #include <cstdint>
 
 namespace avr {
-    uint8_t& CPIInstruction::GetDestinationRegister(CPU& cpu, uint16_t opcode) const
+    uint8_t CPIInstruction::GetDestinationRegister(uint16_t opcode) const
     {
         auto mask = 0x00F0u;
         auto index = static_cast<uint16_t>(((opcode & mask) >> 4) + 0x10u);
-        return cpu.R[index];
+        return static_cast<uint8_t>(index);
     }
 
     uint8_t CPIInstruction::GetImmediateValue(uint16_t opcode) const
@@ -17,30 +18,27 @@ namespace avr {
             | static_cast<uint8_t>(0xFu & opcode);
     }
 
-    void CPIInstruction::SetStatusRegisters(CPU& cpu, uint8_t k, uint8_t rd, int8_t result) const
+    void CPIInstruction::Decode(DecodedInstruction& insn) const
     {
-        cpu.SREG.Z = result == 0;
-        cpu.SREG.N = result < 0;
-        cpu.SREG.C = (!(rd & 0x80u) && (k & 0x80u))
-            || ((k & 0x80u) && (result & 0x80))
-            || ((result & 0x80) && !(rd & 0x80u));
-        cpu.SREG.V = ((rd & 0x80u) && !(k & 0x80u) && !(result & 0x80))
-            || (!(rd & 0x80u) && (k & 0x80u) && (result & 0x80));
-        cpu.SREG.S = cpu.SREG.V ^ cpu.SREG.N;
-        cpu.SREG.H = (!(rd & 0x08u) && (k & 0x08u))
-            || ((k & 0x08u) && (result & 0x08))
-            || ((result & 0x08) && !(rd & 0x08u));
+        insn.op = Operation::CPI;
+        insn.rd = GetDestinationRegister(insn.opcode);
+        insn.k = GetImmediateValue(insn.opcode);
+        insn.cycles = static_cast<uint8_t>(_cyclesConsumed);
     }
 
     uint32_t CPIInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
-        auto& rd = GetDestinationRegister(ctx.cpu, opcode);
-        auto k = GetImmediateValue(opcode);
+        return ExecuteDecoded(Predecode(opcode, ctx), ctx);
+    }
+
+    uint32_t CPIInstruction::ExecuteDecoded(const DecodedInstruction& insn, ExecutionContext& ctx) const
+    {
+        auto& rd = ctx.cpu.R[insn.rd];
+        auto k = static_cast<uint8_t>(insn.k);
 
         int8_t value = static_cast<int8_t>(rd) - static_cast<int8_t>(k);
 
-        SetStatusRegisters(ctx.cpu, k, rd, value);
-        _clock.ConsumeCycle();
+        SetSubtractFlags(ctx.cpu, rd, k, static_cast<uint8_t>(value));
         return _cyclesConsumed;
     }
 
@@ -7,26 +7,17 @@
 #include <tuple>
 
 namespace avr {
-    uint8_t& CPSEInstruction::GetSourceRegister(CPU& cpu, uint16_t opcode) const
+    uint8_t CPSEInstruction::GetSourceRegister(uint16_t opcode) const
     {
         auto index = static_cast<uint16_t>(((opcode & 0x0200u) >> 5u) | (opcode & 0x000Fu));
-        return cpu.R[index];
+        return static_cast<uint8_t>(index);
     }
 
-    uint8_t& CPSEInstruction::GetDestinationRegister(CPU& cpu, uint16_t opcode) const
+    uint8_t CPSEInstruction::GetDestinationRegister(uint16_t opcode) const
     {
         auto mask = 0x01F0u;
         auto index = static_cast<uint16_t>((opcode & mask) >> 4);
-        return cpu.R[index];
-    }
-
-    uint16_t CPSEInstruction::GetNextOpCode(const CPU& cpu, const ProgramMemory& mem) const
-    {
-        auto pc = cpu.PC;
-        auto opcode = static_cast<uint16_t>(0u);
-        for (uint16_t i = 0u; i < sizeof(pc); i++)
-            opcode |= static_cast<uint16_t>(mem[pc++] << (i * 8u));
-        return opcode;
+        return static_cast<uint8_t>(index);
     }
 
     uint16_t CPSEInstruction::GetOpCodeSize(uint16_t opcode) const
@@ -50,22 +41,29 @@ namespace avr {
         return (it == std::end(twoWordOpCodes)) ? 1u : 2u;
     }
 
+    void CPSEInstruction::Decode(DecodedInstruction& insn) const
+    {
+        insn.op = Operation::CPSE;
+        insn.rr = GetSourceRegister(insn.opcode);
+        insn.rd = GetDestinationRegister(insn.opcode);
+        insn.skip = static_cast<uint8_t>(GetOpCodeSize(insn.operand));
+        insn.cycles = 1u;
+    }
+
     uint32_t CPSEInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
-        auto& rr = GetSourceRegister(ctx.cpu, opcode);
-        auto& rd = GetDestinationRegister(ctx.cpu, opcode);
+        return ExecuteDecoded(Predecode(opcode, ctx), ctx);
+    }
+
+    uint32_t CPSEInstruction::ExecuteDecoded(const DecodedInstruction& insn, ExecutionContext& ctx) const
+    {
+        auto& rr = ctx.cpu.R[insn.rr];
+        auto& rd = ctx.cpu.R[insn.rd];
 
         if (rr != rd)
-        {
-            _clock.ConsumeCycle();
             return 1u;
-        }
-
-        auto nextOpcode = GetNextOpCode(ctx.cpu, ctx.progMem);
-        auto nextOpcodeSize = GetOpCodeSize(nextOpcode);
 
-        for (uint16_t i = 0; i < nextOpcodeSize; i++)
-            _clock.ConsumeCycle();
+        auto nextOpcodeSize = static_cast<uint16_t>(insn.skip);
 
         ctx.cpu.PC += static_cast<uint16_t>(nextOpcodeSize * 2u);
 
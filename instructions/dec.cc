@@ -1,33 +1,31 @@
+#include "core/flags.h"
 #include "instructions/dec.h"
 #include "instructions/opcodes.h"
 
 #include <cstdint>
 
 namespace avr {
-    uint8_t& DECInstruction::GetDestinationRegister(CPU& cpu, uint16_t opcode) const
+    uint8_t DECInstruction::GetDestinationRegister(uint16_t opcode) const
     {
         auto mask = 0x01F0u;
-        auto index = static_cast<uint16_t>((opcode & mask) >> 4);
-        return cpu.R[index];
+        return static_cast<uint8_t>((opcode & mask) >> 4);
     }
 
-    void DECInstruction::SetStatusRegisters(CPU& cpu, uint8_t rd, int8_t result) const
+    void DECInstruction::Decode(DecodedInstruction& insn) const
     {
-        cpu.SREG.Z = result == 0;
-        cpu.SREG.N = (static_cast<uint8_t>(result) & 0x80u) != 0u;
-        cpu.SREG.V = rd == 0x80u;
-        cpu.SREG.S = cpu.SREG.N ^ cpu.SREG.V;
+        insn.op = Operation::DEC;
+        insn.rd = GetDestinationRegister(insn.opcode);
+        insn.cycles = static_cast<uint8_t>(_cyclesConsumed);
     }
 
     uint32_t DECInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
-        auto& rd = GetDestinationRegister(ctx.cpu, opcode);
+        auto& rd = ctx.cpu.R[GetDestinationRegister(opcode)];
 
         int8_t value = static_cast<int8_t>(rd - 1u);
-        SetStatusRegisters(ctx.cpu, rd, value);
+        SetLogicFlags(ctx.cpu, static_cast<uint8_t>(value), rd == 0x80u);
         rd = static_cast<uint8_t>(value);
 
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
@@ -41,9 +41,7 @@ namespace avr {
 
         SetRegisterFlags(ctx.cpu, result, carry);
 
-        _clock.ConsumeCycle();
         WriteResult(ctx.cpu, result);
-        _clock.ConsumeCycle();
 
         return 2u;
     }
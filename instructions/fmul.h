@@ -2,7 +2,6 @@
 
 
 #include "core/executioncontext.h"
-#include "core/iclock.h"
 #include "instructions/instructionexecutor.h"
 #include "instructions/opcodes.h"
 
@@ -11,7 +10,6 @@
 namespace avr {
     class FMULInstruction: public InstructionExecutor {
         private:
-            IClock& _clock;
 
             bool Matches(uint16_t opcode, OpCode code, OpCodeMask mask) const;
             uint8_t& GetSourceRegister(CPU& cpu, uint16_t opcode) const;
@@ -20,10 +18,6 @@ namespace avr {
             void SetRegisterFlags(CPU& cpu, uint16_t result, bool carry) const;
 
         public:
-            FMULInstruction(IClock& clock)
-                : _clock(clock)
-            {}
-
             uint32_t Execute(uint16_t opcode, ExecutionContext& ctx) const override;
             bool Matches(uint16_t opcode) const override;
     };
@@ -7,17 +7,14 @@ namespace avr {
     void ICALLInstruction::PushReturnAddress(CPU& cpu, SRAM& mem) const
     {
         uint16_t returnAddress = cpu.PC;
-        for (uint16_t i = 0u; i < sizeof(cpu.PC); i++) {
-            _clock.ConsumeCycle();
+        for (uint16_t i = 0u; i < sizeof(cpu.PC); i++)
             mem[cpu.SP--] = static_cast<uint8_t>((returnAddress >> (i * 8u)) & 0xFFu);
-        }
     }
 
     uint32_t ICALLInstruction::Execute(uint16_t, ExecutionContext& ctx) const
     {
         PushReturnAddress(ctx.cpu, ctx.ram);
         ctx.cpu.PC = *ctx.cpu.Z;
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
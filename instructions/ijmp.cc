@@ -7,8 +7,6 @@ namespace avr {
     uint32_t IJMPInstruction::Execute(uint16_t, ExecutionContext& ctx) const
     {
         ctx.cpu.PC = *ctx.cpu.Z;
-        _clock.ConsumeCycle();
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
@@ -4,11 +4,11 @@
 #include <cstdint>
 
 namespace avr {
-    uint8_t& INInstruction::GetSourceRegister(CPU& cpu, uint16_t opcode) const
+    uint16_t INInstruction::GetSourceAddress(uint16_t opcode) const
     {
         auto mask = 0x060F;
         uint8_t value = static_cast<uint8_t>((opcode & (mask & 0xFF)) | ((opcode >> 5) & (mask >> 5)));
-        return cpu.GPIO[value];
+        return static_cast<uint16_t>(IOBus::BEGIN + value);
     }
 
     uint8_t& INInstruction::GetDestinationRegister(CPU& cpu, uint16_t opcode) const
@@ -20,12 +20,11 @@ namespace avr {
 
     uint32_t INInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
-        auto& rr = GetSourceRegister(ctx.cpu, opcode);
+        auto address = GetSourceAddress(opcode);
         auto& rd = GetDestinationRegister(ctx.cpu, opcode);
 
-        rd = rr;
+        rd = ctx.Load(address);
 
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
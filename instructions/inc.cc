@@ -1,32 +1,30 @@
+#include "core/flags.h"
 #include "instructions/inc.h"
 #include "instructions/opcodes.h"
 
 #include <cstdint>
 
 namespace avr {
-    uint8_t& INCInstruction::GetDestinationRegister(CPU& cpu, uint16_t opcode) const
+    uint8_t INCInstruction::GetDestinationRegister(uint16_t opcode) const
     {
         auto mask = 0x01F0u;
-        auto index = static_cast<uint16_t>((opcode & mask) >> 4);
-        return cpu.R[index];
+        return static_cast<uint8_t>((opcode & mask) >> 4);
     }
 
-    void INCInstruction::SetStatusRegisters(CPU& cpu, uint8_t rd) const
+    void INCInstruction::Decode(DecodedInstruction& insn) const
     {
-        cpu.SREG.Z = rd == 0;
-        cpu.SREG.N = (rd & 0x80u) != 0u;
-        cpu.SREG.V = rd == 0x80u;
-        cpu.SREG.S = cpu.SREG.N ^ cpu.SREG.V;
+        insn.op = Operation::INC;
+        insn.rd = GetDestinationRegister(insn.opcode);
+        insn.cycles = static_cast<uint8_t>(_cyclesConsumed);
     }
 
     uint32_t INCInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
-        auto& rd = GetDestinationRegister(ctx.cpu, opcode);
+        auto& rd = ctx.cpu.R[GetDestinationRegister(opcode)];
 
         rd = static_cast<uint8_t>(rd + 1u);
-        SetStatusRegisters(ctx.cpu, rd);
+        SetLogicFlags(ctx.cpu, rd, rd == 0x80u);
 
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
@@ -1,14 +1,40 @@
 #pragma once
 
+#include "core/decodecache.h"
 #include "core/executioncontext.h"
 
 #include <cstdint>
 
 namespace avr {
     class InstructionExecutor {
+        protected:
+            // Decodes the opcode the way the Executor would when PC already
+            // points past it, for use by the opcode-only Execute path
+            DecodedInstruction Predecode(uint16_t opcode, const ExecutionContext& ctx) const
+            {
+                auto insn = DecodedInstruction();
+                insn.executor = this;
+                insn.opcode = opcode;
+                insn.operand = static_cast<uint16_t>(
+                    ctx.progMem[ctx.cpu.PC] |
+                    (ctx.progMem[static_cast<uint16_t>(ctx.cpu.PC + 1u)] << 8u));
+                insn.size = 1u;
+                Decode(insn);
+                return insn;
+            }
+
         public:
             virtual ~InstructionExecutor() {}
             virtual uint32_t Execute(uint16_t opcode, ExecutionContext& ctx) const = 0;
             virtual bool Matches(uint16_t opcode) const = 0;
+
+            // Extracts operands from insn.opcode/insn.operand once so that
+            // ExecuteDecoded does not have to on every execution
+            virtual void Decode(DecodedInstruction&) const {}
+
+            virtual uint32_t ExecuteDecoded(const DecodedInstruction& insn, ExecutionContext& ctx) const
+            {
+                return Execute(insn.opcode, ctx);
+            }
     };
 }
@@ -1,5 +1,4 @@
 #include "cdif/cdif.h"
-#include "core/iclock.h"
 #include "instructions/add.h"
 #include "instructions/adiw.h"
 #include "instructions/and.h"
@@ -77,145 +76,145 @@
 namespace avr {
     void InstructionModule::load(cdif::Container& ctx)
     {
-        ctx.bind<ADDInstruction, IClock&>()
+        ctx.bind<ADDInstruction>()
             .build();
-        ctx.bind<ADIWInstruction, IClock&>()
+        ctx.bind<ADIWInstruction>()
             .build();
-        ctx.bind<ANDInstruction, IClock&>()
+        ctx.bind<ANDInstruction>()
             .build();
-        ctx.bind<ANDIInstruction, IClock&>()
+        ctx.bind<ANDIInstruction>()
             .build();
-        ctx.bind<ASRInstruction, IClock&>()
+        ctx.bind<ASRInstruction>()
             .build();
-        ctx.bind<BCLRInstruction, IClock&>()
+        ctx.bind<BCLRInstruction>()
             .build();
-        ctx.bind<BLDInstruction, IClock&>()
+        ctx.bind<BLDInstruction>()
             .build();
-        ctx.bind<BRBCInstruction, IClock&>()
+        ctx.bind<BRBCInstruction>()
             .build();
-        ctx.bind<BREAKInstruction, IClock&>()
+        ctx.bind<BREAKInstruction>()
             .build();
-        ctx.bind<BSTInstruction, IClock&>()
+        ctx.bind<BSTInstruction>()
             .build();
-        ctx.bind<CALLInstruction, IClock&>()
+        ctx.bind<CALLInstruction>()
             .build();
-        ctx.bind<CBIInstruction, IClock&>()
+        ctx.bind<CBIInstruction>()
             .build();
-        ctx.bind<COMInstruction, IClock&>()
+        ctx.bind<COMInstruction>()
             .build();
-        ctx.bind<CPIInstruction, IClock&>()
+        ctx.bind<CPIInstruction>()
             .build();
-        ctx.bind<CPInstruction, IClock&>()
+        ctx.bind<CPInstruction>()
             .build();
-        ctx.bind<CPSEInstruction, IClock&>()
+        ctx.bind<CPSEInstruction>()
             .build();
-        ctx.bind<DECInstruction, IClock&>()
+        ctx.bind<DECInstruction>()
             .build();
-        ctx.bind<EORInstruction, IClock&>()
+        ctx.bind<EORInstruction>()
             .build();
-        ctx.bind<FMULInstruction, IClock&>()
+        ctx.bind<FMULInstruction>()
             .build();
-        ctx.bind<ICALLInstruction, IClock&>()
+        ctx.bind<ICALLInstruction>()
             .build();
-        ctx.bind<IJMPInstruction, IClock&>()
+        ctx.bind<IJMPInstruction>()
             .build();
-        ctx.bind<INInstruction, IClock&>()
+        ctx.bind<INInstruction>()
             .build();
-        ctx.bind<INCInstruction, IClock&>()
+        ctx.bind<INCInstruction>()
             .build();
-        ctx.bind<JMPInstruction, IClock&>()
+        ctx.bind<JMPInstruction>()
             .build();
-        ctx.bind<LACInstruction, IClock&>()
+        ctx.bind<LACInstruction>()
             .build();
-        ctx.bind<LASInstruction, IClock&>()
+        ctx.bind<LASInstruction>()
             .build();
-        ctx.bind<LATInstruction, IClock&>()
+        ctx.bind<LATInstruction>()
             .build();
-        ctx.bind<LDInstruction, IClock&>()
+        ctx.bind<LDInstruction>()
             .build();
-        ctx.bind<LDDInstruction, IClock&>()
+        ctx.bind<LDDInstruction>()
             .build();
-        ctx.bind<LDDZInstruction, IClock&>()
+        ctx.bind<LDDZInstruction>()
             .build();
-        ctx.bind<LDIInstruction, IClock&>()
+        ctx.bind<LDIInstruction>()
             .build();
-        ctx.bind<LDSInstruction, IClock&>()
+        ctx.bind<LDSInstruction>()
             .build();
-        ctx.bind<LPMInstruction, IClock&>()
+        ctx.bind<LPMInstruction>()
             .build();
-        ctx.bind<LSRInstruction, IClock&>()
+        ctx.bind<LSRInstruction>()
             .build();
-        ctx.bind<MOVInstruction, IClock&>()
+        ctx.bind<MOVInstruction>()
             .build();
-        ctx.bind<MOVWInstruction, IClock&>()
+        ctx.bind<MOVWInstruction>()
             .build();
-        ctx.bind<MULInstruction, IClock&>()
+        ctx.bind<MULInstruction>()
             .build();
-        ctx.bind<MULSInstruction, IClock&>()
+        ctx.bind<MULSInstruction>()
             .build();
-        ctx.bind<MULSUInstruction, IClock&>()
+        ctx.bind<MULSUInstruction>()
             .build();
-        ctx.bind<NEGInstruction, IClock&>()
+        ctx.bind<NEGInstruction>()
             .build();
-        ctx.bind<NOPInstruction, IClock&>()
+        ctx.bind<NOPInstruction>()
             .build();
-        ctx.bind<ORInstruction, IClock&>()
+        ctx.bind<ORInstruction>()
             .build();
-        ctx.bind<ORIInstruction, IClock&>()
+        ctx.bind<ORIInstruction>()
             .build();
-        ctx.bind<OUTInstruction, IClock&>()
+        ctx.bind<OUTInstruction>()
             .build();
-        ctx.bind<POPInstruction, IClock&>()
+        ctx.bind<POPInstruction>()
             .build();
-        ctx.bind<PUSHInstruction, IClock&>()
+        ctx.bind<PUSHInstruction>()
             .build();
-        ctx.bind<RCALLInstruction, IClock&>()
+        ctx.bind<RCALLInstruction>()
             .build();
-        ctx.bind<RETInstruction, IClock&>()
+        ctx.bind<RETInstruction>()
             .build();
-        ctx.bind<RETIInstruction, IClock&>()
+        ctx.bind<RETIInstruction>()
             .build();
-        ctx.bind<RJMPInstruction, IClock&>()
+        ctx.bind<RJMPInstruction>()
             .build();
-        ctx.bind<ROLInstruction, IClock&>()
+        ctx.bind<ROLInstruction>()
             .build();
-        ctx.bind<RORInstruction, IClock&>()
+        ctx.bind<RORInstruction>()
             .build();
-        ctx.bind<SBCInstruction, IClock&>()
+        ctx.bind<SBCInstruction>()
             .build();
-        ctx.bind<SBCIInstruction, IClock&>()
+        ctx.bind<SBCIInstruction>()
             .build();
-        ctx.bind<SBIInstruction, IClock&>()
+        ctx.bind<SBIInstruction>()
             .build();
-        ctx.bind<SBICInstruction, IClock&>()
+        ctx.bind<SBICInstruction>()
             .build();
-        ctx.bind<SBISInstruction, IClock&>()
+        ctx.bind<SBISInstruction>()
             .build();
-        ctx.bind<SBIWInstruction, IClock&>()
+        ctx.bind<SBIWInstruction>()
             .build();
-        ctx.bind<SBRCInstruction, IClock&>()
+        ctx.bind<SBRCInstruction>()
             .build();
-        ctx.bind<SBRSInstruction, IClock&>()
+        ctx.bind<SBRSInstruction>()
             .build();
-        ctx.bind<SLEEPInstruction, IClock&>()
+        ctx.bind<SLEEPInstruction>()
             .build();
-        ctx.bind<SPMInstruction, IClock&>()
+        ctx.bind<SPMInstruction>()
             .build();
-        ctx.bind<STXInstruction, IClock&>()
+        ctx.bind<STXInstruction>()
             .build();
-        ctx.bind<STYInstruction, IClock&>()
+        ctx.bind<STYInstruction>()
             .build();
-        ctx.bind<STZInstruction, IClock&>()
+        ctx.bind<STZInstruction>()
             .build();
-        ctx.bind<STSInstruction, IClock&>()
+        ctx.bind<STSInstruction>()
             .build();
-        ctx.bind<SUBInstruction, IClock&>()
+        ctx.bind<SUBInstruction>()
             .build();
-        ctx.bind<SUBIInstruction, IClock&>()
+        ctx.bind<SUBIInstruction>()
             .build();
-        ctx.bind<SWAPInstruction, IClock&>()
+        ctx.bind<SWAPInstruction>()
             .build();
-        ctx.bind<XCHInstruction, IClock&>()
+        ctx.bind<XCHInstruction>()
             .build();
         ctx.bind<NotImplementedInstruction>()
             .build();
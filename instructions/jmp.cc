@@ -4,22 +4,28 @@
 #include <cstdint>
 
 namespace avr {
-    uint16_t JMPInstruction::GetDestinationAddress(CPU& cpu, ProgramMemory& mem) const
+    uint16_t JMPInstruction::GetDestinationAddress(uint16_t operand) const
     {
-        auto address = static_cast<uint16_t>(0u);
-        for (auto i = 0u; i < sizeof(address); i++)
-        {
-            address |= static_cast<uint16_t>(mem[cpu.PC++] << (i * 8u));
-            _clock.ConsumeCycle();
-        }
         // Actual avr assembly has this shifted right one bit to prevent odd addresses
-        return (address << 1u);
+        return static_cast<uint16_t>(operand << 1u);
     }
 
-    uint32_t JMPInstruction::Execute(uint16_t, ExecutionContext& ctx) const
+    void JMPInstruction::Decode(DecodedInstruction& insn) const
     {
-        ctx.cpu.PC = GetDestinationAddress(ctx.cpu, ctx.progMem);
-        _clock.ConsumeCycle();
+        insn.op = Operation::JMP;
+        insn.k = GetDestinationAddress(insn.operand);
+        insn.size = 2u;
+        insn.cycles = static_cast<uint8_t>(_cyclesConsumed);
+    }
+
+    uint32_t JMPInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
+    {
+        return ExecuteDecoded(Predecode(opcode, ctx), ctx);
+    }
+
+    uint32_t JMPInstruction::ExecuteDecoded(const DecodedInstruction& insn, ExecutionContext& ctx) const
+    {
+        ctx.cpu.PC = insn.k;
         return _cyclesConsumed;
     }
 
@@ -15,11 +15,9 @@ namespace avr {
     {
         auto& rd = GetDestinationRegister(ctx.cpu, opcode);
 
-        auto z = ctx.ram[*ctx.cpu.Z];
-        ctx.ram[*ctx.cpu.Z] |= rd;
-        _clock.ConsumeCycle();
+        auto z = ctx.Load(*ctx.cpu.Z);
+        ctx.Store(*ctx.cpu.Z, static_cast<uint8_t>(z | rd));
         rd = z;
-        _clock.ConsumeCycle();
 
         return _cyclesConsumed;
     }
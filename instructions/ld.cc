@@ -18,9 +18,7 @@ namespace avr {
         if (IsPreDecrement(opcode))
             --ctx.cpu.X;
 
-        _clock.ConsumeCycle();
-        rd = ctx.ram[*ctx.cpu.X];
-        _clock.ConsumeCycle();
+        rd = ctx.Load(*ctx.cpu.X);
 
         if (IsPostIncrement(opcode))
             ctx.cpu.X++;
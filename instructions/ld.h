@@ -1,7 +1,6 @@
 #pragma once
 
 #include "core/executioncontext.h"
-#include "core/iclock.h"
 #include "instructions/instructionexecutor.h"
 #include "instructions/opcodes.h"
 
@@ -10,7 +9,6 @@
 namespace avr {
     class LDInstruction: public InstructionExecutor {
         private:
-            IClock& _clock;
             const uint32_t _cyclesConsumed = 2u;
 
             uint8_t& GetDestinationRegister(CPU& cpu, uint16_t opcode) const;
@@ -18,10 +16,6 @@ namespace avr {
             bool IsPreDecrement(uint16_t opcode) const;
 
         public:
-            LDInstruction(IClock& clock)
-                : _clock(clock)
-            {}
-
             uint32_t Execute(uint16_t opcode, ExecutionContext& ctx) const override;
             bool Matches(uint16_t opcode) const override;
     };
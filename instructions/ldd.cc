@@ -25,10 +25,8 @@ namespace avr {
         if (IsPreDecrement(opcode))
             --ctx.cpu.Y;
 
-        _clock.ConsumeCycle();
         auto displacement = IsDisplaced(opcode) ? GetDisplacement(opcode) : static_cast<uint16_t>(0u);
-        rd = ctx.ram[static_cast<uint16_t>(*ctx.cpu.Y + displacement)];
-        _clock.ConsumeCycle();
+        rd = ctx.Load(static_cast<uint16_t>(*ctx.cpu.Y + displacement));
 
         if (IsPostIncrement(opcode))
             ctx.cpu.Y++;
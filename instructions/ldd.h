@@ -1,7 +1,6 @@
 #pragma once
 
 #include "core/executioncontext.h"
-#include "core/iclock.h"
 #include "instructions/instructionexecutor.h"
 #include "instructions/opcodes.h"
 
@@ -10,7 +9,6 @@
 namespace avr {
     class LDDInstruction: public InstructionExecutor {
         private:
-            IClock& _clock;
             const uint32_t _cyclesConsumed = 2u;
 
             uint8_t& GetDestinationRegister(CPU& cpu, uint16_t opcode) const;
@@ -21,10 +19,6 @@ namespace avr {
             bool IsDisplaced(uint16_t opcode) const;
 
         public:
-            LDDInstruction(IClock& clock)
-                : _clock(clock)
-            {}
-
             uint32_t Execute(uint16_t opcode, ExecutionContext& ctx) const override;
             bool Matches(uint16_t opcode) const override;
     };
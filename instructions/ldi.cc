@@ -11,20 +11,32 @@ namespace avr {
         return static_cast<uint8_t>(highNibble | lowNibble);
     }
 
-    uint8_t& LDIInstruction::GetDestinationRegister(CPU& cpu, uint16_t opcode) const
+    uint8_t LDIInstruction::GetDestinationRegister(uint16_t opcode) const
     {
         auto mask = 0x00F0u;
         auto index = static_cast<uint16_t>(((opcode & mask) >> 4) + 16);
-        return cpu.R[index];
+        return static_cast<uint8_t>(index);
+    }
+
+    void LDIInstruction::Decode(DecodedInstruction& insn) const
+    {
+        insn.op = Operation::LDI;
+        insn.rd = GetDestinationRegister(insn.opcode);
+        insn.k = GetImmediate(insn.opcode);
+        insn.cycles = static_cast<uint8_t>(_cyclesConsumed);
     }
 
     uint32_t LDIInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
-        auto& rd = GetDestinationRegister(ctx.cpu, opcode);
-        auto k = GetImmediate(opcode);
+        return ExecuteDecoded(Predecode(opcode, ctx), ctx);
+    }
+
+    uint32_t LDIInstruction::ExecuteDecoded(const DecodedInstruction& insn, ExecutionContext& ctx) const
+    {
+        auto& rd = ctx.cpu.R[insn.rd];
+        auto k = static_cast<uint8_t>(insn.k);
 
         rd = k;
-        _clock.ConsumeCycle();
 
         return _cyclesConsumed;
     }
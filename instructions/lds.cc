@@ -4,29 +4,33 @@
 #include <cstdint>
 
 namespace avr {
-    uint16_t LDSInstruction::GetImmediate(ExecutionContext& ctx) const
+    uint8_t LDSInstruction::GetDestinationRegister(uint16_t opcode) const
     {
-        auto out = static_cast<uint16_t>(0u);
-        for (auto i = 0u; i < sizeof(out); i++)
-            out |= static_cast<uint16_t>(ctx.progMem[ctx.cpu.PC++] << (i * 8u));
-        return out;
+        auto mask = 0x01F0u;
+        return static_cast<uint8_t>((opcode & mask) >> 4);
     }
 
-    uint8_t& LDSInstruction::GetDestinationRegister(CPU& cpu, uint16_t opcode) const
+    void LDSInstruction::Decode(DecodedInstruction& insn) const
     {
-        auto mask = 0x01F0u;
-        auto index = static_cast<uint16_t>((opcode & mask) >> 4);
-        return cpu.R[index];
+        insn.op = Operation::LDS;
+        insn.rd = GetDestinationRegister(insn.opcode);
+        insn.k = insn.operand;
+        insn.size = 2u;
+        insn.cycles = static_cast<uint8_t>(_cyclesConsumed);
     }
 
     uint32_t LDSInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
-        auto& rd = GetDestinationRegister(ctx.cpu, opcode);
-        auto k = GetImmediate(ctx);
+        return ExecuteDecoded(Predecode(opcode, ctx), ctx);
+    }
+
+    uint32_t LDSInstruction::ExecuteDecoded(const DecodedInstruction& insn, ExecutionContext& ctx) const
+    {
+        auto& rd = ctx.cpu.R[insn.rd];
+        auto k = insn.k;
+        ctx.cpu.PC += sizeof(insn.operand);
 
-        _clock.ConsumeCycle();
-        rd = ctx.ram[k];
-        _clock.ConsumeCycle();
+        rd = ctx.Load(k);
 
         return _cyclesConsumed;
     }
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <iostream>
+#include <utility>
 
 namespace avr {
     uint8_t& LPMInstruction::GetDestinationRegister(CPU& cpu, uint16_t opcode) const
@@ -18,14 +19,11 @@ namespace avr {
     {
         auto& rd = GetDestinationRegister(ctx.cpu, opcode);
 
-        _clock.ConsumeCycle();
-        rd = ctx.progMem[*ctx.cpu.Z];
-        _clock.ConsumeCycle();
+        rd = std::as_const(ctx.progMem)[*ctx.cpu.Z];
 
         if (IsPostIncrement(opcode))
             ctx.cpu.Z++;
 
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
@@ -28,7 +28,6 @@ namespace avr {
         auto result = static_cast<uint8_t>(rd >> 1u);
         SetRegisterFlags(ctx.cpu, rd, result);
         rd = result;
-        _clock.ConsumeCycle();
 
         return _cyclesConsumed;
     }
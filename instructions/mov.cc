@@ -4,27 +4,39 @@
 #include <cstdint>
 
 namespace avr {
-    uint8_t& MOVInstruction::GetSourceRegister(CPU& cpu, uint16_t opcode) const
+    uint8_t MOVInstruction::GetSourceRegister(uint16_t opcode) const
     {
         auto mask = 0x020F;
         uint8_t value = static_cast<uint8_t>((opcode & (mask & 0xFF)) | ((opcode >> 5) & (mask >> 5)));
-        return cpu.R[value];
+        return value;
     }
 
-    uint8_t& MOVInstruction::GetDestinationRegister(CPU& cpu, uint16_t opcode) const
+    uint8_t MOVInstruction::GetDestinationRegister(uint16_t opcode) const
     {
         auto mask = 0x01F0;
         uint8_t value = static_cast<uint8_t>((opcode >> 4) & (mask >> 4));
-        return cpu.R[value];
+        return value;
+    }
+
+    void MOVInstruction::Decode(DecodedInstruction& insn) const
+    {
+        insn.op = Operation::MOV;
+        insn.rr = GetSourceRegister(insn.opcode);
+        insn.rd = GetDestinationRegister(insn.opcode);
+        insn.cycles = static_cast<uint8_t>(_cyclesConsumed);
     }
 
     uint32_t MOVInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
-        auto& rr = GetSourceRegister(ctx.cpu, opcode);
-        auto& rd = GetDestinationRegister(ctx.cpu, opcode);
+        return ExecuteDecoded(Predecode(opcode, ctx), ctx);
+    }
+
+    uint32_t MOVInstruction::ExecuteDecoded(const DecodedInstruction& insn, ExecutionContext& ctx) const
+    {
+        auto& rr = ctx.cpu.R[insn.rr];
+        auto& rd = ctx.cpu.R[insn.rd];
 
         rd = rr;
-        _clock.ConsumeCycle();
 
         return _cyclesConsumed;
     }
@@ -25,7 +25,6 @@ namespace avr {
 
         for (auto i = 0u; i < sizeof(uint16_t); i++)
             *(rd + i) = (*(rr + i) >> (i * 8));
-        _clock.ConsumeCycle();
 
         return _cyclesConsumed;
     }
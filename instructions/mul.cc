@@ -34,7 +34,6 @@ namespace avr {
         for (auto i = 0u; i < sizeof(result); i++)
             ctx.cpu.R[i] = static_cast<uint8_t>((result >> (i * 8u)) & 0xFF);
         
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
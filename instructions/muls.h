@@ -1,7 +1,6 @@
 #pragma once
 
 #include "core/executioncontext.h"
-#include "core/iclock.h"
 #include "instructions/instructionexecutor.h"
 
 #include <cstdint>
@@ -9,7 +8,6 @@
 namespace avr {
     class MULSInstruction: public InstructionExecutor {
         private:
-            IClock& _clock;
             const uint32_t _cyclesConsumed = 1u;
 
             uint8_t& GetSourceRegister(CPU& cpu, uint16_t opcode) const;
@@ -17,10 +15,6 @@ namespace avr {
             void SetRegisterFlags(CPU& cpu, int16_t result) const;
 
         public:
-            MULSInstruction(IClock& clock)
-                : _clock(clock)
-            {}
-
             uint32_t Execute(uint16_t opcode, ExecutionContext& ctx) const override;
             bool Matches(uint16_t opcode) const override;
     };
@@ -29,7 +29,6 @@ namespace avr {
         SetStatusRegisters(ctx.cpu, rd, result);
         rd = result;
 
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
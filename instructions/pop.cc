@@ -2,6 +2,7 @@
 #include "instructions/opcodes.h"
 
 #include <cstdint>
+#include <utility>
 
 namespace avr {
     uint8_t& POPInstruction::GetDestinationRegister(CPU& cpu, uint16_t opcode) const
@@ -13,8 +14,7 @@ namespace avr {
 
     uint8_t POPInstruction::GetStackValue(ExecutionContext& ctx) const
     {
-        _clock.ConsumeCycle();
-        return ctx.ram[++ctx.cpu.SP];
+        return std::as_const(ctx.ram)[++ctx.cpu.SP];
     }
 
     uint32_t POPInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
@@ -24,7 +24,6 @@ namespace avr {
 
         rd = value;
 
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
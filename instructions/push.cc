@@ -13,7 +13,6 @@ namespace avr {
 
     void PUSHInstruction::SetStackValue(ExecutionContext& ctx, uint8_t value) const
     {
-        _clock.ConsumeCycle();
         ctx.ram[ctx.cpu.SP--] = value;
     }
 
@@ -21,7 +20,6 @@ namespace avr {
     {
         auto& rd = GetSourceRegister(ctx.cpu, opcode);
         SetStackValue(ctx, rd);
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
@@ -7,10 +7,8 @@ namespace avr {
     void RCALLInstruction::PushReturnAddress(CPU& cpu, SRAM& mem) const
     {
         uint16_t returnAddress = cpu.PC;
-        for (uint16_t i = 0u; i < sizeof(cpu.PC); i++) {
-            _clock.ConsumeCycle();
+        for (uint16_t i = 0u; i < sizeof(cpu.PC); i++)
             mem[cpu.SP--] = static_cast<uint8_t>((returnAddress >> (i * 8u)) & 0xFFu);
-        }
     }
 
     int16_t RCALLInstruction::GetAddress(uint16_t opcode) const
@@ -25,7 +23,6 @@ namespace avr {
     {
         PushReturnAddress(ctx.cpu, ctx.ram);
         ctx.cpu.PC = static_cast<uint16_t>(ctx.cpu.PC + GetAddress(opcode));
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
@@ -2,6 +2,7 @@
 #include "instructions/opcodes.h"
 
 #include <cstdint>
+#include <utility>
 
 namespace avr {
     uint16_t RETInstruction::GetAddress(ExecutionContext& ctx) const
@@ -9,10 +10,9 @@ namespace avr {
         uint16_t address = 0u;
         for (auto i = 0u; i < sizeof(ctx.cpu.PC); i++)
         {
-            _clock.ConsumeCycle();
             auto shift = 8 * (sizeof(ctx.cpu.PC) - i - 1);
             address |= static_cast<uint16_t>(
-                (ctx.ram[++ctx.cpu.SP] << shift) & (0xffu << shift));
+                (std::as_const(ctx.ram)[++ctx.cpu.SP] << shift) & (0xffu << shift));
         }
         return address;
     }
@@ -20,8 +20,6 @@ namespace avr {
     uint32_t RETInstruction::Execute(uint16_t, ExecutionContext& ctx) const
     {
         ctx.cpu.PC = GetAddress(ctx);
-        _clock.ConsumeCycle();
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
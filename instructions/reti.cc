@@ -2,6 +2,7 @@
 #include "instructions/opcodes.h"
 
 #include <cstdint>
+#include <utility>
 
 namespace avr {
     uint16_t RETIInstruction::GetAddress(ExecutionContext& ctx) const
@@ -9,10 +10,9 @@ namespace avr {
         uint16_t address = 0u;
         for (auto i = 0u; i < sizeof(ctx.cpu.PC); i++)
         {
-            _clock.ConsumeCycle();
             auto shift = 8 * (sizeof(ctx.cpu.PC) - i - 1);
             address |= static_cast<uint16_t>(
-                (ctx.ram[++ctx.cpu.SP] << shift) & (0xffu << shift));
+                (std::as_const(ctx.ram)[++ctx.cpu.SP] << shift) & (0xffu << shift));
         }
         return address;
     }
@@ -21,8 +21,8 @@ namespace avr {
     {
         ctx.cpu.PC = GetAddress(ctx);
         ctx.cpu.SREG.I = 1;
-        _clock.ConsumeCycle();
-        _clock.ConsumeCycle();
+        // One more instruction runs before the next pending interrupt
+        ctx.HoldInterrupts(_cyclesConsumed + 1u);
         return _cyclesConsumed;
     }
 
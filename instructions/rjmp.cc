@@ -9,14 +9,24 @@ namespace avr {
         auto address = static_cast<int16_t>(opcode & 0x7FFu);
         if ((opcode & 0x800u) != 0u)
             address |= static_cast<int16_t>(0xF800);
-        _clock.ConsumeCycle();
         return address;
     }
 
+    void RJMPInstruction::Decode(DecodedInstruction& insn) const
+    {
+        insn.op = Operation::RJMP;
+        insn.k = static_cast<uint16_t>(GetAddressOffset(insn.opcode));
+        insn.cycles = static_cast<uint8_t>(_cyclesConsumed);
+    }
+
     uint32_t RJMPInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
-        ctx.cpu.PC = static_cast<uint16_t>(ctx.cpu.PC + GetAddressOffset(opcode));
-        _clock.ConsumeCycle();
+        return ExecuteDecoded(Predecode(opcode, ctx), ctx);
+    }
+
+    uint32_t RJMPInstruction::ExecuteDecoded(const DecodedInstruction& insn, ExecutionContext& ctx) const
+    {
+        ctx.cpu.PC = static_cast<uint16_t>(ctx.cpu.PC + insn.k);
         return _cyclesConsumed;
     }
 
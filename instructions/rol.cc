@@ -25,11 +25,9 @@ namespace avr {
     uint32_t ROLInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
         auto& rd = GetDestinationRegister(ctx.cpu, opcode);
-        _clock.ConsumeCycle();
         auto originalValue = rd;
         rd = rd << 1;
         SetRegisterFlags(ctx.cpu, originalValue, rd);
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
@@ -26,7 +26,6 @@ namespace avr {
         auto originalValue = rd;
         rd = (rd >> 1) | (ctx.cpu.SREG.C << 7);
         SetRegisterFlags(ctx.cpu, originalValue, rd);
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
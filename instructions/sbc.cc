@@ -40,7 +40,6 @@ namespace avr {
         auto originalValue = rd;
         rd = rd - rr - ctx.cpu.SREG.C;
         SetRegisterFlags(ctx.cpu, rr, originalValue, rd);
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
@@ -41,7 +41,6 @@ namespace avr {
         auto originalValue = rd;
         rd = rd - k - ctx.cpu.SREG.C;
         SetRegisterFlags(ctx.cpu, k, originalValue, rd);
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
@@ -4,11 +4,11 @@
 #include <cstdint>
 
 namespace avr {
-    uint8_t& SBIInstruction::GetDestinationIO(CPU& cpu, uint16_t opcode) const
+    uint16_t SBIInstruction::GetDestinationAddress(uint16_t opcode) const
     {
         auto mask = 0x00F8u;
         auto index = static_cast<uint16_t>((opcode & mask) >> 3);
-        return cpu.GPIO[index];
+        return static_cast<uint16_t>(IOBus::BEGIN + index);
     }
 
     uint8_t SBIInstruction::GetSourceBit(uint16_t opcode) const
@@ -18,15 +18,10 @@ namespace avr {
 
     uint32_t SBIInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
-        auto& io = GetDestinationIO(ctx.cpu, opcode);
+        auto address = GetDestinationAddress(opcode);
         auto bit = GetSourceBit(opcode);
-        auto mask = static_cast<uint8_t>(0x1u << bit);
 
-        uint8_t value = io | mask;
-        _clock.ConsumeCycle();
-
-        io = value;
-        _clock.ConsumeCycle();
+        ctx.StoreBit(address, bit, true);
 
         return _cyclesConsumed;
     }
@@ -12,20 +12,10 @@ namespace avr {
         return static_cast<uint8_t>(opcode & 0x07u);
     }
 
-    uint8_t& SBICInstruction::GetIORegister(CPU& cpu, uint16_t opcode) const
+    uint8_t SBICInstruction::GetIORegister(uint16_t opcode) const
     {
         auto mask = 0x00F8u;
-        auto index = static_cast<uint8_t>((opcode & mask) >> 3);
-        return cpu.GPIO[index];
-    }
-
-    uint16_t SBICInstruction::GetNextOpCode(const CPU& cpu, const ProgramMemory& mem) const
-    {
-        auto pc = cpu.PC;
-        auto opcode = static_cast<uint16_t>(0u);
-        for (uint16_t i = 0u; i < sizeof(pc); i++)
-            opcode |= static_cast<uint16_t>(mem[pc++] << (i * 8u));
-        return opcode;
+        return static_cast<uint8_t>((opcode & mask) >> 3);
     }
 
     uint16_t SBICInstruction::GetOpCodeSize(uint16_t opcode) const
@@ -49,22 +39,30 @@ namespace avr {
         return (it == std::end(twoWordOpCodes)) ? 1u : 2u;
     }
 
+    void SBICInstruction::Decode(DecodedInstruction& insn) const
+    {
+        insn.op = Operation::SBIC;
+        insn.rd = GetIORegister(insn.opcode);
+        insn.k = GetBit(insn.opcode);
+        insn.skip = static_cast<uint8_t>(GetOpCodeSize(insn.operand));
+        insn.cycles = 1u;
+    }
+
     uint32_t SBICInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
-        auto bit = GetBit(opcode);
-        auto& io = GetIORegister(ctx.cpu, opcode);
+        return ExecuteDecoded(Predecode(opcode, ctx), ctx);
+    }
+
+    uint32_t SBICInstruction::ExecuteDecoded(const DecodedInstruction& insn, ExecutionContext& ctx) const
+    {
+        auto bit = insn.k;
+        auto io = ctx.Load(static_cast<uint16_t>(IOBus::BEGIN + insn.rd));
 
         auto bitIsSet = (io & (0x1u << bit)) != 0u;
-        if (bitIsSet) {
-            _clock.ConsumeCycle();
+        if (bitIsSet)
             return 1u;
-        }
-
-        auto nextOpcode = GetNextOpCode(ctx.cpu, ctx.progMem);
-        auto nextOpcodeSize = GetOpCodeSize(nextOpcode);
 
-        for (uint16_t i = 0; i < nextOpcodeSize; i++)
-            _clock.ConsumeCycle();
+        auto nextOpcodeSize = static_cast<uint16_t>(insn.skip);
 
         ctx.cpu.PC += static_cast<uint16_t>(nextOpcodeSize * 2u);
 
@@ -35,9 +35,7 @@ namespace avr {
         auto k = GetImmediate(opcode);
         auto originalValue = *rd;
         rd = rd - k;
-        _clock.ConsumeCycle();
         SetRegisterFlags(ctx.cpu, k, originalValue, *rd);
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
@@ -55,17 +55,12 @@ namespace avr {
         auto& src = GetSourceRegister(ctx.cpu, opcode);
 
         auto bitIsSet = (src & (0x1u << bit)) != 0u;
-        if (bitIsSet) {
-            _clock.ConsumeCycle();
+        if (bitIsSet)
             return 1u;
-        }
 
         auto nextOpcode = GetNextOpCode(ctx.cpu, ctx.progMem);
         auto nextOpcodeSize = GetOpCodeSize(nextOpcode);
 
-        for (uint16_t i = 0; i < nextOpcodeSize; i++)
-            _clock.ConsumeCycle();
-
         ctx.cpu.PC += static_cast<uint16_t>(nextOpcodeSize * 2u);
 
         return 1u + nextOpcodeSize;
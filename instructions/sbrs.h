@@ -1,7 +1,6 @@
 #pragma once
 
 #include "core/executioncontext.h"
-#include "core/iclock.h"
 #include "instructions/instructionexecutor.h"
 #include "instructions/opcodes.h"
 
@@ -10,7 +9,6 @@
 namespace avr {
     class SBRSInstruction: public InstructionExecutor {
         private:
-            IClock& _clock;
 
             uint8_t GetBit(uint16_t opcode) const;
             uint8_t& GetSourceRegister(CPU& cpu, uint16_t opcode) const;
@@ -19,10 +17,6 @@ namespace avr {
             uint16_t GetOpCodeSize(uint16_t opcode) const;
 
         public:
-            SBRSInstruction(IClock& clock)
-                : _clock(clock)
-            {}
-
             uint32_t Execute(uint16_t opcode, ExecutionContext& ctx) const override;
             bool Matches(uint16_t opcode) const override;
     };
@@ -10,7 +10,6 @@ namespace avr {
     uint32_t SLEEPInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
         ctx.cpu.is_sleeping = true;
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
@@ -10,10 +10,14 @@
 namespace avr {
     uint32_t SPMInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
-        auto source = IndirectRegister(&ctx.cpu.R[0]);
-        auto destination = IndirectRegister(&ctx.progMem[*ctx.cpu.Z]);
-        destination = *source;
-        _clock.ConsumeCycle();
+        // A byte at a time so that both wrap and mark their page dirty
+        auto address = *ctx.cpu.Z;
+        ctx.progMem[address] = ctx.cpu.R[0];
+        ctx.progMem[static_cast<uint16_t>(address + 1u)] = ctx.cpu.R[1];
+        ctx.decodeCache.Invalidate(address);
+        ctx.decodeCache.Invalidate(static_cast<uint16_t>(address + 1u));
+        ctx.blockCache.Invalidate(address);
+        ctx.blockCache.Invalidate(static_cast<uint16_t>(address + 1u));
         return _cyclesConsumed;
     }
     
@@ -7,31 +7,33 @@
 #include <tuple>
 
 namespace avr {
-    uint8_t& STSInstruction::GetSourceRegister(CPU& cpu, uint16_t opcode) const
+    uint8_t STSInstruction::GetSourceRegister(uint16_t opcode) const
     {
         auto mask = 0x01F0u;
-        auto index = static_cast<uint8_t>((opcode & mask) >> 4);
-        return cpu.R[index];
+        return static_cast<uint8_t>((opcode & mask) >> 4);
     }
 
-    uint16_t STSInstruction::GetAddress(const CPU& cpu, const ProgramMemory& mem) const
+    void STSInstruction::Decode(DecodedInstruction& insn) const
     {
-        auto pc = cpu.PC;
-        auto address = static_cast<uint16_t>(0u);
-        for (uint16_t i = 0u; i < sizeof(pc); i++)
-            address |= static_cast<uint16_t>(mem[pc++] << (i * 8u));
-        return address;
+        insn.op = Operation::STS;
+        insn.rr = GetSourceRegister(insn.opcode);
+        insn.k = insn.operand;
+        insn.size = 2u;
+        insn.cycles = static_cast<uint8_t>(_cyclesConsumed);
     }
 
     uint32_t STSInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
-        auto& src = GetSourceRegister(ctx.cpu, opcode);
-        auto address = GetAddress(ctx.cpu, ctx.progMem);
-        _clock.ConsumeCycle();
+        return ExecuteDecoded(Predecode(opcode, ctx), ctx);
+    }
+
+    uint32_t STSInstruction::ExecuteDecoded(const DecodedInstruction& insn, ExecutionContext& ctx) const
+    {
+        auto& src = ctx.cpu.R[insn.rr];
+        auto address = insn.k;
 
-        ctx.ram[address] = src;
+        ctx.Store(address, src);
         ctx.cpu.PC += 2u;
-        _clock.ConsumeCycle();
 
         return _cyclesConsumed;
     }
@@ -28,14 +28,12 @@ namespace avr {
     uint32_t STXInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
         auto source = GetSourceRegister(opcode, ctx);
-        _clock.ConsumeCycle();
         auto& index = ctx.cpu.X;
         if (IsPreDecrement(opcode))
             index--;
-        ctx.ram[*index] = source;
+        ctx.Store(*index, source);
         if (IsPostIncrement(opcode))
             index++;
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
     
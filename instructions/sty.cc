@@ -36,14 +36,12 @@ namespace avr {
     {
         auto source = GetSourceRegister(opcode, ctx);
         auto displacement = GetDisplacement(opcode);
-        _clock.ConsumeCycle();
         auto& index = ctx.cpu.Y;
         if (IsPreDecrement(opcode))
             index--;
-        ctx.ram[(*index) + displacement] = source;
+        ctx.Store(static_cast<uint16_t>((*index) + displacement), source);
         if (IsPostIncrement(opcode))
             index++;
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
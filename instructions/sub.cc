@@ -1,46 +1,44 @@
+#include "core/flags.h"
 #include "instructions/sub.h"
 #include "instructions/opcodes.h"
 
 #include <cstdint>
 
 namespace avr {
-    uint8_t& SUBInstruction::GetSourceRegister(CPU& cpu, uint16_t opcode) const
+    uint8_t SUBInstruction::GetSourceRegister(uint16_t opcode) const
     {
         auto mask = 0x020Fu;
         uint8_t value = static_cast<uint8_t>(((opcode >> 5) & (mask >> 5)) | (opcode & (mask & 0x0Fu)));
-        return cpu.R[value];
+        return value;
     }
 
-    uint8_t& SUBInstruction::GetDestinationRegister(CPU& cpu, uint16_t opcode) const
+    uint8_t SUBInstruction::GetDestinationRegister(uint16_t opcode) const
     {
         auto mask = 0x01F0u;
         uint8_t value = static_cast<uint8_t>((opcode >> 4) & (mask >> 4));
-        return cpu.R[value];
+        return value;
     }
 
-    void SUBInstruction::SetRegisterFlags(CPU& cpu, uint8_t source, uint8_t dest, uint8_t result) const
+    void SUBInstruction::Decode(DecodedInstruction& insn) const
     {
-        cpu.SREG.N = (result & 0x80u) != 0u;
-        cpu.SREG.Z = (result == 0u);
-        cpu.SREG.C = (((dest & 0x80u) == 0u) && ((source & 0x80u) != 0u)) ||
-            (((source & 0x80u) != 0u) && ((result & 0x80u) != 0u)) ||
-            (((result & 0x80u) != 0u) && ((dest & 0x80u) == 0u));
-        cpu.SREG.V = (((dest & 0x80u) != 0u) && ((source & 0x80u) == 0u) && ((result & 0x80u) == 0u)) ||
-            (((dest & 0x80u) == 0u) && ((source & 0x80u) != 0u) && ((result & 0x80u) != 0u));
-        cpu.SREG.S = cpu.SREG.N ^ cpu.SREG.V;
-        cpu.SREG.H = (((dest & 0x08u) == 0u) && ((source & 0x08u) != 0u)) ||
-            (((source & 0x08u) != 0u) && ((result & 0x08u) != 0u)) ||
-            (((result & 0x08u) != 0u) && ((dest & 0x08u) == 0u));
+        insn.op = Operation::SUB;
+        insn.rr = GetSourceRegister(insn.opcode);
+        insn.rd = GetDestinationRegister(insn.opcode);
+        insn.cycles = static_cast<uint8_t>(_cyclesConsumed);
     }
 
     uint32_t SUBInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
-        auto& rr = GetSourceRegister(ctx.cpu, opcode);
-        auto& rd = GetDestinationRegister(ctx.cpu, opcode);
+        return ExecuteDecoded(Predecode(opcode, ctx), ctx);
+    }
+
+    uint32_t SUBInstruction::ExecuteDecoded(const DecodedInstruction& insn, ExecutionContext& ctx) const
+    {
+        auto& rr = ctx.cpu.R[insn.rr];
+        auto& rd = ctx.cpu.R[insn.rd];
         auto originalValue = rd;
         rd = rd - rr;
-        SetRegisterFlags(ctx.cpu, rr, originalValue, rd);
-        _clock.ConsumeCycle();
+        SetSubtractFlags(ctx.cpu, originalValue, rr, rd);
         return _cyclesConsumed;
     }
 
@@ -1,3 +1,4 @@
+#include "core/flags.h"
 #include "instructions/subi.h"
 #include "instructions/opcodes.h"
 
@@ -11,37 +12,33 @@ namespace avr {
             (opcode & 0xFu));
     }
 
-    uint8_t& SUBIInstruction::GetDestinationRegister(CPU& cpu, uint16_t opcode) const
+    uint8_t SUBIInstruction::GetDestinationRegister(uint16_t opcode) const
     {
         auto mask = 0x00F0u;
         uint8_t value = static_cast<uint8_t>((opcode >> 4) & (mask >> 4) | 0x10u);
-        return cpu.R[value];
+        return value;
     }
 
-    void SUBIInstruction::SetRegisterFlags(CPU& cpu, uint8_t k, uint8_t dest, uint8_t result) const
+    void SUBIInstruction::Decode(DecodedInstruction& insn) const
     {
-        cpu.SREG.N = (result & 0x80u) != 0u;
-        cpu.SREG.Z = (result == 0u);
-        cpu.SREG.C = (((dest & 0x80u) == 0u) && ((k & 0x80u) != 0u)) ||
-            (((k & 0x80u) != 0u) && ((result & 0x80u) != 0u)) ||
-            (((result & 0x80u) != 0u) && ((dest & 0x80u) == 0u));
-        cpu.SREG.V = (((dest & 0x80u) != 0u) && ((k & 0x80u) == 0u) && ((result & 0x80u) == 0u)) ||
-            (((dest & 0x80u) == 0u) && ((k & 0x80u) != 0u) && ((result & 0x80u) != 0u));
-        cpu.SREG.S = cpu.SREG.N ^ cpu.SREG.V;
-        cpu.SREG.H = (((dest & 0x08u) == 0u) && ((k & 0x08u) != 0u)) ||
-            (((k & 0x08u) != 0u) && ((result & 0x08u) != 0u)) ||
-            (((result & 0x08u) != 0u) && ((dest & 0x08u) == 0u));
+        insn.op = Operation::SUBI;
+        insn.rd = GetDestinationRegister(insn.opcode);
+        insn.k = GetImmediate(insn.opcode);
+        insn.cycles = static_cast<uint8_t>(_cyclesConsumed);
     }
-    
 
     uint32_t SUBIInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
-        auto& rd = GetDestinationRegister(ctx.cpu, opcode);
-        auto k = GetImmediate(opcode);
+        return ExecuteDecoded(Predecode(opcode, ctx), ctx);
+    }
+
+    uint32_t SUBIInstruction::ExecuteDecoded(const DecodedInstruction& insn, ExecutionContext& ctx) const
+    {
+        auto& rd = ctx.cpu.R[insn.rd];
+        auto k = static_cast<uint8_t>(insn.k);
         auto originalValue = rd;
         rd = rd - k;
-        SetRegisterFlags(ctx.cpu, k, originalValue, rd);
-        _clock.ConsumeCycle();
+        SetSubtractFlags(ctx.cpu, originalValue, k, rd);
         return _cyclesConsumed;
     }
 
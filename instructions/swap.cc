@@ -19,7 +19,6 @@ namespace avr {
         auto& source = GetSourceRegister(opcode, ctx);
         auto lowNibble = source & 0x0Fu;
         source = (lowNibble << 4u) | (source >> 4u);
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
@@ -17,11 +17,9 @@ namespace avr {
     uint32_t XCHInstruction::Execute(uint16_t opcode, ExecutionContext& ctx) const
     {
         auto& source = GetSourceRegister(opcode, ctx);
-        auto newSourceValue = ctx.ram[*ctx.cpu.Z];
-        ctx.ram[*ctx.cpu.Z] = source;
-        _clock.ConsumeCycle();
+        auto newSourceValue = ctx.Load(*ctx.cpu.Z);
+        ctx.Store(*ctx.cpu.Z, source);
         source = newSourceValue;
-        _clock.ConsumeCycle();
         return _cyclesConsumed;
     }
 
@@ -1,24 +1,208 @@
 #include "cdif/cdif.h"
+#include "core/batchrunner.h"
 #include "core/coremodule.h"
-#include "core/executioncontext.h"
-#include "core/executor.h"
+#include "core/noopclock.h"
+#include "core/threadedexecutor.h"
 #include "instructions/instructionmodule.h"
 
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
 using namespace avr;
 
-cdif::Container BuildContainer()
-{
-    auto ctx = cdif::Container();
-    ctx.registerModule<CoreModule>();
-    ctx.registerModule<InstructionModule>();
-    return ctx;
+namespace {
+    struct Options {
+        uint64_t cycles = 1000000u;
+        unsigned threads = 0u;
+        std::vector<MemoryRange> ranges;
+        std::vector<std::string> names;
+        std::vector<BatchJob> jobs;
+    };
+
+    cdif::Container BuildContainer()
+    {
+        auto ctx = cdif::Container();
+        ctx.registerModule<CoreModule>();
+        ctx.registerModule<InstructionModule>();
+        return ctx;
+    }
+
+    int Usage(const char* program)
+    {
+        std::fprintf(stderr,
+            "usage: %s [--cycles N] [--threads N] [--ram BEGIN:LENGTH]... JOB...\n"
+            "\n"
+            "Runs every JOB in a context of its own, one worker per core unless\n"
+            "--threads is given. A JOB is a raw flash image optionally followed\n"
+            "by bytes to write to RAM before it starts:\n"
+            "\n"
+            "    IMAGE[,ADDRESS=HEXBYTES]...\n"
+            "\n"
+            "Each --ram range is printed with the result of every run.\n",
+            program);
+        return 2;
+    }
+
+    uint16_t ParseAddress(const std::string& text)
+    {
+        using namespace std::string_literals;
+        auto value = std::stoul(text, nullptr, 0);
+        if (value > 0xFFFFu)
+            throw "Address out of range: "s + text;
+        return static_cast<uint16_t>(value);
+    }
+
+    std::string ParseHex(const std::string& text)
+    {
+        using namespace std::string_literals;
+        if (text.size() % 2u != 0u)
+            throw "Odd number of hex digits: "s + text;
+
+        auto bytes = std::string();
+        for (auto i = 0u; i < text.size(); i += 2u)
+            bytes.push_back(static_cast<char>(std::stoul(text.substr(i, 2u), nullptr, 16)));
+        return bytes;
+    }
+
+    std::string ReadImage(const std::string& path)
+    {
+        using namespace std::string_literals;
+        auto file = std::ifstream(path, std::ios::binary);
+        if (!file)
+            throw "Unable to open "s + path;
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    BatchJob ParseJob(const std::string& text, std::string& name)
+    {
+        using namespace std::string_literals;
+        auto job = BatchJob();
+        auto end = text.find(',');
+        name = text.substr(0u, end);
+        job.program = ReadImage(name);
+
+        while (end != std::string::npos)
+        {
+            auto start = end + 1u;
+            end = text.find(',', start);
+            auto input = text.substr(start, end == std::string::npos ? end : end - start);
+            auto equals = input.find('=');
+            if (equals == std::string::npos)
+                throw "Expected ADDRESS=HEXBYTES: "s + input;
+            job.inputs.emplace_back(ParseAddress(input.substr(0u, equals)), ParseHex(input.substr(equals + 1u)));
+        }
+
+        return job;
+    }
+
+    MemoryRange ParseRange(const std::string& text)
+    {
+        using namespace std::string_literals;
+        auto colon = text.find(':');
+        if (colon == std::string::npos)
+            throw "Expected BEGIN:LENGTH: "s + text;
+        return { ParseAddress(text.substr(0u, colon)), ParseAddress(text.substr(colon + 1u)) };
+    }
+
+    Options ParseOptions(const std::vector<std::string>& args)
+    {
+        using namespace std::string_literals;
+        auto options = Options();
+        for (auto i = 0u; i < args.size(); i++)
+        {
+            auto& arg = args[i];
+            auto isOption = arg == "--cycles" || arg == "--threads" || arg == "--ram";
+            if (isOption && i + 1u == args.size())
+                throw "Missing value for "s + arg;
+
+            if (arg == "--cycles")
+                options.cycles = std::stoull(args[++i], nullptr, 0);
+            else if (arg == "--threads")
+                options.threads = static_cast<unsigned>(std::stoul(args[++i], nullptr, 0));
+            else if (arg == "--ram")
+                options.ranges.push_back(ParseRange(args[++i]));
+            else
+            {
+                options.names.emplace_back();
+                options.jobs.push_back(ParseJob(arg, options.names.back()));
+            }
+        }
+        return options;
+    }
+
+    const char* Describe(ExitReason reason)
+    {
+        switch (reason)
+        {
+            case ExitReason::CycleLimit:
+                return "limit";
+            case ExitReason::Halted:
+                return "halted";
+            case ExitReason::Error:
+                return "error";
+        }
+        return "unknown";
+    }
+
+    void Print(const std::string& name, const RunResult& result, const std::vector<MemoryRange>& ranges)
+    {
+        std::printf("%s: %s cycles=%llu pc=0x%04x sp=0x%04x sreg=0x%02x r=",
+            name.c_str(),
+            Describe(result.reason),
+            static_cast<unsigned long long>(result.cycles),
+            result.pc,
+            result.sp,
+            result.sreg);
+        for (auto value : result.registers)
+            std::printf("%02x", value);
+        for (auto i = 0u; i < ranges.size(); i++)
+        {
+            std::printf(" ram[0x%04x]=", ranges[i].begin);
+            for (auto value : result.ram[i])
+                std::printf("%02x", static_cast<uint8_t>(value));
+        }
+        if (result.reason == ExitReason::Error)
+            std::printf(" (%s)", result.error.c_str());
+        std::printf("\n");
+    }
 }
 
-int main()
+int main(int argc, char** argv)
 {
+    auto options = Options();
+    try
+    {
+        options = ParseOptions(std::vector<std::string>(argv + 1, argv + argc));
+    }
+    catch (const std::string& error)
+    {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return Usage(argv[0]);
+    }
+    catch (const std::exception&)
+    {
+        return Usage(argv[0]);
+    }
+
+    if (options.jobs.empty())
+        return Usage(argv[0]);
+
+    // One executor and decode table serves every worker. The clock only
+    // paces a single context, so runs are left unthrottled.
     auto container = BuildContainer();
-    auto& ctx = container.resolve<ExecutionContext&>();
-    auto executor = container.resolve<Executor>();
-    executor.Execute(ctx, 10);
+    auto clock = NoopClock();
+    auto executor = ThreadedExecutor(clock, container.resolve<ThreadedExecutor>().GetDispatchTable());
+
+    auto runner = BatchRunner(executor, options.cycles, options.ranges, options.threads);
+    auto results = runner.Run(options.jobs);
+    for (auto i = 0u; i < results.size(); i++)
+        Print(options.names[i], results[i], options.ranges);
+
     return 0;
 }
@@ -0,0 +1,219 @@
+#include "core/adc.h"
+#include "core/executioncontext.h"
+#include "core/interrupts.h"
+#include "core/waveform.h"
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace avr;
+
+namespace {
+    constexpr uint16_t ADCL = 0x78u;
+    constexpr uint16_t ADCH = 0x79u;
+    constexpr uint16_t ADCSRA = 0x7Au;
+    constexpr uint16_t ADMUX = 0x7Cu;
+
+    constexpr uint8_t ADIE = 0x08u;
+    constexpr uint8_t ADIF = 0x10u;
+    constexpr uint8_t ADATE = 0x20u;
+    constexpr uint8_t ADSC = 0x40u;
+    constexpr uint8_t ADEN = 0x80u;
+    constexpr uint8_t ADLAR = 0x20u;
+
+    constexpr std::size_t FRAMES = 0x10000u;
+
+    uint64_t Bit(uint8_t interrupt)
+    {
+        return uint64_t(1u) << interrupt;
+    }
+}
+
+// Two channels with a frame a cycle: channel 0 ramps up with the cycle
+// and channel 1 ramps down
+class AdcTests : public ::testing::Test
+{
+    protected:
+        std::string path;
+        ExecutionContext ctx;
+        std::shared_ptr<Adc> adc;
+
+        uint16_t Result()
+        {
+            auto low = ctx.Load(ADCL);
+            return static_cast<uint16_t>(low | (ctx.Load(ADCH) << 8));
+        }
+
+    public:
+        AdcTests()
+            : path(),
+              ctx(),
+              adc()
+        {
+            char name[] = "/tmp/avr-emu-adc-XXXXXX";
+            auto fd = mkstemp(name);
+            if (fd < 0)
+                throw std::string("Unable to create waveform");
+            path = name;
+
+            auto bytes = std::vector<uint8_t>();
+            for (auto i = std::size_t(0u); i < FRAMES; i++)
+                for (auto sample : { i & 0x3FFu, 0x3FFu - (i & 0x3FFu) })
+                {
+                    bytes.push_back(static_cast<uint8_t>(sample));
+                    bytes.push_back(static_cast<uint8_t>(sample >> 8));
+                }
+            auto written = write(fd, bytes.data(), bytes.size());
+            close(fd);
+            if (written != static_cast<ssize_t>(bytes.size()))
+                throw std::string("Unable to write waveform");
+
+            adc = Adc::Attach(ctx, ADC_LAYOUT, std::make_shared<Waveform>(path, 2u, 1u));
+        }
+
+        ~AdcTests()
+        {
+            ctx.io = IOBus();
+            ctx.scheduler.Clear();
+            unlink(path.c_str());
+        }
+};
+
+TEST_F(AdcTests, ADCSRA_GivenFirstConversion_SamplesAt13AndAHalfClocksAndEndsAt25)
+{
+    ctx.Store(ADCSRA, ADEN | ADSC);     // clk/2
+
+    ctx.cycles = 49u;
+    auto converting = ctx.Load(ADCSRA);
+    ctx.cycles = 50u;
+    auto done = ctx.Load(ADCSRA);
+
+    ASSERT_EQ(converting & (ADSC | ADIF), ADSC);
+    ASSERT_EQ(done & (ADSC | ADIF), ADIF);
+    ASSERT_EQ(Result(), 27u);
+    ASSERT_EQ(adc->misses(), 0u);
+    ASSERT_TRUE(ctx.scheduler.Empty());
+}
+
+TEST_F(AdcTests, ADCSRA_GivenLaterConversion_Takes13ClocksAtThePrescaler)
+{
+    ctx.Store(ADCSRA, ADEN | ADSC | 0x07u);     // clk/128
+    ctx.cycles = 25u * 128u;
+    ctx.Store(ADCSRA, ADEN | ADSC | ADIF | 0x07u);
+
+    ctx.cycles += 13u * 128u - 1u;
+    auto converting = ctx.Load(ADCSRA) & ADSC;
+    ctx.cycles += 1u;
+
+    ASSERT_EQ(converting, ADSC);
+    ASSERT_EQ(ctx.Load(ADCSRA) & (ADSC | ADIF), ADIF);
+    ASSERT_EQ(Result(), (25u * 128u + 192u) & 0x3FFu);
+}
+
+TEST_F(AdcTests, ADMUX_GivenChannelAndADLAR_LeftAdjustsThatChannelsSample)
+{
+    ctx.Store(ADMUX, ADLAR | 0x01u);
+    ctx.Store(ADCSRA, ADEN | ADSC);
+    ctx.cycles = 50u;
+
+    auto low = ctx.Load(ADCL);
+    auto high = ctx.Load(ADCH);
+
+    ASSERT_EQ(high, (0x3FFu - 27u) >> 2);
+    ASSERT_EQ(low, static_cast<uint8_t>((0x3FFu - 27u) << 6));
+}
+
+TEST_F(AdcTests, ADCSRA_GivenADIEEnabled_RaisesInterruptWhenConversionEnds)
+{
+    ctx.Store(ADCSRA, ADEN | ADSC | ADIE);
+
+    ASSERT_EQ(ctx.scheduler.NextDue(), 50u);
+    ctx.cycles = 50u;
+    ctx.scheduler.RunDue(ctx);
+
+    ASSERT_EQ(ctx.pendingInterrupts, Bit(ADC_LAYOUT.interrupt));
+    ASSERT_EQ(ctx.Load(ADCSRA) & ADIF, ADIF);
+    ASSERT_TRUE(ctx.scheduler.Empty());
+}
+
+TEST_F(AdcTests, ADCSRA_GivenInterruptVectored_ClearsADIF)
+{
+    ctx.Store(ADCSRA, ADEN | ADSC | ADIE);
+    ctx.cycles = 50u;
+    ctx.scheduler.RunDue(ctx);
+    ctx.cpu.SP = 0x7EFu;
+
+    EnterInterrupt(ctx);
+
+    ASSERT_EQ(ctx.Load(ADCSRA) & ADIF, 0u);
+}
+
+TEST_F(AdcTests, ADCSRA_GivenADIFWrittenWithOne_ClearsItAndTheInterrupt)
+{
+    ctx.Store(ADCSRA, ADEN | ADSC | ADIE);
+    ctx.cycles = 50u;
+    ctx.scheduler.RunDue(ctx);
+
+    ctx.Store(ADCSRA, ADEN | ADIE | ADIF);
+
+    ASSERT_EQ(ctx.Load(ADCSRA) & ADIF, 0u);
+    ASSERT_EQ(ctx.pendingInterrupts, 0u);
+}
+
+TEST_F(AdcTests, ADCSRA_GivenFreeRunning_HoldsTheLastConversionFinished)
+{
+    ctx.Store(ADCSRA, ADEN | ADSC | ADATE);
+
+    // The first ends on 50, then one every 26 cycles
+    ctx.cycles = 50u + 26u * 100u + 5u;
+
+    ASSERT_EQ(ctx.Load(ADCSRA) & (ADSC | ADIF), ADSC | ADIF);
+    ASSERT_EQ(Result(), (50u + 26u * 99u + 3u) & 0x3FFu);
+}
+
+TEST_F(AdcTests, ADCSRA_GivenFreeRunningWithADIE_SchedulesEachConversion)
+{
+    ctx.Store(ADCSRA, ADEN | ADSC | ADATE | ADIE);
+
+    ctx.cycles = 50u;
+    ctx.scheduler.RunDue(ctx);
+    ctx.ClearInterrupt(ADC_LAYOUT.interrupt);
+
+    ASSERT_EQ(ctx.scheduler.NextDue(), 76u);
+    ctx.cycles = 76u;
+    ctx.scheduler.RunDue(ctx);
+    ASSERT_EQ(ctx.pendingInterrupts, Bit(ADC_LAYOUT.interrupt));
+}
+
+TEST_F(AdcTests, ADCL_GivenReadBeforeADCH_KeepsThePairTogether)
+{
+    ctx.Store(ADCSRA, ADEN | ADSC);
+    ctx.cycles = 50u;
+    auto low = ctx.Load(ADCL);
+
+    ctx.Store(ADCSRA, ADEN | ADSC | ADIF);
+    ctx.cycles = 76u;
+    auto high = ctx.Load(ADCH);
+
+    ASSERT_EQ(low, 27u);
+    ASSERT_EQ(high, 0u);
+    ASSERT_EQ(ctx.Load(ADCSRA) & ADIF, ADIF);
+    ASSERT_EQ(Result(), 27u);
+}
+
+TEST_F(AdcTests, ADCSRA_GivenADENCleared_AbortsTheConversion)
+{
+    ctx.Store(ADCSRA, ADEN | ADSC);
+    ctx.cycles = 20u;
+    ctx.Store(ADCSRA, 0u);
+    ctx.cycles = 100u;
+
+    ASSERT_EQ(ctx.Load(ADCSRA) & (ADSC | ADIF), 0u);
+}
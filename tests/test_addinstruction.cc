@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/add.h"
 #include "instructions/opcodes.h"
 
@@ -15,7 +14,6 @@ class ADDInstructionTests : public ::testing::Test
 {
 
     protected:
-        NoopClock clock;
         ADDInstruction subject;
         ExecutionContext ctx;
 
@@ -143,7 +141,7 @@ class ADDInstructionTests : public ::testing::Test
         }
     public:
         ADDInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/adiw.h"
 #include "instructions/opcodes.h"
 
@@ -15,7 +14,6 @@ class ADIWInstructionTests : public ::testing::Test
 {
 
     protected:
-        NoopClock clock;
         ADIWInstruction subject;
         ExecutionContext ctx;
 
@@ -37,7 +35,7 @@ class ADIWInstructionTests : public ::testing::Test
 
     public:
         ADIWInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/andi.h"
 #include "instructions/opcodes.h"
 
@@ -15,7 +14,6 @@ class ANDIInstructionTests : public ::testing::Test
 {
 
     protected:
-        NoopClock clock;
         ANDIInstruction subject;
         ExecutionContext ctx;
 
@@ -40,7 +38,7 @@ class ANDIInstructionTests : public ::testing::Test
 
     public:
         ANDIInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/and.h"
 #include "instructions/opcodes.h"
 
@@ -15,7 +14,6 @@ class ANDInstructionTests : public ::testing::Test
 {
 
     protected:
-        NoopClock clock;
         ANDInstruction subject;
         ExecutionContext ctx;
 
@@ -36,7 +34,7 @@ class ANDInstructionTests : public ::testing::Test
 
     public:
         ANDInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -0,0 +1,153 @@
+#include "cdif/cdif.h"
+#include "core/batchrunner.h"
+#include "core/coremodule.h"
+#include "core/noopclock.h"
+#include "core/threadedexecutor.h"
+#include "instructions/instructionmodule.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace avr;
+
+namespace {
+    cdif::Container BuildBatchContainer()
+    {
+        auto ctx = cdif::Container();
+        ctx.registerModule<InstructionModule>();
+        ctx.registerModule<CoreModule>();
+        return ctx;
+    }
+
+    // Sums the bytes at 0x0200 until it reaches a zero, stores the sum at
+    // 0x0300 and halts
+    const std::string SUM = std::string(
+        "\xa0\xe0"          // ldi  r26, 0x00
+        "\xb2\xe0"          // ldi  r27, 0x02
+        "\x00\x27"          // clr  r16
+        "\x1d\x91"          // ld   r17, X+
+        "\x01\x0f"          // add  r16, r17
+        "\x11\x23"          // tst  r17
+        "\xe1\xf7"          // brne .-8
+        "\x00\x93\x00\x03"  // sts  0x0300, r16
+        "\xfe\xcf"          // rjmp .-2
+        , 20);
+
+    const std::string SPIN = std::string(
+        "\x03\x95"          // inc  r16
+        "\xfc\xcf"          // rjmp .-4
+        , 4);
+
+    class ThrowingExecutor : public IExecutor {
+        public:
+            void Execute(ExecutionContext&, uint32_t) const override
+            {
+                throw std::runtime_error("out of host memory");
+            }
+
+            void Interrupt(ExecutionContext&, uint8_t) const override
+            {}
+    };
+}
+
+class BatchRunnerTests : public ::testing::Test
+{
+    protected:
+        cdif::Container container;
+        NoopClock clock;
+        ThreadedExecutor executor;
+
+    public:
+        BatchRunnerTests()
+            : container(BuildBatchContainer()),
+              clock(),
+              executor(clock, container.resolve<ThreadedExecutor>().GetDispatchTable())
+        {}
+};
+
+TEST_F(BatchRunnerTests, Run_GivenHaltingProgram_ReportsHaltedWithRegistersAndRam)
+{
+    auto subject = BatchRunner(executor, 10000u, { { 0x0300u, 1u } }, 2u);
+
+    auto results = subject.Run({ { SUM, { { 0x0200u, std::string("\x01\x02\x03", 3) } } } });
+
+    ASSERT_EQ(results.size(), 1u);
+    ASSERT_EQ(results[0].reason, ExitReason::Halted);
+    ASSERT_EQ(results[0].ram[0], std::string("\x06", 1));
+    ASSERT_EQ(results[0].registers[16], 6u);
+    ASSERT_EQ(results[0].sreg & 0x02u, 0x02u);     // Z from tst on the terminating zero
+    ASSERT_EQ(results[0].pc, 0x940u + 18u);
+    ASSERT_LT(results[0].cycles, 10000u);
+}
+
+TEST_F(BatchRunnerTests, Run_GivenProgramRunningPastLimit_ReportsCycleLimit)
+{
+    auto subject = BatchRunner(executor, 1000u, {}, 1u);
+
+    auto results = subject.Run({ { SPIN, {} } });
+
+    ASSERT_EQ(results[0].reason, ExitReason::CycleLimit);
+    ASSERT_GE(results[0].cycles, 1000u);
+    ASSERT_LT(results[0].cycles, 1010u);
+}
+
+TEST_F(BatchRunnerTests, Run_GivenUndecodableInstruction_ReportsError)
+{
+    auto subject = BatchRunner(executor, 1000u, {}, 1u);
+
+    auto results = subject.Run({ { std::string("\xff\xff", 2), {} } });
+
+    ASSERT_EQ(results[0].reason, ExitReason::Error);
+    ASSERT_FALSE(results[0].error.empty());
+}
+
+TEST_F(BatchRunnerTests, Run_GivenExecutorThrowingStdException_ReportsError)
+{
+    auto throwing = ThrowingExecutor();
+    auto subject = BatchRunner(throwing, 1000u, {}, 1u);
+
+    auto results = subject.Run({ { SPIN, {} } });
+
+    ASSERT_EQ(results[0].reason, ExitReason::Error);
+    ASSERT_EQ(results[0].error, "out of host memory");
+}
+
+TEST_F(BatchRunnerTests, Run_GivenManyJobs_ReturnsResultsInJobOrder)
+{
+    auto subject = BatchRunner(executor, 100000u, { { 0x0300u, 1u } }, 8u);
+    auto jobs = std::vector<BatchJob>();
+    for (auto i = 0u; i < 100u; i++)
+    {
+        // Uneven lengths so workers run out at different times and steal
+        auto input = std::string(i % 23u + 1u, static_cast<char>(i % 7u + 1u));
+        jobs.push_back({ SUM, { { 0x0200u, input } } });
+    }
+
+    auto results = subject.Run(jobs);
+
+    ASSERT_EQ(results.size(), jobs.size());
+    for (auto i = 0u; i < results.size(); i++)
+    {
+        ASSERT_EQ(results[i].reason, ExitReason::Halted);
+        auto expected = static_cast<uint8_t>((i % 23u + 1u) * (i % 7u + 1u));
+        ASSERT_EQ(static_cast<uint8_t>(results[i].ram[0][0]), expected);
+    }
+}
+
+TEST_F(BatchRunnerTests, Run_GivenNoJobs_ReturnsNothing)
+{
+    auto subject = BatchRunner(executor, 1000u, {}, 4u);
+
+    ASSERT_TRUE(subject.Run({}).empty());
+}
+
+TEST_F(BatchRunnerTests, Constructor_GivenNoThreadCount_UsesAtLeastOne)
+{
+    auto subject = BatchRunner(executor, 1000u, {});
+
+    ASSERT_GE(subject.Threads(), 1u);
+}
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/bclr.h"
 #include "instructions/opcodes.h"
 
@@ -14,7 +13,6 @@ using namespace avr;
 class BCLRInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         BCLRInstruction subject;
         ExecutionContext ctx;
 
@@ -49,7 +47,7 @@ class BCLRInstructionTests : public ::testing::Test
 
     public:
         BCLRInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/bld.h"
 #include "instructions/opcodes.h"
 
@@ -14,7 +13,6 @@ using namespace avr;
 class BLDInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         BLDInstruction subject;
         ExecutionContext ctx;
 
@@ -35,7 +33,7 @@ class BLDInstructionTests : public ::testing::Test
 
     public:
         BLDInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -0,0 +1,76 @@
+#include "core/blockcache.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+
+using namespace avr;
+
+class BlockCacheTests : public ::testing::Test
+{
+    protected:
+        BlockCache subject;
+
+        TranslatedBlock& Add(uint16_t start, uint32_t end)
+        {
+            auto block = std::make_unique<TranslatedBlock>();
+            block->start = start;
+            block->end = end;
+            block->exits = {};
+            return subject.Insert(std::move(block));
+        }
+
+    public:
+        BlockCacheTests()
+            : subject(0x100u)
+        {}
+};
+
+TEST_F(BlockCacheTests, Find_GivenNewCache_ReturnsNull)
+{
+    ASSERT_EQ(subject.Find(0x40u), nullptr);
+}
+
+TEST_F(BlockCacheTests, Find_GivenInsertedBlock_ReturnsBlock)
+{
+    auto& block = Add(0x40u, 0x48u);
+
+    ASSERT_EQ(subject.Find(0x40u), &block);
+    ASSERT_EQ(subject.Find(0x42u), nullptr);
+}
+
+TEST_F(BlockCacheTests, Invalidate_GivenAddressInsideBlock_DropsBlockAndBumpsGeneration)
+{
+    Add(0x40u, 0x48u);
+    auto generation = subject.Generation();
+
+    subject.Invalidate(0x47u);
+
+    ASSERT_EQ(subject.Find(0x40u), nullptr);
+    ASSERT_NE(subject.Generation(), generation);
+}
+
+TEST_F(BlockCacheTests, Invalidate_GivenAddressOutsideBlocks_KeepsBlocks)
+{
+    auto& block = Add(0x40u, 0x48u);
+    auto generation = subject.Generation();
+
+    subject.Invalidate(0x48u);
+
+    ASSERT_EQ(subject.Find(0x40u), &block);
+    ASSERT_EQ(subject.Generation(), generation);
+}
+
+TEST_F(BlockCacheTests, Invalidate_GivenLinkedBlocks_UnlinksSurvivors)
+{
+    auto& first = Add(0x40u, 0x48u);
+    auto& second = Add(0x48u, 0x50u);
+    first.exits[0] = { 0x48u, &second };
+    second.exits[0] = { 0x40u, &first };
+
+    subject.Invalidate(0x4Au);
+
+    ASSERT_EQ(subject.Find(0x40u), &first);
+    ASSERT_EQ(first.exits[0].block, nullptr);
+}
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/brbc.h"
 #include "instructions/opcodes.h"
 
@@ -13,7 +12,6 @@ using namespace avr;
 class BRBCInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         BRBCInstruction subject;
         ExecutionContext ctx;
 
@@ -26,7 +24,7 @@ class BRBCInstructionTests : public ::testing::Test
 
     public:
         BRBCInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/bst.h"
 #include "instructions/opcodes.h"
 
@@ -14,7 +13,6 @@ using namespace avr;
 class BSTInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         BSTInstruction subject;
         ExecutionContext ctx;
 
@@ -35,7 +33,7 @@ class BSTInstructionTests : public ::testing::Test
 
     public:
         BSTInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/call.h"
 #include "instructions/opcodes.h"
 
@@ -13,7 +12,6 @@ using namespace avr;
 class CALLInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         CALLInstruction subject;
         ExecutionContext ctx;
 
@@ -56,7 +54,7 @@ class CALLInstructionTests : public ::testing::Test
 
     public:
         CALLInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/cbi.h"
 #include "instructions/opcodes.h"
 
@@ -14,7 +13,6 @@ using namespace avr;
 class CBIInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         CBIInstruction subject;
         ExecutionContext ctx;
 
@@ -35,7 +33,7 @@ class CBIInstructionTests : public ::testing::Test
 
     public:
         CBIInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -74,3 +72,16 @@ TEST_F(CBIInstructionTests, Execute_GivenBitSet_ClearsBit)
 
     ASSERT_EQ(ctx.cpu.GPIO[dst], expectedValue);
 }
+
+TEST_F(CBIInstructionTests, Execute_GivenRegisterOfFlagsClearedByOne_LeavesFlagsSet)
+{
+    auto written = uint8_t(0xFFu);
+    ctx.io.Map(0x35u,
+        [] (ExecutionContext&, uint16_t) { return uint8_t(0x97u); },
+        [&written] (ExecutionContext&, uint16_t, uint8_t value) { written = value; },
+        0x07u);
+
+    subject.Execute(GetOpCode(4u, 0x15u), ctx);
+
+    ASSERT_EQ(written, 0x80u);
+}
@@ -0,0 +1,83 @@
+#include "core/clock.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+using namespace avr;
+using namespace std::chrono_literals;
+
+class ClockTests : public ::testing::Test
+{
+    protected:
+        // 1 MHz keeps the cycle counts in these tests readable
+        Clock subject;
+
+    public:
+        ClockTests()
+            : subject(1000000u, 1ms)
+        {}
+};
+
+TEST_F(ClockTests, Quantum_GivenFrequencyAndDuration_ReturnsCyclesPerQuantum)
+{
+    auto clock = Clock(16000000u, 1ms);
+
+    ASSERT_EQ(clock.Quantum(), 16000u);
+    ASSERT_EQ(clock.Frequency(), 16000000u);
+}
+
+TEST_F(ClockTests, Quantum_GivenQuantumShorterThanACycle_ReturnsOneCycle)
+{
+    auto clock = Clock(1000u, 1us);
+
+    ASSERT_EQ(clock.Quantum(), 1u);
+}
+
+TEST_F(ClockTests, Synchronize_GivenCPUAheadOfRealTime_WaitsForDeadline)
+{
+    subject.Synchronize(0u);
+    auto start = std::chrono::steady_clock::now();
+
+    subject.Synchronize(20000u);
+
+    ASSERT_GE(std::chrono::steady_clock::now() - start, 19ms);
+    ASSERT_LT(subject.Lag(), 0ns);
+}
+
+TEST_F(ClockTests, Synchronize_GivenCPUBehindRealTime_ReportsLag)
+{
+    subject.Synchronize(0u);
+    std::this_thread::sleep_for(10ms);
+
+    subject.Synchronize(1000u);
+
+    ASSERT_GE(subject.Lag(), 9ms);
+}
+
+TEST_F(ClockTests, Synchronize_GivenLagBeyondMaximum_StopsCatchingUp)
+{
+    subject.Synchronize(0u);
+    std::this_thread::sleep_for(Clock::MAX_LAG + 10ms);
+    subject.Synchronize(1000u);
+    auto lag = subject.Lag();
+    auto start = std::chrono::steady_clock::now();
+
+    subject.Synchronize(11000u);
+
+    ASSERT_GT(lag, Clock::MAX_LAG);
+    ASSERT_GE(std::chrono::steady_clock::now() - start, 9ms);
+}
+
+TEST_F(ClockTests, Pulse_GivenLongPause_RestartsPacing)
+{
+    subject.Synchronize(0u);
+    std::this_thread::sleep_for(10ms);
+
+    subject.Pulse();
+    subject.Synchronize(1000u);
+
+    ASSERT_EQ(subject.Lag(), 0ns);
+}
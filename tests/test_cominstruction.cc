@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/com.h"
 #include "instructions/opcodes.h"
 
@@ -14,7 +13,6 @@ using namespace avr;
 class COMInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         COMInstruction subject;
         ExecutionContext ctx;
 
@@ -33,7 +31,7 @@ class COMInstructionTests : public ::testing::Test
 
     public:
         COMInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
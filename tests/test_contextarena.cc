@@ -0,0 +1,119 @@
+#include "cdif/cdif.h"
+#include "core/contextarena.h"
+#include "core/coremodule.h"
+#include "core/executioncontext.h"
+#include "core/loader.h"
+#include "core/threadedexecutor.h"
+#include "instructions/instructionmodule.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+
+using namespace avr;
+
+namespace {
+    cdif::Container BuildArenaContainer()
+    {
+        auto ctx = cdif::Container();
+        ctx.registerModule<InstructionModule>();
+        ctx.registerModule<CoreModule>();
+        return ctx;
+    }
+
+    const std::string COUNTER = std::string(
+        "\x03\x95"          // inc  r16
+        "\x00\x93\x00\x02"  // sts  0x0200, r16
+        "\xf8\xcf"          // rjmp .-8
+        , 8);
+}
+
+class ContextArenaTests : public ::testing::Test
+{
+    protected:
+        cdif::Container container;
+        ThreadedExecutor executor;
+        Loader loader;
+
+    public:
+        ContextArenaTests()
+            : container(BuildArenaContainer()),
+              executor(container.resolve<ThreadedExecutor>()),
+              loader()
+        {}
+};
+
+TEST_F(ContextArenaTests, Allocate_GivenArenaFull_Throws)
+{
+    auto subject = ContextArena(2u);
+    subject.Allocate();
+    subject.Allocate();
+
+    ASSERT_THROW(subject.Allocate(), std::string);
+    ASSERT_EQ(subject.size(), 2u);
+}
+
+TEST_F(ContextArenaTests, Allocate_AlignsRegisterFilesAndCPUsToCacheLines)
+{
+    auto subject = ContextArena(5u);
+    for (auto i = 0u; i < subject.capacity(); i++)
+        subject.Allocate();
+
+    for (auto& ctx : subject)
+    {
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(ctx.cpu.R) % ContextArena::ALIGNMENT, 0u);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(&ctx.cpu) % ContextArena::ALIGNMENT, 0u);
+        ASSERT_EQ(&ctx.cpu.R[0], &ctx.ram[0x00u]);
+    }
+}
+
+TEST_F(ContextArenaTests, Allocate_GivenContextsWritingMemory_KeepsThemApart)
+{
+    auto subject = ContextArena(3u, 0x1000u);
+    for (auto i = 0u; i < subject.capacity(); i++)
+        subject.Allocate().ram[0xFFFu] = static_cast<uint8_t>(i + 1u);
+
+    ASSERT_EQ(subject[0].ram[0xFFFu], 1u);
+    ASSERT_EQ(subject[1].ram[0xFFFu], 2u);
+    ASSERT_EQ(subject[2].ram[0xFFFu], 3u);
+    ASSERT_EQ(subject[1].ram[0x000u], 0u);
+}
+
+TEST_F(ContextArenaTests, Allocate_GivenLoadedImage_RunsLikeLoadedProgram)
+{
+    auto subject = ContextArena(64u);
+    auto& first = subject.Allocate();
+    loader.LoadProgram(first, COUNTER);
+    auto image = first.Snapshot();
+    for (auto i = 1u; i < subject.capacity(); i++)
+        subject.Allocate(image);
+    auto expected = loader.LoadProgram(COUNTER);
+    executor.Execute(expected, 50u);
+
+    for (auto& ctx : subject)
+    {
+        executor.Execute(ctx, 50u);
+
+        ASSERT_EQ(ctx.cpu.R[16], expected.cpu.R[16]);
+        ASSERT_EQ(ctx.ram[0x200u], expected.ram[0x200u]);
+        ASSERT_EQ(ctx.cpu.PC, expected.cpu.PC);
+        ASSERT_EQ(ctx.cycles, expected.cycles);
+    }
+}
+
+TEST_F(ContextArenaTests, Reset_GivenContextFromImage_ReturnsToImage)
+{
+    auto subject = ContextArena(2u);
+    auto& first = subject.Allocate();
+    loader.LoadProgram(first, COUNTER);
+    auto& ctx = subject.Allocate(first.Snapshot());
+    executor.Execute(ctx, 100u);
+
+    ctx.Reset();
+
+    ASSERT_EQ(ctx.cpu.R[16], 0u);
+    ASSERT_EQ(ctx.ram[0x200u], 0u);
+    ASSERT_EQ(ctx.cpu.PC, 0x940u);
+    ASSERT_EQ(ctx.cycles, 0u);
+}
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/cpse.h"
 #include "instructions/opcodes.h"
 
@@ -14,7 +13,6 @@ using namespace avr;
 class CPSEInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         CPSEInstruction subject;
         ExecutionContext ctx;
 
@@ -56,7 +54,7 @@ class CPSEInstructionTests : public ::testing::Test
 
     public:
         CPSEInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
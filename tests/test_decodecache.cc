@@ -0,0 +1,66 @@
+#include "core/decodecache.h"
+#include "instructions/nop.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+using namespace avr;
+
+class DecodeCacheTests : public ::testing::Test
+{
+    protected:
+        NOPInstruction executor;
+        DecodeCache subject;
+
+        void Fill(uint16_t address)
+        {
+            subject[address].executor = &executor;
+        }
+
+    public:
+        DecodeCacheTests()
+            : executor(), subject(0x100u)
+        {}
+};
+
+TEST_F(DecodeCacheTests, IsCacheable_GivenOddAddress_ReturnsFalse)
+{
+    ASSERT_FALSE(DecodeCache::IsCacheable(0x41u));
+    ASSERT_TRUE(DecodeCache::IsCacheable(0x40u));
+}
+
+TEST_F(DecodeCacheTests, Lookup_GivenNewCache_ReturnsEmptySlot)
+{
+    ASSERT_EQ(subject[0x40u].executor, nullptr);
+}
+
+TEST_F(DecodeCacheTests, Lookup_GivenAddressBeyondMemorySize_WrapsToSameSlot)
+{
+    Fill(0x40u);
+
+    ASSERT_EQ(&subject[0x140u], &subject[0x40u]);
+    ASSERT_EQ(subject[0x140u].executor, &executor);
+}
+
+TEST_F(DecodeCacheTests, Invalidate_GivenAddress_ClearsWordAndPreviousWord)
+{
+    Fill(0x3Eu);
+    Fill(0x40u);
+    Fill(0x42u);
+
+    subject.Invalidate(0x41u);
+
+    ASSERT_EQ(subject[0x3Eu].executor, nullptr);
+    ASSERT_EQ(subject[0x40u].executor, nullptr);
+    ASSERT_EQ(subject[0x42u].executor, &executor);
+}
+
+TEST_F(DecodeCacheTests, Invalidate_GivenFirstWord_ClearsLastWord)
+{
+    Fill(0xFEu);
+
+    subject.Invalidate(0x00u);
+
+    ASSERT_EQ(subject[0xFEu].executor, nullptr);
+}
@@ -0,0 +1,61 @@
+#include "core/dispatchtable.h"
+#include "instructions/add.h"
+#include "instructions/instructionexecutor.h"
+#include "instructions/nop.h"
+#include "instructions/notimplemented.h"
+#include "instructions/opcodes.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+using namespace avr;
+
+class DispatchTableTests : public ::testing::Test
+{
+    protected:
+        std::vector<std::unique_ptr<InstructionExecutor>> BuildExecutors(bool withFallback)
+        {
+            auto executors = std::vector<std::unique_ptr<InstructionExecutor>>();
+            executors.push_back(std::make_unique<NOPInstruction>());
+            executors.push_back(std::make_unique<ADDInstruction>());
+            if (withFallback)
+                executors.push_back(std::make_unique<NotImplementedInstruction>());
+            return executors;
+        }
+};
+
+TEST_F(DispatchTableTests, Lookup_GivenAnyOpCode_ReturnsFirstMatchingExecutor)
+{
+    auto executors = BuildExecutors(true);
+    auto expected = std::vector<const InstructionExecutor*>();
+    for (const auto& executor : executors)
+        expected.push_back(executor.get());
+    auto subject = DispatchTable(std::move(executors));
+
+    for (auto i = 0u; i < DispatchTable::OPCODE_COUNT; i++)
+    {
+        auto opcode = static_cast<uint16_t>(i);
+        auto match = *std::find_if(std::begin(expected), std::end(expected),
+            [opcode] (const auto* executor) { return executor->Matches(opcode); });
+        ASSERT_EQ(subject[opcode], match);
+    }
+}
+
+TEST_F(DispatchTableTests, Lookup_GivenADDOpCode_ReturnsADDExecutor)
+{
+    auto subject = DispatchTable(BuildExecutors(true));
+
+    auto executor = subject[static_cast<uint16_t>(OpCode::ADD) | 0x0123u];
+
+    ASSERT_NE(dynamic_cast<const ADDInstruction*>(executor), nullptr);
+}
+
+TEST_F(DispatchTableTests, Lookup_GivenNoMatchingExecutor_ReturnsNull)
+{
+    auto subject = DispatchTable(BuildExecutors(false));
+
+    ASSERT_EQ(subject[static_cast<uint16_t>(OpCode::SLEEP)], nullptr);
+}
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/eor.h"
 #include "instructions/opcodes.h"
 
@@ -15,7 +14,6 @@ class EORInstructionTests : public ::testing::Test
 {
 
     protected:
-        NoopClock clock;
         EORInstruction subject;
         ExecutionContext ctx;
 
@@ -36,7 +34,7 @@ class EORInstructionTests : public ::testing::Test
 
     public:
         EORInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -0,0 +1,201 @@
+#include "cdif/cdif.h"
+#include "core/coremodule.h"
+#include "core/eventqueue.h"
+#include "core/executioncontext.h"
+#include "core/executor.h"
+#include "core/loader.h"
+#include "core/noopclock.h"
+#include "instructions/instructionmodule.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace avr;
+
+namespace {
+    cdif::Container BuildEventContainer()
+    {
+        auto ctx = cdif::Container();
+        ctx.registerModule<InstructionModule>();
+        ctx.registerModule<CoreModule>();
+        return ctx;
+    }
+
+    const std::string SPIN = std::string(
+        "\xfe\xcf"          // rjmp .-2
+        , 2);
+}
+
+class EventQueueTests : public ::testing::Test
+{
+    protected:
+        cdif::Container container;
+        NoopClock clock;
+        Executor executor;
+        Loader loader;
+
+    public:
+        EventQueueTests()
+            : container(BuildEventContainer()),
+              clock(),
+              executor(clock, container.resolve<Executor>().GetDispatchTable()),
+              loader()
+        {}
+};
+
+TEST_F(EventQueueTests, Take_GivenPostedEvents_ReturnsThemInOrder)
+{
+    auto subject = EventQueue(4u);
+    subject.Post(ExternalEvent::Interrupt(10u, 1u));
+    subject.Post(ExternalEvent::Pins(20u, 0x23u, 0x01u, 0x01u));
+
+    auto event = ExternalEvent();
+    ASSERT_TRUE(subject.Take(event));
+    ASSERT_EQ(event.kind, ExternalEvent::Kind::Interrupt);
+    ASSERT_EQ(event.cycle, 10u);
+    ASSERT_TRUE(subject.Take(event));
+    ASSERT_EQ(event.kind, ExternalEvent::Kind::Pins);
+    ASSERT_EQ(event.address, 0x23u);
+    ASSERT_FALSE(subject.Take(event));
+}
+
+TEST_F(EventQueueTests, Post_GivenFullQueue_ReturnsFalseUntilDrained)
+{
+    auto subject = EventQueue(2u);
+    ASSERT_TRUE(subject.Post(ExternalEvent::Interrupt(0u, 0u)));
+    ASSERT_TRUE(subject.Post(ExternalEvent::Interrupt(0u, 1u)));
+
+    ASSERT_FALSE(subject.Post(ExternalEvent::Interrupt(0u, 2u)));
+
+    auto event = ExternalEvent();
+    subject.Take(event);
+    ASSERT_TRUE(subject.Post(ExternalEvent::Interrupt(0u, 2u)));
+}
+
+TEST_F(EventQueueTests, Post_GivenInterruptOutOfRange_ThrowsAndQueuesNothing)
+{
+    auto subject = EventQueue(4u);
+
+    ASSERT_THROW(subject.Post(ExternalEvent::Interrupt(0u, 64u)), std::string);
+
+    auto event = ExternalEvent();
+    ASSERT_FALSE(subject.Take(event));
+}
+
+TEST_F(EventQueueTests, Post_GivenManyProducers_DeliversEveryEventOnceInProducerOrder)
+{
+    constexpr auto PRODUCERS = 4u;
+    constexpr auto EVENTS = 5000u;
+    auto subject = EventQueue(64u);
+
+    auto producers = std::vector<std::thread>();
+    for (auto producer = 0u; producer < PRODUCERS; producer++)
+        producers.emplace_back([&subject, producer] {
+            for (auto i = 0u; i < EVENTS; i++)
+                while (!subject.Post(ExternalEvent::Interrupt(i, static_cast<uint8_t>(producer))))
+                    std::this_thread::yield();
+        });
+
+    auto next = std::vector<uint64_t>(PRODUCERS, 0u);
+    auto received = 0u;
+    auto event = ExternalEvent();
+    while (received < PRODUCERS * EVENTS)
+    {
+        if (!subject.Take(event))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(event.cycle, next[event.value]++);
+        received++;
+    }
+    for (auto& producer : producers)
+        producer.join();
+
+    ASSERT_FALSE(subject.Take(event));
+}
+
+TEST_F(EventQueueTests, Drain_GivenFutureEvent_AppliesItAtItsCycle)
+{
+    auto ctx = loader.LoadProgram(SPIN);
+    auto events = ctx.Events();
+    events->Post(ExternalEvent::Pins(1000u, 0x23u, 0x0Fu, 0xFFu));
+    ctx.ram[0x23u] = 0xA0u;
+
+    executor.Execute(ctx, 500u);
+    auto before = std::as_const(ctx.ram)[0x23u];
+    executor.Execute(ctx, 1000u);
+
+    ASSERT_EQ(before, 0xA0u);
+    ASSERT_EQ(std::as_const(ctx.ram)[0x23u], 0xAFu);
+    ASSERT_GE(events->Now(), 500u);
+}
+
+TEST_F(EventQueueTests, Drain_GivenInterruptFromAnotherThread_EntersHandler)
+{
+    auto ctx = loader.LoadProgram(SPIN);
+    // Handler 0 sets r16
+    ctx.progMem[0x0A00u] = 0x0Fu;   // ldi r16, 0xFF
+    ctx.progMem[0x0A01u] = 0xEFu;
+    ctx.progMem[0x0A02u] = 0x08u;   // ret
+    ctx.progMem[0x0A03u] = 0x95u;
+    ctx.ram[0x7F0u] = 0x00u;
+    ctx.ram[0x7F1u] = 0x0Au;
+    ctx.cpu.SREG.I = true;
+    auto events = ctx.Events();
+
+    auto producer = std::thread([events] {
+        events->Post(ExternalEvent::Interrupt(0u, 0u));
+    });
+    producer.join();
+    executor.Execute(ctx, 100u);
+
+    ASSERT_EQ(ctx.cpu.R[16], 0xFFu);
+    ASSERT_EQ(ctx.cpu.PC, 0x940u);
+    ASSERT_TRUE(ctx.cpu.SREG.I);
+}
+
+TEST_F(EventQueueTests, Events_GivenContextMoved_KeepsSameQueue)
+{
+    auto ctx = loader.LoadProgram(SPIN);
+    auto events = ctx.Events();
+
+    auto moved = std::move(ctx);
+
+    ASSERT_EQ(moved.Events(), events);
+}
+
+TEST_F(EventQueueTests, Drain_GivenInterruptPostedWhileRunning_EntersHandlerBeforeBudgetRunsOut)
+{
+    auto ctx = loader.LoadProgram(std::string(
+        "\x13\x95"          // inc  r17
+        "\xfe\xcf"          // rjmp .-4
+        , 4));
+    ctx.progMem[0x0A00u] = 0x0Fu;   // ldi r16, 0xFF
+    ctx.progMem[0x0A01u] = 0xEFu;
+    ctx.progMem[0x0A02u] = 0x08u;   // ret
+    ctx.progMem[0x0A03u] = 0x95u;
+    ctx.ram[0x7F0u] = 0x00u;
+    ctx.ram[0x7F1u] = 0x0Au;
+    ctx.cpu.SREG.I = true;
+    auto events = ctx.Events();
+
+    // Posts from another thread while the context is stopped mid-run, well
+    // past the drain when the run started
+    auto postedAt = uint64_t(0u);
+    ctx.scheduler.Schedule(1000u, [events, &postedAt] (ExecutionContext& context) {
+        postedAt = context.cycles;
+        auto producer = std::thread([events] {
+            events->Post(ExternalEvent::Interrupt(0u, 0u));
+        });
+        producer.join();
+    });
+    executor.Execute(ctx, 100000000u);
+
+    ASSERT_GE(postedAt, 1000u);
+    ASSERT_EQ(ctx.cpu.R[16], 0xFFu);
+}
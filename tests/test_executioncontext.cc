@@ -0,0 +1,261 @@
+#include "cdif/cdif.h"
+#include "core/coremodule.h"
+#include "core/executioncontext.h"
+#include "core/loader.h"
+#include "core/threadedexecutor.h"
+#include "instructions/instructionmodule.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace avr;
+
+namespace {
+    cdif::Container BuildSnapshotContainer()
+    {
+        auto ctx = cdif::Container();
+        ctx.registerModule<InstructionModule>();
+        ctx.registerModule<CoreModule>();
+        return ctx;
+    }
+
+    const std::string COUNTER = std::string(
+        "\x03\x95"          // inc  r16
+        "\x00\x93\x00\x02"  // sts  0x0200, r16
+        "\x0f\x93"          // push r16
+        "\xf6\xcf"          // rjmp .-10
+        , 10);
+}
+
+class ExecutionContextTests : public ::testing::Test
+{
+    protected:
+        cdif::Container container;
+        ThreadedExecutor executor;
+        Loader loader;
+
+    public:
+        ExecutionContextTests()
+            : container(BuildSnapshotContainer()),
+              executor(container.resolve<ThreadedExecutor>()),
+              loader()
+        {}
+};
+
+TEST_F(ExecutionContextTests, Restore_GivenProgramRunPastSnapshot_RewindsToSnapshot)
+{
+    auto ctx = loader.LoadProgram(COUNTER);
+    executor.Execute(ctx, 70u);
+    auto snapshot = ctx.Snapshot();
+    auto r16 = ctx.cpu.R[16];
+    auto sp = ctx.cpu.SP;
+    auto pc = ctx.cpu.PC;
+    auto cycles = ctx.cycles;
+
+    executor.Execute(ctx, 300u);
+    ctx.Restore(snapshot);
+
+    ASSERT_EQ(ctx.cpu.R[16], r16);
+    ASSERT_EQ(ctx.ram[0x200u], r16);
+    ASSERT_EQ(ctx.ram[static_cast<uint16_t>(sp + 1u)], r16);
+    ASSERT_EQ(ctx.ram[sp], 0x00u);
+    ASSERT_EQ(ctx.cpu.SP, sp);
+    ASSERT_EQ(ctx.cpu.PC, pc);
+    ASSERT_EQ(ctx.cycles, cycles);
+}
+
+TEST_F(ExecutionContextTests, Restore_GivenSnapshotRunTwice_RepeatsTheSameRun)
+{
+    auto ctx = loader.LoadProgram(COUNTER);
+    executor.Execute(ctx, 35u);
+    auto snapshot = ctx.Snapshot();
+    executor.Execute(ctx, 200u);
+    auto r16 = ctx.cpu.R[16];
+    auto sp = ctx.cpu.SP;
+    auto cycles = ctx.cycles;
+
+    ctx.Restore(snapshot);
+    executor.Execute(ctx, 200u);
+
+    ASSERT_EQ(ctx.cpu.R[16], r16);
+    ASSERT_EQ(ctx.cpu.SP, sp);
+    ASSERT_EQ(ctx.cycles, cycles);
+}
+
+TEST_F(ExecutionContextTests, Restore_GivenSnapshotOfAnotherContext_ForksIt)
+{
+    auto original = loader.LoadProgram(COUNTER);
+    executor.Execute(original, 49u);
+    auto snapshot = original.Snapshot();
+    auto fork = loader.LoadProgram("");
+
+    fork.Restore(snapshot);
+    executor.Execute(fork, 100u);
+    executor.Execute(original, 100u);
+
+    ASSERT_EQ(fork.cpu.R[16], original.cpu.R[16]);
+    ASSERT_EQ(fork.cpu.PC, original.cpu.PC);
+    ASSERT_EQ(fork.cpu.SP, original.cpu.SP);
+    ASSERT_EQ(fork.ram[0x200u], original.ram[0x200u]);
+}
+
+TEST_F(ExecutionContextTests, Restore_GivenFlashChangedAfterSnapshot_RunsOriginalCode)
+{
+    auto ctx = loader.LoadProgram(
+        "\x01\xe0"  // ldi  r16, 0x01
+        "\xfe\xcf"  // rjmp .-2
+    );
+    auto snapshot = ctx.Snapshot();
+    ctx.progMem[0x940u] = 0x02u;    // ldi  r16, 0x02
+    executor.Execute(ctx, 3u);
+    auto changed = ctx.cpu.R[16];
+
+    ctx.Restore(snapshot);
+    executor.Execute(ctx, 3u);
+
+    ASSERT_EQ(changed, 0x02u);
+    ASSERT_EQ(ctx.cpu.R[16], 0x01u);
+}
+
+TEST_F(ExecutionContextTests, Restore_GivenEventRunAfterSnapshot_SchedulesItAgain)
+{
+    auto ctx = loader.LoadProgram("\xfe\xcf");
+    auto runs = 0u;
+    ctx.scheduler.Schedule(50u, [&runs] (ExecutionContext&) { runs++; });
+    auto snapshot = ctx.Snapshot();
+
+    executor.Execute(ctx, 100u);
+    ctx.Restore(snapshot);
+    executor.Execute(ctx, 100u);
+
+    ASSERT_EQ(runs, 2u);
+}
+
+TEST_F(ExecutionContextTests, Snapshot_GivenStackOnlyPopped_SharesTheStackPage)
+{
+    auto ctx = loader.LoadProgram("\x0f\x91\x0f\x91\xfe\xcf");   // pop r16; pop r16; rjmp .-2
+    auto before = ctx.Snapshot();
+
+    executor.Execute(ctx, 4u);
+    auto after = ctx.Snapshot();
+
+    auto page = (ctx.cpu.SP & 0xFFFFu) / Memory::PAGE_SIZE;
+    ASSERT_EQ(ctx.cpu.SP, 0x7F1u);
+    ASSERT_EQ(before.ram[page], after.ram[page]);
+}
+
+TEST_F(ExecutionContextTests, Snapshot_GivenPeripheralMapped_Throws)
+{
+    auto ctx = loader.LoadProgram("\xfe\xcf");
+    ctx.io.Map(0x25u, nullptr, nullptr);
+
+    ASSERT_THROW(ctx.Snapshot(), std::string);
+}
+
+TEST_F(ExecutionContextTests, Reset_GivenPeripheralMapped_ThrowsUntilItIsUnmapped)
+{
+    auto ctx = loader.LoadProgram("\xfe\xcf");
+    ctx.io.Map(0x25u, nullptr, nullptr);
+
+    ASSERT_THROW(ctx.Reset(), std::string);
+    ctx.io.Unmap(0x25u);
+    ASSERT_NO_THROW(ctx.Reset());
+}
+
+TEST_F(ExecutionContextTests, Reset_GivenLoadedProgramRun_ReturnsToLoadedState)
+{
+    auto ctx = loader.LoadProgram(COUNTER);
+    executor.Execute(ctx, 300u);
+
+    ctx.Reset();
+
+    ASSERT_EQ(ctx.cpu.R[16], 0x00u);
+    ASSERT_EQ(ctx.ram[0x200u], 0x00u);
+    ASSERT_EQ(ctx.ram[0x7EFu], 0x00u);
+    ASSERT_EQ(ctx.cpu.PC, 0x940u);
+    ASSERT_EQ(ctx.cpu.SP, 0x7EFu);
+    ASSERT_EQ(ctx.cycles, 0u);
+}
+
+TEST_F(ExecutionContextTests, Reset_GivenRepeatedRuns_BehavesLikeFreshLoad)
+{
+    auto ctx = loader.LoadProgram(COUNTER);
+    auto expected = loader.LoadProgram(COUNTER);
+    executor.Execute(expected, 150u);
+
+    for (auto run = 0u; run < 3u; run++)
+    {
+        ctx.Reset();
+        executor.Execute(ctx, 150u);
+
+        ASSERT_EQ(ctx.cpu.R[16], expected.cpu.R[16]);
+        ASSERT_EQ(ctx.cpu.SP, expected.cpu.SP);
+        ASSERT_EQ(ctx.cpu.PC, expected.cpu.PC);
+        ASSERT_EQ(ctx.cycles, expected.cycles);
+    }
+}
+
+TEST_F(ExecutionContextTests, Reset_GivenNoResetImage_Throws)
+{
+    auto ctx = ExecutionContext();
+
+    ASSERT_THROW(ctx.Reset(), std::string);
+}
+
+TEST_F(ExecutionContextTests, MoveAssign_GivenLoadedProgram_RebindsRegisterViews)
+{
+    auto ctx = ExecutionContext();
+
+    ctx = loader.LoadProgram(COUNTER);
+    ctx.cpu.R[26] = 0x34u;
+    ctx.cpu.R[27] = 0x12u;
+
+    ASSERT_EQ(&ctx.cpu.R[0], &ctx.ram[0x00u]);
+    ASSERT_EQ(&ctx.cpu.GPIO[0], &ctx.ram[0x20u]);
+    ASSERT_EQ(*ctx.cpu.X, 0x1234u);
+    ASSERT_EQ(ctx.cpu.PC, 0x940u);
+    ASSERT_EQ(ctx.cpu.SP, 0x7EFu);
+}
+
+TEST_F(ExecutionContextTests, CPUAssign_GivenAnotherContextsCPU_CopiesStateButKeepsOwnRegisters)
+{
+    static_assert(!std::is_copy_constructible_v<CPU>);
+    auto source = loader.LoadProgram(COUNTER);
+    auto target = ExecutionContext();
+    source.cpu.R[26] = 0x34u;
+    source.cpu.SREG.Z = true;
+
+    target.cpu = source.cpu;
+    target.cpu.R[26] = 0x56u;
+
+    ASSERT_EQ(&target.cpu.R[0], &target.ram[0x00u]);
+    ASSERT_EQ(target.cpu.PC, 0x940u);
+    ASSERT_TRUE(target.cpu.SREG.Z);
+    ASSERT_EQ(source.cpu.R[26], 0x34u);
+}
+
+TEST_F(ExecutionContextTests, Execute_GivenContextsHeldInGrowingVector_RunsEachIndependently)
+{
+    auto contexts = std::vector<ExecutionContext>();
+    for (auto i = 0u; i < 9u; i++)
+    {
+        contexts.push_back(loader.LoadProgram(COUNTER));
+        executor.Execute(contexts.back(), 7u * (i + 1u));
+    }
+
+    for (auto i = 0u; i < contexts.size(); i++)
+    {
+        auto& ctx = contexts[i];
+        ASSERT_EQ(&ctx.cpu.R[0], &ctx.ram[0x00u]);
+        ASSERT_EQ(ctx.cpu.R[16], i + 1u);
+        ASSERT_EQ(ctx.ram[0x200u], i + 1u);
+
+        ctx.Reset();
+        executor.Execute(ctx, 7u);
+        ASSERT_EQ(ctx.cpu.R[16], 1u);
+    }
+}
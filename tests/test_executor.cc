@@ -3,6 +3,7 @@
 #include "core/loader.h"
 #include "core/executioncontext.h"
 #include "core/executor.h"
+#include "core/interrupts.h"
 #include "core/noopclock.h"
 #include "instructions/instructionmodule.h"
 
@@ -11,6 +12,7 @@
 #include <cstdlib>
 #include <ctime>
 #include <tuple>
+#include <vector>
 
 using namespace avr;
 
@@ -22,6 +24,34 @@ cdif::Container BuildContainer()
     return ctx;
 }
 
+namespace {
+    class RecordingClock : public IClock
+    {
+        private:
+            uint32_t _quantum;
+
+        public:
+            std::vector<uint64_t> synchronized;
+
+            RecordingClock(uint32_t quantum)
+                : _quantum(quantum),
+                  synchronized()
+            {}
+
+            void Pulse() override {}
+
+            void Synchronize(uint64_t cycles) override
+            {
+                synchronized.push_back(cycles);
+            }
+
+            uint32_t Quantum() const override
+            {
+                return _quantum;
+            }
+    };
+}
+
 class ExecutorTests : public ::testing::Test
 {
 
@@ -82,6 +112,45 @@ TEST_F(ExecutorTests, Execute_GivenEnoughCycles_CompletesProgram)
     ASSERT_EQ(ctx.cpu.R[3], 14u);
 }
 
+TEST_F(ExecutorTests, Execute_GivenSharedDispatchTable_CompletesProgram)
+{
+    LoadProgramToAddress(
+        "\x05\xe0" // ldi r16, 0x05     1
+        "\x19\xe0" // ldi r17, 0x09     1
+        "\x01\x0f" // add r16, r17      1
+        ,
+        6,
+        0x100);
+    ctx.cpu.PC = 0x100;
+    auto shared = Executor(container.resolve<IClock&>(), subject.GetDispatchTable());
+
+    shared.Execute(ctx, 3);
+
+    ASSERT_EQ(shared.GetDispatchTable(), subject.GetDispatchTable());
+    ASSERT_EQ(ctx.cpu.PC, 0x106u);
+    ASSERT_EQ(ctx.cpu.R[16], 14u);
+}
+
+TEST_F(ExecutorTests, Execute_GivenCodeRewrittenBySPM_ExecutesNewInstruction)
+{
+    LoadProgramToAddress(
+        "\x05\xe0" // ldi  r16, 0x05    1
+        "\xe8\x95" // spm               1
+        "\xfa\xcf" // rjmp .-6          2
+        ,
+        6,
+        0x100);
+    ctx.cpu.PC = 0x100;
+    ctx.cpu.R[0] = 0x09; // ldi r16, 0x09
+    ctx.cpu.R[1] = 0xe0;
+    ctx.cpu.Z = 0x100;
+
+    subject.Execute(ctx, 5);
+
+    ASSERT_EQ(ctx.cpu.PC, 0x102u);
+    ASSERT_EQ(ctx.cpu.R[16], 0x09u);
+}
+
 TEST_F(ExecutorTests, AttachInterrupt_PlacesInterruptHandlerInMemory)
 {
     ctx.cpu.PC = 0x900u;
@@ -141,12 +210,19 @@ TEST_F(ExecutorTests, Interrupt_GivenInterruptEnabled_ExecutesHandlerToEnd)
     ctx.ram[0x7F0] = 0x00;
     ctx.ram[0x7F1] = 0x0A;
     ctx.cpu.SREG.I = true;
+    auto sp = ctx.cpu.SP;
 
     subject.Interrupt(ctx, 0);
+    auto ranBeforeExecute = ctx.cpu.R[16] == 16u;
+    subject.Execute(ctx, 100);
 
-    ASSERT_EQ(ctx.cpu.PC, 0x940);
+    // Back from the handler to the sleep it interrupted
+    ASSERT_FALSE(ranBeforeExecute);
+    ASSERT_EQ(ctx.cpu.PC, 0x942);
+    ASSERT_EQ(ctx.cpu.SP, sp);
     ASSERT_EQ(ctx.cpu.R[16], 16u);
     ASSERT_TRUE(ctx.cpu.SREG.I);
+    ASSERT_EQ(ctx.pendingInterrupts, 0u);
 }
 
 TEST_F(ExecutorTests, Interrupt_GivenInterruptDisabled_SkipsHandler)
@@ -166,8 +242,269 @@ TEST_F(ExecutorTests, Interrupt_GivenInterruptDisabled_SkipsHandler)
     ctx.cpu.R[16] = 0xFF;
 
     subject.Interrupt(ctx, 0);
+    subject.Execute(ctx, 100);
 
-    ASSERT_EQ(ctx.cpu.PC, 0x940);
+    ASSERT_EQ(ctx.cpu.PC, 0x942);
     ASSERT_EQ(ctx.cpu.R[16], 0xFF);
     ASSERT_FALSE(ctx.cpu.SREG.I);
+    ASSERT_EQ(ctx.pendingInterrupts, 0x1u);
+}
+
+TEST_F(ExecutorTests, Execute_GivenProgram_CountsCyclesEachInstructionTakes)
+{
+    LoadProgramToAddress(
+        "\x05\xe0" // ldi  r16, 0x05    1
+        "\x1f\x93" // push r17          2
+        "\x00\x00" // nop               1
+        ,
+        6,
+        0x100);
+    ctx.cpu.PC = 0x100;
+    ctx.cpu.SP = ctx.cpu.SRAM_BEG + 0x100u;
+
+    subject.Execute(ctx, 4);
+
+    ASSERT_EQ(ctx.cpu.PC, 0x106u);
+    ASSERT_EQ(ctx.cycles, 4u);
+}
+
+TEST_F(ExecutorTests, Execute_GivenQuantum_SynchronizesClockOncePerQuantum)
+{
+    auto clock = RecordingClock(4u);
+    auto executor = Executor(clock, subject.GetDispatchTable());
+    ctx.cpu.PC = 0x100;
+
+    executor.Execute(ctx, 10);
+
+    ASSERT_EQ(ctx.cycles, 10u);
+    ASSERT_EQ(clock.synchronized, (std::vector<uint64_t>{1u, 5u, 9u}));
+}
+
+TEST_F(ExecutorTests, Execute_GivenSyncRequested_SynchronizesClockAfterNextInstruction)
+{
+    auto clock = RecordingClock(100u);
+    auto executor = Executor(clock, subject.GetDispatchTable());
+    ctx.cpu.PC = 0x100;
+    executor.Execute(ctx, 3);
+
+    ctx.RequestSync();
+    executor.Execute(ctx, 3);
+
+    ASSERT_EQ(clock.synchronized, (std::vector<uint64_t>{1u, 4u}));
+}
+
+TEST_F(ExecutorTests, Execute_GivenScheduledEvent_RunsItOnTimeWithoutSynchronizingClock)
+{
+    auto clock = RecordingClock(100u);
+    auto executor = Executor(clock, subject.GetDispatchTable());
+    ctx.cpu.PC = 0x100;
+    auto ranAt = uint64_t(0u);
+    ctx.scheduler.Schedule(50u, [&ranAt] (ExecutionContext& context) {
+        ranAt = context.cycles;
+    });
+
+    executor.Execute(ctx, 120);
+
+    ASSERT_EQ(ranAt, 50u);
+    ASSERT_EQ(clock.synchronized, (std::vector<uint64_t>{1u, 101u}));
+}
+
+TEST_F(ExecutorTests, Execute_GivenSleepWithNothingScheduled_SleepsThroughBudget)
+{
+    LoadProgramToAddress(
+        "\x88\x95" // sleep             1
+        ,
+        2,
+        0x100);
+    ctx.cpu.PC = 0x100;
+
+    subject.Execute(ctx, 100000);
+
+    ASSERT_TRUE(ctx.cpu.is_sleeping);
+    ASSERT_EQ(ctx.cpu.PC, 0x102u);
+    ASSERT_EQ(ctx.cycles, 100000u);
+}
+
+TEST_F(ExecutorTests, Execute_GivenWakeUpEvent_ResumesAfterSleepAtEvent)
+{
+    LoadProgramToAddress(
+        "\x88\x95" // sleep             1
+        "\x05\xe0" // ldi  r16, 0x05    1
+        "\xfe\xcf" // rjmp .-2          2
+        ,
+        6,
+        0x100);
+    ctx.cpu.PC = 0x100;
+    auto wokenAt = uint64_t(0u);
+    ctx.scheduler.Schedule(500u, [&wokenAt] (ExecutionContext& context) {
+        wokenAt = context.cycles;
+        context.cpu.is_sleeping = false;
+    });
+
+    subject.Execute(ctx, 400);
+    auto sleptThrough = ctx.cpu.is_sleeping;
+    subject.Execute(ctx, 600);
+
+    ASSERT_TRUE(sleptThrough);
+    ASSERT_FALSE(ctx.cpu.is_sleeping);
+    ASSERT_EQ(wokenAt, 500u);
+    ASSERT_EQ(ctx.cpu.R[16], 0x05u);
+    ASSERT_EQ(ctx.cpu.PC, 0x104u);
+}
+
+TEST_F(ExecutorTests, Interrupt_GivenSleepingCore_WakesItToRunHandler)
+{
+    LoadProgramToAddress(
+        "\x08\xe0" // ldi     r16, 0x08       ; 8
+        "\x00\x0f" // add     r16, r16
+        "\x08\x95" // ret
+        ,
+        6,
+        0x0A00
+    );
+    ctx.ram[0x7F0] = 0x00;
+    ctx.ram[0x7F1] = 0x0A;
+    ctx.cpu.SREG.I = true;
+    subject.Execute(ctx, 1);
+    auto sp = ctx.cpu.SP;
+
+    subject.Interrupt(ctx, 0);
+    subject.Execute(ctx, 100);
+
+    ASSERT_FALSE(ctx.cpu.is_sleeping);
+    ASSERT_EQ(ctx.cpu.SP, sp);
+    ASSERT_EQ(ctx.cpu.R[16], 16u);
+}
+
+TEST_F(ExecutorTests, Interrupt_GivenPendingWhenSEIRuns_EntersAfterNextInstruction)
+{
+    LoadProgramToAddress(
+        "\x78\x94" // sei               1
+        "\x11\xe0" // ldi  r17, 0x01    1
+        "\x12\xe0" // ldi  r17, 0x02    1
+        "\xfe\xcf" // rjmp .-2          2
+        ,
+        8,
+        0x100);
+    ctx.cpu.PC = 0x100;
+    ctx.cpu.SREG.I = false;
+    ctx.ram[0x7F0] = 0x00;
+    ctx.ram[0x7F1] = 0x0A;
+
+    subject.Interrupt(ctx, 0);
+    subject.Execute(ctx, 2);
+
+    ASSERT_EQ(ctx.cpu.PC, 0x0A00u);
+    ASSERT_FALSE(ctx.cpu.SREG.I);
+    ASSERT_EQ(ctx.cpu.R[17], 0x01u);
+    ASSERT_EQ(ctx.ram[ctx.cpu.SP + 1u], INTERRUPT_RETURN >> 8);
+    ASSERT_EQ(ctx.ram[ctx.cpu.SP + 2u], INTERRUPT_RETURN & 0xFFu);
+    ASSERT_EQ(ctx.ram[ctx.cpu.SP + 18u], 0x01u);
+    ASSERT_EQ(ctx.ram[ctx.cpu.SP + 19u], 0x04u);
+    ASSERT_EQ(ctx.cycles, 2u + INTERRUPT_RESPONSE_CYCLES + INTERRUPT_SAVE_CYCLES);
+}
+
+TEST_F(ExecutorTests, Interrupt_GivenSeveralPending_EntersLowestNumberedFirst)
+{
+    ctx.cpu.SREG.I = true;
+    ctx.ram[0x7F2] = 0x00;
+    ctx.ram[0x7F3] = 0x0A;
+    ctx.ram[0x7F6] = 0x00;
+    ctx.ram[0x7F7] = 0x0B;
+
+    subject.Interrupt(ctx, 3);
+    subject.Interrupt(ctx, 1);
+    subject.Execute(ctx, 1);
+
+    ASSERT_EQ(ctx.cpu.PC, 0x0A00u);
+    ASSERT_EQ(ctx.pendingInterrupts, 0x8u);
+}
+
+TEST_F(ExecutorTests, Interrupt_GivenEnteredBetweenCompareAndBranch_LeavesRegistersAndFlags)
+{
+    LoadProgramToAddress(
+        "\x21\x2d"          // mov  r18, r1
+        "\x20\x93\x00\x02"  // sts  0x0200, r18
+        "\xaf\xef"          // ldi  r26, 0xFF
+        "\xff\xef"          // ldi  r31, 0xFF
+        "\x08\xe0"          // ldi  r16, 0x08
+        "\x00\x0f"          // add  r16, r16
+        "\x08\x95"          // ret
+        ,
+        16,
+        0x0A00
+    );
+    LoadProgramToAddress(
+        "\x88\x17" // cp   r24, r24     1
+        "\x19\xf0" // breq .+6          1/2
+        "\x1f\xef" // ldi  r17, 0xFF    1
+        "\xfe\xcf" // rjmp .-2          2
+        "\x00\x00" // nop
+        "\x11\xe0" // ldi  r17, 0x01    1
+        "\xfe\xcf" // rjmp .-2          2
+        ,
+        14,
+        0x100);
+    ctx.ram[0x7F0] = 0x00;
+    ctx.ram[0x7F1] = 0x0A;
+    ctx.ram[0x200] = 0xFF;
+    ctx.cpu.PC = 0x100;
+    ctx.cpu.SREG.I = true;
+    ctx.cpu.R[0] = 0x5Au;
+    ctx.cpu.R[1] = 0x77u;
+    ctx.cpu.R[18] = 0x12u;
+    ctx.cpu.R[24] = 0x33u;
+    ctx.cpu.R[26] = 0x26u;
+    ctx.cpu.R[30] = 0x44u;
+    ctx.cpu.R[31] = 0x55u;
+    auto sp = ctx.cpu.SP;
+    ctx.scheduler.Schedule(1u, [] (ExecutionContext& context) {
+        context.RaiseInterrupt(0);
+    });
+
+    subject.Execute(ctx, 200);
+
+    // r1 was clear for the handler, as avr-gcc code expects
+    ASSERT_EQ(ctx.ram[0x200], 0x00u);
+    ASSERT_EQ(ctx.cpu.R[16], 16u);
+    ASSERT_EQ(ctx.cpu.R[17], 0x01u);
+    ASSERT_EQ(ctx.cpu.R[0], 0x5Au);
+    ASSERT_EQ(ctx.cpu.R[1], 0x77u);
+    ASSERT_EQ(ctx.cpu.R[18], 0x12u);
+    ASSERT_EQ(ctx.cpu.R[24], 0x33u);
+    ASSERT_EQ(ctx.cpu.R[26], 0x26u);
+    ASSERT_EQ(ctx.cpu.R[30], 0x44u);
+    ASSERT_EQ(ctx.cpu.R[31], 0x55u);
+    ASSERT_EQ(ctx.cpu.SP, sp);
+}
+
+TEST_F(ExecutorTests, Interrupt_GivenRaisedByEventWhileAsleep_WakesAtEvent)
+{
+    LoadProgramToAddress(
+        "\x08\xe0" // ldi     r16, 0x08       ; 8
+        "\x00\x0f" // add     r16, r16
+        "\x08\x95" // ret
+        ,
+        6,
+        0x0A00
+    );
+    ctx.ram[0x7F0] = 0x00;
+    ctx.ram[0x7F1] = 0x0A;
+    // Spin after the sleep once the handler returns to it
+    LoadProgramToAddress("\xfe\xcf", 2, 0x942);
+    ctx.cpu.SREG.I = true;
+    auto sp = ctx.cpu.SP;
+    ctx.scheduler.Schedule(500u, [] (ExecutionContext& context) {
+        context.RaiseInterrupt(0);
+    });
+
+    subject.Execute(ctx, 400);
+    auto sleptThrough = ctx.cpu.is_sleeping;
+    subject.Execute(ctx, 600);
+
+    ASSERT_TRUE(sleptThrough);
+    ASSERT_FALSE(ctx.cpu.is_sleeping);
+    ASSERT_EQ(ctx.cpu.R[16], 16u);
+    ASSERT_EQ(ctx.cpu.PC, 0x942u);
+    ASSERT_EQ(ctx.cpu.SP, sp);
 }
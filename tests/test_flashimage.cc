@@ -0,0 +1,147 @@
+#include "cdif/cdif.h"
+#include "core/coremodule.h"
+#include "core/executioncontext.h"
+#include "core/flashimage.h"
+#include "core/loader.h"
+#include "core/threadedexecutor.h"
+#include "instructions/instructionmodule.h"
+#include "instructions/opcodes.h"
+#include "instructions/spm.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+using namespace avr;
+
+namespace {
+    cdif::Container BuildImageContainer()
+    {
+        auto ctx = cdif::Container();
+        ctx.registerModule<InstructionModule>();
+        ctx.registerModule<CoreModule>();
+        return ctx;
+    }
+
+    const std::string COUNTER = std::string(
+        "\x03\x95"          // inc  r16
+        "\x00\x93\x00\x02"  // sts  0x0200, r16
+        "\xf8\xcf"          // rjmp .-8
+        , 8);
+}
+
+class FlashImageTests : public ::testing::Test
+{
+    protected:
+        cdif::Container container;
+        ThreadedExecutor executor;
+        Loader loader;
+
+    public:
+        FlashImageTests()
+            : container(BuildImageContainer()),
+              executor(container.resolve<ThreadedExecutor>()),
+              loader()
+        {}
+};
+
+TEST_F(FlashImageTests, Map_GivenMemory_ReadsSameContents)
+{
+    auto memory = Memory(0x800u);
+    for (auto i = 0u; i < memory.size(); i++)
+        memory[static_cast<uint16_t>(i)] = static_cast<uint8_t>(i * 7u);
+
+    auto subject = FlashImage(memory);
+    auto mapped = subject.Map();
+
+    ASSERT_EQ(mapped->size(), memory.size());
+    for (auto i = 0u; i < memory.size(); i++)
+        ASSERT_EQ(std::as_const(*mapped)[static_cast<uint16_t>(i)], static_cast<uint8_t>(i * 7u));
+}
+
+TEST_F(FlashImageTests, Map_GivenWriteToOneMapping_LeavesImageAndOtherMappingsUnchanged)
+{
+    auto memory = Memory(0x800u);
+    memory[0x123u] = 0x45u;
+    auto subject = FlashImage(memory);
+    auto first = subject.Map();
+    auto second = subject.Map();
+
+    (*first)[0x123u] = 0x99u;
+
+    ASSERT_EQ(std::as_const(*first)[0x123u], 0x99u);
+    ASSERT_EQ(std::as_const(*second)[0x123u], 0x45u);
+    ASSERT_EQ(std::as_const(*subject.Map())[0x123u], 0x45u);
+}
+
+TEST_F(FlashImageTests, Map_GivenImageDestroyed_KeepsMappingUsable)
+{
+    auto memory = Memory(0x800u);
+    memory[0x10u] = 0x5Au;
+    auto image = std::make_unique<FlashImage>(memory);
+    auto mapped = image->Map();
+
+    image.reset();
+
+    ASSERT_EQ(std::as_const(*mapped)[0x10u], 0x5Au);
+}
+
+TEST_F(FlashImageTests, TakeSnapshot_GivenFreshMapping_SharesImagePages)
+{
+    auto memory = Memory(0x800u);
+    auto pages = memory.TakeSnapshot();
+    auto subject = FlashImage(memory);
+    auto mapped = subject.Map();
+
+    auto snapshot = mapped->TakeSnapshot();
+
+    for (auto page = 0u; page < pages.size(); page++)
+        ASSERT_EQ(snapshot[page], pages[page]);
+}
+
+TEST_F(FlashImageTests, LoadImage_RunsLikeLoadProgram)
+{
+    auto image = loader.BuildImage(COUNTER);
+    auto expected = loader.LoadProgram(COUNTER);
+    auto subject = loader.LoadImage(*image);
+
+    executor.Execute(expected, 100u);
+    executor.Execute(subject, 100u);
+
+    ASSERT_EQ(subject.cpu.PC, expected.cpu.PC);
+    ASSERT_EQ(subject.cpu.SP, expected.cpu.SP);
+    ASSERT_EQ(subject.cpu.R[16], expected.cpu.R[16]);
+    ASSERT_EQ(std::as_const(subject.ram)[0x0200u], std::as_const(expected.ram)[0x0200u]);
+}
+
+TEST_F(FlashImageTests, LoadImage_GivenSPMInOneContext_LeavesOtherContextsFlashUnchanged)
+{
+    auto image = loader.BuildImage(COUNTER);
+    auto writer = loader.LoadImage(*image);
+    auto reader = loader.LoadImage(*image);
+
+    writer.cpu.Z = 0x940u;
+    writer.cpu.R[0] = 0x00u;
+    writer.cpu.R[1] = 0x00u;
+    SPMInstruction().Execute(static_cast<uint16_t>(OpCode::SPM), writer);
+
+    ASSERT_EQ(std::as_const(writer.progMem)[0x940u], 0x00u);
+    ASSERT_EQ(std::as_const(reader.progMem)[0x940u], 0x03u);
+    ASSERT_EQ(std::as_const(reader.progMem)[0x941u], 0x95u);
+}
+
+TEST_F(FlashImageTests, Reset_GivenContextFromImage_ReturnsToImage)
+{
+    auto image = loader.BuildImage(COUNTER);
+    auto subject = loader.LoadImage(*image);
+    executor.Execute(subject, 100u);
+
+    subject.Reset();
+
+    ASSERT_EQ(subject.cpu.PC, 0x940u);
+    ASSERT_EQ(subject.cpu.R[16], 0u);
+    ASSERT_EQ(std::as_const(subject.ram)[0x0200u], 0u);
+}
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/fmul.h"
 #include "instructions/opcodes.h"
 
@@ -14,7 +13,6 @@ using namespace avr;
 class FMULInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         FMULInstruction subject;
         ExecutionContext ctx;
 
@@ -43,7 +41,7 @@ class FMULInstructionTests : public ::testing::Test
 
     public:
         FMULInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
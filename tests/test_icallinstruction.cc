@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/icall.h"
 #include "instructions/opcodes.h"
 
@@ -13,7 +12,6 @@ using namespace avr;
 class ICALLInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         ICALLInstruction subject;
         ExecutionContext ctx;
 
@@ -38,7 +36,7 @@ class ICALLInstructionTests : public ::testing::Test
 
     public:
         ICALLInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -0,0 +1,295 @@
+#include "cdif/cdif.h"
+#include "core/coremodule.h"
+#include "core/dispatchtable.h"
+#include "core/eventqueue.h"
+#include "core/executioncontext.h"
+#include "core/executor.h"
+#include "core/iexecutor.h"
+#include "core/idleloop.h"
+#include "core/iobus.h"
+#include "core/loader.h"
+#include "core/threadedexecutor.h"
+#include "instructions/instructionmodule.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+
+using namespace avr;
+
+namespace {
+    cdif::Container BuildIdleLoopContainer()
+    {
+        auto ctx = cdif::Container();
+        ctx.registerModule<InstructionModule>();
+        ctx.registerModule<CoreModule>();
+        return ctx;
+    }
+
+    // Every program starts at the loop under test and ends up in a spin
+    const std::string COUNTDOWN =
+        "\x88\xec"  // ldi  r24, 0xC8
+        "\x8a\x95"  // dec  r24
+        "\xf1\xf7"  // brne .-4
+        "\x01\xe0"  // ldi  r16, 0x01
+        "\xfe\xcf"; // rjmp .-2
+
+    const std::string WIDE_COUNTDOWN =
+        "\x81\x50"  // subi r24, 0x01
+        "\x90\x40"  // sbci r25, 0x00
+        "\xe9\xf7"  // brne .-6
+        "\x01\xe0"  // ldi  r16, 0x01
+        "\xfe\xcf"; // rjmp .-2
+
+    const std::string WORD_COUNTDOWN =
+        "\x01\x97"  // sbiw r24, 0x01
+        "\xf1\xf7"  // brne .-4
+        "\x01\xe0"  // ldi  r16, 0x01
+        "\xfe\xcf"; // rjmp .-2
+
+    const std::string SKIP_POLL =
+        "\x80\x9b"  // sbis 0x10, 0
+        "\xfc\xcf"  // rjmp .-4
+        "\x01\xe0"  // ldi  r16, 0x01
+        "\xfe\xcf"; // rjmp .-2
+
+    const std::string LOAD_POLL =
+        "\x80\xb3"  // in   r24, 0x10
+        "\x80\xff"  // sbrs r24, 0
+        "\xfa\xcf"  // rjmp .-6
+        "\x01\xe0"  // ldi  r16, 0x01
+        "\xfe\xcf"; // rjmp .-2
+}
+
+class IdleLoopTests : public ::testing::Test
+{
+    protected:
+        cdif::Container container;
+        Executor reference;
+        ThreadedExecutor threaded;
+        Loader loader;
+
+        IdleLoop FindAt(const ExecutionContext& ctx, uint16_t address)
+        {
+            auto insn = reference.GetDispatchTable()->Decode(ctx.progMem, address);
+            return IdleLoop::Find(ctx.progMem, address, insn);
+        }
+
+        void SetBitAt(ExecutionContext& ctx, uint64_t due)
+        {
+            ctx.scheduler.Schedule(due, [] (ExecutionContext& context) { context.cpu.GPIO[0x10] |= 0x01u; });
+        }
+
+        // One instruction per call never leaves room to fast-forward
+        void Step(ExecutionContext& ctx, uint64_t cycles)
+        {
+            while (ctx.cycles < cycles)
+                reference.Execute(ctx, 1u);
+        }
+
+        void AssertMatchesStepping(const IExecutor& subject, const std::string& program, uint32_t cycles, uint64_t due)
+        {
+            auto expected = loader.LoadProgram(program);
+            auto actual = loader.LoadProgram(program);
+            expected.cpu.R[24] = 0x34u;
+            expected.cpu.R[25] = 0x02u;
+            actual.cpu.R[24] = 0x34u;
+            actual.cpu.R[25] = 0x02u;
+            SetBitAt(expected, due);
+            SetBitAt(actual, due);
+
+            Step(expected, cycles);
+            subject.Execute(actual, cycles);
+
+            for (auto i = 0u; i < 32u; i++)
+                ASSERT_EQ(actual.cpu.R[i], expected.cpu.R[i]) << "r" << i;
+            ASSERT_EQ(actual.cpu.PC, expected.cpu.PC);
+            ASSERT_EQ(actual.cycles, expected.cycles);
+            ASSERT_EQ(actual.cpu.SREG.Z, expected.cpu.SREG.Z);
+            ASSERT_EQ(actual.cpu.SREG.C, expected.cpu.SREG.C);
+        }
+
+    public:
+        IdleLoopTests()
+            : container(BuildIdleLoopContainer()),
+              reference(container.resolve<Executor>()),
+              threaded(container.resolve<IClock&>(), reference.GetDispatchTable()),
+              loader()
+        {}
+};
+
+TEST_F(IdleLoopTests, Find_GivenJumpToItself_ReturnsSpin)
+{
+    auto ctx = loader.LoadProgram(COUNTDOWN);
+
+    auto loop = FindAt(ctx, 0x948u);
+
+    ASSERT_EQ(loop.kind, IdleLoop::Kind::Spin);
+    ASSERT_EQ(loop.head, 0x948u);
+    ASSERT_EQ(loop.period, 2u);
+}
+
+TEST_F(IdleLoopTests, Find_GivenDecrementLoop_ReturnsCountdown)
+{
+    auto ctx = loader.LoadProgram(COUNTDOWN);
+
+    auto loop = FindAt(ctx, 0x944u);
+
+    ASSERT_EQ(loop.kind, IdleLoop::Kind::Countdown);
+    ASSERT_EQ(loop.head, 0x942u);
+    ASSERT_EQ(loop.rd, 24u);
+    ASSERT_FALSE(loop.wide);
+    ASSERT_EQ(loop.period, 3u);
+}
+
+TEST_F(IdleLoopTests, Find_GivenSubtractWithCarryLoop_ReturnsWideCountdown)
+{
+    auto ctx = loader.LoadProgram(WIDE_COUNTDOWN);
+
+    auto loop = FindAt(ctx, 0x944u);
+
+    ASSERT_EQ(loop.kind, IdleLoop::Kind::Countdown);
+    ASSERT_TRUE(loop.wide);
+    ASSERT_EQ(loop.rd, 24u);
+    ASSERT_EQ(loop.rdHigh, 25u);
+    ASSERT_EQ(loop.period, 4u);
+}
+
+TEST_F(IdleLoopTests, Find_GivenSkipPoll_ReturnsPoll)
+{
+    auto ctx = loader.LoadProgram(SKIP_POLL);
+
+    auto loop = FindAt(ctx, 0x942u);
+
+    ASSERT_EQ(loop.kind, IdleLoop::Kind::Poll);
+    ASSERT_EQ(loop.io, 0x10u);
+    ASSERT_EQ(loop.bit, 0u);
+    ASSERT_TRUE(loop.exitWhenSet);
+    ASSERT_FALSE(loop.loads);
+    ASSERT_EQ(loop.period, 3u);
+}
+
+TEST_F(IdleLoopTests, Find_GivenLoopDoingOtherWork_ReturnsNone)
+{
+    auto ctx = loader.LoadProgram(
+        "\x01\x0f"  // add  r16, r17
+        "\x8a\x95"  // dec  r24
+        "\xe9\xf7"  // brne .-6
+    );
+
+    auto loop = FindAt(ctx, 0x944u);
+
+    ASSERT_EQ(loop.kind, IdleLoop::Kind::None);
+}
+
+TEST_F(IdleLoopTests, Find_GivenWordCountdownByTwo_ReturnsNone)
+{
+    auto ctx = loader.LoadProgram(
+        "\x02\x97"  // sbiw r24, 0x02
+        "\xf1\xf7"  // brne .-4
+    );
+
+    auto loop = FindAt(ctx, 0x942u);
+
+    ASSERT_EQ(loop.kind, IdleLoop::Kind::None);
+}
+
+TEST_F(IdleLoopTests, FastForward_GivenSpin_RunsToBudget)
+{
+    auto ctx = loader.LoadProgram(COUNTDOWN);
+    auto branch = reference.GetDispatchTable()->Decode(ctx.progMem, 0x948u);
+    ctx.cpu.PC = 0x948u;
+
+    auto cycles = FastForward(ctx, 0x948u, branch, 1001u);
+
+    ASSERT_EQ(cycles, 1000u);
+}
+
+TEST_F(IdleLoopTests, FastForward_GivenScheduledEvent_StopsAtEvent)
+{
+    auto ctx = loader.LoadProgram(SKIP_POLL);
+    auto branch = reference.GetDispatchTable()->Decode(ctx.progMem, 0x942u);
+    ctx.cpu.PC = 0x940u;
+    SetBitAt(ctx, 301u);
+
+    auto cycles = FastForward(ctx, 0x942u, branch, 1000u);
+
+    ASSERT_EQ(cycles, 300u);
+}
+
+TEST_F(IdleLoopTests, FastForward_GivenEventQueue_StopsWhenItIsDueADrain)
+{
+    auto ctx = loader.LoadProgram(COUNTDOWN);
+    auto branch = reference.GetDispatchTable()->Decode(ctx.progMem, 0x948u);
+    ctx.cpu.PC = 0x948u;
+    ctx.Events();
+
+    auto cycles = FastForward(ctx, 0x948u, branch, 4000000000u);
+
+    ASSERT_EQ(cycles, EventQueue::DRAIN_CYCLES);
+}
+
+TEST_F(IdleLoopTests, FastForward_GivenCountdown_LeavesLastIterationToInterpreter)
+{
+    auto ctx = loader.LoadProgram(COUNTDOWN);
+    auto branch = reference.GetDispatchTable()->Decode(ctx.progMem, 0x944u);
+    ctx.cpu.PC = 0x942u;
+    ctx.cpu.R[24] = 10u;
+
+    auto cycles = FastForward(ctx, 0x944u, branch, 1000u);
+
+    ASSERT_EQ(cycles, 27u);
+    ASSERT_EQ(ctx.cpu.R[24], 1u);
+}
+
+TEST_F(IdleLoopTests, FastForward_GivenPollAlreadySatisfied_DoesNothing)
+{
+    auto ctx = loader.LoadProgram(SKIP_POLL);
+    auto branch = reference.GetDispatchTable()->Decode(ctx.progMem, 0x942u);
+    ctx.cpu.GPIO[0x10] = 0x01u;
+
+    auto cycles = FastForward(ctx, 0x942u, branch, 1000u);
+
+    ASSERT_EQ(cycles, 0u);
+}
+
+TEST_F(IdleLoopTests, Execute_GivenPollOnMappedRegister_ReadsEveryIteration)
+{
+    auto ctx = loader.LoadProgram(SKIP_POLL);
+    auto reads = 0u;
+    ctx.io.Map(static_cast<uint16_t>(IOBus::BEGIN + 0x10u), [&reads] (ExecutionContext&, uint16_t) {
+        return static_cast<uint8_t>(++reads == 5u ? 0x01u : 0x00u);
+    }, nullptr);
+
+    reference.Execute(ctx, 1000u);
+
+    ASSERT_EQ(reads, 5u);
+    ASSERT_EQ(ctx.cpu.R[16], 0x01u);
+}
+
+TEST_F(IdleLoopTests, Execute_GivenIdleLoops_MatchesSteppedExecution)
+{
+    for (const auto& program : {COUNTDOWN, WIDE_COUNTDOWN, WORD_COUNTDOWN, SKIP_POLL, LOAD_POLL})
+    {
+        for (auto cycles : {5u, 600u, 2500u, 10000u})
+        {
+            for (auto due : {7u, 1000u, 4000u})
+            {
+                AssertMatchesStepping(reference, program, cycles, due);
+                AssertMatchesStepping(threaded, program, cycles, due);
+            }
+        }
+    }
+}
+
+TEST_F(IdleLoopTests, Execute_GivenSpinWithoutEvents_ReturnsWithoutInterpretingEachIteration)
+{
+    auto ctx = loader.LoadProgram(COUNTDOWN);
+    ctx.cpu.PC = 0x948u;
+
+    reference.Execute(ctx, 4000000000u);
+
+    ASSERT_EQ(ctx.cpu.PC, 0x948u);
+    ASSERT_EQ(ctx.cycles, 4000000000u);
+}
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/ijmp.h"
 #include "instructions/opcodes.h"
 
@@ -13,7 +12,6 @@ using namespace avr;
 class IJMPInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         IJMPInstruction subject;
         ExecutionContext ctx;
 
@@ -29,7 +27,7 @@ class IJMPInstructionTests : public ::testing::Test
 
     public:
         IJMPInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/inc.h"
 #include "instructions/opcodes.h"
 
@@ -14,7 +13,6 @@ using namespace avr;
 class INCInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         INCInstruction subject;
         ExecutionContext ctx;
 
@@ -33,7 +31,7 @@ class INCInstructionTests : public ::testing::Test
 
     public:
         INCInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/in.h"
 #include "instructions/opcodes.h"
 
@@ -15,7 +14,6 @@ class INInstructionTests : public ::testing::Test
 {
 
     protected:
-        NoopClock clock;
         INInstruction subject;
         ExecutionContext ctx;
 
@@ -28,7 +26,7 @@ class INInstructionTests : public ::testing::Test
 
         std::tuple<uint16_t, uint8_t, uint8_t> GetRegisters()
         {
-            auto src = static_cast<uint8_t>(rand() % 64);
+            auto src = static_cast<uint8_t>(rand() % 63);  // 0x3F is SREG
             auto dst = static_cast<uint8_t>(rand() % 32);
             auto compiledOpcode = GetOpCode(src, dst);
             return std::make_tuple(std::move(compiledOpcode), src, dst);
@@ -36,7 +34,7 @@ class INInstructionTests : public ::testing::Test
 
     public:
         INInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -64,3 +62,16 @@ TEST_F(INInstructionTests, Execute_CopiesIOValueToRegister)
 
     ASSERT_EQ(ctx.cpu.R[dst], ctx.cpu.GPIO[src]);
 }
+
+TEST_F(INInstructionTests, Execute_GivenMappedIORegister_ReadsThroughBus)
+{
+    auto [opcode, src, dst] = GetRegisters();
+    ctx.io.Map(static_cast<uint16_t>(IOBus::BEGIN + src),
+        [] (ExecutionContext&, uint16_t) { return uint8_t(0xA5u); }, nullptr);
+    ctx.cpu.GPIO[src] = 0x0u;
+    ctx.cpu.R[dst] = 0x0u;
+
+    subject.Execute(opcode, ctx);
+
+    ASSERT_EQ(ctx.cpu.R[dst], 0xA5u);
+}
@@ -0,0 +1,157 @@
+#include "core/executioncontext.h"
+#include "core/iobus.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace avr;
+
+class IOBusTests : public ::testing::Test
+{
+    protected:
+        ExecutionContext ctx;
+
+    public:
+        IOBusTests()
+            : ctx()
+        {}
+};
+
+TEST_F(IOBusTests, IsMapped_GivenNothingMapped_ReturnsFalse)
+{
+    ASSERT_FALSE(ctx.io.IsMapped(0x25u));
+    ASSERT_FALSE(ctx.io.IsMapped(0x800u));
+}
+
+TEST_F(IOBusTests, Map_GivenAddressOutsideIORange_Throws)
+{
+    ASSERT_THROW(ctx.io.Map(0x1Fu, nullptr, nullptr), std::string);
+    ASSERT_THROW(ctx.io.Map(0x100u, nullptr, nullptr), std::string);
+}
+
+TEST_F(IOBusTests, Load_GivenMappedAddress_CallsReadHandler)
+{
+    auto seen = uint16_t(0u);
+    ctx.io.Map(0xC6u, [&seen] (ExecutionContext&, uint16_t address) {
+        seen = address;
+        return uint8_t(0x5Au);
+    }, nullptr);
+
+    auto value = ctx.Load(0xC6u);
+
+    ASSERT_EQ(value, 0x5Au);
+    ASSERT_EQ(seen, 0xC6u);
+}
+
+TEST_F(IOBusTests, Store_GivenMappedAddress_CallsWriteHandlerInsteadOfRam)
+{
+    auto writes = std::vector<uint8_t>();
+    ctx.io.Map(0x25u, nullptr, [&writes] (ExecutionContext&, uint16_t, uint8_t value) {
+        writes.push_back(value);
+    });
+
+    ctx.Store(0x25u, 0x12u);
+    ctx.Store(0x25u, 0x34u);
+
+    ASSERT_EQ(writes, std::vector<uint8_t>({ 0x12u, 0x34u }));
+    ASSERT_EQ(ctx.ram[0x25u], 0x00u);
+}
+
+TEST_F(IOBusTests, Load_GivenMappedAddressWithoutReadHandler_ReadsRam)
+{
+    ctx.io.Map(0x25u, nullptr, [] (ExecutionContext&, uint16_t, uint8_t) {});
+    ctx.ram[0x25u] = 0x77u;
+
+    ASSERT_EQ(ctx.Load(0x25u), 0x77u);
+}
+
+TEST_F(IOBusTests, Map_GivenAddressAlreadyMapped_ReplacesHandlers)
+{
+    ctx.io.Map(0x30u, [] (ExecutionContext&, uint16_t) { return uint8_t(1u); }, nullptr);
+    ctx.io.Map(0x30u, [] (ExecutionContext&, uint16_t) { return uint8_t(2u); }, nullptr);
+
+    ASSERT_EQ(ctx.Load(0x30u), 2u);
+}
+
+TEST_F(IOBusTests, Unmap_GivenMappedAddress_ReturnsAddressToRam)
+{
+    ctx.io.Map(0x30u, [] (ExecutionContext&, uint16_t) { return uint8_t(1u); }, nullptr);
+    ctx.ram[0x30u] = 0x99u;
+
+    ctx.io.Unmap(0x30u);
+
+    ASSERT_FALSE(ctx.io.IsMapped(0x30u));
+    ASSERT_EQ(ctx.Load(0x30u), 0x99u);
+}
+
+TEST_F(IOBusTests, Map_GivenManyMapUnmapCycles_KeepsRoutingToTheLatestHandlers)
+{
+    ctx.io.Map(0x31u, [] (ExecutionContext&, uint16_t) { return uint8_t(7u); }, nullptr);
+    for (auto i = 0u; i < 1000u; i++)
+    {
+        ctx.io.Map(0x30u, [i] (ExecutionContext&, uint16_t) { return static_cast<uint8_t>(i); }, nullptr);
+        ctx.io.Unmap(0x30u);
+    }
+
+    ctx.io.Map(0x30u, [] (ExecutionContext&, uint16_t) { return uint8_t(0x42u); }, nullptr);
+
+    ASSERT_EQ(ctx.Load(0x30u), 0x42u);
+    ASSERT_EQ(ctx.Load(0x31u), 7u);
+}
+
+TEST_F(IOBusTests, Store_GivenMappedAddress_RequestsClockSync)
+{
+    ctx.io.Map(0x25u, nullptr, [] (ExecutionContext&, uint16_t, uint8_t) {});
+    ctx.cycles = 40u;
+    ctx.syncAt = 1000u;
+
+    ctx.Store(0x25u, 0x01u);
+
+    ASSERT_EQ(ctx.syncAt, 40u);
+}
+
+TEST_F(IOBusTests, Load_GivenSREGAddress_ReadsStatusRegister)
+{
+    ctx.cpu.SREG.C = true;
+    ctx.cpu.SREG.I = true;
+
+    ASSERT_EQ(ctx.Load(IOBus::SREG), 0x81u);
+}
+
+TEST_F(IOBusTests, Store_GivenSREGAddress_SetsStatusRegister)
+{
+    ctx.Store(IOBus::SREG, 0x42u);
+
+    ASSERT_TRUE(ctx.cpu.SREG.Z);
+    ASSERT_TRUE(ctx.cpu.SREG.T);
+    ASSERT_FALSE(ctx.cpu.SREG.C);
+    ASSERT_FALSE(ctx.cpu.SREG.I);
+}
+
+TEST_F(IOBusTests, Store_GivenSREGAddress_LeavesClockAlone)
+{
+    ctx.cycles = 40u;
+    ctx.syncAt = 1000u;
+    ctx.clockAt = 1000u;
+
+    ctx.Store(IOBus::SREG, ctx.Load(IOBus::SREG));
+
+    ASSERT_EQ(ctx.syncAt, 1000u);
+    ASSERT_EQ(ctx.clockAt, 1000u);
+}
+
+TEST_F(IOBusTests, Store_GivenSREGEnablingPendingInterrupt_LeavesFastPathOnly)
+{
+    ctx.cycles = 40u;
+    ctx.syncAt = 1000u;
+    ctx.clockAt = 1000u;
+    ctx.pendingInterrupts = 0x1u;
+
+    ctx.Store(IOBus::SREG, 0x80u);
+
+    ASSERT_EQ(ctx.syncAt, 40u);
+    ASSERT_EQ(ctx.clockAt, 1000u);
+}
@@ -0,0 +1,60 @@
+#include "core/jitarena.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+using namespace avr;
+
+class JitArenaTests : public ::testing::Test
+{
+    protected:
+        JitArena subject;
+
+    public:
+        JitArenaTests()
+            : subject(0x1000u)
+        {}
+};
+
+TEST_F(JitArenaTests, Commit_GivenCode_ReturnsAlignedEntryPoints)
+{
+    auto code = std::vector<uint8_t>(3u, 0xC3u);
+
+    auto first = subject.Commit(code);
+    auto second = subject.Commit(code);
+
+    ASSERT_NE(first, nullptr);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(second) - reinterpret_cast<uintptr_t>(first), 0x10u);
+    ASSERT_EQ(subject.Used(), 0x20u);
+}
+
+TEST_F(JitArenaTests, Commit_GivenCodeLargerThanRemainingSpace_ReturnsNull)
+{
+    auto code = std::vector<uint8_t>(0x1001u, 0xC3u);
+
+    ASSERT_EQ(subject.Commit(code), nullptr);
+    ASSERT_EQ(subject.Used(), 0u);
+}
+
+TEST_F(JitArenaTests, Id_GivenSeparateArenas_Differs)
+{
+    auto other = JitArena(0x1000u);
+
+    ASSERT_NE(subject.Id(), other.Id());
+}
+
+#if defined(__x86_64__)
+TEST_F(JitArenaTests, Commit_GivenFunction_CanBeCalled)
+{
+    auto code = std::vector<uint8_t>({
+        0xB8, 0x2A, 0x00, 0x00, 0x00, // mov eax, 42
+        0xC3                          // ret
+    });
+
+    auto function = reinterpret_cast<uint32_t (*)()>(const_cast<void*>(subject.Commit(code)));
+
+    ASSERT_EQ(function(), 42u);
+}
+#endif
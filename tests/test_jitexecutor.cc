@@ -0,0 +1,205 @@
+#include "cdif/cdif.h"
+#include "core/coremodule.h"
+#include "core/executioncontext.h"
+#include "core/executor.h"
+#include "core/jitexecutor.h"
+#include "core/loader.h"
+#include "instructions/instructionmodule.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace avr;
+
+namespace {
+    cdif::Container BuildJitContainer()
+    {
+        auto ctx = cdif::Container();
+        ctx.registerModule<InstructionModule>();
+        ctx.registerModule<CoreModule>();
+        return ctx;
+    }
+}
+
+class JitExecutorTests : public ::testing::Test
+{
+    protected:
+        cdif::Container container;
+        JitExecutor subject;
+        Executor reference;
+        Loader loader;
+        ExecutionContext ctx;
+
+        void LoadProgramToAddress(const char* program, std::size_t size, uint16_t address)
+        {
+            for (auto i = 0u; i < size; i++)
+                ctx.progMem[address + i] = program[i];
+        }
+
+        // Only the compiled subset plus short backward branches, so loops
+        // turn hot and get compiled
+        uint16_t RandomOpCode() const
+        {
+            static const std::vector<std::tuple<uint16_t, uint16_t>> templates = {
+                { 0x0C00u, 0x03FFu }, // add
+                { 0x1C00u, 0x03FFu }, // adc
+                { 0x1800u, 0x03FFu }, // sub
+                { 0x2000u, 0x03FFu }, // and
+                { 0x2800u, 0x03FFu }, // or
+                { 0x2400u, 0x03FFu }, // eor
+                { 0x2C00u, 0x03FFu }, // mov
+                { 0x1400u, 0x03FFu }, // cp
+                { 0x0400u, 0x03FFu }, // cpc
+                { 0x3000u, 0x0FFFu }, // cpi
+                { 0xE000u, 0x0FFFu }, // ldi
+                { 0x5000u, 0x0FFFu }, // subi
+                { 0x7000u, 0x0FFFu }, // andi
+                { 0x6000u, 0x0FFFu }, // ori
+                { 0x9403u, 0x01F0u }, // inc
+                { 0x940Au, 0x01F0u }, // dec
+                { 0xF3C0u, 0x0407u }, // brbs/brbc .-16
+                { 0xCFF8u, 0x0000u }, // rjmp .-8
+            };
+
+            auto& [op, mask] = templates[static_cast<std::size_t>(rand()) % templates.size()];
+            return static_cast<uint16_t>(op | (static_cast<uint16_t>(rand()) & mask));
+        }
+
+        void RunRandomPrograms(const JitExecutor& executor)
+        {
+            for (auto iteration = 0u; iteration < 64u; iteration++)
+            {
+                auto program = std::string(16u, '\0');
+                for (auto i = 0u; i < 32u; i++)
+                {
+                    auto opcode = RandomOpCode();
+                    program.push_back(static_cast<char>(opcode & 0xFFu));
+                    program.push_back(static_cast<char>(opcode >> 8u));
+                }
+
+                auto expected = loader.LoadProgram(program);
+                auto actual = loader.LoadProgram(program);
+                for (auto i = 0u; i < 32u; i++)
+                {
+                    auto value = static_cast<uint8_t>(rand());
+                    expected.cpu.R[i] = value;
+                    actual.cpu.R[i] = value;
+                }
+
+                for (auto slice = 0u; slice < 16u; slice++)
+                {
+                    auto cycles = static_cast<uint32_t>(rand()) % 128u;
+                    reference.Execute(expected, cycles);
+                    executor.Execute(actual, cycles);
+                }
+
+                for (auto i = 0u; i < 32u; i++)
+                    ASSERT_EQ(actual.cpu.R[i], expected.cpu.R[i]) << "r" << i;
+                ASSERT_EQ(actual.cpu.PC, expected.cpu.PC);
+                ASSERT_EQ(actual.cycles, expected.cycles);
+                ASSERT_EQ(actual.cpu.SREG.C, expected.cpu.SREG.C);
+                ASSERT_EQ(actual.cpu.SREG.Z, expected.cpu.SREG.Z);
+                ASSERT_EQ(actual.cpu.SREG.N, expected.cpu.SREG.N);
+                ASSERT_EQ(actual.cpu.SREG.V, expected.cpu.SREG.V);
+                ASSERT_EQ(actual.cpu.SREG.S, expected.cpu.SREG.S);
+                ASSERT_EQ(actual.cpu.SREG.H, expected.cpu.SREG.H);
+            }
+        }
+
+    public:
+        JitExecutorTests()
+            : container(BuildJitContainer()),
+            subject(container.resolve<JitExecutor>()),
+            reference(container.resolve<IClock&>(), subject.GetDispatchTable()),
+            loader(),
+            ctx(loader.LoadProgram("\x88\x95"))
+        {
+            srand(static_cast<unsigned int>(time(NULL)));
+        }
+};
+
+TEST_F(JitExecutorTests, Execute_GivenHotLoop_CompilesLoopBody)
+{
+    if (!subject.GetCompiler()->IsSupported())
+        GTEST_SKIP() << "No code generator for this host";
+
+    LoadProgramToAddress(
+        "\x08\xec" // ldi  r16, 0xC8    1
+        "\x10\xe0" // ldi  r17, 0x00    1
+        "\x13\x95" // inc  r17          1
+        "\x0a\x95" // dec  r16          1
+        "\xe9\xf7" // brne .-6          2/1
+        ,
+        10,
+        0x100);
+    ctx.cpu.PC = 0x100;
+
+    subject.Execute(ctx, 2u + 199u * 4u + 3u);
+
+    ASSERT_EQ(ctx.cpu.PC, 0x10au);
+    ASSERT_EQ(ctx.cpu.R[16], 0u);
+    ASSERT_EQ(ctx.cpu.R[17], 0xC8u);
+    ASSERT_TRUE(ctx.cpu.SREG.Z);
+    auto loop = ctx.blockCache.Find(0x104u);
+    ASSERT_NE(loop, nullptr);
+    ASSERT_NE(loop->native.function, nullptr);
+}
+
+TEST_F(JitExecutorTests, Execute_GivenUnsupportedInstruction_KeepsBlockInterpreted)
+{
+    LoadProgramToAddress(
+        "\x08\xec" // ldi  r16, 0xC8    1
+        "\x12\x95" // swap r17          1
+        "\x0a\x95" // dec  r16          1
+        "\xe9\xf7" // brne .-6          2/1
+        ,
+        8,
+        0x100);
+    ctx.cpu.PC = 0x100;
+
+    subject.Execute(ctx, 1u + 199u * 4u + 3u);
+
+    ASSERT_EQ(ctx.cpu.PC, 0x108u);
+    ASSERT_EQ(ctx.cpu.R[16], 0u);
+    auto loop = ctx.blockCache.Find(0x102u);
+    ASSERT_NE(loop, nullptr);
+    ASSERT_EQ(loop->native.function, nullptr);
+}
+
+TEST_F(JitExecutorTests, Execute_GivenCompiledBlockRewritten_RunsNewCode)
+{
+    LoadProgramToAddress(
+        "\x01\xe0" // ldi  r16, 0x01    1
+        "\x01\x0f" // add  r16, r17     1
+        "\xfa\xcf" // rjmp .-6          2
+        ,
+        6,
+        0x100);
+    ctx.cpu.PC = 0x100;
+    ctx.cpu.R[17] = 0x01;
+
+    subject.Execute(ctx, 4u * 32u);
+    LoadProgramToAddress("\x05\xe0", 2, 0x100); // ldi r16, 0x05
+    ctx.blockCache.Invalidate(0x100u);
+    subject.Execute(ctx, 4u);
+
+    ASSERT_EQ(ctx.cpu.PC, 0x100u);
+    ASSERT_EQ(ctx.cpu.R[16], 0x06u);
+}
+
+TEST_F(JitExecutorTests, Execute_GivenRandomProgram_MatchesExecutor)
+{
+    RunRandomPrograms(subject);
+}
+
+TEST_F(JitExecutorTests, Execute_GivenDifferentialMode_AgreesWithInterpreter)
+{
+    auto differential = JitExecutor(container.resolve<IClock&>(), subject.GetDispatchTable(), JitMode::Differential);
+
+    RunRandomPrograms(differential);
+}
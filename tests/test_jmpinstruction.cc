@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/jmp.h"
 #include "instructions/opcodes.h"
 
@@ -13,7 +12,6 @@ using namespace avr;
 class JMPInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         JMPInstruction subject;
         ExecutionContext ctx;
 
@@ -37,7 +35,7 @@ class JMPInstructionTests : public ::testing::Test
 
     public:
         JMPInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/ldd.h"
 #include "instructions/opcodes.h"
 
@@ -14,7 +13,6 @@ using namespace avr;
 class LDDInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         LDDInstruction subject;
         ExecutionContext ctx;
 
@@ -58,7 +56,7 @@ class LDDInstructionTests : public ::testing::Test
 
     public:
         LDDInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
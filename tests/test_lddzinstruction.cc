@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/lddz.h"
 #include "instructions/opcodes.h"
 
@@ -14,7 +13,6 @@ using namespace avr;
 class LDDZInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         LDDZInstruction subject;
         ExecutionContext ctx;
 
@@ -58,7 +56,7 @@ class LDDZInstructionTests : public ::testing::Test
 
     public:
         LDDZInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/ld.h"
 #include "instructions/opcodes.h"
 
@@ -14,7 +13,6 @@ using namespace avr;
 class LDInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         LDInstruction subject;
         ExecutionContext ctx;
 
@@ -40,7 +38,7 @@ class LDInstructionTests : public ::testing::Test
 
     public:
         LDInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
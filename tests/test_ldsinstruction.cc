@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/lds.h"
 #include "instructions/opcodes.h"
 
@@ -14,7 +13,6 @@ using namespace avr;
 class LDSInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         LDSInstruction subject;
         ExecutionContext ctx;
 
@@ -47,7 +45,7 @@ class LDSInstructionTests : public ::testing::Test
 
     public:
         LDSInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
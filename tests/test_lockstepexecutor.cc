@@ -0,0 +1,226 @@
+#include "cdif/cdif.h"
+#include "core/contextarena.h"
+#include "core/coremodule.h"
+#include "core/executioncontext.h"
+#include "core/executor.h"
+#include "core/loader.h"
+#include "core/lockstepexecutor.h"
+#include "instructions/instructionmodule.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace avr;
+
+namespace {
+    cdif::Container BuildLockstepContainer()
+    {
+        auto ctx = cdif::Container();
+        ctx.registerModule<InstructionModule>();
+        ctx.registerModule<CoreModule>();
+        return ctx;
+    }
+}
+
+class LockstepExecutorTests : public ::testing::Test
+{
+    protected:
+        cdif::Container container;
+        LockstepExecutor subject;
+        Executor reference;
+        Loader loader;
+
+        // Straight line ALU instructions with randomised operands, plus
+        // forward branches to split lanes up. Skips and branches only move
+        // forward so every program terminates.
+        uint16_t RandomOpCode() const
+        {
+            static const std::vector<std::tuple<uint16_t, uint16_t>> templates = {
+                { 0x0C00u, 0x03FFu }, // add
+                { 0x1C00u, 0x03FFu }, // adc
+                { 0x1800u, 0x03FFu }, // sub
+                { 0x2000u, 0x03FFu }, // and
+                { 0x2800u, 0x03FFu }, // or
+                { 0x2400u, 0x03FFu }, // eor
+                { 0x2C00u, 0x03FFu }, // mov
+                { 0x1400u, 0x03FFu }, // cp
+                { 0x0400u, 0x03FFu }, // cpc
+                { 0x1000u, 0x03FFu }, // cpse
+                { 0x3000u, 0x0FFFu }, // cpi
+                { 0xE000u, 0x0FFFu }, // ldi
+                { 0x5000u, 0x0FFFu }, // subi
+                { 0x7000u, 0x0FFFu }, // andi
+                { 0x6000u, 0x0FFFu }, // ori
+                { 0x9403u, 0x01F0u }, // inc
+                { 0x940Au, 0x01F0u }, // dec
+                { 0x9402u, 0x01F0u }, // swap
+                { 0xF000u, 0x0417u }, // brbs/brbc .+0 or .+4
+            };
+
+            auto& [op, mask] = templates[static_cast<std::size_t>(rand()) % templates.size()];
+            return static_cast<uint16_t>(op | (static_cast<uint16_t>(rand()) & mask));
+        }
+
+        void AssertContextsMatch(const ExecutionContext& actual, const ExecutionContext& expected)
+        {
+            for (auto i = 0u; i < 32u; i++)
+                ASSERT_EQ(actual.cpu.R[i], expected.cpu.R[i]) << "r" << i;
+
+            ASSERT_EQ(actual.cpu.PC, expected.cpu.PC);
+            ASSERT_EQ(actual.cycles, expected.cycles);
+            ASSERT_EQ(actual.cpu.SREG.C, expected.cpu.SREG.C);
+            ASSERT_EQ(actual.cpu.SREG.Z, expected.cpu.SREG.Z);
+            ASSERT_EQ(actual.cpu.SREG.N, expected.cpu.SREG.N);
+            ASSERT_EQ(actual.cpu.SREG.V, expected.cpu.SREG.V);
+            ASSERT_EQ(actual.cpu.SREG.S, expected.cpu.SREG.S);
+            ASSERT_EQ(actual.cpu.SREG.H, expected.cpu.SREG.H);
+            ASSERT_EQ(actual.cpu.SREG.T, expected.cpu.SREG.T);
+            ASSERT_EQ(actual.cpu.SREG.I, expected.cpu.SREG.I);
+        }
+
+    public:
+        LockstepExecutorTests()
+            : container(BuildLockstepContainer()),
+              subject(container.resolve<LockstepExecutor>()),
+              reference(container.resolve<IClock&>(), subject.GetDispatchTable()),
+              loader()
+        {
+            srand(static_cast<unsigned int>(time(NULL)));
+        }
+};
+
+TEST_F(LockstepExecutorTests, Execute_GivenLanesWithDifferentInputs_MatchesExecutorOnEachLane)
+{
+    for (auto iteration = 0u; iteration < 16u; iteration++)
+    {
+        auto program = std::string();
+        for (auto i = 0u; i < 64u; i++)
+        {
+            auto opcode = RandomOpCode();
+            program.push_back(static_cast<char>(opcode & 0xFFu));
+            program.push_back(static_cast<char>(opcode >> 8u));
+        }
+
+        auto lanes = std::vector<ExecutionContext>();
+        auto expected = std::vector<ExecutionContext>();
+        for (auto lane = 0u; lane < 37u; lane++)
+        {
+            lanes.push_back(loader.LoadProgram(program));
+            expected.push_back(loader.LoadProgram(program));
+            for (auto i = 0u; i < 32u; i++)
+            {
+                auto value = static_cast<uint8_t>(rand());
+                lanes.back().cpu.R[i] = value;
+                expected.back().cpu.R[i] = value;
+            }
+            auto carry = (rand() & 1) != 0;
+            lanes.back().cpu.SREG.C = carry;
+            expected.back().cpu.SREG.C = carry;
+        }
+
+        auto cycles = static_cast<uint32_t>(rand()) % 64u;
+        auto pointers = std::vector<ExecutionContext*>();
+        for (auto& ctx : lanes)
+            pointers.push_back(&ctx);
+        subject.Execute(pointers, cycles);
+
+        for (auto lane = 0u; lane < lanes.size(); lane++)
+        {
+            reference.Execute(expected[lane], cycles);
+            AssertContextsMatch(lanes[lane], expected[lane]);
+        }
+    }
+}
+
+TEST_F(LockstepExecutorTests, Execute_GivenLoopCountsDifferingPerLane_RunsEachLaneToItsOwnEnd)
+{
+    auto program = std::string(
+        "\x00\xe0"  // ldi  r16, 0x00
+        "\x03\x95"  // inc  r16
+        "\x8a\x95"  // dec  r24
+        "\xe9\xf7"  // brne .-6
+        "\x10\x2f"  // mov  r17, r16
+        "\xfe\xcf"  // rjmp .-2
+        , 12);
+    auto arena = ContextArena(8u);
+    auto& first = arena.Allocate();
+    loader.LoadProgram(first, program);
+    auto image = first.Snapshot();
+    for (auto i = 1u; i < arena.capacity(); i++)
+        arena.Allocate(image);
+    for (auto i = 0u; i < arena.size(); i++)
+        arena[i].cpu.R[24] = static_cast<uint8_t>(3u * i + 1u);
+
+    subject.Execute(arena, 500u);
+
+    for (auto i = 0u; i < arena.size(); i++)
+    {
+        ASSERT_EQ(arena[i].cpu.R[17], 3u * i + 1u);
+        ASSERT_EQ(arena[i].cpu.PC, 0x94Au);
+        ASSERT_GE(arena[i].cycles, 500u);
+    }
+}
+
+TEST_F(LockstepExecutorTests, Execute_GivenSleepingLane_WakesItOnItsOwnEvent)
+{
+    auto program = std::string(
+        "\x88\x95"  // sleep
+        "\x05\xe0"  // ldi  r16, 0x05
+        "\xfe\xcf"  // rjmp .-2
+    );
+    auto sleeper = loader.LoadProgram(program);
+    auto other = loader.LoadProgram(program);
+    sleeper.scheduler.Schedule(300u, [] (ExecutionContext& ctx) { ctx.cpu.is_sleeping = false; });
+
+    subject.Execute(std::vector<ExecutionContext*>{ &sleeper, &other }, 1000u);
+
+    ASSERT_EQ(sleeper.cpu.R[16], 0x05u);
+    ASSERT_TRUE(other.cpu.is_sleeping);
+    ASSERT_EQ(other.cpu.R[16], 0x00u);
+    ASSERT_EQ(other.cycles, 1000u);
+}
+
+TEST_F(LockstepExecutorTests, Execute_GivenEventsDuringALURun_SeeAndChangeEachLanesRegisters)
+{
+    auto program = std::string(
+        "\x03\x95"  // inc  r16
+        "\x10\x0f"  // add  r17, r16
+        "\xfa\xcf"  // rjmp .-6
+        , 6);
+    auto lanes = std::vector<ExecutionContext>();
+    auto expected = std::vector<ExecutionContext>();
+    auto seen = std::vector<uint8_t>(16u, 0u);
+    auto expectedSeen = std::vector<uint8_t>(16u, 0u);
+    for (auto lane = 0u; lane < seen.size(); lane++)
+    {
+        lanes.push_back(loader.LoadProgram(program));
+        expected.push_back(loader.LoadProgram(program));
+        auto due = 100u + 7u * lane;
+        lanes.back().scheduler.Schedule(due, [&seen, lane] (ExecutionContext& ctx) {
+            seen[lane] = ctx.cpu.R[16];
+            ctx.cpu.R[17] = 0u;
+        });
+        expected.back().scheduler.Schedule(due, [&expectedSeen, lane] (ExecutionContext& ctx) {
+            expectedSeen[lane] = ctx.cpu.R[16];
+            ctx.cpu.R[17] = 0u;
+        });
+    }
+
+    auto pointers = std::vector<ExecutionContext*>();
+    for (auto& ctx : lanes)
+        pointers.push_back(&ctx);
+    subject.Execute(pointers, 400u);
+
+    for (auto lane = 0u; lane < lanes.size(); lane++)
+    {
+        reference.Execute(expected[lane], 400u);
+        ASSERT_NE(seen[lane], 0u);
+        ASSERT_EQ(seen[lane], expectedSeen[lane]);
+        AssertContextsMatch(lanes[lane], expected[lane]);
+    }
+}
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/lsr.h"
 #include "instructions/opcodes.h"
 
@@ -14,7 +13,6 @@ using namespace avr;
 class LSRInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         LSRInstruction subject;
         ExecutionContext ctx;
 
@@ -33,7 +31,7 @@ class LSRInstructionTests : public ::testing::Test
 
     public:
         LSRInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -0,0 +1,95 @@
+#include "core/memory.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace avr;
+
+TEST(MemoryTests, Size_GivenPowerOfTwo_KeepsSize)
+{
+    auto subject = Memory(0x800u);
+
+    ASSERT_EQ(subject.size(), 0x800u);
+}
+
+TEST(MemoryTests, Size_GivenOtherSize_RoundsUpToPowerOfTwo)
+{
+    auto subject = Memory(AVR_EMU_FLASH_SIZE + AVR_EMU_RAM_SIZE);
+
+    ASSERT_EQ(subject.size(), 0x8000u);
+}
+
+TEST(MemoryTests, Index_GivenAddressPastEnd_WrapsAround)
+{
+    auto subject = Memory(0x100u);
+    subject[0x12u] = 0xABu;
+
+    ASSERT_EQ(subject[0x112u], 0xABu);
+    ASSERT_EQ(subject[0xFF12u], 0xABu);
+}
+
+TEST(MemoryTests, Unchecked_GivenAddressInRange_AccessesSameByte)
+{
+    auto subject = Memory(0x100u);
+    subject[0x34u] = 0xCDu;
+
+    subject.Unchecked(0x35u) = 0xEFu;
+
+    ASSERT_EQ(subject.Unchecked(0x34u), 0xCDu);
+    ASSERT_EQ(subject[0x35u], 0xEFu);
+}
+
+TEST(MemoryTests, TakeSnapshot_GivenPagesUnchangedSinceLastSnapshot_SharesThem)
+{
+    auto subject = Memory(0x400u);
+    auto first = subject.TakeSnapshot();
+    subject[0x123u] = 0x01u;
+
+    auto second = subject.TakeSnapshot();
+
+    ASSERT_EQ(second.size(), 4u);
+    ASSERT_EQ(first[0], second[0]);
+    ASSERT_NE(first[1], second[1]);
+    ASSERT_EQ(first[2], second[2]);
+    ASSERT_EQ((*second[1])[0x23u], 0x01u);
+}
+
+TEST(MemoryTests, Restore_GivenWrittenPages_CopiesBackOnlyThose)
+{
+    auto subject = Memory(0x400u);
+    subject[0x010u] = 0xAAu;
+    auto snapshot = subject.TakeSnapshot();
+    subject[0x010u] = 0xBBu;
+    subject[0x310u] = 0xCCu;
+    auto restored = std::vector<uint16_t>();
+
+    subject.Restore(snapshot, [&restored] (uint16_t address, std::size_t) { restored.push_back(address); });
+
+    ASSERT_EQ(restored, std::vector<uint16_t>({ 0x000u, 0x300u }));
+    ASSERT_EQ(subject[0x010u], 0xAAu);
+    ASSERT_EQ(subject[0x310u], 0x00u);
+}
+
+TEST(MemoryTests, Restore_GivenSnapshotOfOtherMemory_CopiesDifferingPages)
+{
+    auto source = Memory(0x200u);
+    source[0x180u] = 0x42u;
+    auto snapshot = source.TakeSnapshot();
+    auto subject = Memory(0x200u);
+    subject.TakeSnapshot();
+
+    subject.Restore(snapshot, [] (uint16_t, std::size_t) {});
+
+    ASSERT_EQ(subject[0x180u], 0x42u);
+}
+
+TEST(MemoryTests, Restore_GivenSnapshotOfDifferentSize_Throws)
+{
+    auto snapshot = Memory(0x200u).TakeSnapshot();
+    auto subject = Memory(0x400u);
+
+    ASSERT_THROW(subject.Restore(snapshot, [] (uint16_t, std::size_t) {}), std::string);
+}
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/mov.h"
 #include "instructions/opcodes.h"
 
@@ -15,7 +14,6 @@ class MOVInstructionTests : public ::testing::Test
 {
 
     protected:
-        NoopClock clock;
         MOVInstruction subject;
         ExecutionContext ctx;
 
@@ -36,7 +34,7 @@ class MOVInstructionTests : public ::testing::Test
 
     public:
         MOVInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/movw.h"
 #include "instructions/opcodes.h"
 
@@ -15,7 +14,6 @@ class MOVWInstructionTests : public ::testing::Test
 {
 
     protected:
-        NoopClock clock;
         MOVWInstruction subject;
         ExecutionContext ctx;
 
@@ -50,7 +48,7 @@ class MOVWInstructionTests : public ::testing::Test
 
     public:
         MOVWInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/mul.h"
 #include "instructions/opcodes.h"
 
@@ -15,7 +14,6 @@ class MULInstructionTests : public ::testing::Test
 {
 
     protected:
-        NoopClock clock;
         MULInstruction subject;
         ExecutionContext ctx;
 
@@ -44,7 +42,7 @@ class MULInstructionTests : public ::testing::Test
 
     public:
         MULInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/muls.h"
 #include "instructions/opcodes.h"
 
@@ -15,7 +14,6 @@ class MULSInstructionTests : public ::testing::Test
 {
 
     protected:
-        NoopClock clock;
         MULSInstruction subject;
         ExecutionContext ctx;
 
@@ -44,7 +42,7 @@ class MULSInstructionTests : public ::testing::Test
 
     public:
         MULSInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/mulsu.h"
 #include "instructions/opcodes.h"
 
@@ -15,7 +14,6 @@ class MULSUInstructionTests : public ::testing::Test
 {
 
     protected:
-        NoopClock clock;
         MULSUInstruction subject;
         ExecutionContext ctx;
 
@@ -44,7 +42,7 @@ class MULSUInstructionTests : public ::testing::Test
 
     public:
         MULSUInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/neg.h"
 #include "instructions/opcodes.h"
 
@@ -14,7 +13,6 @@ using namespace avr;
 class NEGInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         NEGInstruction subject;
         ExecutionContext ctx;
 
@@ -33,7 +31,7 @@ class NEGInstructionTests : public ::testing::Test
 
     public:
         NEGInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/nop.h"
 #include "instructions/opcodes.h"
 
@@ -14,13 +13,12 @@ using namespace avr;
 class NOPInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         NOPInstruction subject;
         ExecutionContext ctx;
 
     public:
         NOPInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
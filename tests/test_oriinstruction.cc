@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/ori.h"
 #include "instructions/opcodes.h"
 
@@ -15,7 +14,6 @@ class ORIInstructionTests : public ::testing::Test
 {
 
     protected:
-        NoopClock clock;
         ORIInstruction subject;
         ExecutionContext ctx;
 
@@ -40,7 +38,7 @@ class ORIInstructionTests : public ::testing::Test
 
     public:
         ORIInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/or.h"
 #include "instructions/opcodes.h"
 
@@ -15,7 +14,6 @@ class ORInstructionTests : public ::testing::Test
 {
 
     protected:
-        NoopClock clock;
         ORInstruction subject;
         ExecutionContext ctx;
 
@@ -36,7 +34,7 @@ class ORInstructionTests : public ::testing::Test
 
     public:
         ORInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/out.h"
 #include "instructions/opcodes.h"
 
@@ -16,7 +15,6 @@ class OUTInstructionTests : public ::testing::Test
 {
 
     protected:
-        NoopClock clock;
         OUTInstruction subject;
         ExecutionContext ctx;
 
@@ -29,7 +27,7 @@ class OUTInstructionTests : public ::testing::Test
 
         std::tuple<uint16_t, uint8_t, uint8_t> GetRegisters()
         {
-            auto dst = static_cast<uint8_t>(rand() % 64);
+            auto dst = static_cast<uint8_t>(rand() % 63);  // 0x3F is SREG
             auto src = static_cast<uint8_t>(rand() % 32);
             auto compiledOpcode = GetOpCode(src, dst);
             return std::make_tuple(std::move(compiledOpcode), src, dst);
@@ -37,7 +35,7 @@ class OUTInstructionTests : public ::testing::Test
 
     public:
         OUTInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -65,3 +63,18 @@ TEST_F(OUTInstructionTests, Execute_CopiesRegisterValueToIORegister)
 
     ASSERT_EQ(ctx.cpu.GPIO[dst], ctx.cpu.R[src]);
 }
+
+TEST_F(OUTInstructionTests, Execute_GivenMappedIORegister_WritesThroughBus)
+{
+    auto [opcode, src, dst] = GetRegisters();
+    auto written = -1;
+    ctx.io.Map(static_cast<uint16_t>(IOBus::BEGIN + dst), nullptr,
+        [&written] (ExecutionContext&, uint16_t, uint8_t value) { written = value; });
+    ctx.cpu.GPIO[dst] = 0x0u;
+    ctx.cpu.R[src] = static_cast<uint8_t>(rand() | 0x1u);
+
+    subject.Execute(opcode, ctx);
+
+    ASSERT_EQ(written, ctx.cpu.R[src]);
+    ASSERT_EQ(ctx.cpu.GPIO[dst], 0x0u);
+}
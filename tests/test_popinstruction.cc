@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/pop.h"
 #include "instructions/opcodes.h"
 
@@ -15,7 +14,6 @@ class POPInstructionTests : public ::testing::Test
 {
 
     protected:
-        NoopClock clock;
         POPInstruction subject;
         ExecutionContext ctx;
 
@@ -44,7 +42,7 @@ class POPInstructionTests : public ::testing::Test
 
     public:
         POPInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
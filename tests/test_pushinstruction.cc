@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/push.h"
 #include "instructions/opcodes.h"
 
@@ -15,7 +14,6 @@ class PUSHInstructionTests : public ::testing::Test
 {
 
     protected:
-        NoopClock clock;
         PUSHInstruction subject;
         ExecutionContext ctx;
 
@@ -42,7 +40,7 @@ class PUSHInstructionTests : public ::testing::Test
 
     public:
         PUSHInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
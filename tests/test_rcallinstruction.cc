@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/rcall.h"
 #include "instructions/opcodes.h"
 
@@ -13,7 +12,6 @@ using namespace avr;
 class RCALLInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         RCALLInstruction subject;
         ExecutionContext ctx;
 
@@ -45,7 +43,7 @@ class RCALLInstructionTests : public ::testing::Test
 
     public:
         RCALLInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/reti.h"
 #include "instructions/opcodes.h"
 
@@ -13,7 +12,6 @@ using namespace avr;
 class RETIInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         RETIInstruction subject;
         ExecutionContext ctx;
 
@@ -44,7 +42,7 @@ class RETIInstructionTests : public ::testing::Test
 
     public:
         RETIInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
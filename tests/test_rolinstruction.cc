@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/rol.h"
 #include "instructions/opcodes.h"
 
@@ -13,7 +12,6 @@ using namespace avr;
 class ROLInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         ROLInstruction subject;
         ExecutionContext ctx;
 
@@ -38,7 +36,7 @@ class ROLInstructionTests : public ::testing::Test
 
     public:
         ROLInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
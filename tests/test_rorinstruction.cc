@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/ror.h"
 #include "instructions/opcodes.h"
 
@@ -13,7 +12,6 @@ using namespace avr;
 class RORInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         RORInstruction subject;
         ExecutionContext ctx;
 
@@ -33,7 +31,7 @@ class RORInstructionTests : public ::testing::Test
 
     public:
         RORInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
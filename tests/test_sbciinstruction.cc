@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/sbci.h"
 #include "instructions/opcodes.h"
 
@@ -13,7 +12,6 @@ using namespace avr;
 class SBCIInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         SBCIInstruction subject;
         ExecutionContext ctx;
 
@@ -35,7 +33,7 @@ class SBCIInstructionTests : public ::testing::Test
 
     public:
         SBCIInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/sbc.h"
 #include "instructions/opcodes.h"
 
@@ -13,7 +12,6 @@ using namespace avr;
 class SBCInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         SBCInstruction subject;
         ExecutionContext ctx;
 
@@ -36,7 +34,7 @@ class SBCInstructionTests : public ::testing::Test
 
     public:
         SBCInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/sbic.h"
 #include "instructions/opcodes.h"
 
@@ -14,7 +13,6 @@ using namespace avr;
 class SBICInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         SBICInstruction subject;
         ExecutionContext ctx;
 
@@ -42,7 +40,7 @@ class SBICInstructionTests : public ::testing::Test
 
     public:
         SBICInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
             ctx.cpu.PC = static_cast<uint16_t>(rand() % (ctx.progMem.size() / 2));
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/sbi.h"
 #include "instructions/opcodes.h"
 
@@ -14,7 +13,6 @@ using namespace avr;
 class SBIInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         SBIInstruction subject;
         ExecutionContext ctx;
 
@@ -35,7 +33,7 @@ class SBIInstructionTests : public ::testing::Test
 
     public:
         SBIInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -74,3 +72,29 @@ TEST_F(SBIInstructionTests, Execute_GivenBitSet_IsNoop)
 
     ASSERT_EQ(ctx.cpu.GPIO[io], expectedValue);
 }
+
+TEST_F(SBIInstructionTests, Execute_GivenRegisterOfFlagsClearedByOne_WritesOnlyThatBit)
+{
+    auto written = uint8_t(0u);
+    ctx.io.Map(0x35u,
+        [] (ExecutionContext&, uint16_t) { return uint8_t(0x07u); },
+        [&written] (ExecutionContext&, uint16_t, uint8_t value) { written = value; },
+        0x07u);
+
+    subject.Execute(GetOpCode(1u, 0x15u), ctx);
+
+    ASSERT_EQ(written, 0x02u);
+}
+
+TEST_F(SBIInstructionTests, Execute_GivenRegisterOfFlagsClearedByOne_KeepsOtherBits)
+{
+    auto written = uint8_t(0u);
+    ctx.io.Map(0x35u,
+        [] (ExecutionContext&, uint16_t) { return uint8_t(0x81u); },
+        [&written] (ExecutionContext&, uint16_t, uint8_t value) { written = value; },
+        0x01u);
+
+    subject.Execute(GetOpCode(4u, 0x15u), ctx);
+
+    ASSERT_EQ(written, 0x90u);
+}
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/sbiw.h"
 #include "instructions/opcodes.h"
 
@@ -13,7 +12,6 @@ using namespace avr;
 class SBIWInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         SBIWInstruction subject;
         ExecutionContext ctx;
 
@@ -47,7 +45,7 @@ class SBIWInstructionTests : public ::testing::Test
 
     public:
         SBIWInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
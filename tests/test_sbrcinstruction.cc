@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/sbrc.h"
 #include "instructions/opcodes.h"
 
@@ -14,7 +13,6 @@ using namespace avr;
 class SBRCInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         SBRCInstruction subject;
         ExecutionContext ctx;
 
@@ -42,7 +40,7 @@ class SBRCInstructionTests : public ::testing::Test
 
     public:
         SBRCInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
             ctx.cpu.PC = static_cast<uint16_t>(rand() % (ctx.progMem.size() / 2));
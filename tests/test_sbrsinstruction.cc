@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/sbrs.h"
 #include "instructions/opcodes.h"
 
@@ -14,7 +13,6 @@ using namespace avr;
 class SBRSInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         SBRSInstruction subject;
         ExecutionContext ctx;
 
@@ -42,7 +40,7 @@ class SBRSInstructionTests : public ::testing::Test
 
     public:
         SBRSInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
             ctx.cpu.PC = static_cast<uint16_t>(rand() % (ctx.progMem.size() / 2));
@@ -0,0 +1,197 @@
+#include "core/executioncontext.h"
+#include "core/scheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace avr;
+
+class SchedulerTests : public ::testing::Test
+{
+    protected:
+        Scheduler subject;
+        ExecutionContext ctx;
+        std::vector<int> ran;
+
+        Scheduler::Action Record(int value)
+        {
+            return [this, value] (ExecutionContext&) { ran.push_back(value); };
+        }
+
+    public:
+        SchedulerTests()
+            : subject(), ctx(), ran()
+        {}
+};
+
+TEST_F(SchedulerTests, NextDue_GivenNothingScheduled_ReturnsNever)
+{
+    ASSERT_EQ(subject.NextDue(), Scheduler::NEVER);
+    ASSERT_TRUE(subject.Empty());
+}
+
+TEST_F(SchedulerTests, NextDue_GivenEvents_ReturnsEarliest)
+{
+    subject.Schedule(30u, Record(1));
+    subject.Schedule(10u, Record(2));
+    subject.Schedule(20u, Record(3));
+
+    ASSERT_EQ(subject.NextDue(), 10u);
+}
+
+TEST_F(SchedulerTests, RunDue_GivenEventsDue_RunsThemInOrder)
+{
+    subject.Schedule(30u, Record(1));
+    subject.Schedule(10u, Record(2));
+    subject.Schedule(10u, Record(3));
+    subject.Schedule(20u, Record(4));
+    ctx.cycles = 25u;
+
+    subject.RunDue(ctx);
+
+    ASSERT_EQ(ran, (std::vector<int>{2, 3, 4}));
+    ASSERT_EQ(subject.NextDue(), 30u);
+}
+
+TEST_F(SchedulerTests, RunDue_GivenActionSchedulingDueEvent_RunsItToo)
+{
+    subject.Schedule(10u, [this] (ExecutionContext&) {
+        ran.push_back(1);
+        subject.Schedule(12u, Record(2));
+    });
+    ctx.cycles = 15u;
+
+    subject.RunDue(ctx);
+
+    ASSERT_EQ(ran, (std::vector<int>{1, 2}));
+    ASSERT_TRUE(subject.Empty());
+}
+
+TEST_F(SchedulerTests, Cancel_GivenPendingEvent_RemovesIt)
+{
+    auto id = subject.Schedule(10u, Record(1));
+    subject.Schedule(20u, Record(2));
+
+    ASSERT_TRUE(subject.Cancel(id));
+    ASSERT_FALSE(subject.Cancel(id));
+    ASSERT_EQ(subject.NextDue(), 20u);
+}
+
+TEST_F(SchedulerTests, RunDue_GivenEventsOnEveryLevel_RunsThemInOrder)
+{
+    subject.Schedule(uint64_t(1u) << 40, Record(5));
+    subject.Schedule(70000u, Record(4));
+    subject.Schedule(5000u, Record(3));
+    subject.Schedule(100u, Record(2));
+    subject.Schedule(3u, Record(1));
+
+    ctx.cycles = 100000u;
+    subject.RunDue(ctx);
+    auto beforeFarEvent = ran;
+    ctx.cycles = uint64_t(1u) << 40;
+    subject.RunDue(ctx);
+
+    ASSERT_EQ(beforeFarEvent, (std::vector<int>{1, 2, 3, 4}));
+    ASSERT_EQ(ran, (std::vector<int>{1, 2, 3, 4, 5}));
+    ASSERT_TRUE(subject.Empty());
+}
+
+TEST_F(SchedulerTests, RunDue_GivenSameDueScheduledFromDifferentDistances_RunsInScheduledOrder)
+{
+    subject.Schedule(5000u, Record(1));
+    ctx.cycles = 4990u;
+    subject.RunDue(ctx);
+    subject.Schedule(5000u, Record(2));
+
+    ctx.cycles = 5000u;
+    subject.RunDue(ctx);
+
+    ASSERT_EQ(ran, (std::vector<int>{1, 2}));
+}
+
+TEST_F(SchedulerTests, Schedule_GivenDueBeforeEventsAlreadyRun_RunsItNext)
+{
+    subject.Schedule(100u, Record(1));
+    subject.Schedule(200u, Record(3));
+    ctx.cycles = 150u;
+    subject.RunDue(ctx);
+
+    subject.Schedule(50u, Record(2));
+
+    ASSERT_EQ(subject.NextDue(), 50u);
+    ctx.cycles = 200u;
+    subject.RunDue(ctx);
+    ASSERT_EQ(ran, (std::vector<int>{1, 2, 3}));
+}
+
+TEST_F(SchedulerTests, Cancel_GivenIdOfEventWhoseEntryWasReused_ReturnsFalse)
+{
+    auto id = subject.Schedule(10u, Record(1));
+    subject.Cancel(id);
+    subject.Schedule(20u, Record(2));
+
+    ASSERT_FALSE(subject.Cancel(id));
+    ASSERT_EQ(subject.NextDue(), 20u);
+}
+
+TEST_F(SchedulerTests, Cancel_GivenEarliestOnHigherLevel_FindsNextDue)
+{
+    auto id = subject.Schedule(1000u, Record(1));
+    subject.Schedule(1010u, Record(2));
+    subject.Schedule(300000u, Record(3));
+
+    subject.Cancel(id);
+
+    ASSERT_EQ(subject.NextDue(), 1010u);
+}
+
+TEST_F(SchedulerTests, Copy_GivenEventsScheduled_RunsIndependently)
+{
+    subject.Schedule(10u, Record(1));
+    subject.Schedule(5000u, Record(2));
+    auto copy = subject;
+
+    ctx.cycles = 10000u;
+    subject.RunDue(ctx);
+    copy.RunDue(ctx);
+
+    ASSERT_EQ(ran, (std::vector<int>{1, 2, 1, 2}));
+}
+
+TEST_F(SchedulerTests, RunDue_GivenRandomEventsAndCancels_MatchesSortedOrder)
+{
+    auto rng = std::mt19937_64(1234u);
+    auto expected = std::vector<std::pair<uint64_t, int>>();
+    auto ids = std::vector<Scheduler::EventId>();
+    for (auto i = 0; i < 2000; i++)
+    {
+        auto due = rng() >> (1u + rng() % 63u);
+        ids.push_back(subject.Schedule(due, Record(i)));
+        expected.emplace_back(due, i);
+    }
+    for (auto i = 0; i < 2000; i += 7)
+    {
+        subject.Cancel(ids[static_cast<std::size_t>(i)]);
+        expected[static_cast<std::size_t>(i)].first = Scheduler::NEVER;
+    }
+    std::stable_sort(expected.begin(), expected.end());
+    expected.erase(
+        std::find_if(expected.begin(), expected.end(), [] (auto& event) { return event.first == Scheduler::NEVER; }),
+        expected.end());
+
+    while (!subject.Empty())
+    {
+        ctx.cycles = subject.NextDue() + (rng() % 3u == 0u ? rng() % 1000u : 0u);
+        subject.RunDue(ctx);
+    }
+
+    ASSERT_EQ(ran.size(), expected.size());
+    for (auto i = std::size_t(0u); i < ran.size(); i++)
+        ASSERT_EQ(ran[i], expected[i].second);
+}
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/sleep.h"
 #include "instructions/opcodes.h"
 
@@ -14,13 +13,12 @@ using namespace avr;
 class SLEEPInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         SLEEPInstruction subject;
         ExecutionContext ctx;
 
     public:
         SLEEPInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -0,0 +1,224 @@
+#include "core/executioncontext.h"
+#include "core/interrupts.h"
+#include "core/ispidevice.h"
+#include "core/spi.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace avr;
+
+namespace {
+    constexpr uint16_t PORTB = 0x25u;
+    constexpr uint16_t SPCR = 0x4Cu;
+    constexpr uint16_t SPSR = 0x4Du;
+    constexpr uint16_t SPDR = 0x4Eu;
+
+    constexpr uint8_t MASTER = 0x50u;   // SPE | MSTR, clk/4
+    constexpr uint8_t SPIE = 0x80u;
+    constexpr uint8_t SPI2X = 0x01u;
+    constexpr uint8_t WCOL = 0x40u;
+    constexpr uint8_t SPIF = 0x80u;
+
+    // Eight SCK periods at clk/4
+    constexpr uint64_t BYTE = 32u;
+
+    // Answers each byte with its complement and records what it saw
+    class FakeSpiDevice : public ISpiDevice {
+        public:
+            std::vector<uint8_t> received;
+            int selects = 0;
+            int deselects = 0;
+
+            void Select() override
+            {
+                selects++;
+            }
+
+            void Deselect() override
+            {
+                deselects++;
+            }
+
+            void Transfer(const uint8_t* mosi, uint8_t* miso, std::size_t length) override
+            {
+                for (auto i = std::size_t(0u); i < length; i++)
+                {
+                    received.push_back(mosi[i]);
+                    miso[i] = static_cast<uint8_t>(~mosi[i]);
+                }
+            }
+    };
+
+    uint64_t Bit(uint8_t interrupt)
+    {
+        return uint64_t(1u) << interrupt;
+    }
+}
+
+class SpiTests : public ::testing::Test
+{
+    protected:
+        ExecutionContext ctx;
+        std::shared_ptr<FakeSpiDevice> device;
+
+    public:
+        SpiTests()
+            : ctx(),
+              device(std::make_shared<FakeSpiDevice>())
+        {}
+
+        ~SpiTests()
+        {
+            ctx.io = IOBus();
+            ctx.scheduler.Clear();
+        }
+};
+
+TEST_F(SpiTests, SPDR_GivenDeviceSelected_HoldsItsAnswerAfterEightSCKPeriods)
+{
+    auto spi = Spi::Attach(ctx, SPI_LAYOUT);
+    spi->Connect(2u, device);
+    ctx.Store(PORTB, 0xFBu);
+    ctx.Store(SPCR, MASTER);
+
+    ctx.Store(SPDR, 0x3Cu);
+    ctx.cycles = BYTE - 1u;
+    auto shifting = ctx.Load(SPSR);
+    ctx.cycles = BYTE;
+    auto done = ctx.Load(SPSR);
+
+    ASSERT_EQ(device->received, std::vector<uint8_t>({ 0x3Cu }));
+    ASSERT_EQ(shifting & SPIF, 0u);
+    ASSERT_EQ(done & SPIF, SPIF);
+    ASSERT_EQ(ctx.Load(SPDR), 0xC3u);
+    ASSERT_TRUE(ctx.scheduler.Empty());
+}
+
+TEST_F(SpiTests, SPDR_GivenNoDeviceSelected_ReadsMISOFloatingHigh)
+{
+    auto spi = Spi::Attach(ctx, SPI_LAYOUT);
+    spi->Connect(2u, device);
+    ctx.Store(PORTB, 0xFFu);
+    ctx.Store(SPCR, MASTER);
+
+    ctx.Store(SPDR, 0x3Cu);
+    ctx.cycles = BYTE;
+
+    ASSERT_TRUE(device->received.empty());
+    ASSERT_EQ(ctx.Load(SPDR), 0xFFu);
+}
+
+TEST_F(SpiTests, PORTB_GivenChipSelectToggled_SelectsAndDeselectsOnlyThatDevice)
+{
+    auto other = std::make_shared<FakeSpiDevice>();
+    auto spi = Spi::Attach(ctx, SPI_LAYOUT);
+    ctx.Store(PORTB, 0xFFu);
+    spi->Connect(2u, device);
+    spi->Connect(1u, other);
+
+    ctx.Store(PORTB, 0xFBu);
+    ctx.Store(PORTB, 0xFBu);
+    ctx.Store(PORTB, 0xFFu);
+
+    ASSERT_EQ(device->selects, 1);
+    ASSERT_EQ(device->deselects, 1);
+    ASSERT_EQ(other->selects, 0);
+    ASSERT_EQ(ctx.Load(PORTB), 0xFFu);
+}
+
+TEST_F(SpiTests, SPDR_GivenWriteDuringTransfer_SetsWCOLAndDropsIt)
+{
+    auto spi = Spi::Attach(ctx, SPI_LAYOUT);
+    spi->Connect(2u, device);
+    ctx.Store(PORTB, 0xFBu);
+    ctx.Store(SPCR, MASTER);
+
+    ctx.Store(SPDR, 0x01u);
+    ctx.cycles = 10u;
+    ctx.Store(SPDR, 0x02u);
+
+    ASSERT_EQ(ctx.Load(SPSR) & WCOL, WCOL);
+    ASSERT_EQ(device->received, std::vector<uint8_t>({ 0x01u }));
+}
+
+TEST_F(SpiTests, SPSR_GivenSPIFReadThenSPDRRead_ClearsSPIF)
+{
+    auto spi = Spi::Attach(ctx, SPI_LAYOUT);
+    spi->Connect(2u, device);
+    ctx.Store(PORTB, 0xFBu);
+    ctx.Store(SPCR, MASTER);
+    ctx.Store(SPDR, 0x01u);
+    ctx.cycles = BYTE;
+
+    auto unread = ctx.Load(SPDR);
+    auto flagged = ctx.Load(SPSR) & SPIF;
+    ctx.Load(SPDR);
+
+    ASSERT_EQ(unread, 0xFEu);
+    ASSERT_EQ(flagged, SPIF);
+    ASSERT_EQ(ctx.Load(SPSR) & SPIF, 0u);
+}
+
+TEST_F(SpiTests, SPDR_GivenSPIEEnabled_RaisesInterruptWhenTransferEnds)
+{
+    auto spi = Spi::Attach(ctx, SPI_LAYOUT);
+    spi->Connect(2u, device);
+    ctx.Store(PORTB, 0xFBu);
+    ctx.Store(SPCR, MASTER | SPIE);
+
+    ctx.Store(SPDR, 0x55u);
+
+    ASSERT_EQ(ctx.scheduler.NextDue(), BYTE);
+    ctx.cycles = BYTE;
+    ctx.scheduler.RunDue(ctx);
+    ASSERT_EQ(ctx.pendingInterrupts, Bit(SPI_LAYOUT.interrupt));
+    ASSERT_EQ(ctx.Load(SPSR) & SPIF, SPIF);
+    ASSERT_EQ(ctx.Load(SPDR), 0xAAu);
+    ASSERT_EQ(ctx.pendingInterrupts, 0u);
+}
+
+TEST_F(SpiTests, SPSR_GivenInterruptVectored_ClearsSPIF)
+{
+    auto spi = Spi::Attach(ctx, SPI_LAYOUT);
+    spi->Connect(2u, device);
+    ctx.Store(PORTB, 0xFBu);
+    ctx.Store(SPCR, MASTER | SPIE);
+    ctx.Store(SPDR, 0x55u);
+    ctx.cycles = BYTE;
+    ctx.scheduler.RunDue(ctx);
+    ctx.cpu.SP = 0x7EFu;
+
+    EnterInterrupt(ctx);
+
+    ASSERT_EQ(ctx.Load(SPSR) & SPIF, 0u);
+}
+
+TEST_F(SpiTests, SPCR_GivenSPIECleared_KeepsSPIFButDropsInterrupt)
+{
+    auto spi = Spi::Attach(ctx, SPI_LAYOUT);
+    ctx.Store(SPCR, MASTER | SPIE);
+    ctx.Store(SPDR, 0x55u);
+    ctx.cycles = BYTE;
+    ctx.scheduler.RunDue(ctx);
+
+    ctx.Store(SPCR, MASTER);
+
+    ASSERT_EQ(ctx.pendingInterrupts, 0u);
+    ASSERT_EQ(ctx.Load(SPSR) & SPIF, SPIF);
+}
+
+TEST_F(SpiTests, SPDR_GivenSPI2XAtSlowestRate_TakesSixtyFourCyclesPerBit)
+{
+    auto spi = Spi::Attach(ctx, SPI_LAYOUT);
+    ctx.Store(SPCR, MASTER | SPIE | 0x03u);
+    ctx.Store(SPSR, SPI2X);
+
+    ctx.Store(SPDR, 0x00u);
+
+    ASSERT_EQ(ctx.scheduler.NextDue(), 8u * 64u);
+}
@@ -0,0 +1,193 @@
+#include "core/executioncontext.h"
+#include "core/spi.h"
+#include "core/spiflash.h"
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace avr;
+
+namespace {
+    constexpr std::size_t IMAGE_SIZE = 0x20000u;
+}
+
+class SpiFlashTests : public ::testing::Test
+{
+    protected:
+        std::string path;
+
+        // Selects the flash, shifts out bytes and returns what came back
+        std::vector<uint8_t> Command(SpiFlash& flash, std::vector<uint8_t> bytes)
+        {
+            auto miso = std::vector<uint8_t>(bytes.size(), 0xFFu);
+            flash.Select();
+            flash.Transfer(bytes.data(), miso.data(), bytes.size());
+            flash.Deselect();
+            return miso;
+        }
+
+        std::vector<uint8_t> Read(SpiFlash& flash, uint32_t address, std::size_t length)
+        {
+            auto bytes = std::vector<uint8_t>({ 0x03u,
+                static_cast<uint8_t>(address >> 16), static_cast<uint8_t>(address >> 8), static_cast<uint8_t>(address) });
+            bytes.resize(4u + length, 0x00u);
+            auto miso = Command(flash, bytes);
+            return std::vector<uint8_t>(miso.begin() + 4, miso.end());
+        }
+
+        uint8_t FileByte(std::size_t offset)
+        {
+            auto fd = open(path.c_str(), O_RDONLY);
+            auto value = uint8_t(0u);
+            pread(fd, &value, 1u, static_cast<off_t>(offset));
+            close(fd);
+            return value;
+        }
+
+    public:
+        SpiFlashTests()
+            : path()
+        {
+            char name[] = "/tmp/avr-emu-spiflash-XXXXXX";
+            auto fd = mkstemp(name);
+            if (fd < 0)
+                throw std::string("Unable to create flash image");
+            path = name;
+
+            auto image = std::vector<uint8_t>(IMAGE_SIZE);
+            for (auto i = std::size_t(0u); i < IMAGE_SIZE; i++)
+                image[i] = static_cast<uint8_t>(i * 7u);
+            auto written = write(fd, image.data(), image.size());
+            close(fd);
+            if (written != static_cast<ssize_t>(IMAGE_SIZE))
+                throw std::string("Unable to write flash image");
+        }
+
+        ~SpiFlashTests()
+        {
+            unlink(path.c_str());
+        }
+};
+
+TEST_F(SpiFlashTests, Transfer_GivenRead_ReturnsImageInPlaceWrappingAtTheEnd)
+{
+    auto flash = SpiFlash(path);
+
+    auto start = Read(flash, 0x000010u, 3u);
+    auto end = Read(flash, IMAGE_SIZE - 1u, 2u);
+
+    ASSERT_EQ(start, std::vector<uint8_t>({ 0x70u, 0x77u, 0x7Eu }));
+    ASSERT_EQ(end, std::vector<uint8_t>({ static_cast<uint8_t>((IMAGE_SIZE - 1u) * 7u), 0x00u }));
+}
+
+TEST_F(SpiFlashTests, Transfer_GivenReadSplitAcrossCalls_CarriesOnFromTheAddress)
+{
+    auto flash = SpiFlash(path);
+    const uint8_t command[] = { 0x0Bu, 0x00u, 0x01u, 0x00u, 0x00u };
+    uint8_t header[5];
+    uint8_t first[2];
+    uint8_t second[2];
+
+    flash.Select();
+    flash.Transfer(command, header, 5u);
+    flash.Transfer(command, first, 2u);
+    flash.Transfer(command, second, 2u);
+    flash.Deselect();
+
+    ASSERT_EQ(first[0], flash.data()[0x100u]);
+    ASSERT_EQ(first[1], flash.data()[0x101u]);
+    ASSERT_EQ(second[0], flash.data()[0x102u]);
+    ASSERT_EQ(second[1], flash.data()[0x103u]);
+}
+
+TEST_F(SpiFlashTests, Transfer_GivenJEDECID_ReportsCapacityAsPowerOfTwo)
+{
+    auto flash = SpiFlash(path);
+
+    auto id = Command(flash, { 0x9Fu, 0x00u, 0x00u, 0x00u });
+
+    ASSERT_EQ(id, std::vector<uint8_t>({ 0xFFu, 0xEFu, 0x40u, 17u }));
+}
+
+TEST_F(SpiFlashTests, Transfer_GivenPageProgramWithoutWriteEnable_LeavesImageAlone)
+{
+    auto flash = SpiFlash(path);
+
+    Command(flash, { 0x02u, 0x00u, 0x00u, 0x10u, 0x00u });
+
+    ASSERT_EQ(Read(flash, 0x10u, 1u), std::vector<uint8_t>({ 0x70u }));
+}
+
+TEST_F(SpiFlashTests, Transfer_GivenPageProgram_ClearsBitsWrappingWithinThePage)
+{
+    auto flash = SpiFlash(path);
+
+    Command(flash, { 0x06u });
+    auto enabled = Command(flash, { 0x05u, 0x00u })[1];
+    Command(flash, { 0x02u, 0x00u, 0x01u, 0xFFu, 0x0Fu, 0x00u });
+    auto disabled = Command(flash, { 0x05u, 0x00u })[1];
+
+    ASSERT_EQ(enabled, 0x02u);
+    ASSERT_EQ(disabled, 0x00u);
+    ASSERT_EQ(Read(flash, 0x1FFu, 1u)[0], static_cast<uint8_t>((0x1FFu * 7u) & 0x0Fu));
+    ASSERT_EQ(Read(flash, 0x100u, 1u)[0], 0x00u);
+    ASSERT_EQ(Read(flash, 0x200u, 1u)[0], static_cast<uint8_t>(0x200u * 7u));
+}
+
+TEST_F(SpiFlashTests, Deselect_GivenSectorEraseWithWriteBack_ErasesTheFile)
+{
+    {
+        auto flash = SpiFlash(path, true);
+        Command(flash, { 0x06u });
+        Command(flash, { 0x20u, 0x00u, 0x12u, 0x34u });
+
+        ASSERT_EQ(Read(flash, 0x1000u, 1u)[0], 0xFFu);
+        ASSERT_EQ(Read(flash, 0x1FFFu, 1u)[0], 0xFFu);
+        ASSERT_EQ(Read(flash, 0x2000u, 1u)[0], static_cast<uint8_t>(0x2000u * 7u));
+    }
+
+    ASSERT_EQ(FileByte(0x1234u), 0xFFu);
+}
+
+TEST_F(SpiFlashTests, Deselect_GivenChipEraseWithoutWriteBack_LeavesTheFileAlone)
+{
+    {
+        auto flash = SpiFlash(path);
+        Command(flash, { 0x06u });
+        Command(flash, { 0xC7u });
+
+        ASSERT_EQ(Read(flash, 0x10u, 1u)[0], 0xFFu);
+    }
+
+    ASSERT_EQ(FileByte(0x10u), 0x70u);
+}
+
+TEST_F(SpiFlashTests, Spi_GivenFlashOnChipSelect_ReadsItThroughSPDR)
+{
+    auto ctx = ExecutionContext();
+    auto spi = Spi::Attach(ctx, SPI_LAYOUT);
+    spi->Connect(2u, std::make_shared<SpiFlash>(path));
+    ctx.Store(0x4Cu, 0x50u);
+    ctx.Store(0x25u, 0xFFu);
+    ctx.Store(0x25u, 0xFBu);
+
+    auto received = std::vector<uint8_t>();
+    for (auto value : { 0x03u, 0x00u, 0x00u, 0x10u, 0x00u, 0x00u })
+    {
+        ctx.Store(0x4Eu, static_cast<uint8_t>(value));
+        ctx.cycles += 32u;
+        received.push_back(ctx.Load(0x4Eu));
+    }
+    ctx.Store(0x25u, 0xFFu);
+
+    ASSERT_EQ(received, std::vector<uint8_t>({ 0xFFu, 0xFFu, 0xFFu, 0xFFu, 0x70u, 0x77u }));
+    ctx.io = IOBus();
+}
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/spm.h"
 #include "instructions/opcodes.h"
 
@@ -14,7 +13,6 @@ using namespace avr;
 class SPMInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         SPMInstruction subject;
         ExecutionContext ctx;
 
@@ -28,7 +26,7 @@ class SPMInstructionTests : public ::testing::Test
 
     public:
         SPMInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
             ctx.cpu.PC = static_cast<uint16_t>(rand() % (ctx.progMem.size() / 2));
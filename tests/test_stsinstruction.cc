@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/sts.h"
 #include "instructions/opcodes.h"
 
@@ -14,14 +13,13 @@ using namespace avr;
 class STSInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         STSInstruction subject;
         ExecutionContext ctx;
 
         std::tuple<uint16_t, uint8_t, uint16_t> GetRegisters()
         {
             auto src = static_cast<uint8_t>(rand() % 32);
-            auto address = static_cast<uint16_t>(rand() % ctx.ram.size());
+            auto address = static_cast<uint16_t>(rand() % (ctx.ram.size() - ctx.cpu.SRAM_BEG) + ctx.cpu.SRAM_BEG);
             auto compiledOpcode = static_cast<uint16_t>(OpCode::STS) | ((src & 0x1fu) << 4);
             ctx.cpu.PC = 0x100u;
             auto pcWriter = IndirectRegister(&ctx.progMem[ctx.cpu.PC]);
@@ -32,7 +30,7 @@ class STSInstructionTests : public ::testing::Test
 
     public:
         STSInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
             ctx.cpu.PC = static_cast<uint16_t>(rand() % (ctx.progMem.size() / 2));
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/stx.h"
 #include "instructions/opcodes.h"
 
@@ -14,13 +13,12 @@ using namespace avr;
 class STXInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         STXInstruction subject;
         ExecutionContext ctx;
 
         std::tuple<uint16_t, uint16_t, uint16_t> GetRegisters(bool pre_decrement, bool post_increment)
         {
-            auto offset = static_cast<uint16_t>(rand() % (ctx.ram.size() / 2));
+            auto offset = static_cast<uint16_t>(rand() % (ctx.ram.size() / 2 - ctx.cpu.SRAM_BEG) + ctx.cpu.SRAM_BEG);
             auto srcIndex = static_cast<uint16_t>(rand() % 26);
             auto compiledOpcode = static_cast<uint16_t>(OpCode::STX)
                 | ((srcIndex & 0x1Fu) << 4u)
@@ -32,7 +30,7 @@ class STXInstructionTests : public ::testing::Test
 
     public:
         STXInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
             ctx.cpu.PC = static_cast<uint16_t>(rand() % (ctx.progMem.size() / 2));
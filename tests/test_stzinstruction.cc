@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/stz.h"
 #include "instructions/opcodes.h"
 
@@ -14,13 +13,12 @@ using namespace avr;
 class STZInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         STZInstruction subject;
         ExecutionContext ctx;
 
         std::tuple<uint16_t, uint16_t, uint16_t, uint8_t> GetRegisters(bool pre_decrement, bool post_increment, bool has_displacement)
         {
-            auto offset = static_cast<uint16_t>(rand() % (ctx.ram.size() / 2));
+            auto offset = static_cast<uint16_t>(rand() % (ctx.ram.size() / 2 - ctx.cpu.SRAM_BEG) + ctx.cpu.SRAM_BEG);
             auto srcIndex = static_cast<uint16_t>(rand() % 26);
             auto displacement = static_cast<uint16_t>((has_displacement) ? 
                     rand() % 64u
@@ -37,7 +35,7 @@ class STZInstructionTests : public ::testing::Test
 
     public:
         STZInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
             ctx.cpu.PC = static_cast<uint16_t>(rand() % (ctx.progMem.size() / 2));
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/subi.h"
 #include "instructions/opcodes.h"
 
@@ -13,7 +12,6 @@ using namespace avr;
 class SUBIInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         SUBIInstruction subject;
         ExecutionContext ctx;
 
@@ -35,7 +33,7 @@ class SUBIInstructionTests : public ::testing::Test
 
     public:
         SUBIInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
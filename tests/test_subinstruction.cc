@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/sub.h"
 #include "instructions/opcodes.h"
 
@@ -13,7 +12,6 @@ using namespace avr;
 class SUBInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         SUBInstruction subject;
         ExecutionContext ctx;
 
@@ -36,7 +34,7 @@ class SUBInstructionTests : public ::testing::Test
 
     public:
         SUBInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/swap.h"
 #include "instructions/opcodes.h"
 
@@ -13,7 +12,6 @@ using namespace avr;
 class SWAPInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         SWAPInstruction subject;
         ExecutionContext ctx;
 
@@ -33,7 +31,7 @@ class SWAPInstructionTests : public ::testing::Test
 
     public:
         SWAPInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }
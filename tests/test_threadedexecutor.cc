@@ -0,0 +1,309 @@
+#include "cdif/cdif.h"
+#include "core/coremodule.h"
+#include "core/executioncontext.h"
+#include "core/executor.h"
+#include "core/loader.h"
+#include "core/threadedexecutor.h"
+#include "instructions/instructionmodule.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace avr;
+
+namespace {
+    cdif::Container BuildThreadedContainer()
+    {
+        auto ctx = cdif::Container();
+        ctx.registerModule<InstructionModule>();
+        ctx.registerModule<CoreModule>();
+        return ctx;
+    }
+}
+
+class ThreadedExecutorTests : public ::testing::Test
+{
+    protected:
+        cdif::Container container;
+        ThreadedExecutor subject;
+        Executor reference;
+        Loader loader;
+        ExecutionContext ctx;
+
+        void LoadProgramToAddress(const char* program, std::size_t size, uint16_t address, ExecutionContext& context)
+        {
+            for (auto i = 0u; i < size; i++)
+                context.progMem[address + i] = program[i];
+        }
+
+        void LoadProgramToAddress(const char* program, std::size_t size, uint16_t address)
+        {
+            LoadProgramToAddress(program, size, address, ctx);
+        }
+
+        // Straight line instructions with randomised operands. Branch and
+        // skip offsets only move forward so every program terminates.
+        uint16_t RandomOpCode() const
+        {
+            static const std::vector<std::tuple<uint16_t, uint16_t>> templates = {
+                { 0x0C00u, 0x03FFu }, // add
+                { 0x1C00u, 0x03FFu }, // adc
+                { 0x1800u, 0x03FFu }, // sub
+                { 0x2000u, 0x03FFu }, // and
+                { 0x2800u, 0x03FFu }, // or
+                { 0x2400u, 0x03FFu }, // eor
+                { 0x2C00u, 0x03FFu }, // mov
+                { 0x1400u, 0x03FFu }, // cp
+                { 0x0400u, 0x03FFu }, // cpc
+                { 0x1000u, 0x03FFu }, // cpse
+                { 0x3000u, 0x0FFFu }, // cpi
+                { 0xE000u, 0x0FFFu }, // ldi
+                { 0x5000u, 0x0FFFu }, // subi
+                { 0x7000u, 0x0FFFu }, // andi
+                { 0x6000u, 0x0FFFu }, // ori
+                { 0x9403u, 0x01F0u }, // inc
+                { 0x940Au, 0x01F0u }, // dec
+                { 0x9402u, 0x01F0u }, // swap
+                { 0x9400u, 0x01F0u }, // com
+                { 0xF000u, 0x0417u }, // brbs/brbc .+0 or .+4
+            };
+
+            auto& [op, mask] = templates[static_cast<std::size_t>(rand()) % templates.size()];
+            return static_cast<uint16_t>(op | (static_cast<uint16_t>(rand()) & mask));
+        }
+
+        void AssertContextsMatch(const ExecutionContext& actual, const ExecutionContext& expected)
+        {
+            for (auto i = 0u; i < 32u; i++)
+                ASSERT_EQ(actual.cpu.R[i], expected.cpu.R[i]) << "r" << i;
+
+            ASSERT_EQ(actual.cpu.PC, expected.cpu.PC);
+            ASSERT_EQ(actual.cycles, expected.cycles);
+            ASSERT_EQ(actual.cpu.SP, expected.cpu.SP);
+            ASSERT_EQ(actual.cpu.SREG.C, expected.cpu.SREG.C);
+            ASSERT_EQ(actual.cpu.SREG.Z, expected.cpu.SREG.Z);
+            ASSERT_EQ(actual.cpu.SREG.N, expected.cpu.SREG.N);
+            ASSERT_EQ(actual.cpu.SREG.V, expected.cpu.SREG.V);
+            ASSERT_EQ(actual.cpu.SREG.S, expected.cpu.SREG.S);
+            ASSERT_EQ(actual.cpu.SREG.H, expected.cpu.SREG.H);
+            ASSERT_EQ(actual.cpu.SREG.T, expected.cpu.SREG.T);
+            ASSERT_EQ(actual.cpu.SREG.I, expected.cpu.SREG.I);
+        }
+
+    public:
+        ThreadedExecutorTests()
+            : container(BuildThreadedContainer()),
+            subject(container.resolve<ThreadedExecutor>()),
+            reference(container.resolve<IClock&>(), subject.GetDispatchTable()),
+            loader(),
+            ctx(loader.LoadProgram("\x88\x95"))
+        {
+            srand(static_cast<unsigned int>(time(NULL)));
+        }
+};
+
+TEST_F(ThreadedExecutorTests, Execute_GivenEnoughCycles_CompletesProgram)
+{
+    LoadProgramToAddress(
+                // add():
+        "\x1f\x92" // push r1           2
+        "\x12\x1c" // ADC  r1, r2       1
+        "\x31\x2c" // mov  r3, r1       1
+        "\x1f\x90" // pop  r1           2
+        "\x08\x95" // ret               4
+                // main():
+        "\x05\xe0" // ldi r16, 0x05     1
+        "\x19\xe0" // ldi r17, 0x09     1
+        "\x10\x2e" // mov r1, r16       1
+        "\x21\x2e" // mov r2, r17       1
+        "\xf6\xdf" // rcall .-20        3
+        ,
+        20,
+        0x100);
+    ctx.cpu.PC = 0x10a;
+    ctx.cpu.SP = ctx.cpu.SRAM_BEG + 0x100u;
+    auto originalSP = ctx.cpu.SP;
+
+    subject.Execute(ctx, 17);
+
+    ASSERT_EQ(ctx.cpu.PC, 0x114u);
+    ASSERT_EQ(ctx.cpu.SP, originalSP);
+    ASSERT_EQ(ctx.cpu.R[3], 14u);
+}
+
+TEST_F(ThreadedExecutorTests, Execute_GivenLoop_BranchesUntilCounterExpires)
+{
+    LoadProgramToAddress(
+        "\x03\xe0" // ldi  r16, 0x03    1
+        "\x10\xe0" // ldi  r17, 0x00    1
+        "\x13\x95" // inc  r17          1
+        "\x0a\x95" // dec  r16          1
+        "\xe9\xf7" // brne .-6          2/1
+        ,
+        10,
+        0x100);
+    ctx.cpu.PC = 0x100;
+
+    subject.Execute(ctx, 13);
+
+    ASSERT_EQ(ctx.cpu.PC, 0x10au);
+    ASSERT_EQ(ctx.cpu.R[16], 0u);
+    ASSERT_EQ(ctx.cpu.R[17], 3u);
+}
+
+TEST_F(ThreadedExecutorTests, Execute_GivenCallAndJump_FollowsTargets)
+{
+    LoadProgramToAddress(
+        "\x0e\x94\x84\x00" // call 0x108            4
+        "\x0c\x94\x86\x00" // jmp  0x10c            3
+        "\x08\x95"         // ret                   4
+        "\x00\x00"         // nop
+        "\x0a\xe2"         // ldi r16, 0x2A         1
+        ,
+        14,
+        0x100);
+    ctx.cpu.PC = 0x100;
+    ctx.cpu.SP = ctx.cpu.SRAM_BEG + 0x100u;
+    auto originalSP = ctx.cpu.SP;
+
+    subject.Execute(ctx, 12);
+
+    ASSERT_EQ(ctx.cpu.PC, 0x10eu);
+    ASSERT_EQ(ctx.cpu.SP, originalSP);
+    ASSERT_EQ(ctx.cpu.R[16], 0x2Au);
+}
+
+TEST_F(ThreadedExecutorTests, Execute_GivenCodeRewrittenBySPM_ExecutesNewInstruction)
+{
+    LoadProgramToAddress(
+        "\x05\xe0" // ldi  r16, 0x05    1
+        "\xe8\x95" // spm               1
+        "\xfa\xcf" // rjmp .-6          2
+        ,
+        6,
+        0x100);
+    ctx.cpu.PC = 0x100;
+    ctx.cpu.R[0] = 0x09; // ldi r16, 0x09
+    ctx.cpu.R[1] = 0xe0;
+    ctx.cpu.Z = 0x100;
+
+    subject.Execute(ctx, 5);
+
+    ASSERT_EQ(ctx.cpu.PC, 0x102u);
+    ASSERT_EQ(ctx.cpu.R[16], 0x09u);
+}
+
+TEST_F(ThreadedExecutorTests, Interrupt_GivenInterruptEnabled_ExecutesHandlerToEnd)
+{
+    LoadProgramToAddress(
+        "\x08\xe0" // ldi     r16, 0x08       ; 8
+        "\x00\x0f" // add     r16, r16
+        "\x08\x95" // ret
+        ,
+        6,
+        0x0A00
+    );
+    // Set interrupt handler 0
+    ctx.ram[0x7F0] = 0x00;
+    ctx.ram[0x7F1] = 0x0A;
+    ctx.cpu.SREG.I = true;
+    auto sp = ctx.cpu.SP;
+
+    subject.Interrupt(ctx, 0);
+    auto ranBeforeExecute = ctx.cpu.R[16] == 16u;
+    subject.Execute(ctx, 100);
+
+    // Back from the handler to the sleep it interrupted
+    ASSERT_FALSE(ranBeforeExecute);
+    ASSERT_EQ(ctx.cpu.PC, 0x942);
+    ASSERT_EQ(ctx.cpu.SP, sp);
+    ASSERT_EQ(ctx.cpu.R[16], 16u);
+    ASSERT_TRUE(ctx.cpu.SREG.I);
+    ASSERT_EQ(ctx.pendingInterrupts, 0u);
+}
+
+TEST_F(ThreadedExecutorTests, Execute_GivenWakeUpEvent_ResumesAfterSleepAtEvent)
+{
+    LoadProgramToAddress(
+        "\x88\x95" // sleep             1
+        "\x05\xe0" // ldi  r16, 0x05    1
+        "\xfe\xcf" // rjmp .-2          2
+        ,
+        6,
+        0x100);
+    ctx.cpu.PC = 0x100;
+    auto wokenAt = uint64_t(0u);
+    ctx.scheduler.Schedule(500u, [&wokenAt] (ExecutionContext& context) {
+        wokenAt = context.cycles;
+        context.cpu.is_sleeping = false;
+    });
+
+    subject.Execute(ctx, 400);
+    auto sleptThrough = ctx.cpu.is_sleeping;
+    subject.Execute(ctx, 600);
+
+    ASSERT_TRUE(sleptThrough);
+    ASSERT_EQ(wokenAt, 500u);
+    ASSERT_EQ(ctx.cpu.R[16], 0x05u);
+    ASSERT_EQ(ctx.cpu.PC, 0x104u);
+    ASSERT_EQ(ctx.cycles, 1001u);
+}
+
+TEST_F(ThreadedExecutorTests, Execute_GivenDirectAccessToMappedRegister_GoesThroughBus)
+{
+    LoadProgramToAddress(
+        "\x00\x91\xc6\x00" // lds  r16, 0xC6
+        "\x03\x95"         // inc  r16
+        "\x00\x93\xc6\x00" // sts  0xC6, r16
+        "\xfe\xcf"         // rjmp .-2
+        ,
+        12,
+        0x100);
+    ctx.cpu.PC = 0x100;
+    auto written = 0u;
+    ctx.io.Map(0xC6u,
+        [] (ExecutionContext&, uint16_t) { return uint8_t(0x41u); },
+        [&written] (ExecutionContext&, uint16_t, uint8_t value) { written = value; });
+
+    subject.Execute(ctx, 5);
+
+    ASSERT_EQ(written, 0x42u);
+    ASSERT_EQ(ctx.ram[0xC6u], 0x00u);
+}
+
+TEST_F(ThreadedExecutorTests, Execute_GivenRandomProgram_MatchesExecutor)
+{
+    for (auto iteration = 0u; iteration < 64u; iteration++)
+    {
+        auto program = std::string();
+        for (auto i = 0u; i < 64u; i++)
+        {
+            auto opcode = RandomOpCode();
+            program.push_back(static_cast<char>(opcode & 0xFFu));
+            program.push_back(static_cast<char>(opcode >> 8u));
+        }
+
+        auto expected = loader.LoadProgram(program);
+        auto actual = loader.LoadProgram(program);
+        for (auto i = 0u; i < 32u; i++)
+        {
+            auto value = static_cast<uint8_t>(rand());
+            expected.cpu.R[i] = value;
+            actual.cpu.R[i] = value;
+        }
+        auto carry = (rand() & 1) != 0;
+        expected.cpu.SREG.C = carry;
+        actual.cpu.SREG.C = carry;
+
+        auto cycles = static_cast<uint32_t>(rand()) % 64u;
+        reference.Execute(expected, cycles);
+        subject.Execute(actual, cycles);
+
+        AssertContextsMatch(actual, expected);
+    }
+}
@@ -0,0 +1,293 @@
+#include "cdif/cdif.h"
+#include "core/coremodule.h"
+#include "core/executioncontext.h"
+#include "core/executor.h"
+#include "core/interrupts.h"
+#include "core/loader.h"
+#include "core/noopclock.h"
+#include "core/scheduler.h"
+#include "core/timercounter.h"
+#include "instructions/instructionmodule.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+
+using namespace avr;
+
+namespace {
+    cdif::Container BuildTimerContainer()
+    {
+        auto ctx = cdif::Container();
+        ctx.registerModule<InstructionModule>();
+        ctx.registerModule<CoreModule>();
+        return ctx;
+    }
+
+    constexpr uint16_t TCCR0A = 0x44u;
+    constexpr uint16_t TCCR0B = 0x45u;
+    constexpr uint16_t TCNT0 = 0x46u;
+    constexpr uint16_t OCR0A = 0x47u;
+    constexpr uint16_t TIMSK0 = 0x6Eu;
+    constexpr uint16_t TIFR0 = 0x35u;
+    constexpr uint16_t TCCR1B = 0x81u;
+    constexpr uint16_t TCNT1L = 0x84u;
+    constexpr uint16_t TCNT1H = 0x85u;
+    constexpr uint16_t OCR1AL = 0x88u;
+    constexpr uint16_t OCR1AH = 0x89u;
+    constexpr uint16_t TIMSK1 = 0x6Fu;
+}
+
+class TimerCounterTests : public ::testing::Test
+{
+    protected:
+        ExecutionContext ctx;
+
+    public:
+        TimerCounterTests()
+            : ctx()
+        {}
+};
+
+TEST_F(TimerCounterTests, Count_GivenStoppedTimer_StaysPut)
+{
+    auto timer = TimerCounter::Attach(ctx, TIMER0_LAYOUT);
+    ctx.Store(TCNT0, 0x12u);
+
+    ctx.cycles = 1000u;
+
+    ASSERT_EQ(ctx.Load(TCNT0), 0x12u);
+}
+
+TEST_F(TimerCounterTests, Count_GivenRunningTimer_IsWorkedOutFromCycles)
+{
+    auto timer = TimerCounter::Attach(ctx, TIMER0_LAYOUT);
+    ctx.Store(TCCR0B, 0x02u);   // clk/8
+
+    ctx.cycles = 800u;
+    auto first = ctx.Load(TCNT0);
+    ctx.cycles = 8u * 300u + 7u;
+    auto wrapped = ctx.Load(TCNT0);
+
+    ASSERT_EQ(first, 100u);
+    ASSERT_EQ(wrapped, 300u - 256u);
+    ASSERT_TRUE(ctx.scheduler.Empty());
+}
+
+TEST_F(TimerCounterTests, TIFR_GivenOverflowWithInterruptMasked_SetsFlagUntilCleared)
+{
+    auto timer = TimerCounter::Attach(ctx, TIMER0_LAYOUT);
+    ctx.Store(TCCR0B, 0x01u);
+
+    ctx.cycles = 255u;
+    auto before = ctx.Load(TIFR0);
+    ctx.cycles = 256u;
+    auto after = ctx.Load(TIFR0);
+    ctx.Store(TIFR0, 0x01u);
+
+    ASSERT_EQ(before & 0x01u, 0x00u);
+    ASSERT_EQ(after & 0x01u, 0x01u);
+    ASSERT_EQ(ctx.Load(TIFR0) & 0x01u, 0x00u);
+    ASSERT_EQ(ctx.pendingInterrupts, 0u);
+}
+
+TEST_F(TimerCounterTests, TIFR_GivenSBIOnOneFlag_ClearsOnlyThatFlag)
+{
+    auto timer = TimerCounter::Attach(ctx, TIMER0_LAYOUT);
+    ctx.Store(OCR0A, 99u);
+    ctx.Store(TCCR0B, 0x01u);
+    ctx.cycles = 256u;
+    auto before = ctx.Load(TIFR0);
+
+    ctx.StoreBit(TIFR0, 0u, true);
+
+    ASSERT_EQ(before & 0x03u, 0x03u);
+    ASSERT_EQ(ctx.Load(TIFR0) & 0x03u, 0x02u);
+}
+
+TEST_F(TimerCounterTests, Count_GivenCTCMode_ClearsAtOCRA)
+{
+    auto timer = TimerCounter::Attach(ctx, TIMER0_LAYOUT);
+    ctx.Store(OCR0A, 99u);
+    ctx.Store(TCCR0A, 0x02u);   // WGM01
+    ctx.Store(TCCR0B, 0x01u);
+
+    ctx.cycles = 250u;
+
+    ASSERT_EQ(ctx.Load(TCNT0), 50u);
+    ASSERT_EQ(ctx.Load(TIFR0) & 0x03u, 0x02u);
+}
+
+TEST_F(TimerCounterTests, Count_GivenPhaseCorrectMode_CountsBackDown)
+{
+    auto timer = TimerCounter::Attach(ctx, TIMER0_LAYOUT);
+    ctx.Store(TCCR0A, 0x01u);   // WGM00
+    ctx.Store(TCCR0B, 0x01u);
+
+    ctx.cycles = 300u;
+    auto down = ctx.Load(TCNT0);
+    auto flagsAtTop = ctx.Load(TIFR0);
+    ctx.cycles = 510u;
+
+    ASSERT_EQ(down, 255u - 45u);
+    ASSERT_EQ(flagsAtTop & 0x01u, 0x00u);
+    ASSERT_EQ(ctx.Load(TIFR0) & 0x01u, 0x01u);
+}
+
+TEST_F(TimerCounterTests, Count_GivenCountWrittenPastTOP_RunsToMAXAndWraps)
+{
+    auto timer = TimerCounter::Attach(ctx, TIMER0_LAYOUT);
+    ctx.Store(OCR0A, 9u);
+    ctx.Store(TCCR0A, 0x02u);
+    ctx.Store(TCNT0, 250u);
+    ctx.Store(TCCR0B, 0x01u);
+
+    ctx.cycles = 5u;
+    auto atMax = ctx.Load(TCNT0);
+    ctx.cycles = 6u + 10u + 3u;
+
+    ASSERT_EQ(atMax, 255u);
+    ASSERT_EQ(ctx.Load(TCNT0), 3u);
+    ASSERT_EQ(ctx.Load(TIFR0) & 0x03u, 0x03u);
+}
+
+TEST_F(TimerCounterTests, TIMSK_GivenOverflowEnabled_SchedulesOnlyTheNextOverflow)
+{
+    auto timer = TimerCounter::Attach(ctx, TIMER0_LAYOUT);
+    ctx.Store(TCCR0B, 0x03u);   // clk/64
+    ctx.Store(TIMSK0, 0x01u);
+    auto first = ctx.scheduler.NextDue();
+
+    ctx.cycles = first;
+    ctx.scheduler.RunDue(ctx);
+
+    ASSERT_EQ(first, 256u * 64u);
+    ASSERT_EQ(ctx.scheduler.NextDue(), 2u * 256u * 64u);
+    ASSERT_EQ(ctx.pendingInterrupts, uint64_t(1u) << TIMER0_LAYOUT.overflowInterrupt);
+    ASSERT_EQ(ctx.Load(TIFR0) & 0x01u, 0x01u);
+}
+
+TEST_F(TimerCounterTests, TIFR_GivenInterruptVectored_ClearsFlag)
+{
+    auto timer = TimerCounter::Attach(ctx, TIMER0_LAYOUT);
+    ctx.Store(TCCR0B, 0x01u);
+    ctx.Store(TIMSK0, 0x01u);
+    ctx.cpu.SP = 0x7EFu;
+    ctx.cycles = 256u;
+    ctx.scheduler.RunDue(ctx);
+    auto before = ctx.Load(TIFR0);
+
+    EnterInterrupt(ctx);
+
+    ASSERT_EQ(before & 0x01u, 0x01u);
+    ASSERT_EQ(ctx.Load(TIFR0) & 0x01u, 0x00u);
+}
+
+TEST_F(TimerCounterTests, TIMSK_GivenFlagAlreadySet_RaisesInterrupt)
+{
+    auto timer = TimerCounter::Attach(ctx, TIMER0_LAYOUT);
+    ctx.Store(TCCR0B, 0x01u);
+    ctx.cycles = 300u;
+
+    ctx.Store(TIMSK0, 0x01u);
+
+    ASSERT_EQ(ctx.pendingInterrupts, uint64_t(1u) << TIMER0_LAYOUT.overflowInterrupt);
+    ASSERT_EQ(ctx.Load(TIFR0) & 0x01u, 0x01u);
+}
+
+TEST_F(TimerCounterTests, TIMSK_GivenClearedBeforeVectoring_KeepsFlagButNotInterrupt)
+{
+    auto timer = TimerCounter::Attach(ctx, TIMER0_LAYOUT);
+    ctx.Store(TCCR0B, 0x01u);
+    ctx.Store(TIMSK0, 0x01u);
+    ctx.cycles = 300u;
+
+    ctx.Store(TIMSK0, 0x00u);
+
+    ASSERT_EQ(ctx.pendingInterrupts, 0u);
+    ASSERT_EQ(ctx.Load(TIFR0) & 0x01u, 0x01u);
+}
+
+TEST_F(TimerCounterTests, TCNT1_GivenHighByteWrittenFirst_WritesBothThroughTEMP)
+{
+    auto timer = TimerCounter::Attach(ctx, TIMER1_LAYOUT);
+    ctx.Store(TCNT1H, 0x12u);
+    ctx.Store(TCNT1L, 0x34u);
+    ctx.Store(TCCR1B, 0x01u);
+
+    ctx.cycles = 0x100u;
+    auto low = ctx.Load(TCNT1L);
+    ctx.cycles = 0x200u;
+    auto high = ctx.Load(TCNT1H);
+
+    ASSERT_EQ(low, 0x34u);
+    ASSERT_EQ(high, 0x13u);
+}
+
+TEST_F(TimerCounterTests, OCR1A_GivenCTCMode_RaisesCompareMatchEachPeriod)
+{
+    auto timer = TimerCounter::Attach(ctx, TIMER1_LAYOUT);
+    ctx.Store(OCR1AH, 0x03u);
+    ctx.Store(OCR1AL, 0xE7u);   // 999
+    ctx.Store(TIMSK1, 0x02u);
+    ctx.Store(TCCR1B, 0x09u);   // WGM12, clk/1
+
+    ASSERT_EQ(ctx.scheduler.NextDue(), 1000u);
+    ctx.cycles = 1000u;
+    ctx.scheduler.RunDue(ctx);
+
+    ASSERT_EQ(ctx.pendingInterrupts, uint64_t(1u) << TIMER1_LAYOUT.compareAInterrupt);
+    ASSERT_EQ(ctx.scheduler.NextDue(), 2000u);
+    ASSERT_EQ(timer->Count(ctx), 0u);
+}
+
+TEST_F(TimerCounterTests, Execute_GivenOverflowInterruptEnabled_RunsHandlerOncePerOverflow)
+{
+    auto container = BuildTimerContainer();
+    auto clock = NoopClock();
+    auto executor = Executor(clock, container.resolve<Executor>().GetDispatchTable());
+    auto context = Loader().LoadProgram(std::string(
+        "\x01\xe0"          // ldi  r16, 0x01
+        "\x00\x93\x6e\x00"  // sts  TIMSK0, r16
+        "\x00\x93\x45\x00"  // sts  TCCR0B, r16
+        "\x78\x94"          // sei
+        "\xfe\xcf"          // rjmp .-2
+        , 14));
+    for (auto i = 0u; i < 4u; i++)
+        context.progMem[static_cast<uint16_t>(0xA00u + i)] = static_cast<uint8_t>("\x23\x94\x08\x95"[i]);   // inc r2; ret
+    auto vector = static_cast<uint16_t>(0x7F0u + 2u * TIMER0_LAYOUT.overflowInterrupt);
+    context.ram[vector] = 0x00u;
+    context.ram[static_cast<uint16_t>(vector + 1u)] = 0x0Au;
+    auto timer = TimerCounter::Attach(context, TIMER0_LAYOUT);
+
+    // Started on cycle 3, so overflows land on 259, 515 and 771
+    executor.Execute(context, 1000u);
+
+    ASSERT_EQ(context.cpu.R[2], 3u);
+    ASSERT_EQ(context.cpu.PC, 0x94Cu);
+}
+
+TEST_F(TimerCounterTests, Execute_GivenTIFRPolledWithInterruptsDisabled_SeesOverflow)
+{
+    auto container = BuildTimerContainer();
+    auto clock = NoopClock();
+    auto executor = Executor(clock, container.resolve<Executor>().GetDispatchTable());
+    auto context = Loader().LoadProgram(std::string(
+        "\x01\xe0"          // ldi  r16, 0x01
+        "\x00\x93\x6e\x00"  // sts  TIMSK0, r16
+        "\x00\x93\x45\x00"  // sts  TCCR0B, r16
+        "\x15\xb3"          // in   r17, TIFR0
+        "\x10\xff"          // sbrs r17, 0
+        "\xfa\xcf"          // rjmp .-6
+        "\x2f\xef"          // ldi  r18, 0xFF
+        "\xfe\xcf"          // rjmp .-2
+        , 20));
+    auto timer = TimerCounter::Attach(context, TIMER0_LAYOUT);
+
+    executor.Execute(context, 1000u);
+
+    ASSERT_EQ(context.cpu.R[18], 0xFFu);
+    ASSERT_FALSE(context.cpu.SREG.I);
+    ASSERT_EQ(context.pendingInterrupts, uint64_t(1u) << TIMER0_LAYOUT.overflowInterrupt);
+}
@@ -0,0 +1,205 @@
+#include "core/executioncontext.h"
+#include "core/itwidevice.h"
+#include "core/twi.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace avr;
+
+namespace {
+    constexpr uint16_t TWBR = 0xB8u;
+    constexpr uint16_t TWSR = 0xB9u;
+    constexpr uint16_t TWDR = 0xBBu;
+    constexpr uint16_t TWCR = 0xBCu;
+
+    constexpr uint8_t TWIE = 0x01u;
+    constexpr uint8_t TWEN = 0x04u;
+    constexpr uint8_t TWSTO = 0x10u;
+    constexpr uint8_t TWSTA = 0x20u;
+    constexpr uint8_t TWEA = 0x40u;
+    constexpr uint8_t TWINT = 0x80u;
+
+    // SCL periods with TWBR and TWPS at 0
+    constexpr uint64_t BIT = 16u;
+    constexpr uint64_t BYTE = 9u * BIT;
+
+    constexpr uint8_t ADDRESS = 0x48u;
+
+    // A register-pointer sensor: the first byte written picks a register,
+    // reads return it and count on
+    class FakeTwiDevice : public ITwiDevice {
+        public:
+            std::vector<uint8_t> written;
+            uint8_t next = 0x40u;
+            std::size_t acceptable = 2u;
+            int stops = 0;
+
+            bool Address(bool) override
+            {
+                return true;
+            }
+
+            bool Write(const uint8_t* data, std::size_t length) override
+            {
+                written.insert(written.end(), data, data + length);
+                return written.size() < acceptable;
+            }
+
+            void Read(uint8_t* data, std::size_t length) override
+            {
+                for (auto i = std::size_t(0u); i < length; i++)
+                    data[i] = next++;
+            }
+
+            void Stop() override
+            {
+                stops++;
+            }
+    };
+
+    uint64_t Bit(uint8_t interrupt)
+    {
+        return uint64_t(1u) << interrupt;
+    }
+}
+
+class TwiTests : public ::testing::Test
+{
+    protected:
+        ExecutionContext ctx;
+        std::shared_ptr<FakeTwiDevice> device;
+        std::shared_ptr<Twi> twi;
+
+        // Runs one TWI action to completion and returns TWSR's status
+        uint8_t Step(uint8_t control)
+        {
+            ctx.Store(TWCR, static_cast<uint8_t>(TWINT | TWEN | control));
+            ctx.cycles = ctx.cycles + ((control & TWSTA) ? BIT : BYTE);
+            return static_cast<uint8_t>(ctx.Load(TWSR) & 0xF8u);
+        }
+
+        uint8_t Send(uint8_t value)
+        {
+            ctx.Store(TWDR, value);
+            return Step(0u);
+        }
+
+    public:
+        TwiTests()
+            : ctx(),
+              device(std::make_shared<FakeTwiDevice>()),
+              twi(Twi::Attach(ctx, TWI_LAYOUT))
+        {
+            twi->Connect(ADDRESS, device);
+        }
+
+        ~TwiTests()
+        {
+            ctx.io = IOBus();
+            ctx.scheduler.Clear();
+        }
+};
+
+TEST_F(TwiTests, TWCR_GivenStart_SetsTWINTOneSCLPeriodLater)
+{
+    ctx.Store(TWCR, TWINT | TWEN | TWSTA);
+    ctx.cycles = BIT - 1u;
+    auto sending = ctx.Load(TWCR) & TWINT;
+    ctx.cycles = BIT;
+
+    ASSERT_EQ(sending, 0u);
+    ASSERT_EQ(ctx.Load(TWCR) & TWINT, TWINT);
+    ASSERT_EQ(ctx.Load(TWSR), 0x08u);
+    ASSERT_TRUE(ctx.scheduler.Empty());
+}
+
+TEST_F(TwiTests, TWDR_GivenAddress_ReportsWhetherADeviceACKedIt)
+{
+    Step(TWSTA);
+    auto present = Send(static_cast<uint8_t>(ADDRESS << 1));
+    Step(TWSTA);
+    auto absent = Send(0x20u);
+
+    ASSERT_EQ(present, 0x18u);
+    ASSERT_EQ(absent, 0x20u);
+}
+
+TEST_F(TwiTests, TWDR_GivenDataWritten_HandsItToTheDeviceUntilNACKed)
+{
+    Step(TWSTA);
+    Send(static_cast<uint8_t>(ADDRESS << 1));
+
+    auto first = Send(0x01u);
+    auto second = Send(0x02u);
+
+    ASSERT_EQ(first, 0x28u);
+    ASSERT_EQ(second, 0x30u);
+    ASSERT_EQ(device->written, std::vector<uint8_t>({ 0x01u, 0x02u }));
+}
+
+TEST_F(TwiTests, TWDR_GivenRead_ACKsWithTWEAAndNACKsTheLastByte)
+{
+    Step(TWSTA);
+    auto addressed = Send(static_cast<uint8_t>((ADDRESS << 1) | 0x01u));
+
+    auto acked = Step(TWEA);
+    auto first = ctx.Load(TWDR);
+    auto nacked = Step(0u);
+    auto last = ctx.Load(TWDR);
+
+    ASSERT_EQ(addressed, 0x40u);
+    ASSERT_EQ(acked, 0x50u);
+    ASSERT_EQ(first, 0x40u);
+    ASSERT_EQ(nacked, 0x58u);
+    ASSERT_EQ(last, 0x41u);
+}
+
+TEST_F(TwiTests, TWCR_GivenStop_ReleasesDeviceAndClearsTWSTOWithoutTWINT)
+{
+    Step(TWSTA);
+    Send(static_cast<uint8_t>(ADDRESS << 1));
+
+    ctx.Store(TWCR, TWINT | TWEN | TWSTO);
+    auto stopping = ctx.Load(TWCR);
+    ctx.cycles += BIT;
+
+    ASSERT_EQ(device->stops, 1);
+    ASSERT_EQ(stopping & (TWSTO | TWINT), TWSTO);
+    ASSERT_EQ(ctx.Load(TWCR) & (TWSTO | TWINT), 0u);
+    ASSERT_EQ(ctx.Load(TWSR), 0xF8u);
+}
+
+TEST_F(TwiTests, TWCR_GivenTWIEEnabled_RequestsInterruptWhileTWINTSet)
+{
+    ctx.Store(TWCR, TWINT | TWEN | TWIE | TWSTA);
+
+    ASSERT_EQ(ctx.scheduler.NextDue(), BIT);
+    ctx.cycles = BIT;
+    ctx.scheduler.RunDue(ctx);
+    auto raised = ctx.pendingInterrupts;
+    ctx.Store(TWCR, TWEN | TWIE);
+    auto held = ctx.pendingInterrupts;
+    ctx.Store(TWDR, static_cast<uint8_t>(ADDRESS << 1));
+    ctx.Store(TWCR, TWINT | TWEN | TWIE);
+
+    ASSERT_EQ(raised, Bit(TWI_LAYOUT.interrupt));
+    ASSERT_EQ(held, Bit(TWI_LAYOUT.interrupt));
+    ASSERT_EQ(ctx.pendingInterrupts, 0u);
+    ASSERT_EQ(ctx.scheduler.NextDue(), BIT + BYTE);
+}
+
+TEST_F(TwiTests, TWBR_GivenPrescaler_StretchesTheSCLPeriod)
+{
+    ctx.Store(TWBR, 72u);
+    ctx.Store(TWSR, 0x01u);
+
+    ctx.Store(TWCR, TWINT | TWEN | TWIE | TWSTA);
+
+    ASSERT_EQ(ctx.scheduler.NextDue(), 16u + 2u * 72u * 4u);
+    ASSERT_EQ(ctx.Load(TWSR), 0xF9u);
+}
@@ -0,0 +1,277 @@
+#include "cdif/cdif.h"
+#include "core/coremodule.h"
+#include "core/executioncontext.h"
+#include "core/executor.h"
+#include "core/interrupts.h"
+#include "core/loader.h"
+#include "core/noopclock.h"
+#include "core/usart.h"
+#include "instructions/instructionmodule.h"
+
+#include <gtest/gtest.h>
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <string>
+
+using namespace avr;
+
+namespace {
+    cdif::Container BuildUsartContainer()
+    {
+        auto ctx = cdif::Container();
+        ctx.registerModule<InstructionModule>();
+        ctx.registerModule<CoreModule>();
+        return ctx;
+    }
+
+    constexpr uint16_t UCSR0A = 0xC0u;
+    constexpr uint16_t UCSR0B = 0xC1u;
+    constexpr uint16_t UDR0 = 0xC6u;
+
+    constexpr uint8_t UDRE0 = 0x20u;
+    constexpr uint8_t TXC0 = 0x40u;
+    constexpr uint8_t RXC0 = 0x80u;
+    constexpr uint8_t TXEN0 = 0x08u;
+    constexpr uint8_t RXEN0 = 0x10u;
+    constexpr uint8_t UDRIE0 = 0x20u;
+    constexpr uint8_t TXCIE0 = 0x40u;
+    constexpr uint8_t RXCIE0 = 0x80u;
+
+    // 8N1 with UBRR at 0: ten bits of sixteen cycles
+    constexpr uint64_t FRAME = 160u;
+
+    uint64_t Bit(uint8_t interrupt)
+    {
+        return uint64_t(1u) << interrupt;
+    }
+}
+
+class UsartTests : public ::testing::Test
+{
+    protected:
+        int tx[2];
+        int rx[2];
+        ExecutionContext ctx;
+
+        std::string Drain(int fd)
+        {
+            auto text = std::string();
+            auto ready = pollfd{fd, POLLIN, 0};
+            while (poll(&ready, 1u, 0) > 0)
+            {
+                char buffer[0x1000];
+                auto count = read(fd, buffer, sizeof(buffer));
+                if (count <= 0)
+                    break;
+                text.append(buffer, static_cast<std::size_t>(count));
+            }
+            return text;
+        }
+
+    public:
+        UsartTests()
+            : tx(),
+              rx(),
+              ctx()
+        {
+            if (pipe(tx) != 0 || pipe(rx) != 0)
+                throw std::string("Unable to create pipes");
+        }
+
+        ~UsartTests()
+        {
+            ctx.io = IOBus();
+            ctx.scheduler.Clear();
+            for (auto fd : { tx[0], tx[1], rx[0], rx[1] })
+                close(fd);
+        }
+};
+
+TEST_F(UsartTests, UDR_GivenBytesWritten_HoldsThemUntilFlushed)
+{
+    auto usart = Usart::Attach(ctx, USART0_LAYOUT, tx[1]);
+    ctx.Store(UCSR0B, TXEN0);
+
+    ctx.Store(UDR0, 'h');
+    ctx.Store(UDR0, 'i');
+    auto waiting = ctx.Load(UCSR0A) & UDRE0;
+    ctx.cycles = FRAME;
+    auto ready = ctx.Load(UCSR0A) & UDRE0;
+    auto beforeFlush = Drain(tx[0]);
+    usart->Flush();
+
+    ASSERT_EQ(waiting, 0u);
+    ASSERT_EQ(ready, UDRE0);
+    ASSERT_EQ(beforeFlush, "");
+    ASSERT_EQ(Drain(tx[0]), "hi");
+}
+
+TEST_F(UsartTests, UCSRA_GivenLastFrameSent_SetsTXCUntilCleared)
+{
+    auto usart = Usart::Attach(ctx, USART0_LAYOUT, tx[1]);
+    ctx.Store(UCSR0B, TXEN0);
+    ctx.Store(UDR0, 'x');
+
+    ctx.cycles = FRAME - 1u;
+    auto sending = ctx.Load(UCSR0A) & TXC0;
+    ctx.cycles = FRAME;
+    auto sent = ctx.Load(UCSR0A) & TXC0;
+    ctx.Store(UCSR0A, TXC0);
+
+    ASSERT_EQ(sending, 0u);
+    ASSERT_EQ(sent, TXC0);
+    ASSERT_EQ(ctx.Load(UCSR0A) & TXC0, 0u);
+    ASSERT_TRUE(ctx.scheduler.NextDue() > FRAME);
+}
+
+TEST_F(UsartTests, UDR_GivenTXCInterruptEnabled_RaisesItAtEndOfFrame)
+{
+    auto usart = Usart::Attach(ctx, USART0_LAYOUT, tx[1]);
+    ctx.Store(UCSR0B, TXEN0 | TXCIE0);
+    ctx.Store(UDR0, 'x');
+
+    ASSERT_EQ(ctx.scheduler.NextDue(), FRAME);
+    ctx.cycles = FRAME;
+    ctx.scheduler.RunDue(ctx);
+
+    ASSERT_EQ(ctx.pendingInterrupts, Bit(USART0_LAYOUT.txInterrupt));
+    ASSERT_EQ(ctx.Load(UCSR0A) & TXC0, TXC0);
+}
+
+TEST_F(UsartTests, UCSRA_GivenTXCInterruptVectored_ClearsTXC)
+{
+    auto usart = Usart::Attach(ctx, USART0_LAYOUT, tx[1]);
+    ctx.Store(UCSR0B, TXEN0 | TXCIE0);
+    ctx.Store(UDR0, 'x');
+    ctx.cycles = FRAME;
+    ctx.scheduler.RunDue(ctx);
+    ctx.cpu.SP = 0x7EFu;
+
+    EnterInterrupt(ctx);
+
+    ASSERT_EQ(ctx.Load(UCSR0A) & TXC0, 0u);
+    ASSERT_EQ(ctx.pendingInterrupts, 0u);
+}
+
+TEST_F(UsartTests, UCSRA_GivenTXCClearedByWritingOne_DropsPendingInterrupt)
+{
+    auto usart = Usart::Attach(ctx, USART0_LAYOUT, tx[1]);
+    ctx.Store(UCSR0B, TXEN0 | TXCIE0);
+    ctx.Store(UDR0, 'x');
+    ctx.cycles = FRAME;
+    ctx.scheduler.RunDue(ctx);
+
+    ctx.Store(UCSR0A, TXC0);
+
+    ASSERT_EQ(ctx.Load(UCSR0A) & TXC0, 0u);
+    ASSERT_EQ(ctx.pendingInterrupts, 0u);
+}
+
+TEST_F(UsartTests, UDR_GivenUDREInterruptEnabled_RequestsItWhileRegisterEmpty)
+{
+    auto usart = Usart::Attach(ctx, USART0_LAYOUT, tx[1]);
+    ctx.Store(UCSR0B, TXEN0 | UDRIE0);
+    auto empty = ctx.pendingInterrupts;
+
+    ctx.Store(UDR0, 'a');
+    ctx.Store(UDR0, 'b');
+    auto full = ctx.pendingInterrupts;
+    ctx.cycles = ctx.scheduler.NextDue();
+    ctx.scheduler.RunDue(ctx);
+
+    ASSERT_EQ(empty, Bit(USART0_LAYOUT.udreInterrupt));
+    ASSERT_EQ(full, 0u);
+    ASSERT_EQ(ctx.cycles, FRAME);
+    ASSERT_EQ(ctx.pendingInterrupts, Bit(USART0_LAYOUT.udreInterrupt));
+}
+
+TEST_F(UsartTests, UDR_GivenInputOnDescriptor_ReceivesAFrameApart)
+{
+    ASSERT_EQ(write(rx[1], "ab", 2u), 2);
+    auto usart = Usart::Attach(ctx, USART0_LAYOUT, -1, rx[0]);
+    ctx.Store(UCSR0B, RXEN0 | RXCIE0);
+
+    ASSERT_EQ(ctx.scheduler.NextDue(), FRAME);
+    ctx.cycles = FRAME;
+    ctx.scheduler.RunDue(ctx);
+    auto pending = ctx.pendingInterrupts;
+    auto first = ctx.Load(UDR0);
+    auto afterRead = ctx.pendingInterrupts;
+    ctx.cycles = 2u * FRAME;
+    ctx.scheduler.RunDue(ctx);
+
+    ASSERT_EQ(pending, Bit(USART0_LAYOUT.rxInterrupt));
+    ASSERT_EQ(first, 'a');
+    ASSERT_EQ(afterRead, 0u);
+    ASSERT_EQ(ctx.Load(UCSR0A) & RXC0, RXC0);
+    ASSERT_EQ(ctx.Load(UDR0), 'b');
+}
+
+TEST_F(UsartTests, UCSRB_GivenNoInputYet_PollsEveryFewHundredFrames)
+{
+    auto usart = Usart::Attach(ctx, USART0_LAYOUT, -1, rx[0]);
+    ctx.Store(UCSR0B, RXEN0);
+    auto firstPoll = ctx.scheduler.NextDue();
+
+    ASSERT_EQ(write(rx[1], "z", 1u), 1);
+    ctx.cycles = firstPoll;
+    ctx.scheduler.RunDue(ctx);
+
+    ASSERT_EQ(firstPoll, FRAME * Usart::RX_POLL_FRAMES);
+    ASSERT_EQ(ctx.Load(UCSR0A) & RXC0, RXC0);
+    ASSERT_EQ(ctx.Load(UDR0), 'z');
+}
+
+TEST_F(UsartTests, UDR_GivenBufferFilled_WritesItOutInOneBatch)
+{
+    auto usart = Usart::Attach(ctx, USART0_LAYOUT, tx[1]);
+    ctx.Store(UCSR0B, TXEN0);
+
+    for (auto i = 0u; i < Usart::BUFFER_SIZE - 1u; i++)
+    {
+        ctx.cycles = i * FRAME;
+        ctx.Store(UDR0, 'a');
+    }
+    auto beforeFull = Drain(tx[0]);
+    ctx.cycles = (Usart::BUFFER_SIZE - 1u) * FRAME;
+    ctx.Store(UDR0, 'b');
+
+    ASSERT_EQ(beforeFull, "");
+    ASSERT_EQ(Drain(tx[0]), std::string(Usart::BUFFER_SIZE - 1u, 'a') + "b");
+}
+
+TEST_F(UsartTests, UDR_GivenFewBytes_FlushesThemAfterFlushCycles)
+{
+    auto usart = Usart::Attach(ctx, USART0_LAYOUT, tx[1]);
+    ctx.Store(UCSR0B, TXEN0);
+    ctx.Store(UDR0, 'q');
+
+    ctx.cycles = Usart::FLUSH_CYCLES;
+    ctx.scheduler.RunDue(ctx);
+
+    ASSERT_EQ(Drain(tx[0]), "q");
+}
+
+TEST_F(UsartTests, Execute_GivenFirmwareWritingUDR_WritesToDescriptorWhenContextGoes)
+{
+    auto container = BuildUsartContainer();
+    auto clock = NoopClock();
+    auto executor = Executor(clock, container.resolve<Executor>().GetDispatchTable());
+    {
+        auto context = Loader().LoadProgram(std::string(
+            "\x08\xe0"          // ldi  r16, 0x08
+            "\x00\x93\xc1\x00"  // sts  UCSR0B, r16
+            "\x01\xe4"          // ldi  r16, 'A'
+            "\x00\x93\xc6\x00"  // sts  UDR0, r16
+            "\xfe\xcf"          // rjmp .-2
+            , 14));
+        Usart::Attach(context, USART0_LAYOUT, tx[1]);
+
+        executor.Execute(context, 100u);
+    }
+
+    ASSERT_EQ(Drain(tx[0]), "A");
+}
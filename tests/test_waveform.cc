@@ -0,0 +1,136 @@
+#include "core/waveform.h"
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace avr;
+
+class WaveformTests : public ::testing::Test
+{
+    protected:
+        std::string path;
+
+        void WriteSamples(const std::vector<uint16_t>& samples)
+        {
+            auto bytes = std::vector<uint8_t>();
+            for (auto sample : samples)
+            {
+                bytes.push_back(static_cast<uint8_t>(sample));
+                bytes.push_back(static_cast<uint8_t>(sample >> 8));
+            }
+            auto fd = open(path.c_str(), O_WRONLY | O_TRUNC);
+            auto written = write(fd, bytes.data(), bytes.size());
+            close(fd);
+            if (written != static_cast<ssize_t>(bytes.size()))
+                throw std::string("Unable to write waveform");
+        }
+
+    public:
+        WaveformTests()
+            : path()
+        {
+            char name[] = "/tmp/avr-emu-waveform-XXXXXX";
+            auto fd = mkstemp(name);
+            if (fd < 0)
+                throw std::string("Unable to create waveform");
+            close(fd);
+            path = name;
+        }
+
+        ~WaveformTests()
+        {
+            unlink(path.c_str());
+        }
+};
+
+TEST_F(WaveformTests, Sample_GivenCycle_ReadsThatFramesSampleForTheChannel)
+{
+    WriteSamples({ 0x0001u, 0x0100u, 0x0002u, 0x0200u, 0x0003u, 0x0300u });
+    auto waveform = Waveform(path, 2u, 10u);
+
+    ASSERT_EQ(waveform.frames(), 3u);
+    ASSERT_EQ(waveform.Sample(0u, 0u), 0x0001u);
+    ASSERT_EQ(waveform.Sample(1u, 9u), 0x0100u);
+    ASSERT_EQ(waveform.Sample(0u, 10u), 0x0002u);
+    ASSERT_EQ(waveform.Sample(1u, 25u), 0x0300u);
+}
+
+TEST_F(WaveformTests, Sample_GivenCyclePastTheEnd_HoldsTheLastFrame)
+{
+    WriteSamples({ 0x0001u, 0x0002u });
+    auto waveform = Waveform(path, 1u, 4u);
+
+    ASSERT_EQ(waveform.Sample(0u, 1000000u), 0x0002u);
+}
+
+TEST_F(WaveformTests, Sample_GivenChannelNotInFile_ReadsZero)
+{
+    WriteSamples({ 0x0123u });
+    auto waveform = Waveform(path, 1u, 1u);
+
+    ASSERT_EQ(waveform.Sample(3u, 0u), 0u);
+}
+
+TEST_F(WaveformTests, Sample_GivenLongFileNonBlocking_ReadsItThroughWithoutMisses)
+{
+    auto samples = std::vector<uint16_t>(3u * Waveform::PREFETCH_BYTES / 2u);
+    for (auto i = std::size_t(0u); i < samples.size(); i++)
+        samples[i] = static_cast<uint16_t>(i);
+    WriteSamples(samples);
+    auto waveform = Waveform(path, 1u, 1u, Waveform::Mode::NonBlocking);
+
+    auto mismatches = 0u;
+    for (auto i = std::size_t(0u); i < samples.size(); i += 97u)
+        if (waveform.Sample(0u, i) != samples[i])
+            mismatches++;
+
+    ASSERT_EQ(mismatches, 0u);
+    ASSERT_EQ(waveform.misses(), 0u);
+}
+
+TEST_F(WaveformTests, Sample_GivenFileDroppedFromThePageCache_ReadsEverySample)
+{
+    auto samples = std::vector<uint16_t>(2u * Waveform::PREFETCH_BYTES);
+    for (auto i = std::size_t(0u); i < samples.size(); i++)
+        samples[i] = static_cast<uint16_t>(i * 7u);
+    WriteSamples(samples);
+    auto fd = open(path.c_str(), O_RDONLY);
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+    auto waveform = Waveform(path, 1u, 1u);
+
+    auto mismatches = 0u;
+    for (auto i = std::size_t(0u); i < samples.size(); i += 4093u)
+        if (waveform.Sample(0u, samples.size() - 1u - i) != samples[samples.size() - 1u - i])
+            mismatches++;
+
+    ASSERT_EQ(mismatches, 0u);
+    ASSERT_EQ(waveform.misses(), 0u);
+}
+
+TEST_F(WaveformTests, Sample_GivenCycleBeforeTheLastOne_ReadsThatFrame)
+{
+    auto samples = std::vector<uint16_t>(3u * Waveform::PREFETCH_BYTES / 2u);
+    for (auto i = std::size_t(0u); i < samples.size(); i++)
+        samples[i] = static_cast<uint16_t>(i);
+    WriteSamples(samples);
+    auto waveform = Waveform(path, 1u, 1u);
+
+    ASSERT_EQ(waveform.Sample(0u, samples.size() - 1u), static_cast<uint16_t>(samples.size() - 1u));
+    ASSERT_EQ(waveform.Sample(0u, 3u), 3u);
+}
+
+TEST_F(WaveformTests, Constructor_GivenFileShorterThanAFrame_Throws)
+{
+    WriteSamples({ 0x0001u });
+
+    ASSERT_THROW(Waveform(path, 2u, 1u), std::string);
+}
@@ -1,5 +1,4 @@
 #include "core/executioncontext.h"
-#include "core/noopclock.h"
 #include "instructions/xch.h"
 #include "instructions/opcodes.h"
 
@@ -13,7 +12,6 @@ using namespace avr;
 class XCHInstructionTests : public ::testing::Test
 {
     protected:
-        NoopClock clock;
         XCHInstruction subject;
         ExecutionContext ctx;
 
@@ -28,13 +26,13 @@ class XCHInstructionTests : public ::testing::Test
         {
             auto src = static_cast<uint16_t>(rand() % 30);
             auto compiledOpcode = GetOpCode(src);
-            ctx.cpu.Z = static_cast<uint16_t>(rand() % (ctx.ram.size() / 2));
+            ctx.cpu.Z = static_cast<uint16_t>(rand() % (ctx.ram.size() / 2 - ctx.cpu.SRAM_BEG) + ctx.cpu.SRAM_BEG);
             return std::make_tuple(std::move(compiledOpcode), src);
         }
 
     public:
         XCHInstructionTests() :
-            clock(), subject(clock), ctx()
+            subject(), ctx()
         {
             srand(static_cast<unsigned int>(time(NULL)));
         }